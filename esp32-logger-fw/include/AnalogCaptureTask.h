@@ -0,0 +1,32 @@
+#ifndef ANALOG_CAPTURE_TASK_H
+#define ANALOG_CAPTURE_TASK_H
+
+#include <Arduino.h>
+
+// Continuous (DMA) ADC capture for LogRecordV1::analog_ch.
+// ADC1 scans up to 8 channels at ANALOG_SAMPLE_RATE_HZ per channel; each channel runs through a
+// two-stage FIR decimation chain (ESP-DSP dot products, vectorized on the S3) down to the log rate.
+
+#define ANALOG_MAX_CHANNELS 8
+
+struct AnalogCaptureStats {
+    uint32_t frames = 0;          // DMA frames processed
+    uint32_t samples = 0;         // Raw conversions consumed
+    uint32_t outputs = 0;         // Decimated outputs per channel
+    uint32_t overflows = 0;       // Driver reported lost conversions (task fell behind)
+    uint32_t discarded = 0;       // Conversions for unexpected channels/units
+};
+
+void analogCaptureTask(void *pvParameters);
+
+// Latest decimated value per channel, in volts. Unconfigured channels (and all channels before the
+// first output) are NAN, matching the log format's "no data" convention.
+void analogGetLatest(float out[ANALOG_MAX_CHANNELS]);
+
+void analogGetStats(AnalogCaptureStats* out);
+
+// Runs the decimation chain and the scalar reference over one second of synthetic input,
+// prints throughput (samples/s/channel) for both and the largest output difference.
+void analogRunBenchmark();
+
+#endif // ANALOG_CAPTURE_TASK_H
@@ -25,4 +25,15 @@
 
 void bleManagerTask(void *pvParameters);
 
+// FTP used for intensity factor / TSS (the analytics run inside the notification callback)
+void setPowerAnalyticsFtp(uint16_t ftpWatts);
+uint16_t getPowerAnalyticsFtp();
+
+// Posts the session's mean-maximal curve to the event log (called when a log is closed).
+void postMeanMaxSummary();
+
+// Appends the mean-maximal curve so far to MMP_SAVE_FILE on the SD card. Done by the BLE task after
+// the power meter disconnects, and by `mmp save`. False if there is nothing to save or the write failed.
+bool saveMeanMaxCurve();
+
 #endif // BLE_MANAGER_TASK_H
@@ -8,7 +8,7 @@ void dataAcquisitionTask(void *pvParameters);
 
 // Functions for sensor initialization (to be called from this task or setup)
 bool initializeGPS();
-bool initializeIMU();
+// initializeIMU() lives in ImuTask.h; the IMU is serviced by its own FIFO-driven task
 // bool initializePowerMeterBLE(); // Future
 
 // Functions to get latest data from sensors
@@ -14,6 +14,9 @@ public:
     bool initialize(); // Allocate PSRAM
     bool write(const T& record);
     bool read(T& record); // Reads and removes the oldest record
+    // Single producer / single consumer: each side copies outside the lock, only count is shared
+    size_t writeBatch(const T* records, size_t n); // Returns how many fitted
+    size_t readBatch(T* out, size_t maxRecords);   // Removes up to maxRecords, oldest first
     bool peek(T& record) const; // Reads the oldest record without removing
     bool isFull() const;
     bool isEmpty() const;
@@ -25,7 +28,8 @@ private:
     size_t capacity;
     size_t head;
     size_t tail;
-    size_t count;
+    volatile size_t count;
+    portMUX_TYPE countMux = portMUX_INITIALIZER_UNLOCKED;
     // Add mutex for thread safety if accessed by multiple writer/reader tasks directly
     // SemaphoreHandle_t xMutex;
 };
@@ -7,4 +7,12 @@ void displayUpdateTask(void *pvParameters);
 
 bool initializeDisplay();
 
+// Wake the display task because shared data it shows has changed.
+// Safe to call from any task (not from ISRs); a no-op until the display task is running.
+void displayNotifyDataChanged();
+
+// Frames rendered during the last complete minute, and whether the display is currently idle (dimmed).
+uint32_t displayGetFramesLastMinute();
+bool displayIsIdle();
+
 #endif // DISPLAY_UPDATE_TASK_H
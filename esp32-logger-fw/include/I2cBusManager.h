@@ -0,0 +1,78 @@
+#ifndef I2C_BUS_MANAGER_H
+#define I2C_BUS_MANAGER_H
+
+#include <Arduino.h>
+#include <FreeRTOS.h>
+#include <semphr.h> // For SemaphoreHandle_t
+
+// The I2C bus manager task is the only code that touches `Wire` after boot.
+// - Other tasks submit raw transactions (write, then optional repeated-start read) through a
+//   priority queue; IMU transactions are always served first.
+// - Slow devices (MAX17048 fuel gauge, BME280) are polled on fixed schedules by the manager
+//   itself and their results cached, so consumers read them in O(1) without touching the bus.
+
+enum I2cPriority {
+    I2C_PRIORITY_IMU = 0,    // Served before anything else
+    I2C_PRIORITY_NORMAL,
+    I2C_PRIORITY_BACKGROUND,
+    I2C_PRIORITY_COUNT
+};
+
+// One bus transaction. The submitting task owns the struct (and its buffers) until it completes.
+// Call i2cTransactionInit() once before first use; the struct can then be reused indefinitely.
+struct I2cTransaction {
+    uint8_t address = 0;
+    const uint8_t* txData = nullptr; // Bytes written first (typically a register address)
+    size_t txLen = 0;
+    uint8_t* rxData = nullptr;       // Bytes read after a repeated start, may be nullptr
+    size_t rxLen = 0;
+
+    // Filled in by the manager
+    bool success = false;
+    int64_t queuedAtUs = 0;
+    SemaphoreHandle_t done = NULL;
+};
+
+// Cached results of the scheduled polls. Values are only meaningful when the matching *_valid flag is set.
+struct I2cSensorCache {
+    bool batt_valid = false;
+    float batt_voltage = 0.0f;       // Volts
+    float batt_percent = 0.0f;       // State of charge, %
+    float batt_charge_rate = 0.0f;   // %/hour, negative while discharging
+    unsigned long batt_update_millis = 0;
+
+    bool bme_valid = false;
+    float bme_temperature_c = 0.0f;
+    float bme_pressure_pa = 0.0f;
+    float bme_humidity_percent = 0.0f;
+    unsigned long bme_update_millis = 0;
+};
+
+struct I2cBusStats {
+    uint32_t window_ms = 0;          // Length of the sampling window these figures cover
+    uint32_t busy_us = 0;            // Time the bus was in use during the window
+    uint32_t transactions[I2C_PRIORITY_COUNT] = {0};
+    uint32_t polls = 0;
+    uint32_t errors = 0;
+    uint32_t latency_max_us[I2C_PRIORITY_COUNT] = {0}; // Queued -> completed
+    uint64_t latency_sum_us[I2C_PRIORITY_COUNT] = {0};
+};
+
+// Bring up Wire and probe the on-board devices. Called once from setup() before any task uses I2C.
+bool initializeI2cBus();
+
+void i2cBusManagerTask(void *pvParameters);
+
+bool i2cTransactionInit(I2cTransaction& txn);
+
+// Queue a transaction and block until it completes or `timeout` expires. Returns txn.success.
+// After a timeout the manager may still run the transaction later, so `txn` and its buffers must outlive it.
+bool i2cBusTransfer(I2cTransaction& txn, I2cPriority priority, TickType_t timeout);
+
+// O(1) copy of the cached poll results.
+void i2cGetSensorCache(I2cSensorCache* out);
+
+// Copy the statistics of the current window. With `resetWindow` a new window is started.
+void i2cGetBusStats(I2cBusStats* out, bool resetWindow);
+
+#endif // I2C_BUS_MANAGER_H
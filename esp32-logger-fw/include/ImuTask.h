@@ -0,0 +1,46 @@
+#ifndef IMU_TASK_H
+#define IMU_TASK_H
+
+#include <Arduino.h>
+#include "imu_fifo_parser.h" // For ImuSample
+
+// 6-axis IMU (LSM6DSO family) driven through its hardware FIFO.
+// The sensor batches accel+gyro at IMU_ODR_HZ and raises INT1 at the FIFO watermark; the IMU task
+// then drains the FIFO in one burst through the I2C bus manager, reconstructs per-sample
+// timestamps and publishes the samples in bulk to a ring consumed by the acquisition path.
+// Every sample also goes through the attitude filter at the full ODR; the latest roll/pitch is
+// published separately so consumers at lower rates never have to replay the sample stream.
+
+struct ImuStats {
+    uint32_t interrupts = 0;     // Watermark wake-ups
+    uint32_t bursts = 0;         // FIFO burst reads
+    uint32_t samples = 0;        // Samples published
+    uint32_t overruns = 0;       // Sensor FIFO overflowed before we drained it
+    uint32_t ring_dropped = 0;   // Samples lost because the consumer fell behind
+    uint32_t bus_errors = 0;
+    float ahrs_update_us_avg = 0; // Attitude filter cost per sample, averaged over the last burst
+    float ahrs_update_us_max = 0;
+};
+
+struct ImuAttitude {
+    bool valid = false;
+    int64_t timestamp_us = 0; // Time of the last sample folded in
+    float roll_deg = 0;       // Positive leaning right
+    float pitch_deg = 0;      // Positive nose down
+};
+
+// Probe and configure the sensor (FIFO, ODR, INT1). Requires the I2C bus manager to be running.
+bool initializeIMU();
+
+void imuTask(void *pvParameters);
+
+// Copy up to `maxSamples` published samples (oldest first) and remove them from the ring. The
+// acquisition task calls it every tick; samples are only queued once it has been called, so a
+// build without a consumer does not count ring_dropped.
+size_t imuReadSamples(ImuSample* out, size_t maxSamples);
+
+void imuGetStats(ImuStats* out);
+
+void imuGetAttitude(ImuAttitude* out);
+
+#endif // IMU_TASK_H
@@ -7,7 +7,7 @@
 void sdLoggingTask(void *pvParameters);
 
 bool initializeSDCard();
-void createNewLogFile();
+bool createNewLogFile(); // False (and STATE_SD_CARD_ERROR) if no log file could be opened
 void closeLogFile();
 
 #endif // SD_LOGGING_TASK_H
@@ -1,5 +1,23 @@
 #ifndef WIFI_HANDLER_TASK_H
 #define WIFI_HANDLER_TASK_H
 #include <Arduino.h>
+
+// Post-ride log offload: while enabled the logger runs a soft AP and serves the SD log directory
+// over HTTP (http_file_server.h), including Range requests so interrupted downloads resume.
+// Radio and server are off otherwise.
+
+struct WifiOffloadStats {
+    bool active = false;
+    uint32_t requests = 0;
+    uint64_t bytes_served = 0;
+    float last_mbps = 0.0f;       // Throughput of the last file transfer
+    uint8_t stations = 0;         // Clients associated with the AP
+};
+
 void wifiHandlerTask(void *pvParameters);
+
+// Starts/stops offload mode; takes effect in the Wi-Fi task. Safe to call from any task.
+void wifiOffloadSetEnabled(bool enabled);
+void wifiOffloadGetStats(WifiOffloadStats* out);
+
 #endif // WIFI_HANDLER_TASK_H
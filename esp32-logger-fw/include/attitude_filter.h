@@ -0,0 +1,49 @@
+#ifndef ATTITUDE_FILTER_H
+#define ATTITUDE_FILTER_H
+
+#include <stdint.h>
+
+// Madgwick gradient-descent attitude filter for a 6-axis IMU (gyro + accelerometer).
+// Single precision throughout, no allocation and no platform dependencies (host-buildable);
+// one update is a few dozen multiply-adds and one reciprocal square root on the S3's FPU.
+//
+// Sensor frame: X forward, Y left, Z up. Roll is positive leaning right, pitch positive nose
+// down (right-handed rotations about X and Y). Without a magnetometer yaw is free-running.
+//
+// In a steady corner the accelerometer sees gravity plus the centripetal acceleration, which
+// pulls an uncompensated filter back towards upright. When a forward speed is supplied the
+// centripetal term (speed x yaw rate, horizontal and perpendicular to the heading) is removed
+// from the accelerometer before it is used as the gravity reference.
+
+class AttitudeFilter {
+public:
+    // `beta`: accelerometer correction gain (rad/s); larger converges faster but follows
+    // lateral accelerations more
+    explicit AttitudeFilter(float beta);
+
+    void reset();
+    void setBeta(float beta) { _beta = beta; }
+
+    // Forward speed used for centripetal compensation; 0 (the default) disables it
+    void setForwardSpeed(float mps) { _speedMps = mps; }
+
+    // One sample: gyro in rad/s, accel in m/s^2 (any consistent unit), dt in seconds.
+    // The first call seeds roll and pitch from the accelerometer alone.
+    void update(const float gyro[3], const float accel[3], float dt);
+
+    bool initialized() const { return _initialized; }
+    const float* quaternion() const { return _q; } // w, x, y, z (sensor to earth)
+
+    float rollDeg() const;
+    float pitchDeg() const;
+
+private:
+    void seedFromAccel(const float accel[3]);
+
+    float _beta;
+    float _speedMps;
+    float _q[4];
+    bool _initialized;
+};
+
+#endif // ATTITUDE_FILTER_H
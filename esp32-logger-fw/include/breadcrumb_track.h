@@ -0,0 +1,57 @@
+#ifndef BREADCRUMB_TRACK_H
+#define BREADCRUMB_TRACK_H
+
+#include <stdint.h>
+
+// Bounded breadcrumb trail of the route ridden so far, for the map screen.
+//
+// Fixes are projected into a local integer frame (decimetres east/north of the first fix) and
+// simplified as they stream in: a fix only becomes a stored point once the fixes since the last
+// stored point can no longer be represented by a straight line within `tolerance`. When the
+// point buffer fills up, the tolerance doubles and the stored points are re-simplified in place,
+// so memory stays fixed however long the ride is. No platform dependencies (host-buildable).
+
+struct TrackPoint {
+    int32_t x;   // Decimetres east of the origin
+    int32_t y;   // Decimetres north of the origin
+};
+
+class BreadcrumbTrack {
+public:
+    // `storage` holds the simplified points, `pending` the fixes since the last stored point.
+    BreadcrumbTrack(TrackPoint* storage, uint32_t capacity, TrackPoint* pending, uint32_t pendingCapacity,
+                    int32_t initialToleranceDm);
+
+    void addFix(double latitude, double longitude);
+    void reset();
+
+    const TrackPoint* points() const { return _points; }
+    uint32_t count() const { return _count; }
+    // Changes whenever existing points are rewritten (re-simplification, reset); appends keep it.
+    uint32_t generation() const { return _generation; }
+    int32_t toleranceDm() const { return _tolerance; }
+    void bounds(int32_t* minX, int32_t* minY, int32_t* maxX, int32_t* maxY) const;
+
+private:
+    void project(double latitude, double longitude, TrackPoint* out) const;
+    void append(const TrackPoint& p);
+    bool deviates(const TrackPoint& a, const TrackPoint& b, const TrackPoint* candidates, uint32_t n) const;
+    void resimplify();
+
+    TrackPoint* _points;
+    uint32_t _capacity;
+    uint32_t _count;
+    TrackPoint* _pending;
+    uint32_t _pendingCapacity;
+    uint32_t _pendingCount;
+
+    int32_t _tolerance;
+    int32_t _initialTolerance;
+    uint32_t _generation;
+
+    bool _haveOrigin;
+    double _originLat, _originLon, _dmPerDegLon;
+    int32_t _minX, _minY, _maxX, _maxY;
+};
+
+#endif // BREADCRUMB_TRACK_H
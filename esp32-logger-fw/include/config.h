@@ -1,10 +1,14 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+// Also included by the host replay (tools/sensor_replay_host.cpp), which has no Arduino core:
+// keep platform types inside the ARDUINO blocks.
+#ifdef ARDUINO
 #include <Arduino.h>
-#include "types.h" // For PowerCadenceData
 #include <FreeRTOS.h>
 #include <semphr.h> // For SemaphoreHandle_t
+#endif
+#include "types.h" // For PowerCadenceData
 
 // Pin Definitions
 // GPS (using Serial2, typically UART2 on ESP32-S3)
@@ -14,12 +18,74 @@
 // IMU (I2C0 - Wire)
 #define IMU_SDA_PIN GPIO_NUM_8
 #define IMU_SCL_PIN GPIO_NUM_9
+#define IMU_INT1_PIN GPIO_NUM_12 // LSM6DSO INT1 (FIFO watermark)
+#define IMU_I2C_ADDRESS 0x6A     // 0x6B when SDO/SA0 is pulled high
+#define IMU_ODR_HZ 416           // Accel + gyro output/batch rate: 416, 833 or 1666 Hz
+#define IMU_FIFO_WATERMARK_WORDS 32 // Accel and gyro words (16 samples) per watermark interrupt
+#define IMU_SAMPLE_RING_SIZE 512 // Published samples buffered for the acquisition path (~1.2 s at 416 Hz)
+#define IMU_SAMPLE_PERIOD_US (1000000UL / IMU_ODR_HZ)
+#define ACCEL_MPS2_PER_LSB  (0.244e-3f * 9.80665f)      // +-8 g range set by ImuTask.cpp
+#define GYRO_RADPS_PER_LSB  (70.0e-3f * 0.01745329252f) // +-2000 dps range set by ImuTask.cpp
+// Attitude filter (Madgwick). Assumes the board is mounted with sensor X forward and Z up.
+#define AHRS_BETA 0.05f                  // Accelerometer correction gain (rad/s)
+#define AHRS_COMPENSATION_MIN_SPEED_MPS 2.0f // Centripetal compensation from GPS speed above this
+
+// Elevation filter (BME280 pressure + GPS altitude, see elevation_filter.h)
+#define ELEVATION_ACCEL_NOISE_MPS2 0.2f       // Vertical acceleration of the rider, 1 sigma
+#define ELEVATION_BARO_NOISE_M 0.4f           // BME280 pressure altitude noise at x16 oversampling
+#define ELEVATION_GPS_NOISE_M 6.0f            // GPS altitude noise
+#define ELEVATION_OFFSET_DRIFT_M 0.02f        // Weather drift of the baro offset, m per sqrt(s)
+#define ELEVATION_GPS_GATE_SIGMA 5.0f         // Reject GPS altitudes further out than this
+#define ELEVATION_GRADIENT_TAU_S 4.0f         // Smoothing of the displayed gradient
+#define ELEVATION_GRADIENT_MIN_SPEED_MPS 2.0f // Gradient reads 0 below walking pace
+#define ELEVATION_ASCENT_HYSTERESIS_M 2.0f    // Total ascent ignores wiggles smaller than this
+
+// I2C Bus Manager (all devices on Wire: MAX17048, BME280, IMU)
+#define I2C_BUS_CLOCK_HZ 400000
+#define I2C_BUS_BUFFER_SIZE 256        // Wire buffer; must hold the largest IMU FIFO burst
+#define I2C_QUEUE_DEPTH 8              // Pending transactions per priority level
+#define I2C_FUEL_GAUGE_POLL_MS 5000    // MAX17048 at 0.2 Hz
+#define I2C_BME280_POLL_MS 200         // BME280 at 5 Hz (feeds the elevation filter)
+
+// Analog capture (ADC1 continuous/DMA mode)
+#define ANALOG_CHANNEL_COUNT 3
+#define ANALOG_ADC1_CHANNELS { 4, 5, 9 }  // ADC1 channels: GPIO5 (D5), GPIO6 (D6), GPIO10 (D10). ADC2 is not usable in DMA mode alongside Wi-Fi
+#define ANALOG_SAMPLE_RATE_HZ 4000        // Per channel
+#define ANALOG_DECIM_STAGE1 4             // 4000 -> 1000 Hz
+#define ANALOG_DECIM_STAGE2 5             // 1000 -> 200 Hz (log rate is lower; latest output is sampled)
+#define ANALOG_FIR_STAGE1_TAPS 32
+#define ANALOG_FIR_STAGE2_TAPS 48
+#define ANALOG_DMA_FRAME_BYTES 256        // Conversions handed over per DMA interrupt (4 bytes each on the S3)
 
 // SD Card (SPI3/HSPI)
 #define SD_MOSI_PIN GPIO_NUM_35
 #define SD_MISO_PIN GPIO_NUM_37
 #define SD_SCK_PIN  GPIO_NUM_36
 #define SD_CS_PIN   GPIO_NUM_34
+#define SD_SPI_CLOCK_MHZ 16
+#define LOG_DIRECTORY "/"                 // Where log_NNN.bin / .evt / .lod files are written
+
+// SD Benchmark (`sdbench`; see sd_bench.h)
+#define SD_BENCH_FILE "/sdbench.tmp"       // Scratch file, removed afterwards
+#define SD_BENCH_PROFILE_FILE "/sdbench.json" // Per-card profile, kept on the card it describes
+#define SD_BENCH_SEQUENTIAL_BYTES (2UL * 1024 * 1024) // Per block size; 8 sizes, so 16 MB written by default
+#define SD_BENCH_SUSTAINED_WRITES 2000     // Logger-sized writes per latency run (~3 MB)
+#define SD_BENCH_RING_MARGIN 2             // Recommended ring depth covers the worst stall this many times
+
+// Log Rotation (`rotation`; see log_rotation.h)
+#define LOG_ROTATE_BYTES (64ULL * 1024 * 1024) // Also each log's preallocated extent (~55 min at 200 Hz)
+#define LOG_ROTATE_MINUTES 60              // Rotate after this long even if the size limit is not reached
+#define LOG_ROTATE_EVENT_BYTES (1024UL * 1024) // Preallocated per event sidecar (~19,000 events)
+#define LOG_COUNTER_FILE "/log_next.txt"   // Next log number, so no directory walk is needed to name files
+#define LOG_ROTATE_NAME_ATTEMPTS 8         // Taken names skipped before falling back to a directory scan
+#define LOG_ROTATION_POLL_MS 1000          // Rotation task wakes at least this often
+#define SD_LOG_SYNC_INTERVAL_MS 1000       // Directory entry updated this often, so a power cut loses at most this much
+#define SD_LOG_IDLE_POLL_MS 50             // SD logging task sleeps this long once the ring is drained
+#define LOG_SUMMARY_SPAN_MINUTES (LOG_ROTATE_MINUTES + 15) // .lod regions sized for this; later buckets are flagged and dropped
+
+// Log Download (`ls` / `get` over USB CDC, tools/log_download.py)
+#define LOG_DOWNLOAD_CHUNK_BYTES 4096     // File bytes per CRC-protected frame
+#define LOG_DOWNLOAD_STALL_MS 2000        // Abort a transfer when the host stops reading this long
 
 // Buttons (ESP32-S3 Reverse TFT Feather)
 #define BUTTON_A_PIN GPIO_NUM_0  // BOOT/D0 button
@@ -34,14 +100,105 @@
 // Data Acquisition
 #define DATA_ACQUISITION_INTERVAL_MS 5 // 200Hz
 
-// LogRecordV1 Structure (defined in types.h)
+// Record Overflow Policy (SD stalls; see log_backpressure.h). Marks are PSRAM ring fill in percent.
+#define LOG_STAGING_RECORDS 64             // Internal staging ring (~6.5 KB), holds records the PSRAM ring can't take
+#define LOG_STAGING_SPILL_RECORDS 16       // Staged records are copied to PSRAM in batches of this many
+#define LOG_BP_DECIMATE_PERCENT 50         // Above this: keep 1 in LOG_BP_DECIMATED_EVERY records
+#define LOG_BP_MINIMAL_PERCENT 80          // Above this: keep 1 in LOG_BP_MINIMAL_EVERY records
+#define LOG_BP_RECOVER_PERCENT 25          // Back to full rate once the writer drains the ring to this
+#define LOG_BP_DECIMATED_EVERY 4           // 50 Hz; records with new power, cadence or GPS data are always kept
+#define LOG_BP_MINIMAL_EVERY 20            // 10 Hz
+
+// Display Refresh
+// The display task sleeps until data changes, a button is pressed or the refresh deadline expires.
+#define DISPLAY_MAX_FPS 20                 // Cap on redraws; a full 240x135 push takes ~15ms over SPI
+#define DISPLAY_MIN_REFRESH_MS 1000        // Redraw at least this often while active (clock-like fields, GPS timeout)
+#define DISPLAY_IDLE_REFRESH_MS 5000       // Redraw interval once idle
+#define DISPLAY_IDLE_TIMEOUT_MS 60000      // No activity for this long -> idle (dimmed, slow refresh)
+#define DISPLAY_IDLE_SPEED_MPS 1.0f        // GPS speed above this counts as activity
+#define DISPLAY_BACKLIGHT_ACTIVE 255       // PWM duty (0-255)
+#define DISPLAY_BACKLIGHT_DIMMED 24
+
+// Segment / Lap Gates
+#define GATES_FILE_PATH "/gates.csv"       // segment_id,kind(S|F|L),lat1,lon1,lat2,lon2 per line
+#define GATE_CELL_SIZE_M 50.0f             // Grid cell; a fix-to-fix movement walks every cell on its line
+#define GATE_HASH_BUCKETS 4096             // Power of two
+#define GATE_MIN_LAP_MS 10000              // Ignore lap-gate re-crossings sooner than this
+
+// Breadcrumb Map
+#define TRACK_MAX_POINTS 512               // Simplified points kept for the map screen (fixed memory)
+#define TRACK_PENDING_FIXES 32             // Fixes that can be merged into one straight segment
+#define TRACK_TOLERANCE_DM 20              // Initial simplification tolerance (2 m); doubles whenever the buffer fills
+
+// Power Analytics (rolling averages, NP, IF, TSS)
+#define POWER_FTP_WATTS 250                // Default FTP for IF/TSS; change at runtime with the `ftp` command
+#define POWER_DROPOUT_MS 3000              // No notification for this long -> power counts as 0
+#define POWER_SUMMARY_INTERVAL_S 60        // Metrics snapshot written to the event log this often
+#define MMP_DURATIONS_S { 5, 60, 300, 1200 } // Mean-maximal curve durations; the longest sets the PSRAM ring size
+#define MMP_SAVE_FILE LOG_DIRECTORY "mmp.csv" // Curve appended here on power meter disconnect and `mmp save`
+
+// Live Telemetry (USB CDC)
+#define TELEMETRY_TX_RING_BYTES 16384      // ~80 ms of LogRecordV1 frames at 200 Hz plus sensor messages
+
+// Raw Capture (`capture on|only|off`; see raw_capture.h, decoded by tools/sensor_capture.py)
+#define RAW_CAPTURE_RING_BYTES 32768       // ~4 s of IMU FIFO + NMEA + GATT chunks (~8 KB/s) through a card stall
+#define RAW_CAPTURE_WRITE_BYTES 4096       // Card write size while capturing (multiple of the 512-byte sector)
+#define RAW_CAPTURE_PREALLOC_BYTES (32ULL * 1024 * 1024) // Contiguous extent per cap_NNN.cap (~70 min)
+#define RAW_CAPTURE_SYNC_MS 1000           // Directory entry updated this often, so a power cut loses at most this much
+#define RAW_CAPTURE_POLL_MS 100            // Capture task drains the ring this often
+#define RAW_CAPTURE_COUNTER_FILE "/cap_next.txt" // Next capture number, like LOG_COUNTER_FILE
+#define RAW_CAPTURE_NAME_ATTEMPTS 4        // Numbers tried from the counter before one directory scan
+
+// Wi-Fi Log Offload (`wifi on|off`; soft AP + HTTP server for the log directory)
+#define WIFI_AP_SSID "ESP32-Logger"       // The last two bytes of the unit's MAC are appended
+#define WIFI_AP_PASSWORD ""                // Empty: random per unit, made at the first 'wifi on' and kept in NVS
+#define WIFI_AP_PASSWORD_LENGTH 12         // Generated password; WPA2 needs at least 8 characters
+#define WIFI_HTTP_PORT 80
+#define WIFI_HTTP_BUFFER_BYTES 16384       // File read / socket write chunk (multiple of the 512-byte sector)
+#define WIFI_CLIENT_TIMEOUT_MS 5000        // Drop a client that stops reading or sending this long
+
+// Event Log (low-rate records written next to the main log)
+#define EVENT_LOG_QUEUE_DEPTH 32
+
+// Event Tracing (`trace` command, tools/trace2chrome.py)
+// #define ENABLE_TRACE                    // Uncomment to compile the trace points in
+#define TRACE_RING_RECORDS 8192            // Per core, 16 bytes each, in PSRAM
+
+// Task Monitor (`top` and periodic task/heap records)
+#define TASK_MONITOR_WINDOW_MS 1000        // Default `top` sampling window
+#define TASK_MONITOR_LOG_INTERVAL_S 60     // Task stats written to the event log this often
+
+// Power Management (`pm` command; needs CONFIG_PM_ENABLE, light sleep also CONFIG_FREERTOS_USE_TICKLESS_IDLE;
+// neither is set by the Arduino core's prebuilt sdkconfig, so these only apply to an arduino + espidf build)
+#define POWER_CPU_MAX_MHZ 240              // While any task runs
+#define POWER_CPU_MIN_MHZ 80               // Both cores idle; 80 keeps APB (UART/I2C/SPI clocks) unchanged
+#define POWER_LIGHT_SLEEP_ENABLE true      // Light sleep through idle periods nobody holds a lock against
+#define POWER_GPS_IDLE_MS 2000             // NMEA silent this long -> the GPS UART no longer blocks light sleep
+#define BATTERY_CAPACITY_MAH 1200          // Converts the fuel gauge's %/h charge rate into mA
+#define GPS_WAIT_MS 100                    // GPS task sleeps this long without UART data (barometer is 5 Hz)
+#define TERMINAL_WAIT_MS 500               // Terminal task sleeps this long without input or stream data
+
+// Heap Audit (`heap_audit` command; counting needs the heap_audit PlatformIO environment)
+#define HEAP_AUDIT_AUTO_MARK_S 120         // Steady-state marker set this long after boot (0: manual only)
+
+// Memory Placement (`mem`, `membench`; see mem_placement.h)
+#define MEM_ARENA_INTERNAL_BYTES 0         // Not reserved until something run-time-sized lives there
+#define MEM_ARENA_DMA_BYTES 0              // Not reserved until something run-time-sized lives there
+#define MEM_ARENA_PSRAM_BYTES (640 * 1024) // Framebuffer, mean-max ring, trace rings, record ring
+#define MEM_BENCH_AT_BOOT true             // Print the per-region benchmark during setup() (~50 ms)
+#define MEM_BENCH_BYTES (64 * 1024)        // Buffer size for the boot benchmark and `membench` default
+#define DISPLAY_FRAMEBUFFER_REGION MEM_REGION_PSRAM // 64 KB canvas; MEM_REGION_INTERNAL trades RAM for speed
+
+// LogRecordV1 Structure (generated from the table in log_schema.h)
 
 // PSRAM Buffer Configuration
 #define PSRAM_BUFFER_SIZE_RECORDS 2000 // Number of LogRecordV1 entries (e.g., 10 seconds at 200Hz)
 
 // Shared data structure for power and cadence
 extern PowerCadenceData g_powerCadenceData;
+#ifdef ARDUINO
 extern SemaphoreHandle_t g_dataMutex;
+#endif
 
 // System States (Example)
 enum SystemState {
@@ -0,0 +1,72 @@
+#ifndef CYCLING_POWER_H
+#define CYCLING_POWER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Decoder for Cycling Power Measurement notifications (0x2A63), as used by the BLE manager's
+// notify callback and the host replay. Cadence comes from the crank revolution counter and event
+// time of consecutive notifications, so the decoder keeps that state between calls; reset() it
+// when the power meter reconnects. No platform dependencies (host-buildable).
+
+// Measurement flags (Cycling Power Service 1.1, 0x2A63). Optional fields follow the flags and the
+// instantaneous power in this bit order; the ones not decoded here are stepped over.
+#define CP_FLAG_BALANCE            0x0001 // uint8, 1/2 percent
+#define CP_FLAG_BALANCE_REFERENCE  0x0002 // No field: balance is of the left pedal
+#define CP_FLAG_ACCUMULATED_TORQUE 0x0004 // 2 bytes
+#define CP_FLAG_TORQUE_SOURCE      0x0008 // No field
+#define CP_FLAG_WHEEL_REVOLUTIONS  0x0010 // 6 bytes
+#define CP_FLAG_CRANK_REVOLUTIONS  0x0020 // uint16 revolutions, uint16 event time (1/1024 s)
+#define CP_FLAG_EXTREME_FORCES     0x0040 // 4 bytes
+#define CP_FLAG_EXTREME_TORQUES    0x0080 // 4 bytes
+#define CP_FLAG_EXTREME_ANGLES     0x0100 // 3 bytes
+#define CP_FLAG_TOP_DEAD_SPOT      0x0200 // uint16 degrees
+#define CP_FLAG_BOTTOM_DEAD_SPOT   0x0400 // uint16 degrees
+#define CP_FLAG_ACCUMULATED_ENERGY 0x0800 // 2 bytes, last; not decoded
+
+// Cycling Power Feature (0x2A65) bit for meters that report dead spot angles
+#define CP_FEATURE_DEAD_SPOT_ANGLES (1UL << 6)
+
+// Fields a notification announced in its flags but was too short to hold
+#define CP_SHORT_FLAGS      0x01 // Not even the flags; nothing was decoded
+#define CP_SHORT_POWER      0x02
+#define CP_SHORT_BALANCE    0x04
+#define CP_SHORT_CRANK      0x08
+#define CP_SHORT_TOP_DEAD   0x10
+#define CP_SHORT_BOTTOM_DEAD 0x20
+
+struct CyclingPowerMeasurement {
+    uint16_t flags;
+    uint16_t power_watts;          // Negative instantaneous power reads as 0
+    uint8_t cadence_rpm;           // 0 until two crank events have been seen
+    float left_balance_percent;    // 50 when not reported
+    bool balance_available;
+    uint16_t top_dead_spot_deg;
+    bool top_dead_spot_available;
+    uint16_t bottom_dead_spot_deg;
+    bool bottom_dead_spot_available;
+};
+
+class CyclingPowerDecoder {
+public:
+    CyclingPowerDecoder();
+
+    void reset();
+
+    // Dead spot angles are only decoded when the Cycling Power Feature characteristic says the
+    // meter supports them
+    void setDeadSpotAnglesSupported(bool supported) { _deadSpotAnglesSupported = supported; }
+    void setFeatures(uint32_t features) { _deadSpotAnglesSupported = (features & CP_FEATURE_DEAD_SPOT_ANGLES) != 0; }
+
+    // Decodes one notification payload into `out`; returns the CP_SHORT_* bits for fields that
+    // were announced but truncated (0 for a complete notification)
+    uint8_t decode(const uint8_t* data, size_t length, CyclingPowerMeasurement* out);
+
+private:
+    bool _deadSpotAnglesSupported;
+    bool _haveCrank;
+    uint16_t _prevCrankRevolutions;
+    uint16_t _prevCrankEventTime; // 1/1024 s
+};
+
+#endif // CYCLING_POWER_H
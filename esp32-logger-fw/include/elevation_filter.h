@@ -0,0 +1,72 @@
+#ifndef ELEVATION_FILTER_H
+#define ELEVATION_FILTER_H
+
+#include <stdint.h>
+
+// Barometric + GPS elevation fusion: a three-state Kalman filter over
+//   elevation h (m, GPS/MSL datum), vertical speed v (m/s) and baro offset o (m),
+// where pressure altitude = h + o. The barometer carries the short-term shape of the climb,
+// GPS altitude slowly pins the absolute level (weather moves o), so neither GPS noise nor
+// pressure drift reaches the output. Measurements are scalar, so an update is a fixed handful
+// of 3x3 multiply-adds plus one powf per pressure sample: no inversion, loops or allocation.
+// No platform dependencies (host-buildable).
+
+struct ElevationFilterConfig {
+    float accel_noise_mps2;     // Vertical acceleration driving the constant-velocity model
+    float baro_noise_m;         // Pressure altitude noise (1 sigma)
+    float gps_noise_m;          // GPS altitude noise (1 sigma)
+    float offset_drift_m;       // Baro offset random walk, m per sqrt(s)
+    float gps_gate_sigma;       // GPS fixes further than this from the prediction are rejected
+    float gradient_tau_s;       // Smoothing of the reported gradient
+    float gradient_min_speed_mps; // Below this the gradient is undefined and reported as 0
+    float ascent_hysteresis_m;  // Elevation gain counts once the climb exceeds this
+};
+
+struct ElevationEstimate {
+    bool valid = false;
+    float elevation_m = 0.0f;
+    float vertical_speed_mps = 0.0f;
+    float gradient_percent = 0.0f;
+    float ascent_m = 0.0f;          // Total climbing since reset
+    float baro_offset_m = 0.0f;     // Pressure altitude minus elevation
+    float elevation_sigma_m = 0.0f; // 1 sigma uncertainty of elevation_m
+    uint32_t baro_updates = 0;
+    uint32_t gps_updates = 0;
+    uint32_t gps_rejected = 0;      // Fixes dropped by the innovation gate
+};
+
+// Pressure altitude in the standard atmosphere (1013.25 hPa at sea level)
+float pressureAltitudeM(float pressurePa);
+
+class ElevationFilter {
+public:
+    explicit ElevationFilter(const ElevationFilterConfig& config);
+
+    void reset();
+
+    // Timestamps are monotonic milliseconds; a sample older than the filter time is applied
+    // without prediction.
+    void addPressure(uint32_t timestampMs, float pressurePa);
+    void addGps(uint32_t timestampMs, float altitudeM, float groundSpeedMps);
+
+    void getEstimate(ElevationEstimate* out) const { *out = _estimate; }
+
+private:
+    void predictTo(uint32_t timestampMs);
+    bool update(const float h[3], float z, float variance, float gateSigma);
+    void initialize(uint32_t timestampMs, float elevationM);
+    void publish(float dtS);
+
+    ElevationFilterConfig _config;
+    bool _initialized;
+    uint32_t _timeMs;
+    float _x[3];    // h, v, o
+    float _p[3][3];
+    float _groundSpeedMps;
+    float _ascentReferenceM;
+    bool _climbing;
+    uint32_t _consecutiveGpsRejects;
+    ElevationEstimate _estimate;
+};
+
+#endif // ELEVATION_FILTER_H
@@ -0,0 +1,121 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <Arduino.h>
+
+// Low-rate event/summary records that travel next to the 200 Hz LogRecordV1 stream.
+// Producers post fixed-size records without blocking; the SD logging task drains them into the
+// session's event sidecar file. Records are written verbatim, so payload structs must be packed.
+//
+// Without a card the SD logging task still drains the queue, discarding what it reads.
+
+#define EVENT_PAYLOAD_MAX 48
+#define EVENT_MEAN_MAX_POINTS 4   // Curve points that fit in one record
+
+enum EventType : uint16_t {
+    EVENT_POWER_SUMMARY = 1,   // PowerSummaryEvent
+    EVENT_MEAN_MAX_CURVE = 2,  // MeanMaxCurveEvent, written once when the log is closed
+    EVENT_GATE_CROSSING = 3,   // GateCrossingEvent
+    EVENT_SYSTEM_STATS = 4,    // SystemStatsEvent, followed by one EVENT_TASK_STATS per task
+    EVENT_TASK_STATS = 5,      // TaskStatsEvent
+    EVENT_BACKPRESSURE = 6,    // BackpressureEvent, on every record rate level change
+    EVENT_LOG_ROTATION = 7,    // LogRotationEvent, first in every file after a rotation
+};
+
+typedef struct __attribute__((__packed__)) {
+    uint32_t timestamp_ms;
+    uint16_t type;             // EventType
+    uint16_t length;           // Valid payload bytes
+    uint8_t payload[EVENT_PAYLOAD_MAX];
+} EventRecord;
+
+// Periodic snapshot of PowerMetrics (power_analytics.h)
+typedef struct __attribute__((__packed__)) {
+    uint32_t elapsed_s;
+    uint16_t avg3s_watts;
+    uint16_t avg10s_watts;
+    uint16_t avg30s_watts;
+    uint16_t avg_watts;
+    uint16_t normalized_power;
+    uint16_t ftp_watts;
+    float intensity_factor;
+    float tss;
+    float work_kj;
+} PowerSummaryEvent;
+
+// Session mean-maximal power curve (mean_max_power.h)
+typedef struct __attribute__((__packed__)) {
+    uint32_t elapsed_s;
+    uint8_t count;
+    struct __attribute__((__packed__)) {
+        uint16_t duration_s;
+        uint16_t best_watts;
+        uint32_t best_end_s;
+    } points[EVENT_MEAN_MAX_POINTS];
+} MeanMaxCurveEvent;
+
+// Segment/lap gate crossing (segment_gates.h); elapsed_ms is set when it completes a lap or segment
+typedef struct __attribute__((__packed__)) {
+    int32_t segment_id;
+    uint8_t kind;              // GateKind
+    uint32_t crossing_ms;      // Interpolated GPS time of the crossing (ms since midnight UTC of the first fix's day)
+    uint32_t elapsed_ms;       // 0 unless a lap/segment completed
+} GateCrossingEvent;
+
+// Core load and heap over one task monitor window (task_monitor.h); 0xFFFF = CPU not measured
+typedef struct __attribute__((__packed__)) {
+    uint32_t window_ms;
+    uint16_t core_load_permille[2];
+    uint8_t task_count;
+    uint8_t event_queue_depth;
+    uint32_t heap_internal_free;
+    uint32_t heap_internal_largest;
+    uint32_t heap_internal_min_free;
+    uint32_t heap_psram_free;
+    uint32_t heap_psram_largest;
+} SystemStatsEvent;
+
+typedef struct __attribute__((__packed__)) {
+    char name[16];
+    uint8_t core;              // 0xFF = not pinned
+    uint8_t state;             // eTaskState
+    uint8_t priority;
+    uint16_t cpu_permille;     // Of one core over the window; 0xFFFF = not measured
+    uint32_t stack_free_min_bytes;
+} TaskStatsEvent;
+
+// Record path level change (log_backpressure.h). Counters are totals since logging started; records
+// missing from the log are exactly skipped (deliberate decimation) plus dropped (both rings full).
+typedef struct __attribute__((__packed__)) {
+    uint8_t from_level;        // LogRateLevel
+    uint8_t to_level;
+    uint8_t ring_fill_percent; // PSRAM ring fill that triggered the change
+    uint8_t staging_count;     // Records waiting in the internal staging ring
+    uint32_t in_previous_ms;   // Time spent at from_level
+    uint32_t produced;
+    uint32_t skipped;
+    uint32_t dropped;
+    uint32_t ring_peak;        // Highest PSRAM ring fill so far, records
+} BackpressureEvent;
+
+// Log file rotation (log_rotation.h): links a file to the one before it
+typedef struct __attribute__((__packed__)) {
+    uint32_t previous_index;   // NNN of the previous log_NNN.bin
+    uint32_t index;
+    uint32_t switch_us;        // Writer-side cost of the switch, first write into this file included
+    uint32_t prepare_ms;       // Background preparation of this file
+    uint64_t previous_bytes;   // Final length of the previous log file
+} LogRotationEvent;
+
+bool initializeEventLog();
+
+// Non-blocking; returns false (and counts a drop) if the queue is full or not initialized.
+bool eventLogPost(EventType type, const void* payload, uint16_t length);
+
+// Removes up to `maxRecords` pending records, oldest first. Waits up to `timeout` for the first one.
+size_t eventLogRead(EventRecord* out, size_t maxRecords, TickType_t timeout);
+
+uint32_t eventLogDropped();
+uint32_t eventLogPending();   // Records waiting for the SD logging task
+
+#endif // EVENT_LOG_H
@@ -0,0 +1,53 @@
+#ifndef FIR_DECIMATOR_H
+#define FIR_DECIMATOR_H
+
+#include <stdint.h>
+
+// FIR decimators and filter design helpers.
+//
+// FirDecimator is the block decimation stage AnalogCaptureTask runs per channel. Its dot product
+// is ESP-DSP dsps_dotprod_f32 (S3 vector unit) on the device and a scalar loop elsewhere, so the
+// module still builds on a host. FirDecimatorRef is a plain scalar reference it is checked
+// against (`adc_bench` on the device, test/test_fir_decimator on the host).
+//
+// Only outputs that survive decimation are computed (the polyphase saving): `decim` inputs are
+// pushed per output, then one dot product is evaluated.
+
+// Windowed-sinc (Blackman) linear-phase low-pass with unity DC gain.
+// `cutoff` is the -6 dB point as a fraction of the input sample rate (0 < cutoff < 0.5).
+void firDesignLowpass(float* taps, int numTaps, float cutoff);
+
+struct FirDecimatorRef {
+    const float* taps;
+    float* delay;   // numTaps entries, owned by the caller
+    int numTaps;
+    int decim;
+    int pos;        // Next write position in the circular delay line (also the oldest sample)
+};
+
+void firDecimatorRefInit(FirDecimatorRef* fir, const float* taps, float* delay, int numTaps, int decim);
+
+// Consumes outLen * decim samples from `in` and writes outLen samples to `out`. Returns outLen.
+int firDecimatorRefProcess(FirDecimatorRef* fir, const float* in, float* out, int outLen);
+
+// History is kept linear (not circular) so that every output is a single contiguous dot product,
+// which is what the vector unit is fast at.
+struct FirDecimator {
+    const float* tapsReversed; // Oldest sample meets tapsReversed[0]
+    int numTaps;
+    int decim;
+    float* history;            // FIR_DECIMATOR_HISTORY_LEN(numTaps, decim, maxBlock) entries, owned by the caller
+    int pending;               // New inputs appended after the history
+};
+
+// History needed for inputs of up to `maxBlock` samples per call
+#define FIR_DECIMATOR_HISTORY_LEN(numTaps, decim, maxBlock) ((numTaps) - 1 + (maxBlock) + (decim))
+
+void firDecimatorInit(FirDecimator* fir, const float* tapsReversed, float* history, int historyLen, int numTaps,
+                      int decim);
+
+// Push `count` inputs (at most the `maxBlock` the history was sized for) and produce as many
+// outputs as complete decimation periods allow. Returns the number written to `out`.
+int firDecimatorProcess(FirDecimator* fir, const float* in, int count, float* out);
+
+#endif // FIR_DECIMATOR_H
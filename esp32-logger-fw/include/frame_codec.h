@@ -0,0 +1,37 @@
+#ifndef FRAME_CODEC_H
+#define FRAME_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Binary framing shared by the serial protocols (live telemetry, log download).
+//
+// A frame on the wire is COBS(header | payload | crc32) followed by a single 0x00 delimiter, so a
+// receiver can always resynchronise on the next zero byte, and CRC-32 (IEEE, as in zlib) covers the
+// header and payload. No platform dependencies (host-buildable); tools/ has the Python counterpart.
+
+#define FRAME_HEADER_SIZE 6
+#define FRAME_CRC_SIZE 4
+
+typedef struct __attribute__((__packed__)) {
+    uint8_t type;        // Protocol-specific message type
+    uint8_t flags;       // Reserved, 0
+    uint16_t seq;        // Per-stream sequence number; gaps mean dropped frames
+    uint16_t length;     // Payload bytes
+} FrameHeader;
+
+static_assert(sizeof(FrameHeader) == FRAME_HEADER_SIZE, "FrameHeader must stay packed");
+
+// Worst-case encoded size of a frame with `payloadLen` bytes, including the delimiter
+#define FRAME_ENCODED_MAX(payloadLen) \
+    ((FRAME_HEADER_SIZE + (payloadLen) + FRAME_CRC_SIZE) + ((FRAME_HEADER_SIZE + (payloadLen) + FRAME_CRC_SIZE) / 254) + 2)
+
+uint32_t crc32Update(uint32_t crc, const void* data, size_t len); // Start with crc = 0
+size_t cobsEncode(const uint8_t* in, size_t len, uint8_t* out);   // Returns bytes written (no delimiter)
+size_t cobsDecode(const uint8_t* in, size_t len, uint8_t* out);   // Returns 0 on malformed input
+
+// Builds a complete delimited frame in `out` (at least FRAME_ENCODED_MAX(length) bytes).
+// `scratch` must hold FRAME_HEADER_SIZE + length + FRAME_CRC_SIZE bytes. Returns the encoded size.
+size_t frameEncode(uint8_t type, uint16_t seq, const void* payload, uint16_t length, uint8_t* scratch, uint8_t* out);
+
+#endif // FRAME_CODEC_H
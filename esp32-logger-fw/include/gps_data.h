@@ -4,6 +4,7 @@
 #include <Arduino.h> // For uintX_t types, bool, unsigned long
 #include <FreeRTOS.h>
 #include <semphr.h> // For SemaphoreHandle_t
+#include "segment_gates.h" // For SegmentTimerStatus
 
 // Example shared GPS data structure
 struct GpsData {
@@ -17,7 +18,15 @@ struct GpsData {
     unsigned long last_update_millis = 0;
 };
 
+// Segment/lap timing derived from gate crossings
+struct SegmentState {
+    uint32_t gate_count = 0;   // Gates loaded from GATES_FILE_PATH
+    SegmentTimerStatus timer;  // Times are continuous GPS time
+    int32_t gps_clock_offset_ms = 0; // GPS time minus millis() at the latest fix, for running times
+};
+
 extern GpsData g_gpsData;
+extern SegmentState g_segmentState; // Guarded by g_gpsDataMutex
 extern SemaphoreHandle_t g_gpsDataMutex;
 
 #endif // GPS_DATA_H
@@ -2,8 +2,24 @@
 #define GPS_HANDLER_H
 
 #include <FreeRTOS.h> // For void *pvParameters
+#include "breadcrumb_track.h" // For TrackPoint
+#include "elevation_filter.h" // For ElevationEstimate
 
 void gpsTask(void *pvParameters);
+
+struct GpsTrackInfo {
+    uint32_t count;        // Points in the breadcrumb track
+    uint32_t generation;   // Changes when existing points were rewritten (full redraw needed)
+    int32_t tolerance_dm;
+    int32_t min_x, min_y, max_x, max_y; // Bounds in decimetres
+};
+
+// Copies up to `maxPoints` breadcrumb points starting at index `from`; returns the number copied.
+// `info` always reflects the same snapshot as the copied points.
+uint32_t gpsTrackRead(uint32_t from, TrackPoint* out, uint32_t maxPoints, GpsTrackInfo* info);
+
+// Latest barometric + GPS elevation, vertical speed and gradient (O(1), never blocks)
+void gpsGetElevation(ElevationEstimate* out);
 // It's generally better to have initialization within the task or called by main.
 // For now, we'll keep it simple and do init inside the task.
 // If complex one-time setup outside the task is needed later, we can add:
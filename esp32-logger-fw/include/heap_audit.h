@@ -0,0 +1,53 @@
+#ifndef HEAP_AUDIT_H
+#define HEAP_AUDIT_H
+
+#include <Arduino.h>
+
+// Counts heap activity so the steady state can be shown to be allocation-free. The
+// heap_audit PlatformIO environment links with -Wl,--wrap for the allocator entry points and
+// defines ENABLE_HEAP_AUDIT; every allocation, reallocation and free then bumps a counter here
+// (a few atomic adds, no locks, safe from any task or ISR). Setting the steady-state marker
+// (manually or HEAP_AUDIT_AUTO_MARK_S after boot) zeroes the counters, so anything counted
+// afterwards is a regression; the latest caller address and task are kept to find it
+// (xtensa-esp32s3-elf-addr2line).
+// test/test_heap_soak applies the same per-minute rule to the portable per-sample modules on
+// the host (`pio test -e native -f test_heap_soak`).
+//
+// In IDF 4.4 free() calls heap_caps_free() in another object file, so frees are counted once
+// at heap_caps_free; malloc()/calloc()/realloc() reach heap_caps_* inside their own objects,
+// which the linker does not redirect, so nothing is counted twice. Allocations made through
+// heap_caps_*_default or by the ROM are not seen.
+//
+// Note Print::printf() allocates for output longer than 63 characters; anything printing
+// periodically in the steady state must stay below that.
+//
+// Without ENABLE_HEAP_AUDIT the calls still work but report `enabled = false` and zeros.
+
+struct HeapAuditStats {
+    bool enabled = false;          // Allocator wrapped in this build
+    bool steady = false;           // Marker set; counters run from marker_ms
+    uint32_t marker_ms = 0;
+    uint32_t allocations = 0;      // malloc/calloc/realloc and heap_caps_* equivalents
+    uint32_t frees = 0;
+    uint32_t failures = 0;         // Allocations that returned NULL
+    uint64_t bytes = 0;            // Requested
+    uint32_t last_caller = 0;      // Return address of the latest allocation after the marker
+    char last_task[configMAX_TASK_NAME_LEN] = {0}; // Task that made it ("" from an ISR)
+};
+
+// Zeroes the counters and starts the steady-state window
+void heapAuditMarkSteadyState();
+
+void heapAuditGetStats(HeapAuditStats* out);
+
+// Starts a soak: `minutes` one-minute windows from now, each of which must see no allocation.
+// Progress and the verdict are printed by heapAuditService().
+void heapAuditStartSoak(uint16_t minutes);
+
+// Call periodically from one task (the terminal task): sets the automatic marker and reports
+// soak windows and unexpected steady-state activity to `out`, with short lines only.
+void heapAuditService(Print& out);
+
+void heapAuditPrint(Print& out);
+
+#endif // HEAP_AUDIT_H
@@ -0,0 +1,82 @@
+#ifndef HTTP_FILE_SERVER_H
+#define HTTP_FILE_SERVER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Minimal HTTP/1.1 file server core for the Wi-Fi log offload mode.
+//
+// Handles GET/HEAD for the files of one flat directory plus an HTML index at "/", with single
+// `Range: bytes=` requests (206/416) so interrupted downloads can resume. File data is streamed
+// from the source to the sink through one caller-provided buffer; reads are aligned to
+// HTTP_READ_ALIGN so a block device reads whole sectors. The transport and the filesystem sit
+// behind HttpFileSource / HttpByteSink, so the core has no platform dependencies (host-buildable;
+// tools/http_serve_host.cpp serves a local directory with it).
+
+#define HTTP_MAX_PATH 96
+#define HTTP_MAX_HEAD 1024     // Request line + headers
+#define HTTP_READ_ALIGN 512
+
+class HttpFileSource {
+public:
+    virtual ~HttpFileSource() {}
+    // Opens a regular file by name (no directory part). False if missing.
+    virtual bool open(const char* name, uint64_t* size) = 0;
+    virtual bool seek(uint64_t offset) = 0;
+    virtual int32_t read(uint8_t* buffer, uint32_t length) = 0;  // < 0 on error
+    virtual void close() = 0;
+
+    // Directory listing for the index page
+    virtual bool listBegin() = 0;
+    virtual bool listNext(char* name, size_t nameSize, uint64_t* size) = 0;
+    virtual void listEnd() = 0;
+};
+
+class HttpByteSink {
+public:
+    virtual ~HttpByteSink() {}
+    virtual bool write(const uint8_t* data, size_t length) = 0;  // All or nothing; false = peer gone
+};
+
+struct HttpRequest {
+    char method[8];
+    char path[HTTP_MAX_PATH];   // Percent-decoded
+    bool has_range;
+    bool range_suffix;          // bytes=-N (last N bytes)
+    uint64_t range_first;       // Or N for a suffix range
+    uint64_t range_last;        // UINT64_MAX when open-ended
+};
+
+struct HttpTransferResult {
+    int status;
+    uint64_t body_bytes;        // File bytes actually sent
+};
+
+// Index just past the "\r\n\r\n" ending the request head, or 0 if not complete yet.
+size_t httpFindHeadEnd(const char* data, size_t length);
+
+// Parses a complete request head. False if it is not a well-formed request line.
+bool httpParseRequest(const char* head, size_t length, HttpRequest* out);
+
+class HttpFileServer {
+public:
+    // `buffer` is used for headers and file data; a few KB or more, ideally a multiple of HTTP_READ_ALIGN.
+    HttpFileServer(HttpFileSource& source, uint8_t* buffer, size_t bufferSize);
+
+    HttpTransferResult handle(const HttpRequest& request, HttpByteSink& sink);
+
+    // Sends a bare error response (e.g. 400 for an unparseable request)
+    void sendError(HttpByteSink& sink, int status);
+
+private:
+    bool sendHead(HttpByteSink& sink, int status, const char* contentType, uint64_t contentLength,
+                  const char* extraHeaders);
+    HttpTransferResult serveIndex(const HttpRequest& request, HttpByteSink& sink);
+    HttpTransferResult serveFile(const HttpRequest& request, const char* name, HttpByteSink& sink);
+
+    HttpFileSource& _source;
+    uint8_t* _buffer;
+    size_t _bufferSize;
+};
+
+#endif // HTTP_FILE_SERVER_H
@@ -0,0 +1,65 @@
+#ifndef IMU_FIFO_PARSER_H
+#define IMU_FIFO_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Decoder for the tagged FIFO of the LSM6DSO/LSM6DSOX family.
+// Kept free of Arduino/FreeRTOS dependencies so it can be built and exercised on a host.
+//
+// Each FIFO word is 7 bytes: a tag byte (sensor in bits [7:3], a 2-bit batch counter in
+// bits [2:1]) followed by X/Y/Z as little-endian int16. Accelerometer and gyroscope words
+// carrying the same counter are paired into one ImuSample; a half whose partner never
+// arrives (e.g. the first word read after the FIFO dropped data) is discarded and counted.
+
+#define IMU_FIFO_WORD_SIZE 7
+
+#define IMU_FIFO_TAG_GYRO  0x01
+#define IMU_FIFO_TAG_ACCEL 0x02
+
+struct ImuSample {
+    int64_t timestamp_us;   // Reconstructed sample time (esp_timer time base on the device)
+    float accel_mps2[3];
+    float gyro_radps[3];
+};
+
+struct ImuFifoParserConfig {
+    float accel_mps2_per_lsb;
+    float gyro_radps_per_lsb;
+    uint32_t sample_period_us; // 1e6 / ODR
+};
+
+class ImuFifoParser {
+public:
+    explicit ImuFifoParser(const ImuFifoParserConfig& config);
+
+    // Decode `wordCount` FIFO words from `data`.
+    // Timestamps are reconstructed from the ODR: the sample completed with index `anchorIndex`
+    // (counting from 0 within this call) is placed at `anchorTimeUs`, the others one sample
+    // period apart. Returns the number of samples written to `out` (at most `maxOut`).
+    size_t parse(const uint8_t* data, size_t wordCount, int64_t anchorTimeUs, size_t anchorIndex,
+                 ImuSample* out, size_t maxOut);
+
+    // Forget a half-received accel/gyro pair, e.g. after a FIFO overrun.
+    void reset();
+
+    uint32_t unknownWords() const { return unknownWords_; }
+    uint32_t unpairedWords() const { return unpairedWords_; }
+
+private:
+    ImuFifoParserConfig config_;
+    bool haveAccel_;
+    bool haveGyro_;
+    uint8_t pendingCounter_; // Batch counter of the half-received pair
+    float accel_[3];
+    float gyro_[3];
+    uint32_t unknownWords_;
+    uint32_t unpairedWords_;
+};
+
+// Time of the oldest sample when the FIFO is read on its watermark interrupt. The interrupt marks
+// the arrival of word `watermarkWords`, which completes sample `watermarkWords / 2 - 1` (accel and
+// gyro words interleave); earlier samples are one period apart before it.
+int64_t imuFifoWatermarkFirstSampleUs(int64_t irqTimeUs, uint16_t watermarkWords, uint32_t samplePeriodUs);
+
+#endif // IMU_FIFO_PARSER_H
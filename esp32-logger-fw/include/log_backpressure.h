@@ -0,0 +1,89 @@
+#ifndef LOG_BACKPRESSURE_H
+#define LOG_BACKPRESSURE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Overflow policy for the 200 Hz record path while the SD card stalls (garbage collection on the
+// card routinely blocks writes for 100-500 ms). Records go to a small internal staging ring, which
+// spills in batches into the large PSRAM ring the SD task drains. As the PSRAM ring fills past its
+// high-water marks, the record rate is decimated in steps; records that carry a new power, cadence
+// or GPS value are always kept, so only the IMU and analog channels lose resolution. Full rate
+// returns once the writer has brought the ring back under the recovery mark. Drops happen only
+// when both rings are full. Every level change is reported so the event log can explain any gap.
+// No platform dependencies (host-buildable).
+//
+// On the device it runs inside RecordAssembler in the acquisition task (DataAcquisitionTask.cpp),
+// against psramDataBuffer as drained by the SD logging task; the host replay and
+// test/test_log_backpressure drive the same code.
+
+enum LogRateLevel : uint8_t {
+    LOG_RATE_FULL = 0,       // Every record
+    LOG_RATE_DECIMATED,      // 1 in decimated_every, plus priority records
+    LOG_RATE_MINIMAL,        // 1 in minimal_every, plus priority records
+    LOG_RATE_DROPPING,       // Both rings full; records are being lost
+    LOG_RATE_LEVEL_COUNT
+};
+
+struct LogBackpressureConfig {
+    uint8_t decimate_percent;   // PSRAM ring fill that enters LOG_RATE_DECIMATED
+    uint8_t minimal_percent;    // ... LOG_RATE_MINIMAL
+    uint8_t recover_percent;    // Back to LOG_RATE_FULL at or below this fill
+    uint16_t decimated_every;   // Keep 1 record in N while decimated
+    uint16_t minimal_every;     // Keep 1 record in N while minimal
+};
+
+struct LogBackpressureStats {
+    LogRateLevel level;
+    uint32_t produced;          // Records offered by the acquisition path
+    uint32_t skipped;           // Decimated away on purpose
+    uint32_t dropped;           // Lost because both rings were full
+    uint32_t ring_peak;         // Highest PSRAM ring fill seen (records)
+    uint32_t transitions;
+};
+
+// One level change, with the counters as they stood when it happened
+struct LogBackpressureTransition {
+    LogRateLevel from;
+    LogRateLevel to;
+    uint8_t ring_fill_percent;
+    uint32_t in_previous_ms;    // Time spent in `from`
+    uint32_t skipped;
+    uint32_t dropped;
+    uint32_t ring_peak;
+};
+
+class LogBackpressure {
+public:
+    LogBackpressure();
+
+    // Returns false if the marks are not ordered recover < decimate < minimal <= 100 or a divisor is 0
+    bool begin(const LogBackpressureConfig& config);
+
+    // Called once per produced record. `priority` marks a record with new power/cadence/GPS data.
+    // True if the record should be stored; false if the current level decimates it away.
+    bool admit(bool priority);
+
+    // A record that was admitted but found no room in either ring
+    void recordDropped() { _stats.dropped++; }
+
+    // Called after each spill with the PSRAM ring fill and whether the staging ring is full (the
+    // writer is not keeping up at all). Returns true and fills `out` when the level changed.
+    bool update(size_t ringCount, size_t ringCapacity, bool stagingFull, uint32_t nowMs,
+                LogBackpressureTransition* out);
+
+    LogRateLevel level() const { return _stats.level; }
+    const LogBackpressureStats& stats() const { return _stats; }
+
+private:
+    LogRateLevel levelForFill(uint8_t fillPercent, bool stagingFull) const;
+
+    LogBackpressureConfig _config;
+    LogBackpressureStats _stats;
+    uint16_t _phase;            // Records since the last one kept by decimation
+    uint32_t _levelSinceMs;
+};
+
+const char* logRateLevelName(LogRateLevel level);
+
+#endif // LOG_BACKPRESSURE_H
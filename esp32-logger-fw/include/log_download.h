@@ -0,0 +1,38 @@
+#ifndef LOG_DOWNLOAD_H
+#define LOG_DOWNLOAD_H
+
+#include <Arduino.h>
+
+// Bulk log download over the USB CDC link (`ls`, `get` terminal commands).
+//
+// `get <name> <offset> <length>` answers with binary frames (frame_codec.h): one DL_FRAME_INFO,
+// DL_FRAME_DATA frames of up to LOG_DOWNLOAD_CHUNK_BYTES, then DL_FRAME_END carrying the CRC-32 of
+// every byte sent, or a DL_FRAME_ERROR. A leading 0x00 separates the frames from any text printed
+// before them. Requests are independent, so the host resumes from any byte offset and can keep
+// several requests queued in the serial input to keep the link busy (tools/log_download.py).
+
+enum DownloadFrameType : uint8_t {
+    DL_FRAME_INFO = 0x41,     // DownloadInfo
+    DL_FRAME_DATA = 0x42,     // uint32_t offset + file bytes
+    DL_FRAME_END = 0x43,      // DownloadEnd
+    DL_FRAME_ERROR = 0x44,    // Message text (not terminated)
+};
+
+typedef struct __attribute__((__packed__)) {
+    uint32_t offset;          // First byte that will be sent
+    uint32_t length;          // Bytes that will be sent (clipped to the file size)
+    uint32_t file_size;
+} DownloadInfo;
+
+typedef struct __attribute__((__packed__)) {
+    uint32_t end_offset;      // One past the last byte sent
+    uint32_t crc32;           // Over all DL_FRAME_DATA bytes of this request
+} DownloadEnd;
+
+// Prints the log directory (name and size per line) for humans and tools/log_download.py.
+void logDownloadList(Print& out);
+
+// Streams [offset, offset + length) of `name` in the log directory; length 0 means to the end.
+void logDownloadSend(const char* name, uint32_t offset, uint32_t length);
+
+#endif // LOG_DOWNLOAD_H
@@ -0,0 +1,62 @@
+#ifndef LOG_ROTATION_H
+#define LOG_ROTATION_H
+
+#include <Arduino.h>
+
+// Log files rotated by size and age without filesystem metadata work on the writer's path.
+// File numbers come from a counter persisted on the card (LOG_COUNTER_FILE), so no directory walk
+// is needed to find a free name. The rotation task prepares the next log_NNN.bin/.evt pair and its
+// .lod summary sidecar (log_summary.h) ahead of time: creates them, preallocates a contiguous
+// extent for each and writes the schema blob. The writer then switches files by swapping slots;
+// the files it leaves are truncated to their real length and closed by the rotation task
+// afterwards, one file per card lock. If the next pair is not ready when a rotation is due, the
+// writer keeps appending to the current file and the deferral is counted.
+//
+// All file access happens under the SD card lock (sd_card.h); the writer calls take it themselves.
+
+struct LogRotationStats {
+    bool active;                 // A log file is open
+    bool next_ready;             // The next pair is prepared
+    uint32_t active_index;       // NNN of the file being written
+    uint64_t active_bytes;       // Including the schema blob
+    uint32_t active_age_ms;
+    uint32_t rotations;
+    uint32_t deferred;           // Rotations due while the next pair was not ready yet
+    uint32_t failures;           // Preparations or writes that failed
+    uint32_t last_switch_us;     // Writer-side cost of the last rotation, first write included
+    uint32_t max_switch_us;
+    uint32_t last_retire_stall_us; // Writer wait for the card lock while a retired file was closed
+    uint32_t max_retire_stall_us;
+    uint32_t last_prepare_ms;    // Background: create + preallocate + schema blob
+    uint32_t max_prepare_ms;
+    uint32_t last_retire_ms;     // Background: truncate + close of the previous set, all steps
+};
+
+// Reads the counter, prepares and opens the first pair (blocking; call before logging starts) and
+// asks the rotation task to prepare the next one. False if no card or the file cannot be created.
+bool logRotationBegin();
+
+// Appends to the active log / event file; rotates first if a size or age limit is reached and the
+// next pair is ready. Blocks only for the card lock and the data write itself. logRotationWrite()
+// takes whole packed records (LOG_RECORD_V1_SIZE each), which also feed the summary sidecar.
+bool logRotationWrite(const void* data, size_t length);
+bool logRotationWriteEvents(const void* data, size_t length);
+
+// Flushes data written so far to the card (directory entry included)
+bool logRotationSync();
+
+// Truncates and closes the active pair, deletes the unused prepared pair and gives its number back
+void logRotationEnd();
+
+void logRotationGetStats(LogRotationStats* out);
+void logRotationPrint(Print& out);
+
+// Prepares pairs and retires finished ones; create at low priority with the logging tasks
+void logRotationTask(void* pvParameters);
+
+// One round of the task's work: retires the previous pair and prepares the next. False if the next
+// pair could not be prepared. The host replay (tools/sensor_replay_host.cpp) calls it between
+// writes instead of running the task.
+bool logRotationService();
+
+#endif // LOG_ROTATION_H
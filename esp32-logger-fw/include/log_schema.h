@@ -0,0 +1,170 @@
+#ifndef LOG_SCHEMA_H
+#define LOG_SCHEMA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// The 200 Hz log record, declared once. Everything that depends on its layout is expanded from
+// LOG_RECORD_V1_FIELDS below: the packed struct, the offset/size checks, pack/unpack, the field
+// table behind the CSV/JSON headers and the schema blob at the start of every log file
+// (tools/log_schema.py decodes files from that blob; tools/telemetry_rx.py reads this table).
+// Adding, removing or reordering a field changes the file format: bump LOG_SCHEMA_VERSION and
+// LOG_RECORD_V1_SIZE with it. No platform dependencies (host-buildable).
+//
+// On the device the acquisition task packs every record for the live stream, the SD logging task
+// packs them for the card, and log rotation writes the blob at the head of every log_NNN.bin.
+
+#define LOG_SCHEMA_VERSION 1
+#define LOG_RECORD_V1_SIZE 101
+
+// F(name, type, scale, unit)         scalar field
+// A(name, type, count, scale, unit)  fixed-size array
+// `scale` converts the stored value into `unit` (1 for every float field).
+#define LOG_RECORD_V1_FIELDS(F, A) \
+    F(system_timestamp_ms, uint32_t, 1.0f, "ms") \
+    F(gps_latitude, float, 1.0f, "deg") \
+    F(gps_longitude, float, 1.0f, "deg") \
+    F(gps_altitude, float, 1.0f, "m") \
+    F(gps_speed_mps, float, 1.0f, "m/s") \
+    F(gps_sats, uint8_t, 1.0f, "") \
+    F(gps_fix_type, uint8_t, 1.0f, "") \
+    F(elevation_m, float, 1.0f, "m") \
+    F(vertical_speed_mps, float, 1.0f, "m/s") \
+    F(gradient_percent, float, 1.0f, "%") \
+    F(power_watts, uint16_t, 1.0f, "W") \
+    F(cadence_rpm, uint8_t, 1.0f, "rpm") \
+    F(imu_accel_x_mps2, float, 1.0f, "m/s^2") \
+    F(imu_accel_y_mps2, float, 1.0f, "m/s^2") \
+    F(imu_accel_z_mps2, float, 1.0f, "m/s^2") \
+    F(imu_gyro_x_radps, float, 1.0f, "rad/s") \
+    F(imu_gyro_y_radps, float, 1.0f, "rad/s") \
+    F(imu_gyro_z_radps, float, 1.0f, "rad/s") \
+    F(roll_deg, float, 1.0f, "deg") \
+    F(pitch_deg, float, 1.0f, "deg") \
+    A(analog_ch, float, 8, 1.0f, "V")
+
+// Field notes: gps_fix_type 0 = none, 2 = 2D, 3 = 3D; elevation is the fused barometric/GPS
+// estimate on the GPS datum; roll is positive leaning right, pitch positive nose down;
+// analog_ch is NAN for unused channels.
+
+#define LOG_SCHEMA_SCALAR_MEMBER(name, type, scale, unit) type name;
+#define LOG_SCHEMA_ARRAY_MEMBER(name, type, count, scale, unit) type name[count];
+
+typedef struct __attribute__((__packed__)) {
+    LOG_RECORD_V1_FIELDS(LOG_SCHEMA_SCALAR_MEMBER, LOG_SCHEMA_ARRAY_MEMBER)
+} LogRecordV1;
+
+// Field indices, in record order
+#define LOG_SCHEMA_SCALAR_INDEX(name, type, scale, unit) LOG_FIELD_##name,
+#define LOG_SCHEMA_ARRAY_INDEX(name, type, count, scale, unit) LOG_FIELD_##name,
+enum LogRecordV1Field {
+    LOG_RECORD_V1_FIELDS(LOG_SCHEMA_SCALAR_INDEX, LOG_SCHEMA_ARRAY_INDEX)
+    LOG_RECORD_V1_FIELD_COUNT
+};
+
+// Element type codes stored in the schema blob
+enum LogFieldType : uint8_t {
+    LOG_TYPE_U8 = 1,
+    LOG_TYPE_I8,
+    LOG_TYPE_U16,
+    LOG_TYPE_I16,
+    LOG_TYPE_U32,
+    LOG_TYPE_I32,
+    LOG_TYPE_F32,
+    LOG_TYPE_F64,
+};
+
+template <typename T> struct LogFieldTypeOf;
+template <> struct LogFieldTypeOf<uint8_t>  { static constexpr LogFieldType code = LOG_TYPE_U8; };
+template <> struct LogFieldTypeOf<int8_t>   { static constexpr LogFieldType code = LOG_TYPE_I8; };
+template <> struct LogFieldTypeOf<uint16_t> { static constexpr LogFieldType code = LOG_TYPE_U16; };
+template <> struct LogFieldTypeOf<int16_t>  { static constexpr LogFieldType code = LOG_TYPE_I16; };
+template <> struct LogFieldTypeOf<uint32_t> { static constexpr LogFieldType code = LOG_TYPE_U32; };
+template <> struct LogFieldTypeOf<int32_t>  { static constexpr LogFieldType code = LOG_TYPE_I32; };
+template <> struct LogFieldTypeOf<float>    { static constexpr LogFieldType code = LOG_TYPE_F32; };
+template <> struct LogFieldTypeOf<double>   { static constexpr LogFieldType code = LOG_TYPE_F64; };
+
+struct LogFieldInfo {
+    const char* name;
+    LogFieldType type;
+    uint8_t count;       // 1 for scalars
+    uint8_t element_size;
+    uint16_t offset;
+    float scale;
+    const char* unit;
+};
+
+#define LOG_SCHEMA_SCALAR_INFO(name, type, scale, unit) \
+    { #name, LogFieldTypeOf<type>::code, 1, sizeof(type), offsetof(LogRecordV1, name), scale, unit },
+#define LOG_SCHEMA_ARRAY_INFO(name, type, count, scale, unit) \
+    { #name, LogFieldTypeOf<type>::code, count, sizeof(type), offsetof(LogRecordV1, name), scale, unit },
+static constexpr LogFieldInfo LOG_RECORD_V1_SCHEMA[LOG_RECORD_V1_FIELD_COUNT] = {
+    LOG_RECORD_V1_FIELDS(LOG_SCHEMA_SCALAR_INFO, LOG_SCHEMA_ARRAY_INFO)
+};
+
+// Layout checks: every field sits right after the previous one, and the total is pinned so a
+// schema edit cannot silently change the file format.
+#define LOG_SCHEMA_SCALAR_SIZE(name, type, scale, unit) sizeof(type),
+#define LOG_SCHEMA_ARRAY_SIZE(name, type, count, scale, unit) sizeof(type) * (count),
+static constexpr size_t LOG_RECORD_V1_FIELD_SIZES[LOG_RECORD_V1_FIELD_COUNT] = {
+    LOG_RECORD_V1_FIELDS(LOG_SCHEMA_SCALAR_SIZE, LOG_SCHEMA_ARRAY_SIZE)
+};
+
+constexpr size_t logRecordV1ExpectedOffset(size_t field) {
+    return field == 0 ? 0 : logRecordV1ExpectedOffset(field - 1) + LOG_RECORD_V1_FIELD_SIZES[field - 1];
+}
+
+#define LOG_SCHEMA_SCALAR_CHECK(name, type, scale, unit) \
+    static_assert(offsetof(LogRecordV1, name) == logRecordV1ExpectedOffset(LOG_FIELD_##name), "LogRecordV1::" #name " is misplaced");
+#define LOG_SCHEMA_ARRAY_CHECK(name, type, count, scale, unit) LOG_SCHEMA_SCALAR_CHECK(name, type, scale, unit)
+LOG_RECORD_V1_FIELDS(LOG_SCHEMA_SCALAR_CHECK, LOG_SCHEMA_ARRAY_CHECK)
+static_assert(sizeof(LogRecordV1) == logRecordV1ExpectedOffset(LOG_RECORD_V1_FIELD_COUNT), "LogRecordV1 has padding");
+static_assert(sizeof(LogRecordV1) == LOG_RECORD_V1_SIZE, "Log schema changed: update LOG_RECORD_V1_SIZE and bump LOG_SCHEMA_VERSION");
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Log records are little endian; pack/unpack assume a little-endian CPU");
+
+// Straight-line copies between a record and its wire/file form (LOG_RECORD_V1_SIZE bytes):
+// no branches or loops, and the compiler merges the adjacent copies.
+#define LOG_SCHEMA_SCALAR_PACK(name, type, scale, unit) \
+    memcpy(out + offsetof(LogRecordV1, name), &record.name, sizeof(record.name));
+#define LOG_SCHEMA_ARRAY_PACK(name, type, count, scale, unit) LOG_SCHEMA_SCALAR_PACK(name, type, scale, unit)
+inline void logRecordV1Pack(const LogRecordV1& record, uint8_t* out) {
+    LOG_RECORD_V1_FIELDS(LOG_SCHEMA_SCALAR_PACK, LOG_SCHEMA_ARRAY_PACK)
+}
+
+#define LOG_SCHEMA_SCALAR_UNPACK(name, type, scale, unit) \
+    memcpy(&record->name, in + offsetof(LogRecordV1, name), sizeof(record->name));
+#define LOG_SCHEMA_ARRAY_UNPACK(name, type, count, scale, unit) LOG_SCHEMA_SCALAR_UNPACK(name, type, scale, unit)
+inline void logRecordV1Unpack(const uint8_t* in, LogRecordV1* record) {
+    LOG_RECORD_V1_FIELDS(LOG_SCHEMA_SCALAR_UNPACK, LOG_SCHEMA_ARRAY_UNPACK)
+}
+
+// Schema blob at the start of a log file, followed directly by the records:
+//   LogSchemaBlobHeader, then per field
+//   uint8 type, uint8 count, uint16 offset, float scale, uint8 name_len, name, uint8 unit_len, unit
+// blob_length covers the header and all field entries, so readers can skip to the records.
+#define LOG_SCHEMA_MAGIC "LGS1"
+#define LOG_SCHEMA_BLOB_MAX 1024
+
+typedef struct __attribute__((__packed__)) {
+    char magic[4];           // LOG_SCHEMA_MAGIC
+    uint16_t blob_length;
+    uint16_t schema_version; // LOG_SCHEMA_VERSION
+    uint16_t record_size;
+    uint8_t field_count;
+    uint8_t reserved;
+} LogSchemaBlobHeader;
+
+// Returns the blob length, or 0 if `capacity` is too small
+size_t logSchemaWriteBlob(uint8_t* out, size_t capacity);
+
+// Comma-separated column names with units ("gps_altitude[m]"); arrays become name0..nameN-1.
+// Returns the length without the terminator, or 0 if `size` is too small.
+size_t logSchemaCsvHeader(char* out, size_t size);
+
+// The field table as one JSON object (version, record size, fields with type/offset/scale/unit)
+size_t logSchemaJson(char* out, size_t size);
+
+const char* logFieldTypeName(LogFieldType type);
+
+#endif // LOG_SCHEMA_H
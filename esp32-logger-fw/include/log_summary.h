@@ -0,0 +1,112 @@
+#ifndef LOG_SUMMARY_H
+#define LOG_SUMMARY_H
+
+#include "log_schema.h"
+
+// Level-of-detail pyramid for a log file: per channel min/max/mean over 1 s, 10 s and 60 s
+// buckets, kept incrementally as records are written and stored in a log_NNN.lod sidecar, so a
+// ride overview or a zoomed plot reads kilobytes instead of the whole 200 Hz file.
+//
+// Channels are the schema elements in record order, skipping system_timestamp_ms (analog_ch
+// gives eight). Only the finest level sees records; each coarser level is merged from the
+// buckets of the one below. Buckets sit on a grid starting at the file's first record, and NAN
+// samples (unused analog channels, missing IMU data) are left out of a channel's aggregates.
+//
+// Sidecar layout (tools/log_summary.py decodes it):
+//   LogSummaryFileHeader, then the schema blob of the log (header_length covers both), then one
+//   region per level, coarsest first, each holding `count` buckets of bucket_size bytes:
+//     uint32 start_ms, uint32 records, per channel float min, float max, float mean
+// A channel without a valid sample in the bucket stores NAN for all three.
+// No platform dependencies (host-buildable).
+//
+// On the device log_rotation keeps one per log file: it feeds every record the SD logging task
+// writes, rewrites the header on each sync and finishes the sidecar when the file is retired.
+// tools/log_summary_host.cpp builds the same file from an existing log (tools/tests/test_log_summary.py).
+
+#define LOG_SUMMARY_MAGIC "LOD1"
+#define LOG_SUMMARY_LEVELS 3
+static constexpr uint32_t LOG_SUMMARY_PERIODS_MS[LOG_SUMMARY_LEVELS] = { 1000, 10000, 60000 };
+
+#define LOG_SUMMARY_ELEMENT_SCALAR(name, type, scale, unit) + 1
+#define LOG_SUMMARY_ELEMENT_ARRAY(name, type, count, scale, unit) + (count)
+#define LOG_SUMMARY_CHANNELS (0 LOG_RECORD_V1_FIELDS(LOG_SUMMARY_ELEMENT_SCALAR, LOG_SUMMARY_ELEMENT_ARRAY) - 1)
+#define LOG_SUMMARY_BUCKET_SIZE (8 + LOG_SUMMARY_CHANNELS * 12)
+
+#define LOG_SUMMARY_FLAG_COMPLETE 0x01 // Header rewritten when the log was closed
+#define LOG_SUMMARY_FLAG_OVERFLOW 0x02 // A level region filled up; later buckets of it are missing
+
+static_assert(LOG_FIELD_system_timestamp_ms == 0, "The summary takes bucket times from the first field");
+
+typedef struct __attribute__((__packed__)) {
+    uint32_t period_ms;
+    uint32_t offset;          // From the start of the file
+    uint32_t capacity;        // Buckets the region has room for
+    uint32_t count;           // Buckets written
+} LogSummaryLevelInfo;
+
+typedef struct __attribute__((__packed__)) {
+    char magic[4];            // LOG_SUMMARY_MAGIC
+    uint16_t header_length;   // This header plus the schema blob
+    uint16_t bucket_size;     // LOG_SUMMARY_BUCKET_SIZE
+    uint16_t channel_count;   // LOG_SUMMARY_CHANNELS
+    uint8_t level_count;      // LOG_SUMMARY_LEVELS
+    uint8_t flags;            // LOG_SUMMARY_FLAG_*
+    uint32_t t0_ms;           // Grid origin: system_timestamp_ms of the first record
+    LogSummaryLevelInfo levels[LOG_SUMMARY_LEVELS]; // Finest first
+} LogSummaryFileHeader;
+
+struct LogSummaryChannel {
+    float min;
+    float max;
+    float sum;
+    uint32_t samples;         // Non-NAN values in the bucket
+};
+
+struct LogSummaryBucket {
+    uint32_t start_ms;
+    uint32_t records;
+    LogSummaryChannel channels[LOG_SUMMARY_CHANNELS];
+};
+
+class LogSummary {
+public:
+    // Receives every finished bucket, finest level first; a level's buckets arrive in time order
+    typedef void (*Sink)(void* context, uint8_t level, const LogSummaryBucket& bucket);
+
+    LogSummary();
+
+    // Starts a new pyramid; the grid origin is taken from the next record
+    void begin(Sink sink, void* context);
+
+    // One packed record (LOG_RECORD_V1_SIZE bytes, wire layout)
+    void add(const uint8_t* record);
+
+    // Emits the open bucket of every level; call once when the log is closed
+    void finish();
+
+    bool started() const { return _started; }
+    uint32_t origin() const { return _t0; }
+
+private:
+    void merge(uint8_t level, const LogSummaryBucket& bucket);
+    void open(uint8_t level, uint32_t start);
+    bool route(uint8_t level, uint32_t timeMs); // Emits the open bucket if `timeMs` is past it
+    void emit(uint8_t level);
+
+    Sink _sink;
+    void* _context;
+    bool _started;
+    uint32_t _t0;
+    bool _open[LOG_SUMMARY_LEVELS];
+    LogSummaryBucket _buckets[LOG_SUMMARY_LEVELS];
+};
+
+// Fills in a header for a sidecar whose regions hold `spanMs` of buckets per level, with the log's
+// schema blob (`blobLength` bytes) after the header. Counts, flags and t0 start at zero. Returns
+// the file size with every region full.
+uint32_t logSummaryLayout(uint32_t spanMs, size_t blobLength, LogSummaryFileHeader* header);
+
+// Serializes a bucket into LOG_SUMMARY_BUCKET_SIZE bytes
+void logSummaryEncodeBucket(const LogSummaryBucket& bucket, uint8_t* out);
+
+#endif // LOG_SUMMARY_H
@@ -0,0 +1,24 @@
+#ifndef LOG_WRITER_H
+#define LOG_WRITER_H
+
+#include <Arduino.h>
+#include "DataBuffer.h" // The record ring the acquisition task fills
+
+// The SD logging task's work, one pass at a time: a batch of records from the ring, packed to the
+// schema layout and appended through log_rotation (which feeds the summary sidecar), whatever
+// event records are queued, and a sync once every SD_LOG_SYNC_INTERVAL_MS. SdLoggingTask.cpp
+// loops over it; tools/sensor_replay_host.cpp calls the same passes on its virtual clock, against
+// the same DataBuffer, with the stand-ins in tools/host/.
+
+// Starts the sync interval; call when a log file has been opened
+void logWriterBegin(uint32_t nowMs);
+
+// One pass. Returns the records written; LOG_STAGING_SPILL_RECORDS means the ring holds more, so
+// the caller should loop at once. *ok is false if the log write failed (the batch is lost).
+size_t logWriterService(DataBuffer<LogRecordV1>& ring, uint32_t nowMs, bool* ok);
+
+// Passes until the ring and the event queue are empty, before logRotationEnd(). False if any
+// write failed.
+bool logWriterFlush(DataBuffer<LogRecordV1>& ring, uint32_t nowMs);
+
+#endif // LOG_WRITER_H
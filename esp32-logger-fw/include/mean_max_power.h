@@ -0,0 +1,56 @@
+#ifndef MEAN_MAX_POWER_H
+#define MEAN_MAX_POWER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Live mean-maximal power curve: best average power over a fixed set of durations.
+// Fed with the 1 Hz resampled power from PowerAnalytics. All durations share one ring of the
+// last max(duration) seconds; each keeps a running window sum, so a sample costs O(durations)
+// regardless of ride length. No platform dependencies (host-buildable).
+
+#define MMP_MAX_DURATIONS 8
+
+struct MeanMaxPoint {
+    uint16_t duration_s;
+    float best_watts;        // 0 until the session is at least duration_s long
+    uint32_t best_end_s;     // Session second at which the best window ended
+};
+
+class MeanMaxPower {
+public:
+    MeanMaxPower();
+
+    // `ring` must hold at least the longest duration; it is owned by the caller (PSRAM on the device).
+    // Returns false if the arguments are inconsistent.
+    bool begin(const uint16_t* durations, size_t count, uint16_t* ring, uint32_t ringLength);
+    bool ready() const { return _ring != nullptr; }
+
+    void push(uint16_t watts);
+    void pushZeros(uint32_t count);  // Power dropout spanning `count` seconds
+    void reset();
+
+    size_t getCurve(MeanMaxPoint* out, size_t maxPoints) const;
+    uint32_t elapsedSeconds() const { return _seconds; }
+
+private:
+    uint16_t _durations[MMP_MAX_DURATIONS];
+    uint32_t _sums[MMP_MAX_DURATIONS];
+    uint32_t _bestSums[MMP_MAX_DURATIONS];
+    uint32_t _bestEnd[MMP_MAX_DURATIONS];
+    size_t _count;
+    uint32_t _maxDuration;
+
+    uint16_t* _ring;
+    uint32_t _ringLength;
+    uint32_t _pos;
+    uint32_t _seconds;
+};
+
+// Ring length begin() needs for `durations`
+uint32_t meanMaxLongestDuration(const uint16_t* durations, size_t count);
+
+// PowerAnalytics second sink (power_analytics.h) feeding the MeanMaxPower passed as `context`
+void meanMaxPowerSecondSink(uint16_t watts, uint32_t repeat, void* context);
+
+#endif // MEAN_MAX_POWER_H
@@ -0,0 +1,82 @@
+#ifndef MEM_PLACEMENT_H
+#define MEM_PLACEMENT_H
+
+#include <Arduino.h>
+#include <esp_attr.h>
+
+// Deliberate placement of the large data structures across the S3's memories:
+//   INTERNAL - on-chip DRAM, single-cycle. Everything the 200 Hz path and the ISRs touch.
+//   DMA      - DMA-capable internal DRAM. Buffers a peripheral reads or writes directly.
+//   PSRAM    - octal SPI RAM behind the data cache, several times slower and a cache miss away
+//              from stalling. Large, cold structures: rings read back at low rate, framebuffers.
+// Each region has a fixed arena reserved once in memPlacementInit() (MEM_ARENA_*_BYTES in
+// config.h). Permanent buffers are bump-allocated from it, so they neither fragment the heap nor
+// compete with later allocations. Statics are annotated at their definition and registered with
+// MEM_PLACED(), and `mem` lists every structure with its intended and actual region. `membench`
+// (and the boot benchmark, MEM_BENCH_AT_BOOT) measures what each region really delivers.
+
+// Annotations for static storage. Plain .bss is internal DRAM, so MEM_HOT only states the intent;
+// MEM_BULK moves the object to PSRAM .bss when CONFIG_SPIRAM_ALLOW_BSS_SEG_EXTERNAL_MEMORY is set
+// (zero-initialized objects only) and leaves it internal otherwise.
+#define MEM_HOT
+#define MEM_DMA_BUFFER WORD_ALIGNED_ATTR
+#define MEM_BULK EXT_RAM_ATTR
+
+enum MemRegion : uint8_t {
+    MEM_REGION_INTERNAL = 0,
+    MEM_REGION_DMA,
+    MEM_REGION_PSRAM,
+    MEM_REGION_COUNT,
+    MEM_REGION_UNKNOWN = 0xFF  // Flash-mapped or otherwise not in RAM
+};
+
+struct MemArenaStats {
+    size_t capacity = 0;     // 0 if the arena could not be reserved
+    size_t used = 0;
+    uint32_t failures = 0;   // Allocations that did not fit
+};
+
+struct MemBenchResult {
+    bool valid = false;
+    float memcpy_mbps = 0.0f;
+    float read_mbps = 0.0f;
+    float write_mbps = 0.0f;
+    float miss_ns = 0.0f;    // Per dependent read one cache line apart (cache-miss cost in PSRAM)
+};
+
+// Reserves the arenas. Call once from setup() before anything allocates from them.
+bool memPlacementInit();
+
+// Permanent allocation from a region's arena (never freed). NULL if the arena is missing or full.
+void* memArenaAlloc(MemRegion region, size_t bytes, const char* owner, size_t align = 4);
+
+// Heap allocation restricted to a region, for structures that are freed and rebuilt (free()).
+void* memRegionMalloc(MemRegion region, size_t bytes);
+
+MemRegion memRegionOf(const void* ptr);
+const char* memRegionName(MemRegion region);
+void memArenaGetStats(MemRegion region, MemArenaStats* out);
+
+// Adds an entry to the placement table (fixed size, no allocation). Safe during static init.
+void memPlacementRegister(const char* owner, const void* ptr, size_t bytes, MemRegion intended);
+
+// Registers a static next to its definition: MEM_PLACED(s_ring, MEM_REGION_INTERNAL);
+struct MemPlacedStatic {
+    MemPlacedStatic(const char* owner, const void* ptr, size_t bytes, MemRegion intended) {
+        memPlacementRegister(owner, ptr, bytes, intended);
+    }
+};
+#define MEM_PLACED(object, region) \
+    static MemPlacedStatic s_placed_##object(#object, &(object), sizeof(object), region)
+
+// The placement table and arena usage; misplaced entries are marked
+void memPlacementPrint(Print& out);
+
+// memcpy/read/write throughput of `bytes`-sized buffers in a region (two buffers for memcpy),
+// allocated from the heap for the duration. False if the region has no room.
+bool memBenchmarkRun(MemRegion region, size_t bytes, MemBenchResult* out);
+
+// Runs the benchmark for every region and prints one line each
+void memBenchmarkPrint(Print& out, size_t bytes);
+
+#endif // MEM_PLACEMENT_H
@@ -0,0 +1,76 @@
+#ifndef NMEA_PARSER_H
+#define NMEA_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Incremental NMEA 0183 parser for the GPS FeatherWing's RMC and GGA sentences, fed one UART
+// character at a time. The fix state accumulates across sentences the way the module reports it:
+// position from either sentence, speed from RMC, altitude and satellites from GGA. Sentences with
+// a bad checksum, missing fields or an unsupported type leave the state untouched.
+// No platform dependencies (host-buildable).
+
+#define NMEA_MAX_SENTENCE 96 // NMEA allows 82; the MTK modules stay well under
+#define NMEA_KNOTS_TO_MPS 0.514444f
+
+enum NmeaSentenceType : uint8_t {
+    NMEA_NONE = 0,   // Sentence not complete yet
+    NMEA_INVALID,    // Completed, but rejected (checksum, format or unsupported type)
+    NMEA_RMC,
+    NMEA_GGA,
+};
+
+struct NmeaFix {
+    bool fix;                 // RMC status A, or GGA fix quality > 0, whichever came last
+    uint8_t fix_quality;      // GGA: 0 none, 1 GPS, 2 DGPS
+    uint8_t satellites;       // GGA: satellites used
+    double latitude_deg;      // North positive
+    double longitude_deg;     // East positive
+    float altitude_m;         // GGA: above mean sea level
+    float speed_knots;        // RMC: speed over ground
+    float course_deg;         // RMC: course over ground
+    uint32_t utc_time_ms;     // Time of day of the last sentence, ms since midnight UTC
+};
+
+// The fix as the GPS state, the log records and the telemetry hold it: speed in m/s, and position,
+// altitude, speed and fix quality zeroed while there is no fix (satellites are still reported)
+struct GpsReading {
+    bool valid;
+    double latitude_deg;
+    double longitude_deg;
+    float altitude_m;
+    float speed_mps;
+    uint8_t satellites;
+    uint8_t fix_quality;
+};
+
+GpsReading nmeaGpsReading(const NmeaFix& fix);
+
+class NmeaParser {
+public:
+    NmeaParser();
+
+    void reset();
+
+    // Feeds one received character. Returns the type of the sentence it completed, NMEA_NONE
+    // while a sentence is still being received.
+    NmeaSentenceType feed(char c);
+
+    const NmeaFix& fix() const { return _fix; }
+    const char* lastSentence() const { return _last; } // Without CR/LF
+    uint32_t sentences() const { return _sentences; }  // Accepted RMC/GGA sentences
+    uint32_t rejected() const { return _rejected; }
+
+private:
+    NmeaSentenceType parseLine();
+
+    char _line[NMEA_MAX_SENTENCE + 1];
+    char _last[NMEA_MAX_SENTENCE + 1];
+    size_t _length;
+    bool _overflow;
+    NmeaFix _fix;
+    uint32_t _sentences;
+    uint32_t _rejected;
+};
+
+#endif // NMEA_PARSER_H
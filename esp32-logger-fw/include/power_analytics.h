@@ -0,0 +1,60 @@
+#ifndef POWER_ANALYTICS_H
+#define POWER_ANALYTICS_H
+
+#include <stdint.h>
+#include "types.h" // For PowerMetrics
+
+// Incremental power analytics: 3/10/30 s averages, normalized power, IF, TSS and work.
+// Power meter notifications arrive at irregular intervals (typically 1-4 Hz), so samples are
+// resampled onto a 1 Hz grid by sample-and-hold first; every metric is then updated in O(1)
+// per second from running sums over a 30-entry ring. No platform dependencies (host-buildable).
+
+#define POWER_ANALYTICS_WINDOW_S 30
+
+// Receives every completed 1 Hz sample; `repeat` > 1 only for zero-power dropouts accounted in bulk
+typedef void (*PowerSecondSink)(uint16_t watts, uint32_t repeat, void* context);
+
+class PowerAnalytics {
+public:
+    // `dropoutMs`: a gap between notifications longer than this counts as zero power from then on
+    PowerAnalytics(uint16_t ftpWatts, uint32_t dropoutMs);
+
+    // Feed one power reading taken at `timestampMs` (monotonic). Returns the number of 1 Hz
+    // samples that were completed by this call (0 most of the time).
+    uint32_t addSample(uint32_t timestampMs, uint16_t watts);
+
+    void reset();
+    void setFtp(uint16_t ftpWatts) { _ftpWatts = ftpWatts; }
+    uint16_t ftp() const { return _ftpWatts; }
+
+    void getMetrics(PowerMetrics* out) const;
+
+    // Optional consumer of the 1 Hz series (e.g. the mean-maximal curve)
+    void setSecondSink(PowerSecondSink sink, void* context) { _sink = sink; _sinkContext = context; }
+
+private:
+    void pushSecond(uint16_t watts);
+
+    uint16_t _ftpWatts;
+    uint32_t _dropoutMs;
+    PowerSecondSink _sink;
+    void* _sinkContext;
+
+    bool _started;
+    uint32_t _secondStartMs;    // Start of the 1 Hz slot currently being filled
+    uint32_t _lastSampleMs;
+    uint16_t _heldWatts;        // Last completed slot value, held across slots without notifications
+    uint32_t _slotSum;          // Notifications received in the current slot
+    uint32_t _slotCount;
+
+    uint16_t _ring[POWER_ANALYTICS_WINDOW_S];
+    uint32_t _ringPos;          // Next write index
+    uint32_t _sum3, _sum10, _sum30;
+
+    uint32_t _seconds;          // 1 Hz samples pushed
+    uint64_t _totalJoules;      // Sum of 1 Hz watts
+    double _sumFourthPower;     // Sum of (30 s average)^4, one term per second once the window is full
+    uint32_t _fourthPowerCount;
+};
+
+#endif // POWER_ANALYTICS_H
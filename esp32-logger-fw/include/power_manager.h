@@ -0,0 +1,79 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+#include <driver/uart.h> // For uart_port_t
+
+// Dynamic frequency scaling and automatic light sleep through the ESP-IDF power manager.
+//
+// The CPU runs at POWER_CPU_MAX_MHZ while any task is running (the kernel holds its own per-core
+// lock) and drops to POWER_CPU_MIN_MHZ when both cores are idle; with tickless idle the chip
+// light-sleeps through idle periods unless a lock below forbids it. Locks are taken only around
+// work that cannot tolerate a clock change or a sleep:
+//   I2C      - bus transactions (IMU FIFO bursts, scheduled polls); no light sleep mid-transfer
+//   SPI      - display pushes and SD card access; APB must stay at full speed
+//   BLE      - scanning and connection set-up; the controller guards the connected state itself
+//   GPS_UART - while NMEA is streaming; characters arriving in light sleep are lost
+//   USB      - while a host is attached to the CDC port
+// Drivers hold further locks of their own (Wi-Fi, BT controller, and the ADC continuous driver
+// for as long as AnalogCaptureTask's DMA runs, which is always), so DFS would apply to every idle
+// period but light sleep would not happen while analog capture is running.
+//
+// All of this needs CONFIG_PM_ENABLE (and CONFIG_FREERTOS_USE_TICKLESS_IDLE for light sleep) in
+// the SDK configuration. The prebuilt sdkconfig of the Arduino core used by platformio.ini
+// (framework = arduino) sets neither, so on this build the module is inert: the clock stays at
+// its boot frequency and the lock calls only keep their statistics (`pm` says so). Enabling it
+// takes an arduino + espidf build with an sdkconfig.defaults that sets both options.
+
+enum PowerLockId {
+    POWER_LOCK_I2C = 0,
+    POWER_LOCK_SPI,
+    POWER_LOCK_BLE,
+    POWER_LOCK_GPS_UART,
+    POWER_LOCK_USB,
+    POWER_LOCK_COUNT
+};
+
+struct PowerLockStats {
+    uint32_t acquisitions = 0;
+    uint64_t held_us = 0;     // Cumulative, including a hold in progress
+};
+
+struct PowerManagerStatus {
+    bool dfs_enabled = false;
+    bool light_sleep_enabled = false;
+    uint16_t max_mhz = 0;
+    uint16_t min_mhz = 0;
+};
+
+// Configures DFS/light sleep and creates the locks. Call once from setup() before the tasks start.
+bool powerManagerInit();
+
+void powerGetStatus(PowerManagerStatus* out);
+
+// Nestable; safe from tasks and ISRs
+void powerLockAcquire(PowerLockId id);
+void powerLockRelease(PowerLockId id);
+
+const char* powerLockName(PowerLockId id);
+void powerGetLockStats(PowerLockStats out[POWER_LOCK_COUNT]);
+
+// Lets incoming characters on `port` end a light sleep (the first few are lost)
+void powerEnableUartWakeup(uart_port_t port);
+
+// Per-mode residency from the IDF profiler (CONFIG_PM_PROFILING). False if not compiled in.
+bool powerPrintProfile(Print& out);
+
+// Holds a lock for the rest of the enclosing scope
+class PowerLockScope {
+public:
+    explicit PowerLockScope(PowerLockId id) : _id(id) { powerLockAcquire(id); }
+    ~PowerLockScope() { powerLockRelease(_id); }
+    PowerLockScope(const PowerLockScope&) = delete;
+    PowerLockScope& operator=(const PowerLockScope&) = delete;
+
+private:
+    PowerLockId _id;
+};
+
+#endif // POWER_MANAGER_H
@@ -0,0 +1,56 @@
+#ifndef RAW_CAPTURE_H
+#define RAW_CAPTURE_H
+
+#include <Arduino.h>
+#include "sensor_capture.h"
+
+// Raw-capture logging (`capture on|only|off`): sensor inputs are appended as they arrive, before
+// any decoding, to cap_NNN.cap in the sensor_capture.h format (the host replay's input; decode
+// with tools/sensor_capture.py). Producers copy a chunk header and the payload into a byte ring
+// under a spinlock and never block; a chunk that does not fit is dropped whole and counted. The
+// capture task drains the ring to the card in sector-sized writes.
+//
+// Captured: GPS UART bytes, Cycling Power Measurement notifications and the Feature bitmask, IMU
+// FIFO bursts, barometer pressure and the decimated analog channels. In RAW_CAPTURE_ONLY the GPS and Cycling Power decoders are
+// skipped, so live position, power and cadence stay empty for the session.
+
+enum RawCaptureMode : uint8_t {
+    RAW_CAPTURE_OFF = 0,
+    RAW_CAPTURE_ON,           // Capture next to the normal decoding
+    RAW_CAPTURE_ONLY,         // Capture; GPS and Cycling Power are not decoded on the device
+};
+
+struct RawCaptureStats {
+    RawCaptureMode mode = RAW_CAPTURE_OFF;
+    bool file_open = false;
+    uint32_t file_index = 0;       // NNN of cap_NNN.cap
+    uint32_t chunks = 0;           // Accepted into the ring this session
+    uint32_t chunks_dropped = 0;   // Ring full
+    uint64_t bytes_written = 0;    // To the file, header included
+    uint32_t ring_high_water = 0;
+    uint32_t write_errors = 0;
+};
+
+// Takes effect in the capture task, which opens the file before producers are let in and lets
+// them out before draining and closing it. Switching between ON and ONLY keeps the file. Safe to
+// call from any task.
+void rawCaptureSetMode(RawCaptureMode mode);
+RawCaptureMode rawCaptureMode();
+
+// False only in RAW_CAPTURE_ONLY: producers skip their decoders then
+bool rawCaptureDecoding();
+
+// Changes every time capture is switched on; producers use it to repeat one-off state (such as
+// the Cycling Power Feature bitmask) at the start of each capture file
+uint32_t rawCaptureSession();
+
+// Non-blocking; false if capture is off, the payload exceeds CAPTURE_MAX_PAYLOAD or the ring is full
+bool rawCaptureAppend(uint32_t tMs, CaptureType type, const void* payload, size_t length);
+
+void rawCaptureGetStats(RawCaptureStats* out);
+void rawCapturePrint(Print& out);
+
+// Owns the capture file; sleeps while capture is off. Create at low priority.
+void rawCaptureTask(void* pvParameters);
+
+#endif // RAW_CAPTURE_H
@@ -0,0 +1,83 @@
+#ifndef RECORD_ASSEMBLER_H
+#define RECORD_ASSEMBLER_H
+
+#include "log_schema.h"
+#include "log_backpressure.h"
+#include "elevation_filter.h" // ElevationEstimate
+#include "imu_fifo_parser.h"  // ImuSample
+
+// The 200 Hz record path of the acquisition task, apart from where its inputs come from: builds
+// a LogRecordV1 from the latest sensor state and the IMU samples since the last stored record
+// (boxcar average down to the log rate), then stores it through the internal staging ring into
+// the record ring under the overflow policy of log_backpressure.h. The device task and the host
+// replay both drive it once per acquisition tick. No platform dependencies (host-buildable).
+
+struct RecordInputs {
+    bool gps_fix;
+    double latitude_deg;
+    double longitude_deg;
+    float altitude_m;
+    float speed_mps;
+    uint8_t satellites;
+    ElevationEstimate elevation;
+    bool attitude_valid;
+    float roll_deg;
+    float pitch_deg;
+    uint16_t power_watts;
+    uint8_t cadence_rpm;
+    float analog[8];          // NAN for unused channels
+};
+
+// The ring the SD writer drains (the PSRAM DataBuffer on the device)
+struct RecordRing {
+    size_t (*write)(void* context, const LogRecordV1* records, size_t count); // Returns how many fitted
+    size_t (*count)(void* context);
+    size_t capacity;
+    void* context;
+};
+
+// Receives every backpressure level change, with the staging fill at that moment
+typedef void (*RecordTransitionSink)(void* context, const LogBackpressureTransition& transition, size_t stagingCount);
+
+class RecordAssembler {
+public:
+    // `staging` holds `stagingCapacity` records and is spilled `spillRecords` at a time
+    RecordAssembler(LogRecordV1* staging, size_t stagingCapacity, size_t spillRecords);
+
+    // False if the backpressure marks are inconsistent (logging then stays at full rate)
+    bool begin(const LogBackpressureConfig& config, const RecordRing& ring, RecordTransitionSink sink, void* context);
+
+    // IMU samples published since the previous call
+    void addImuSamples(const ImuSample* samples, size_t count);
+
+    // Builds the record for `nowMs` (also what the live stream sends)
+    const LogRecordV1& assemble(uint32_t nowMs, const RecordInputs& inputs);
+
+    // Stores the record built last. Records carrying new power, cadence or GPS values survive any
+    // decimation level. False if the current level decimated it away.
+    bool store(uint32_t nowMs);
+
+    // Moves whatever is staged into the ring (end of a session)
+    void flush() { spill(true); }
+
+    const LogBackpressure& backpressure() const { return _backpressure; }
+    size_t stagingCount() const { return _stagingCount; }
+
+private:
+    void spill(bool force);
+
+    LogRecordV1* _staging;
+    size_t _stagingCapacity;
+    size_t _spillRecords;
+    size_t _stagingCount;
+    RecordRing _ring;
+    RecordTransitionSink _sink;
+    void* _context;
+    LogBackpressure _backpressure;
+    LogRecordV1 _current;
+    LogRecordV1 _lastStored;
+    float _imuSum[6];         // Carried across ticks while decimated records are skipped
+    uint32_t _imuSumCount;
+};
+
+#endif // RECORD_ASSEMBLER_H
@@ -0,0 +1,55 @@
+#ifndef SD_BENCH_H
+#define SD_BENCH_H
+
+#include <Arduino.h>
+
+// In-place SD card characterization (`sdbench`). Runs on the mounted card through the normal
+// SdFat/SPI setup, so the numbers are what the logger will actually get:
+//   - sequential write and read throughput for block sizes from 512 B to 64 KB (preallocated file)
+//   - write latency p50/p99/max over a sustained run of logger-sized batches, once appending to a
+//     growing file and once into a preallocated one
+// From these it recommends a write block size, the PSRAM ring depth that rides out the worst stall,
+// and whether to preallocate, and stores everything as a JSON profile on the card itself
+// (SD_BENCH_PROFILE_FILE), so the profile travels with the card. Takes the card lock per phase;
+// expect a minute or so with the default sizes.
+
+#define SD_BENCH_BLOCK_SIZES 8        // 512 B .. 64 KB, powers of two
+
+struct SdBenchThroughput {
+    uint32_t block_bytes;
+    float write_kbps;
+    float read_kbps;
+};
+
+struct SdBenchLatency {
+    bool valid;
+    uint32_t writes;
+    uint32_t p50_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+    float kbps;                       // Sustained, including the stalls
+};
+
+struct SdBenchProfile {
+    char card[16];                    // Manufacturer id, OEM and product name from the CID
+    uint64_t sectors;
+    uint32_t sequential_bytes;        // Written per block size
+    SdBenchThroughput throughput[SD_BENCH_BLOCK_SIZES];
+    uint8_t throughput_count;
+    uint32_t batch_bytes;             // Size of each write in the latency runs
+    SdBenchLatency appending;
+    SdBenchLatency preallocated;
+    uint32_t recommended_block_bytes;
+    uint32_t recommended_ring_records;
+    bool recommend_preallocate;
+};
+
+// Runs the benchmark with `sequentialBytes` per block size, prints progress and results to `out`,
+// saves the profile on the card and returns it in `profile` (may be NULL). False if the card is
+// missing or a phase could not run.
+bool sdBenchRun(Print& out, uint32_t sequentialBytes, SdBenchProfile* profile);
+
+// Prints the profile stored on the card
+bool sdBenchPrintStored(Print& out);
+
+#endif // SD_BENCH_H
@@ -0,0 +1,18 @@
+#ifndef SD_CARD_H
+#define SD_CARD_H
+
+#include <Arduino.h>
+#include <SdFat.h>
+
+// SD card access shared by the logger and the features that read configuration from the card.
+// SdFat runs on the SPI pins from config.h (shared with the TFT, so transactions are used).
+// Callers hold the card lock around any sequence of SdFat calls.
+
+bool sdCardBegin();     // Mounts the card; cheap once mounted. False if no card / no filesystem.
+bool sdCardMounted();
+SdFs& sdCardFs();
+
+bool sdCardLock(TickType_t timeout);
+void sdCardUnlock();
+
+#endif // SD_CARD_H
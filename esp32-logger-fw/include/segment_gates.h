@@ -0,0 +1,146 @@
+#ifndef SEGMENT_GATES_H
+#define SEGMENT_GATES_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Segment start/finish and lap gates, matched against consecutive GPS fixes.
+//
+// Gates are projected once into a local metric frame (equirectangular around the first gate) and
+// inserted into a hashed uniform grid: every gate is listed under each cell its bounding box touches.
+// A fix-to-fix movement walks only the cells its line passes through (a 2D DDA), so the per-fix cost
+// depends on the distance moved and how many gates share those cells, not on the total number of
+// gates. Crossing times are interpolated along the movement, giving sub-fix resolution.
+// No platform dependencies (host-buildable).
+
+enum GateKind : uint8_t {
+    GATE_START = 0,   // Starts timing of segment_id
+    GATE_FINISH = 1,  // Finishes timing of segment_id
+    GATE_LAP = 2,     // Start/finish line: each crossing completes a lap and starts the next
+};
+
+// As loaded from the gate file
+struct GateDef {
+    int32_t segment_id;
+    GateKind kind;
+    double lat1, lon1;
+    double lat2, lon2;
+};
+
+struct GateCrossing {
+    uint32_t gate;        // Index into the loaded gates
+    int32_t segment_id;
+    GateKind kind;
+    uint32_t time_ms;     // Interpolated between the two fixes
+};
+
+// Continuous GPS time: NMEA reports ms since midnight UTC, which wraps once a day. Returns the
+// time of day `timeOfDayMs` placed on the day of `previousMs` (the previous result, 0 at start),
+// or on the next day when it is more than half a day earlier.
+uint32_t gateContinuousTimeMs(uint32_t previousMs, uint32_t timeOfDayMs);
+
+#define GATE_QUERY_MAX_GATES 32 // Distinct gates tested per movement (de-duplication list)
+
+typedef void* (*GateAllocFn)(size_t bytes);
+typedef void (*GateFreeFn)(void* ptr);
+
+class GateIndex {
+public:
+    // `bucketCount` must be a power of two. Storage comes from `allocFn` (PSRAM on the device).
+    GateIndex(float cellSizeM, uint32_t bucketCount, GateAllocFn allocFn, GateFreeFn freeFn);
+    ~GateIndex();
+
+    bool build(const GateDef* defs, uint32_t count);
+    void clear();
+    uint32_t gateCount() const { return _gateCount; }
+
+    void project(double lat, double lon, float* x, float* y) const;
+
+    // Tests the movement from (x0, y0) at t0 to (x1, y1) at t1 against the gates listed in every
+    // cell it passes through and writes the crossings in time order.
+    size_t findCrossings(float x0, float y0, uint32_t t0, float x1, float y1, uint32_t t1,
+                         GateCrossing* out, size_t maxOut);
+
+    uint32_t lastCandidates() const { return _lastCandidates; }   // Gates tested by the last query
+    uint32_t lastCells() const { return _lastCells; }             // Cells walked by the last query
+
+private:
+    struct Gate {
+        float x1, y1, x2, y2;
+        int32_t segment_id;
+        GateKind kind;
+    };
+    struct CellEntry {
+        int32_t cx, cy;   // Full cell key; buckets are shared by colliding cells
+        uint32_t gate;
+    };
+
+    uint32_t bucketOf(int32_t cx, int32_t cy) const;
+    int32_t cellOf(float v) const;
+    void testCell(int32_t cx, int32_t cy, float x0, float y0, uint32_t t0, float x1, float y1, uint32_t t1,
+                  GateCrossing* out, size_t maxOut, size_t* found);
+
+    float _cellSize;
+    uint32_t _bucketCount;
+    GateAllocFn _alloc;
+    GateFreeFn _free;
+
+    double _originLat, _originLon, _metersPerDegLon;
+    Gate* _gates;
+    uint32_t _gateCount;
+    uint32_t* _bucketStart;   // _bucketCount + 1 offsets into _entries
+    CellEntry* _entries;
+
+    uint32_t _lastCandidates;
+    uint32_t _lastCells;
+    uint32_t _seen[GATE_QUERY_MAX_GATES]; // Gates already tested by the current query
+    uint32_t _seenCount;
+};
+
+#define SEGMENT_TIMER_MAX_ACTIVE 8
+
+// Live lap/segment timing driven by gate crossings
+struct SegmentTimerStatus {
+    uint32_t lap_count = 0;
+    bool lap_running = false;
+    uint32_t lap_start_ms = 0;         // Timer times are continuous GPS time (gateContinuousTimeMs)
+    uint32_t last_lap_ms = 0;
+    uint32_t best_lap_ms = 0;
+
+    uint8_t active_segments = 0;
+    int32_t newest_segment_id = -1;     // Most recently started segment still running
+    uint32_t newest_segment_start_ms = 0;
+    int32_t last_segment_id = -1;       // Most recently completed segment
+    uint32_t last_segment_ms = 0;
+};
+
+struct SegmentResult {
+    int32_t segment_id;   // -1 for laps
+    GateKind kind;        // GATE_FINISH for a completed segment, GATE_LAP for a lap
+    uint32_t elapsed_ms;
+};
+
+class SegmentTimer {
+public:
+    // Crossings of the lap gate sooner than `minLapMs` after the lap started are ignored (GPS jitter)
+    explicit SegmentTimer(uint32_t minLapMs);
+
+    // Returns true and fills `result` when the crossing completes a lap or a segment.
+    bool onCrossing(const GateCrossing& crossing, SegmentResult* result);
+    void reset();
+
+    const SegmentTimerStatus& status() const { return _status; }
+
+private:
+    void refreshNewest();
+
+    uint32_t _minLapMs;
+    struct Active {
+        int32_t segment_id;
+        uint32_t start_ms;
+    };
+    Active _active[SEGMENT_TIMER_MAX_ACTIVE];
+    SegmentTimerStatus _status;
+};
+
+#endif // SEGMENT_GATES_H
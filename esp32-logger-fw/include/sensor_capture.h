@@ -0,0 +1,73 @@
+#ifndef SENSOR_CAPTURE_H
+#define SENSOR_CAPTURE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Recorded sensor inputs, as they arrive at the firmware before any decoding: a session file is a
+// CaptureFileHeader followed by chunks of
+//   uint32 t_ms, uint8 type, uint16 length, then `length` payload bytes
+// in non-decreasing t_ms order per type. The device writes them in raw-capture mode (raw_capture.h);
+// the host replay (tools/sensor_replay_host.cpp) feeds them through the same parsers, filters and
+// record path the device runs. No platform dependencies (host-buildable).
+
+#define CAPTURE_MAGIC "SNS1"
+#define CAPTURE_VERSION 1
+#define CAPTURE_CHUNK_HEADER_SIZE 7
+#define CAPTURE_MAX_PAYLOAD 1024
+
+enum CaptureType : uint8_t {
+    CAPTURE_NMEA = 1,         // Bytes from the GPS UART, any split (sentences may span chunks)
+    CAPTURE_CP_MEASUREMENT,   // One Cycling Power Measurement notification payload
+    CAPTURE_CP_FEATURE,       // uint32 Cycling Power Feature bitmask read at connect
+    CAPTURE_IMU_FIFO,         // One LSM6DSO FIFO burst (IMU_FIFO_WORD_SIZE bytes per word); t_ms is its first sample
+    CAPTURE_PRESSURE,         // float BME280 pressure in Pa
+    CAPTURE_ANALOG,           // float[8] decimated analog channels, NAN for unused ones
+    CAPTURE_TYPE_COUNT
+};
+
+typedef struct __attribute__((__packed__)) {
+    char magic[4];            // CAPTURE_MAGIC
+    uint16_t version;         // CAPTURE_VERSION
+    uint16_t header_length;   // Chunks start here
+    uint32_t start_ms;        // Device millis() when the capture started
+} CaptureFileHeader;
+
+struct CaptureChunk {
+    uint32_t t_ms;
+    CaptureType type;
+    uint16_t length;
+    const uint8_t* payload;
+};
+
+// Writes the CAPTURE_CHUNK_HEADER_SIZE header of a chunk with `length` payload bytes
+void captureEncodeChunkHeader(uint32_t tMs, CaptureType type, uint16_t length, uint8_t* out);
+
+// Writes the chunk header and payload into `out`; returns the bytes used, 0 if `capacity` is too
+// small or the payload exceeds CAPTURE_MAX_PAYLOAD
+size_t captureEncodeChunk(uint32_t tMs, CaptureType type, const void* payload, size_t length, uint8_t* out,
+                          size_t capacity);
+
+const char* captureTypeName(CaptureType type);
+
+// Walks the chunks of a session held in memory; payload pointers point into that memory
+class CaptureReader {
+public:
+    // False if `data` does not start with a capture header
+    bool begin(const uint8_t* data, size_t length);
+
+    // Next chunk; false at the end or at a truncated chunk (truncated() tells which)
+    bool next(CaptureChunk* out);
+
+    bool truncated() const { return _truncated; }
+    const CaptureFileHeader& header() const { return _header; }
+
+private:
+    const uint8_t* _data = nullptr;
+    size_t _length = 0;
+    size_t _pos = 0;
+    bool _truncated = false;
+    CaptureFileHeader _header = {};
+};
+
+#endif // SENSOR_CAPTURE_H
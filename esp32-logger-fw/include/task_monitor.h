@@ -0,0 +1,65 @@
+#ifndef TASK_MONITOR_H
+#define TASK_MONITOR_H
+
+#include <Arduino.h>
+
+// Per-task CPU usage, stack high-water marks and heap figures, for sizing task stacks and core
+// affinity from measured data (`top` command, periodic event log records).
+//
+// A snapshot records every task's cumulative run time; CPU usage is the difference between two
+// snapshots divided by the window. Per-task CPU needs FreeRTOS run-time stats
+// (CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS); without them the CPU columns are reported as
+// unavailable and everything else still works.
+
+#define TASK_MONITOR_MAX_TASKS 24
+#define TASK_MONITOR_CORES 2
+#define TASK_MONITOR_ANY_CORE -1     // Task not pinned to a core
+
+struct TaskMonitorTask {
+    TaskHandle_t handle;
+    char name[configMAX_TASK_NAME_LEN];
+    int8_t core;                     // 0, 1 or TASK_MONITOR_ANY_CORE
+    eTaskState state;
+    UBaseType_t priority;
+    uint32_t stack_free_min_bytes;   // Least free stack ever observed (high-water mark)
+    uint32_t run_time;               // Cumulative run-time counter
+};
+
+struct TaskMonitorSnapshot {
+    TaskMonitorTask tasks[TASK_MONITOR_MAX_TASKS];
+    uint8_t count = 0;
+    uint32_t total_run_time = 0;
+    uint32_t taken_ms = 0;
+};
+
+struct TaskMonitorUsage {
+    const TaskMonitorTask* task;     // Points into the later snapshot
+    float cpu_percent;               // Of one core; < 0 when run-time stats are unavailable
+};
+
+struct TaskMonitorReport {
+    TaskMonitorUsage tasks[TASK_MONITOR_MAX_TASKS];
+    uint8_t count = 0;
+    uint32_t window_ms = 0;
+    bool cpu_available = false;
+    float core_load_percent[TASK_MONITOR_CORES] = {0};  // 100 - idle task share
+    uint8_t ready_tasks[TASK_MONITOR_CORES] = {0};      // Run-queue length per core at the later snapshot
+    uint8_t ready_any_core = 0;
+
+    uint32_t heap_internal_free = 0;
+    uint32_t heap_internal_largest = 0;
+    uint32_t heap_internal_min_free = 0;  // Low-water mark since boot
+    uint32_t heap_psram_free = 0;
+    uint32_t heap_psram_largest = 0;
+};
+
+// Fills `snapshot`. Fails if more than TASK_MONITOR_MAX_TASKS tasks exist. Not reentrant.
+bool taskMonitorCapture(TaskMonitorSnapshot* snapshot);
+
+// CPU usage between two snapshots (tasks missing from `before` are measured from 0), sorted by
+// CPU usage, plus the current heap figures.
+void taskMonitorCompare(const TaskMonitorSnapshot* before, const TaskMonitorSnapshot* after, TaskMonitorReport* out);
+
+const char* taskMonitorStateName(eTaskState state);
+
+#endif // TASK_MONITOR_H
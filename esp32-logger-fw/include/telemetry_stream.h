@@ -0,0 +1,67 @@
+#ifndef TELEMETRY_STREAM_H
+#define TELEMETRY_STREAM_H
+
+#include <Arduino.h>
+#include "frame_codec.h"
+
+// Live binary telemetry over the USB CDC serial port (`stream on|off`).
+// Producers encode a complete frame (see frame_codec.h) on their own stack and copy it into a TX
+// ring without ever blocking; if the whole frame does not fit it is dropped and counted. Sequence
+// numbers are assigned before the drop decision, so the receiver sees every loss as a gap.
+// The terminal task drains the ring into Serial as fast as the port accepts.
+// tools/telemetry_rx.py is the host-side receiver.
+
+#define TELEMETRY_MAX_PAYLOAD 512
+
+enum TelemetryType : uint8_t {
+    TELEM_POWER = 1,       // TelemetryPower
+    TELEM_GPS = 2,         // TelemetryGps
+    TELEM_IMU = 3,         // uint8_t count + count x TelemetryImuSample
+    TELEM_ANALOG = 4,      // uint32_t timestamp_ms + uint8_t count + count x float volts
+    TELEM_LOG_RECORD = 5,  // LogRecordV1
+};
+
+typedef struct __attribute__((__packed__)) {
+    uint32_t timestamp_ms;
+    uint16_t power_watts;
+    uint8_t cadence_rpm;
+    uint8_t left_balance_half_percent; // 0xFF when the meter does not report balance
+} TelemetryPower;
+
+typedef struct __attribute__((__packed__)) {
+    uint32_t timestamp_ms;
+    double latitude;
+    double longitude;
+    float altitude_m;
+    float speed_mps;
+    uint8_t satellites;
+    uint8_t fix_quality;
+} TelemetryGps;
+
+typedef struct __attribute__((__packed__)) {
+    int64_t timestamp_us;
+    float accel_mps2[3];
+    float gyro_radps[3];
+} TelemetryImuSample;
+
+#define TELEMETRY_IMU_BATCH_MAX ((TELEMETRY_MAX_PAYLOAD - 1) / sizeof(TelemetryImuSample))
+
+struct TelemetryStats {
+    uint32_t frames_queued = 0;   // Accepted into the TX ring
+    uint32_t frames_dropped = 0;
+    uint32_t bytes_sent = 0;
+    uint32_t ring_high_water = 0;
+};
+
+void telemetrySetEnabled(bool enabled);
+bool telemetryEnabled();
+
+// Non-blocking; returns false if streaming is off, the payload is too large or the ring is full.
+bool telemetryPublish(TelemetryType type, const void* payload, uint16_t length);
+
+// Writes queued bytes to Serial without blocking. Called from the terminal task.
+void telemetryDrain();
+
+void telemetryGetStats(TelemetryStats* out);
+
+#endif // TELEMETRY_STREAM_H
@@ -0,0 +1,104 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <Arduino.h>
+#include <freertos/semphr.h>
+#include "config.h" // For ENABLE_TRACE
+
+// Event trace for finding stalls: begin/end spans and instants, time-stamped with the CPU cycle
+// counter into one ring per core (PSRAM). Writers mask interrupts on their own core for the few
+// instructions a record takes and never touch the other core's ring, so there is no lock.
+// Rings overwrite their oldest records (flight recorder); `trace dump` prints them and
+// tools/trace2chrome.py turns the dump into Chrome/Perfetto trace JSON.
+//
+// Everything here compiles to nothing (mutex helpers to plain xSemaphoreTake/Give) unless
+// ENABLE_TRACE is defined in config.h.
+
+// X(id, name): event ids, in dump order
+#define TRACE_EVENT_LIST(X) \
+    X(TRACE_SYNC, "sync") \
+    X(TRACE_DATA_MUTEX_WAIT, "g_dataMutex wait") \
+    X(TRACE_DATA_MUTEX_HOLD, "g_dataMutex held") \
+    X(TRACE_GPS_MUTEX_WAIT, "g_gpsDataMutex wait") \
+    X(TRACE_GPS_MUTEX_HOLD, "g_gpsDataMutex held") \
+    X(TRACE_OTHER_MUTEX_WAIT, "mutex wait") \
+    X(TRACE_OTHER_MUTEX_HOLD, "mutex held") \
+    X(TRACE_BLE_LOOP, "BLE loop") \
+    X(TRACE_BLE_NOTIFY, "BLE notify") \
+    X(TRACE_GPS_LOOP, "GPS loop") \
+    X(TRACE_IMU_DRAIN, "IMU FIFO drain") \
+    X(TRACE_I2C_SERVICE, "I2C service") \
+    X(TRACE_ANALOG_FRAME, "ADC frame") \
+    X(TRACE_DISPLAY_FRAME, "display frame") \
+    X(TRACE_DISPLAY_PUSH, "display push") \
+    X(TRACE_TERMINAL_COMMAND, "terminal command") \
+    X(TRACE_TELEMETRY_DRAIN, "telemetry drain") \
+    X(TRACE_ACQ_RECORD, "acquisition record") \
+    X(TRACE_SD_WRITE, "SD write") \
+    X(TRACE_WIFI_REQUEST, "HTTP request")
+
+#define TRACE_ENUM_ENTRY(id, name) id,
+enum TraceEventId : uint16_t {
+    TRACE_EVENT_LIST(TRACE_ENUM_ENTRY)
+    TRACE_EVENT_COUNT
+};
+#undef TRACE_ENUM_ENTRY
+
+enum TracePhase : uint8_t {
+    TRACE_PHASE_BEGIN = 'B',
+    TRACE_PHASE_END = 'E',
+    TRACE_PHASE_INSTANT = 'I',
+    TRACE_PHASE_SYNC = 'S',   // arg/task hold esp_timer microseconds (low/high word) at `cycles`
+};
+
+typedef struct __attribute__((__packed__)) {
+    uint32_t cycles;      // CPU cycle counter of the recording core
+    uint32_t task;        // TaskHandle_t of the recording task
+    uint32_t arg;
+    uint16_t id;          // TraceEventId
+    uint8_t phase;        // TracePhase
+    uint8_t reserved;
+} TraceRecord;
+
+#ifdef ENABLE_TRACE
+
+bool traceInit();                 // Allocates the rings; tracing starts enabled
+void traceSetEnabled(bool enabled);
+bool traceEnabled();
+void traceRecord(TraceEventId id, TracePhase phase, uint32_t arg);
+void traceDump(Print& out);       // Pauses recording while printing
+void traceClear();
+
+BaseType_t traceMutexTake(SemaphoreHandle_t mutex, TickType_t timeout);
+void traceMutexGive(SemaphoreHandle_t mutex);
+
+// Ends the span when it goes out of scope, so early `continue`/`return` paths are covered
+class TraceScope {
+public:
+    explicit TraceScope(TraceEventId id) : _id(id) { traceRecord(id, TRACE_PHASE_BEGIN, 0); }
+    ~TraceScope() { traceRecord(_id, TRACE_PHASE_END, 0); }
+private:
+    TraceEventId _id;
+};
+
+#define TRACE_BEGIN(id) traceRecord((id), TRACE_PHASE_BEGIN, 0)
+#define TRACE_END(id) traceRecord((id), TRACE_PHASE_END, 0)
+#define TRACE_INSTANT(id, arg) traceRecord((id), TRACE_PHASE_INSTANT, (arg))
+#define TRACE_SCOPE_CONCAT2(a, b) a##b
+#define TRACE_SCOPE_CONCAT(a, b) TRACE_SCOPE_CONCAT2(a, b)
+#define TRACE_SCOPE(id) TraceScope TRACE_SCOPE_CONCAT(traceScope_, __LINE__)(id)
+#define TRACE_MUTEX_TAKE(mutex, timeout) traceMutexTake((mutex), (timeout))
+#define TRACE_MUTEX_GIVE(mutex) traceMutexGive(mutex)
+
+#else
+
+#define TRACE_BEGIN(id) ((void)0)
+#define TRACE_END(id) ((void)0)
+#define TRACE_INSTANT(id, arg) ((void)0)
+#define TRACE_SCOPE(id) ((void)0)
+#define TRACE_MUTEX_TAKE(mutex, timeout) xSemaphoreTake((mutex), (timeout))
+#define TRACE_MUTEX_GIVE(mutex) xSemaphoreGive(mutex)
+
+#endif // ENABLE_TRACE
+
+#endif // TRACE_H
@@ -3,6 +3,8 @@
 
 #include <stdint.h> // For fixed-width integer types
 #include <math.h>   // For NAN
+#include "mean_max_power.h" // For MeanMaxPoint
+#include "log_schema.h"     // LogRecordV1, generated from the log schema table
 
 // BLE Connection State Enum
 enum BleConnectionState {
@@ -13,6 +15,19 @@ enum BleConnectionState {
     BLE_DISCONNECTED
 };
 
+// Derived power metrics, maintained incrementally from 1 Hz resampled power (see power_analytics.h)
+struct PowerMetrics {
+    float avg3s_watts = 0.0f;
+    float avg10s_watts = 0.0f;
+    float avg30s_watts = 0.0f;
+    float avg_watts = 0.0f;          // Whole session
+    float normalized_power = 0.0f;   // 0 until the first 30 s window is complete
+    float intensity_factor = 0.0f;   // NP / FTP
+    float tss = 0.0f;                // Training Stress Score
+    float work_kj = 0.0f;
+    uint32_t elapsed_s = 0;          // 1 Hz samples seen (including dropouts filled with zero)
+};
+
 struct PowerCadenceData {
     uint16_t power = 0;
     uint8_t cadence = 0;
@@ -32,35 +47,11 @@ struct PowerCadenceData {
     uint16_t bottom_dead_spot_angle = 0;  // Value in degrees
     bool bottom_dead_spot_available = false;
     bool dead_spot_angles_supported = false; // Is the feature supported by connected PM
-};
-
-// Data Record Structure (Binary Format)
-// Approximately 81 bytes, check actual size with sizeof(LogRecordV1)
-typedef struct __attribute__((__packed__)) {
-    uint32_t system_timestamp_ms; // System uptime or RTC timestamp
 
-    // GPS Data (18 bytes)
-    float gps_latitude;       // Degrees
-    float gps_longitude;      // Degrees
-    float gps_altitude;       // Meters
-    float gps_speed_mps;      // Speed in meters/second
-    uint8_t gps_sats;         // Number of satellites
-    uint8_t gps_fix_type;     // 0=none, 1=No GPS, 2=2D, 3=3D (from TinyGPS++)
-
-    // Power Meter Data (3 bytes)
-    uint16_t power_watts;     // Watts
-    uint8_t cadence_rpm;      // Revolutions per minute
-
-    // IMU Data (24 bytes for 6-axis)
-    float imu_accel_x_mps2;   // m/s^2
-    float imu_accel_y_mps2;   // m/s^2
-    float imu_accel_z_mps2;   // m/s^2
-    float imu_gyro_x_radps;   // radians/second
-    float imu_gyro_y_radps;   // radians/second
-    float imu_gyro_z_radps;   // radians/second
-
-    // Future External Analog Channels Data (32 bytes) - Placeholder
-    float analog_ch[8];       // Initialize to NAN or zero
-} LogRecordV1;
+    // Rolling analytics, updated with every power sample
+    PowerMetrics metrics;
+    MeanMaxPoint meanMax[MMP_MAX_DURATIONS] = {};
+    uint8_t meanMaxCount = 0;
+};
 
 #endif // TYPES_H
@@ -0,0 +1,262 @@
+#include "AnalogCaptureTask.h"
+#include "config.h"
+#include "fir_decimator.h"
+#include "telemetry_stream.h"
+#include "trace.h"
+#include "mem_placement.h"
+#include "raw_capture.h"
+
+#include <driver/adc.h>
+#include <esp_adc_cal.h>
+#include <esp_timer.h>
+#include <cstring>
+
+#define ANALOG_DECIM_TOTAL (ANALOG_DECIM_STAGE1 * ANALOG_DECIM_STAGE2)
+#define ANALOG_OUTPUT_RATE_HZ (ANALOG_SAMPLE_RATE_HZ / ANALOG_DECIM_TOTAL)
+#define ANALOG_RESULT_BYTES SOC_ADC_DIGI_RESULT_BYTES
+#define ANALOG_RESULTS_PER_FRAME (ANALOG_DMA_FRAME_BYTES / ANALOG_RESULT_BYTES)
+
+// Per-stage input block: the most a single DMA frame can deliver to one channel, rounded up to the decimation
+#define STAGE1_BLOCK (((ANALOG_RESULTS_PER_FRAME + ANALOG_DECIM_STAGE1 - 1) / ANALOG_DECIM_STAGE1) * ANALOG_DECIM_STAGE1)
+#define STAGE2_BLOCK (((STAGE1_BLOCK / ANALOG_DECIM_STAGE1 + ANALOG_DECIM_STAGE2) / ANALOG_DECIM_STAGE2) * ANALOG_DECIM_STAGE2)
+
+static_assert(ANALOG_CHANNEL_COUNT >= 1 && ANALOG_CHANNEL_COUNT <= ANALOG_MAX_CHANNELS, "1..8 analog channels supported");
+static_assert(ANALOG_SAMPLE_RATE_HZ % ANALOG_DECIM_TOTAL == 0, "Decimation must divide the ADC rate evenly");
+
+struct AnalogChannelChain {
+    FirDecimator stage1;
+    FirDecimator stage2;
+    float history1[FIR_DECIMATOR_HISTORY_LEN(ANALOG_FIR_STAGE1_TAPS, ANALOG_DECIM_STAGE1, STAGE1_BLOCK)];
+    float history2[FIR_DECIMATOR_HISTORY_LEN(ANALOG_FIR_STAGE2_TAPS, ANALOG_DECIM_STAGE2, STAGE2_BLOCK)];
+    float input[STAGE1_BLOCK];  // Raw conversions collected from the current frame
+    int inputCount;
+};
+
+static const uint8_t s_adcChannels[ANALOG_CHANNEL_COUNT] = ANALOG_ADC1_CHANNELS;
+static int8_t s_channelIndex[SOC_ADC_MAX_CHANNEL_NUM]; // ADC channel -> chain index, -1 if unused
+
+alignas(16) static float s_taps1Reversed[ANALOG_FIR_STAGE1_TAPS];
+alignas(16) static float s_taps2Reversed[ANALOG_FIR_STAGE2_TAPS];
+MEM_HOT static AnalogChannelChain s_chains[ANALOG_CHANNEL_COUNT]; // FIR delay lines, touched per sample
+MEM_PLACED(s_chains, MEM_REGION_INTERNAL);
+static esp_adc_cal_characteristics_t s_adcChars;
+
+static float s_latest[ANALOG_MAX_CHANNELS];
+static AnalogCaptureStats s_stats;
+static portMUX_TYPE s_latestMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void designTaps() {
+    // Each stage keeps 80% of its output Nyquist band
+    float taps[ANALOG_FIR_STAGE2_TAPS > ANALOG_FIR_STAGE1_TAPS ? ANALOG_FIR_STAGE2_TAPS : ANALOG_FIR_STAGE1_TAPS];
+    firDesignLowpass(taps, ANALOG_FIR_STAGE1_TAPS, 0.4f / ANALOG_DECIM_STAGE1);
+    for (int i = 0; i < ANALOG_FIR_STAGE1_TAPS; i++) s_taps1Reversed[i] = taps[ANALOG_FIR_STAGE1_TAPS - 1 - i];
+    firDesignLowpass(taps, ANALOG_FIR_STAGE2_TAPS, 0.4f / ANALOG_DECIM_STAGE2);
+    for (int i = 0; i < ANALOG_FIR_STAGE2_TAPS; i++) s_taps2Reversed[i] = taps[ANALOG_FIR_STAGE2_TAPS - 1 - i];
+}
+
+static void initChain(AnalogChannelChain* chain) {
+    firDecimatorInit(&chain->stage1, s_taps1Reversed, chain->history1, sizeof(chain->history1) / sizeof(float),
+                     ANALOG_FIR_STAGE1_TAPS, ANALOG_DECIM_STAGE1);
+    firDecimatorInit(&chain->stage2, s_taps2Reversed, chain->history2, sizeof(chain->history2) / sizeof(float),
+                     ANALOG_FIR_STAGE2_TAPS, ANALOG_DECIM_STAGE2);
+    chain->inputCount = 0;
+}
+
+// Run both stages on whatever the channel collected; returns the number of final outputs in `out`.
+static int runChain(AnalogChannelChain* chain, float* out) {
+    float mid[STAGE2_BLOCK];
+    int n1 = firDecimatorProcess(&chain->stage1, chain->input, chain->inputCount, mid);
+    chain->inputCount = 0;
+    return firDecimatorProcess(&chain->stage2, mid, n1, out);
+}
+
+static bool initializeAdcDma() {
+    adc_digi_init_config_t initConfig = {};
+    initConfig.max_store_buf_size = ANALOG_DMA_FRAME_BYTES * 4;
+    initConfig.conv_num_each_intr = ANALOG_DMA_FRAME_BYTES;
+    for (int i = 0; i < ANALOG_CHANNEL_COUNT; i++) {
+        initConfig.adc1_chan_mask |= (1 << s_adcChannels[i]);
+    }
+    if (adc_digi_initialize(&initConfig) != ESP_OK) {
+        return false;
+    }
+
+    static adc_digi_pattern_config_t pattern[SOC_ADC_PATT_LEN_MAX];
+    for (int i = 0; i < ANALOG_CHANNEL_COUNT; i++) {
+        pattern[i].atten = ADC_ATTEN_DB_11;
+        pattern[i].channel = s_adcChannels[i];
+        pattern[i].unit = 0; // ADC1
+        pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    }
+
+    adc_digi_configuration_t digConfig = {};
+    digConfig.conv_limit_en = false;
+    digConfig.conv_limit_num = 250;
+    digConfig.pattern_num = ANALOG_CHANNEL_COUNT;
+    digConfig.adc_pattern = pattern;
+    digConfig.sample_freq_hz = ANALOG_SAMPLE_RATE_HZ * ANALOG_CHANNEL_COUNT; // Total conversions, all channels
+    digConfig.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    digConfig.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+    if (adc_digi_controller_configure(&digConfig) != ESP_OK) {
+        adc_digi_deinitialize();
+        return false;
+    }
+
+    esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12, 1100, &s_adcChars);
+    return adc_digi_start() == ESP_OK;
+}
+
+void analogCaptureTask(void *pvParameters) {
+    Serial.println("Analog Capture Task started");
+
+    for (int i = 0; i < ANALOG_MAX_CHANNELS; i++) s_latest[i] = NAN;
+    for (int i = 0; i < SOC_ADC_MAX_CHANNEL_NUM; i++) s_channelIndex[i] = -1;
+    for (int i = 0; i < ANALOG_CHANNEL_COUNT; i++) s_channelIndex[s_adcChannels[i]] = i;
+
+    designTaps();
+    for (int i = 0; i < ANALOG_CHANNEL_COUNT; i++) initChain(&s_chains[i]);
+
+    if (!initializeAdcDma()) {
+        Serial.println("Analog capture: ADC continuous mode initialization failed! Task exiting.");
+        vTaskDelete(NULL);
+        return;
+    }
+    Serial.printf("Analog capture: %d channels at %d Hz, decimated x%d to %d Hz.\n",
+                  ANALOG_CHANNEL_COUNT, ANALOG_SAMPLE_RATE_HZ, ANALOG_DECIM_TOTAL, ANALOG_OUTPUT_RATE_HZ);
+
+    static uint8_t frame[ANALOG_DMA_FRAME_BYTES];
+    float outputs[STAGE2_BLOCK / ANALOG_DECIM_STAGE2 + 1];
+
+    for (;;) {
+        uint32_t bytesRead = 0;
+        esp_err_t ret = adc_digi_read_bytes(frame, sizeof(frame), &bytesRead, ADC_MAX_DELAY);
+        TRACE_SCOPE(TRACE_ANALOG_FRAME);
+        if (ret == ESP_ERR_INVALID_STATE) {
+            s_stats.overflows++; // Driver pool overflowed; data in this read is still valid
+        } else if (ret != ESP_OK) {
+            continue;
+        }
+
+        // De-interleave the scan into per-channel inputs
+        for (uint32_t i = 0; i + ANALOG_RESULT_BYTES <= bytesRead; i += ANALOG_RESULT_BYTES) {
+            const adc_digi_output_data_t* p = (const adc_digi_output_data_t*)&frame[i];
+            int index = (p->type2.unit == 0 && p->type2.channel < SOC_ADC_MAX_CHANNEL_NUM)
+                            ? s_channelIndex[p->type2.channel] : -1;
+            if (index < 0 || s_chains[index].inputCount >= STAGE1_BLOCK) {
+                s_stats.discarded++;
+                continue;
+            }
+            s_chains[index].input[s_chains[index].inputCount++] = (float)p->type2.data;
+        }
+        s_stats.frames++;
+        s_stats.samples += bytesRead / ANALOG_RESULT_BYTES;
+
+        bool anyOutput = false;
+        for (int ch = 0; ch < ANALOG_CHANNEL_COUNT; ch++) {
+            int produced = runChain(&s_chains[ch], outputs);
+            if (produced == 0) continue;
+            float raw = outputs[produced - 1];
+            uint32_t rawCounts = raw <= 0.0f ? 0 : (uint32_t)(raw + 0.5f); // Filter ringing can go slightly negative
+            float volts = esp_adc_cal_raw_to_voltage(rawCounts, &s_adcChars) / 1000.0f;
+            portENTER_CRITICAL(&s_latestMux);
+            s_latest[ch] = volts;
+            if (ch == 0) s_stats.outputs += produced;
+            portEXIT_CRITICAL(&s_latestMux);
+            anyOutput = true;
+        }
+
+        if (anyOutput && rawCaptureMode() != RAW_CAPTURE_OFF) {
+            float captured[ANALOG_MAX_CHANNELS]; // What the next records' analog_ch will hold
+            analogGetLatest(captured);
+            rawCaptureAppend(millis(), CAPTURE_ANALOG, captured, sizeof(captured));
+        }
+
+        if (anyOutput && telemetryEnabled()) {
+            uint8_t payload[sizeof(uint32_t) + 1 + ANALOG_CHANNEL_COUNT * sizeof(float)];
+            uint32_t now = millis();
+            memcpy(payload, &now, sizeof(now));
+            payload[sizeof(uint32_t)] = ANALOG_CHANNEL_COUNT;
+            portENTER_CRITICAL(&s_latestMux);
+            memcpy(&payload[sizeof(uint32_t) + 1], s_latest, ANALOG_CHANNEL_COUNT * sizeof(float));
+            portEXIT_CRITICAL(&s_latestMux);
+            telemetryPublish(TELEM_ANALOG, payload, sizeof(payload));
+        }
+    }
+}
+
+void analogGetLatest(float out[ANALOG_MAX_CHANNELS]) {
+    portENTER_CRITICAL(&s_latestMux);
+    for (int i = 0; i < ANALOG_MAX_CHANNELS; i++) out[i] = s_latest[i];
+    portEXIT_CRITICAL(&s_latestMux);
+}
+
+void analogGetStats(AnalogCaptureStats* out) {
+    portENTER_CRITICAL(&s_latestMux);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_latestMux);
+}
+
+// --- Benchmark: vector chain vs scalar reference on one second of one channel ---
+void analogRunBenchmark() {
+    const int inputLen = ANALOG_SAMPLE_RATE_HZ;
+    const int outputLen = inputLen / ANALOG_DECIM_TOTAL;
+    float* input = (float*)malloc(inputLen * sizeof(float));
+    float* outVec = (float*)malloc(outputLen * sizeof(float));
+    float* outRef = (float*)malloc(outputLen * sizeof(float));
+    float* midRef = (float*)malloc(inputLen / ANALOG_DECIM_STAGE1 * sizeof(float));
+    AnalogChannelChain* chain = (AnalogChannelChain*)malloc(sizeof(AnalogChannelChain));
+    if (!input || !outVec || !outRef || !midRef || !chain) {
+        Serial.println("adc_bench: out of memory.");
+        free(input); free(outVec); free(outRef); free(midRef); free(chain);
+        return;
+    }
+
+    // 20 Hz signal plus an interferer above the output Nyquist rate, in ADC counts
+    for (int i = 0; i < inputLen; i++) {
+        float t = (float)i / ANALOG_SAMPLE_RATE_HZ;
+        input[i] = 2048.0f + 1000.0f * sinf(2.0f * PI * 20.0f * t) + 300.0f * sinf(2.0f * PI * 900.0f * t);
+    }
+    designTaps();
+
+    // Vector chain, fed frame-sized blocks as the capture task does
+    initChain(chain);
+    int produced = 0;
+    float blockOut[STAGE2_BLOCK / ANALOG_DECIM_STAGE2 + 1];
+    int64_t start = esp_timer_get_time();
+    for (int offset = 0; offset < inputLen; offset += STAGE1_BLOCK) {
+        int n = (inputLen - offset) < STAGE1_BLOCK ? (inputLen - offset) : STAGE1_BLOCK;
+        memcpy(chain->input, input + offset, n * sizeof(float));
+        chain->inputCount = n;
+        int got = runChain(chain, blockOut);
+        for (int k = 0; k < got && produced < outputLen; k++) outVec[produced++] = blockOut[k];
+    }
+    int64_t vecUs = esp_timer_get_time() - start;
+
+    // Scalar reference, same taps (the reference takes them in natural order; they are symmetric)
+    float taps1[ANALOG_FIR_STAGE1_TAPS], taps2[ANALOG_FIR_STAGE2_TAPS];
+    float delay1[ANALOG_FIR_STAGE1_TAPS], delay2[ANALOG_FIR_STAGE2_TAPS];
+    firDesignLowpass(taps1, ANALOG_FIR_STAGE1_TAPS, 0.4f / ANALOG_DECIM_STAGE1);
+    firDesignLowpass(taps2, ANALOG_FIR_STAGE2_TAPS, 0.4f / ANALOG_DECIM_STAGE2);
+    FirDecimatorRef ref1, ref2;
+    firDecimatorRefInit(&ref1, taps1, delay1, ANALOG_FIR_STAGE1_TAPS, ANALOG_DECIM_STAGE1);
+    firDecimatorRefInit(&ref2, taps2, delay2, ANALOG_FIR_STAGE2_TAPS, ANALOG_DECIM_STAGE2);
+    start = esp_timer_get_time();
+    firDecimatorRefProcess(&ref1, input, midRef, inputLen / ANALOG_DECIM_STAGE1);
+    firDecimatorRefProcess(&ref2, midRef, outRef, outputLen);
+    int64_t refUs = esp_timer_get_time() - start;
+
+    float maxDiff = 0.0f;
+    for (int i = 0; i < produced; i++) {
+        float d = fabsf(outVec[i] - outRef[i]);
+        if (d > maxDiff) maxDiff = d;
+    }
+
+    Serial.printf("adc_bench: %d input samples -> %d outputs per channel\n", inputLen, produced);
+    Serial.printf("  ESP-DSP chain:    %lld us, %.0f samples/s/channel\n", vecUs, inputLen * 1e6 / (double)vecUs);
+    Serial.printf("  Scalar reference: %lld us, %.0f samples/s/channel\n", refUs, inputLen * 1e6 / (double)refUs);
+    Serial.printf("  Max |difference|: %.4f counts\n", maxDiff);
+    Serial.printf("  Capacity at %d Hz/channel: ~%.0f channels (vector), ~%.0f (scalar)\n", ANALOG_SAMPLE_RATE_HZ,
+                  1e6 / (double)vecUs, 1e6 / (double)refUs);
+
+    free(input); free(outVec); free(outRef); free(midRef); free(chain);
+}
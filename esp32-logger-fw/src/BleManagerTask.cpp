@@ -2,186 +2,206 @@
 #include "shared_state.h" // Added for g_debugSettings
 #include <NimBLEDevice.h>
 #include "config.h" // For g_powerCadenceData, g_dataMutex, BleConnectionState, types.h
+#include "DisplayUpdateTask.h" // For displayNotifyDataChanged()
+#include "power_analytics.h"   // Rolling power metrics
+#include "mean_max_power.h"    // Live best-power curve
+#include "event_log.h"         // Periodic power summaries
+#include "telemetry_stream.h"  // Live binary stream
+#include "trace.h"             // Stall tracing
+#include "power_manager.h"     // Full clock while connecting
+#include "cycling_power.h"     // Measurement decoding (shared with the host replay)
+#include "raw_capture.h"       // Notification payloads for raw capture
+#include "sd_card.h"           // Mean-max curve saved at the end of a ride
+#include "mem_placement.h"     // Mean-max ring in the PSRAM arena
 #include <Arduino.h> // For Serial prints and other Arduino functions
-#include <string>    // For std::string
 #include <cstring>   // For memset, strncpy
 
 // Static global variables for this file
 static NimBLEScan* pBLEScan;
 static bool s_deadSpotAnglesSupported = false;
+static CyclingPowerDecoder s_cpDecoder; // Crank state between notifications; BLE host task only
+static uint32_t s_cpFeatures = 0;       // Feature bitmask of the connected meter, for raw capture
+static uint32_t s_cpFeaturesCaptured = 0; // Capture session that already has it
 static NimBLEClient* pClient = nullptr;
 static boolean doConnect = false;
 static NimBLEAdvertisedDevice* myDevice = nullptr; // Store the advertised device object
+static char s_deviceName[sizeof(g_powerCadenceData.connectedDeviceName)]; // Advertised name of myDevice
+// Parsed once; the string constructors go through std::string on every call
+static const NimBLEUUID s_cyclingPowerServiceUuid(CYCLING_POWER_SERVICE_UUID);
+static const NimBLEUUID s_cyclingPowerMeasurementUuid(CYCLING_POWER_MEASUREMENT_UUID);
+static const NimBLEUUID s_cyclingPowerFeatureUuid((uint16_t)0x2A65);
 static BLERemoteCharacteristic* pCyclingPowerMeasurementChar = nullptr;
 static boolean connected = false;
-
-// Notification Callback
-void notifyCallback(BLERemoteCharacteristic* pBLERemoteCharacteristic, uint8_t* pData, size_t length, bool isNotify) {
-    static uint16_t prevCrankRevolutions = 0;
-    static uint16_t prevCrankEventTime = 0; // In 1/1024s units
-    static bool firstCrankDataPacketProcessed = false;
-
-    if (length < 2) { // Minimum length for Flags
-        if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
-            if (g_debugSettings.bleDebugStreamOn) {
-                Serial.println("BLE Notify: Data length too short for flags.");
-            }
-            xSemaphoreGive(g_debugSettingsMutex);
-        }
+static volatile bool s_meanMaxSavePending = false; // Set on disconnect; the SD write happens in the BLE task loop
+static PowerAnalytics s_powerAnalytics(POWER_FTP_WATTS, POWER_DROPOUT_MS);
+static MeanMaxPower s_meanMaxPower;
+static const uint16_t s_meanMaxDurations[] = MMP_DURATIONS_S;
+static const size_t MEAN_MAX_DURATION_COUNT = sizeof(s_meanMaxDurations) / sizeof(s_meanMaxDurations[0]);
+static_assert(MEAN_MAX_DURATION_COUNT <= EVENT_MEAN_MAX_POINTS, "MMP_DURATIONS_S must fit in one MeanMaxCurveEvent");
+
+// The mean-max ring holds the longest duration at 1 Hz; it comes from the PSRAM arena when there is one
+static void initializePowerAnalytics() {
+    uint32_t longest = meanMaxLongestDuration(s_meanMaxDurations, MEAN_MAX_DURATION_COUNT);
+    uint16_t* ring = (uint16_t*)memArenaAlloc(MEM_REGION_PSRAM, longest * sizeof(uint16_t), "mean-max ring");
+    if (ring == nullptr) {
+        ring = (uint16_t*)malloc(longest * sizeof(uint16_t)); // Permanent either way, never freed
+    }
+    if (ring == nullptr || !s_meanMaxPower.begin(s_meanMaxDurations, MEAN_MAX_DURATION_COUNT, ring, longest)) {
+        Serial.println("Power analytics: failed to set up the mean-maximal curve.");
         return;
     }
+    s_powerAnalytics.setSecondSink(meanMaxPowerSecondSink, &s_meanMaxPower);
+}
 
-    uint16_t flags = (pData[1] << 8) | pData[0];
-    uint16_t finalPower = 0;
-    uint8_t finalCadence = 0;
-    float finalLeftPedalBalance = 50.0f;
-    bool finalBalanceAvailable = false;
-    uint16_t finalTopDeadSpotAngle = 0;
-    bool finalTopDeadSpotAvailable = false;
-    uint16_t finalBottomDeadSpotAngle = 0;
-    bool finalBottomDeadSpotAvailable = false;
-
-    // --- Parse Power ---
-    if (length >= 4) {
-        int16_t rawPower = (int16_t)((pData[3] << 8) | pData[2]);
-        finalPower = (rawPower < 0) ? 0 : (uint16_t)rawPower;
-    } else {
-        if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
-            if (g_debugSettings.bleDebugStreamOn) {
-                Serial.println("BLE Notify: Data length too short for power measurement.");
-            }
-            xSemaphoreGive(g_debugSettingsMutex);
-        }
-    }
+void setPowerAnalyticsFtp(uint16_t ftpWatts) {
+    s_powerAnalytics.setFtp(ftpWatts);
+}
 
-    // --- Parse Pedal Power Balance ---
-    bool pedalBalanceFlagPresent = (flags & 0x01);
-    uint8_t currentOffset = 4;
+uint16_t getPowerAnalyticsFtp() {
+    return s_powerAnalytics.ftp();
+}
 
-    if (pedalBalanceFlagPresent) {
-        if (length >= currentOffset + 1) {
-            uint8_t balanceValue = pData[currentOffset];
-            finalLeftPedalBalance = (float)balanceValue / 2.0f;
-            finalBalanceAvailable = true;
-            currentOffset += 1;
-        } else {
-            if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
-                if (g_debugSettings.bleDebugStreamOn) {
-                    Serial.println("BLE Notify: Pedal Balance flag set, but data length insufficient.");
-                }
-                xSemaphoreGive(g_debugSettingsMutex);
-            }
-            finalBalanceAvailable = false;
-        }
+void postMeanMaxSummary() {
+    MeanMaxCurveEvent curve = {};
+    MeanMaxPoint points[EVENT_MEAN_MAX_POINTS];
+    uint8_t count = 0;
+    if (TRACE_MUTEX_TAKE(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        count = g_powerCadenceData.meanMaxCount;
+        memcpy(points, g_powerCadenceData.meanMax, count * sizeof(MeanMaxPoint));
+        curve.elapsed_s = g_powerCadenceData.metrics.elapsed_s;
+        TRACE_MUTEX_GIVE(g_dataMutex);
     }
+    curve.count = count;
+    for (uint8_t i = 0; i < count; i++) {
+        curve.points[i].duration_s = points[i].duration_s;
+        curve.points[i].best_watts = (uint16_t)lroundf(points[i].best_watts);
+        curve.points[i].best_end_s = points[i].best_end_s;
+    }
+    eventLogPost(EVENT_MEAN_MAX_CURVE, &curve, sizeof(curve));
+}
 
-    // --- Parse Cadence ---
-    bool crankDataFlagPresent = (flags & 0x02);
-
-    if (crankDataFlagPresent) {
-        if (length >= currentOffset + 4) {
-            uint16_t currentCrankRevolutions = (pData[currentOffset+1] << 8) | pData[currentOffset+0];
-            uint16_t currentCrankEventTime = (pData[currentOffset+3] << 8) | pData[currentOffset+2];
-
-            if (firstCrankDataPacketProcessed) {
-                uint16_t deltaRevolutions;
-                if (currentCrankRevolutions < prevCrankRevolutions) {
-                    deltaRevolutions = (65535 - prevCrankRevolutions) + currentCrankRevolutions + 1;
-                } else {
-                    deltaRevolutions = currentCrankRevolutions - prevCrankRevolutions;
-                }
-
-                uint16_t deltaEventTime;
-                if (currentCrankEventTime < prevCrankEventTime) {
-                    deltaEventTime = (65535 - prevCrankEventTime) + currentCrankEventTime + 1;
-                } else {
-                    deltaEventTime = currentCrankEventTime - prevCrankEventTime;
-                }
+bool saveMeanMaxCurve() {
+    MeanMaxPoint points[MMP_MAX_DURATIONS];
+    uint8_t count = 0;
+    uint32_t elapsed = 0;
+    if (TRACE_MUTEX_TAKE(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        count = g_powerCadenceData.meanMaxCount;
+        memcpy(points, g_powerCadenceData.meanMax, count * sizeof(MeanMaxPoint));
+        elapsed = g_powerCadenceData.metrics.elapsed_s;
+        TRACE_MUTEX_GIVE(g_dataMutex);
+    }
+    if (count == 0 || elapsed == 0) {
+        Serial.println("Mean-max: no power recorded, nothing to save.");
+        return false;
+    }
 
-                if (deltaRevolutions > 0 && deltaEventTime > 0) {
-                    double deltaTimeSeconds = (double)deltaEventTime / 1024.0;
-                    finalCadence = (uint8_t)(((double)deltaRevolutions / deltaTimeSeconds) * 60.0);
-                } else if (deltaEventTime > (1024 * 2)) {
-                    finalCadence = 0;
-                } else {
-                    finalCadence = 0;
-                }
-            } else {
-                firstCrankDataPacketProcessed = true;
-                finalCadence = 0;
-            }
+    // One row per save: uptime_ms,elapsed_s, then best watts and window end for each duration
+    char line[32 + MMP_MAX_DURATIONS * 24];
+    int length = snprintf(line, sizeof(line), "%lu,%lu", (unsigned long)millis(), (unsigned long)elapsed);
+    for (uint8_t i = 0; i < count; i++) {
+        length += snprintf(line + length, sizeof(line) - length, ",%.0f,%lu", points[i].best_watts,
+                           (unsigned long)points[i].best_end_s);
+    }
+    length += snprintf(line + length, sizeof(line) - length, "\n");
 
-            prevCrankRevolutions = currentCrankRevolutions;
-            prevCrankEventTime = currentCrankEventTime;
-            currentOffset += 4; // Advance offset after cadence data
-        } else {
-            if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
-                if (g_debugSettings.bleDebugStreamOn) {
-                    Serial.println("BLE Notify: Crank data flag set, but data length insufficient for crank fields.");
-                }
-                xSemaphoreGive(g_debugSettingsMutex);
-            }
-            firstCrankDataPacketProcessed = false;
-            finalCadence = 0;
-        }
-    } else {
-        if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
-            if (g_debugSettings.bleDebugStreamOn) {
-                // Serial.println("BLE Notify: Crank Revolution Data not present in flags."); // Can be noisy
-            }
-            xSemaphoreGive(g_debugSettingsMutex);
+    if (!sdCardBegin() || !sdCardLock(pdMS_TO_TICKS(1000))) {
+        Serial.println("Mean-max: SD card not available, curve not saved.");
+        return false;
+    }
+    FsFile file;
+    bool ok = file.open(&sdCardFs(), MMP_SAVE_FILE, O_WRONLY | O_CREAT | O_APPEND);
+    if (ok && file.fileSize() == 0) {
+        char header[32 + MMP_MAX_DURATIONS * 32];
+        int headerLength = snprintf(header, sizeof(header), "uptime_ms,elapsed_s");
+        for (uint8_t i = 0; i < count; i++) {
+            headerLength += snprintf(header + headerLength, sizeof(header) - headerLength, ",best_%us_w,best_%us_end_s",
+                                     points[i].duration_s, points[i].duration_s);
         }
-        firstCrankDataPacketProcessed = false;
-        finalCadence = 0;
+        headerLength += snprintf(header + headerLength, sizeof(header) - headerLength, "\n");
+        ok = file.write(header, headerLength) == (size_t)headerLength;
     }
+    ok = ok && file.write(line, length) == (size_t)length;
+    ok = file.close() && ok;
+    sdCardUnlock();
+    Serial.printf("Mean-max curve %s %s\n", ok ? "appended to" : "could not be written to", MMP_SAVE_FILE);
+    return ok;
+}
 
-    // --- Parse Top/Bottom Dead Spot Angles ---
-    bool extremeAnglesFlagPresent = (flags & (1 << 8));
+static void postPowerSummary(const PowerMetrics& metrics) {
+    PowerSummaryEvent summary;
+    summary.elapsed_s = metrics.elapsed_s;
+    summary.avg3s_watts = (uint16_t)lroundf(metrics.avg3s_watts);
+    summary.avg10s_watts = (uint16_t)lroundf(metrics.avg10s_watts);
+    summary.avg30s_watts = (uint16_t)lroundf(metrics.avg30s_watts);
+    summary.avg_watts = (uint16_t)lroundf(metrics.avg_watts);
+    summary.normalized_power = (uint16_t)lroundf(metrics.normalized_power);
+    summary.ftp_watts = s_powerAnalytics.ftp();
+    summary.intensity_factor = metrics.intensity_factor;
+    summary.tss = metrics.tss;
+    summary.work_kj = metrics.work_kj;
+    eventLogPost(EVENT_POWER_SUMMARY, &summary, sizeof(summary));
+}
 
-    if (s_deadSpotAnglesSupported && extremeAnglesFlagPresent) {
-        // Serial.println("Extreme Angles flag present and feature supported."); // Can be noisy
-        if (flags & (1 << 9)) { // Top Dead Spot Angle Present
-            if (length >= currentOffset + 2) {
-                finalTopDeadSpotAngle = (pData[currentOffset+1] << 8) | pData[currentOffset+0];
-                finalTopDeadSpotAvailable = true;
-                currentOffset += 2;
-                // Serial.printf("Parsed TDS Angle: %u\n", finalTopDeadSpotAngle); // Keep commented or wrap if enabled
-            } else {
-                if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
-                    if (g_debugSettings.bleDebugStreamOn) {
-                        Serial.println("BLE Notify: TDS Angle flag set, but data length insufficient.");
-                    }
-                    xSemaphoreGive(g_debugSettingsMutex);
-                }
-            }
+// Prints which announced fields a notification was too short for (BLE debug stream only)
+static void reportShortNotification(uint8_t issues) {
+    if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
+        if (g_debugSettings.bleDebugStreamOn) {
+            if (issues & CP_SHORT_FLAGS) Serial.println("BLE Notify: Data length too short for flags.");
+            if (issues & CP_SHORT_POWER) Serial.println("BLE Notify: Data length too short for power measurement.");
+            if (issues & CP_SHORT_BALANCE) Serial.println("BLE Notify: Pedal Balance flag set, but data length insufficient.");
+            if (issues & CP_SHORT_CRANK) Serial.println("BLE Notify: Crank data flag set, but data length insufficient for crank fields.");
+            if (issues & CP_SHORT_TOP_DEAD) Serial.println("BLE Notify: TDS Angle flag set, but data length insufficient.");
+            if (issues & CP_SHORT_BOTTOM_DEAD) Serial.println("BLE Notify: BDS Angle flag set, but data length insufficient.");
         }
-        if (flags & (1 << 10)) { // Bottom Dead Spot Angle Present
-            if (length >= currentOffset + 2) {
-                finalBottomDeadSpotAngle = (pData[currentOffset+1] << 8) | pData[currentOffset+0];
-                finalBottomDeadSpotAvailable = true;
-                currentOffset += 2;
-                // Serial.printf("Parsed BDS Angle: %u\n", finalBottomDeadSpotAngle); // Keep commented or wrap if enabled
-            } else {
-                if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
-                    if (g_debugSettings.bleDebugStreamOn) {
-                        Serial.println("BLE Notify: BDS Angle flag set, but data length insufficient.");
-                    }
-                    xSemaphoreGive(g_debugSettingsMutex);
-                }
-            }
+        xSemaphoreGive(g_debugSettingsMutex);
+    }
+}
+
+// Notification Callback
+void notifyCallback(BLERemoteCharacteristic* pBLERemoteCharacteristic, uint8_t* pData, size_t length, bool isNotify) {
+    TRACE_SCOPE(TRACE_BLE_NOTIFY);
+    if (rawCaptureMode() != RAW_CAPTURE_OFF) {
+        uint32_t now = millis();
+        if (s_cpFeaturesCaptured != rawCaptureSession()) { // Each capture file starts with the meter's features
+            s_cpFeaturesCaptured = rawCaptureSession();
+            rawCaptureAppend(now, CAPTURE_CP_FEATURE, &s_cpFeatures, sizeof(s_cpFeatures));
         }
-    } else {
-        if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
-            if (g_debugSettings.bleDebugStreamOn) {
-                // if (!s_deadSpotAnglesSupported) { /* Serial.println("TDS/BDS angles feature not supported by device."); */ }
-                // if (!extremeAnglesFlagPresent && s_deadSpotAnglesSupported) { /* Serial.println("Extreme Angles flag not present in this packet."); */ }
-            }
-            xSemaphoreGive(g_debugSettingsMutex);
+        rawCaptureAppend(now, CAPTURE_CP_MEASUREMENT, pData, length);
+        if (!rawCaptureDecoding()) {
+            return;
         }
     }
+    CyclingPowerMeasurement measurement;
+    s_cpDecoder.setDeadSpotAnglesSupported(s_deadSpotAnglesSupported);
+    uint8_t issues = s_cpDecoder.decode(pData, length, &measurement);
+    if (issues != 0) {
+        reportShortNotification(issues);
+    }
+    if (issues & CP_SHORT_FLAGS) {
+        return;
+    }
+    uint16_t finalPower = measurement.power_watts;
+    uint8_t finalCadence = measurement.cadence_rpm;
+    float finalLeftPedalBalance = measurement.left_balance_percent;
+    bool finalBalanceAvailable = measurement.balance_available;
+    uint16_t finalTopDeadSpotAngle = measurement.top_dead_spot_deg;
+    bool finalTopDeadSpotAvailable = measurement.top_dead_spot_available;
+    uint16_t finalBottomDeadSpotAngle = measurement.bottom_dead_spot_deg;
+    bool finalBottomDeadSpotAvailable = measurement.bottom_dead_spot_available;
+
+    // --- Rolling analytics (O(1) per 1 Hz step) ---
+    PowerMetrics metrics;
+    uint32_t secondsCompleted = s_powerAnalytics.addSample(millis(), finalPower);
+    s_powerAnalytics.getMetrics(&metrics);
+    MeanMaxPoint meanMax[MMP_MAX_DURATIONS];
+    size_t meanMaxCount = s_meanMaxPower.getCurve(meanMax, MMP_MAX_DURATIONS);
+    uint32_t previousElapsed = metrics.elapsed_s - secondsCompleted;
+    if (metrics.elapsed_s / POWER_SUMMARY_INTERVAL_S != previousElapsed / POWER_SUMMARY_INTERVAL_S) {
+        postPowerSummary(metrics);
+    }
 
     // --- Update Shared Data ---
-    if (xSemaphoreTake(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+    if (TRACE_MUTEX_TAKE(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
         g_powerCadenceData.power = finalPower;
         g_powerCadenceData.cadence = finalCadence;
         g_powerCadenceData.left_pedal_balance_percent = finalLeftPedalBalance;
@@ -191,10 +211,23 @@ void notifyCallback(BLERemoteCharacteristic* pBLERemoteCharacteristic, uint8_t*
         g_powerCadenceData.top_dead_spot_available = finalTopDeadSpotAvailable;
         g_powerCadenceData.bottom_dead_spot_angle = finalBottomDeadSpotAngle;
         g_powerCadenceData.bottom_dead_spot_available = finalBottomDeadSpotAvailable;
+        g_powerCadenceData.metrics = metrics;
+        memcpy(g_powerCadenceData.meanMax, meanMax, meanMaxCount * sizeof(MeanMaxPoint));
+        g_powerCadenceData.meanMaxCount = (uint8_t)meanMaxCount;
 
         g_powerCadenceData.newData = true;
 
-        xSemaphoreGive(g_dataMutex);
+        TRACE_MUTEX_GIVE(g_dataMutex);
+        displayNotifyDataChanged(); // Wake the display instead of waiting for its refresh deadline
+
+        if (telemetryEnabled()) {
+            TelemetryPower telemetry;
+            telemetry.timestamp_ms = millis();
+            telemetry.power_watts = finalPower;
+            telemetry.cadence_rpm = finalCadence;
+            telemetry.left_balance_half_percent = finalBalanceAvailable ? (uint8_t)(finalLeftPedalBalance * 2.0f) : 0xFF;
+            telemetryPublish(TELEM_POWER, &telemetry, sizeof(telemetry));
+        }
         /*
         Serial.printf("Processed Data -> P: %u, C: %u, LBal: %.1f%%(%s), TDS: %u(%s), BDS: %u(%s)\n",
                       finalPower, finalCadence,
@@ -220,43 +253,77 @@ void notifyCallback(BLERemoteCharacteristic* pBLERemoteCharacteristic, uint8_t*
     }
 }
 
+// NimBLEAddress::toString() and NimBLEAdvertisedDevice::getName() return std::string, so the
+// address and name are formatted into fixed buffers here instead.
+#define BLE_ADDRESS_STRING_LEN 18 // "xx:xx:xx:xx:xx:xx"
+#define AD_TYPE_SHORT_NAME 0x08
+#define AD_TYPE_COMPLETE_NAME 0x09
+#define BLE_FEATURE_READ_TIMEOUT_MS 2000
+
+static void formatAddress(const NimBLEAddress& address, char* out, size_t size) {
+    const uint8_t* a = address.getNative(); // Little-endian
+    snprintf(out, size, "%02x:%02x:%02x:%02x:%02x:%02x", a[5], a[4], a[3], a[2], a[1], a[0]);
+}
+
+// Local name from the advertisement (complete preferred over shortened); empty if none
+static void copyAdvertisedName(NimBLEAdvertisedDevice* device, char* out, size_t size) {
+    out[0] = '\0';
+    const uint8_t* payload = device->getPayload();
+    size_t length = device->getPayloadLength();
+    size_t i = 0;
+    while (i + 1 < length) {
+        uint8_t fieldLength = payload[i];
+        if (fieldLength == 0 || i + 1 + fieldLength > length) {
+            break;
+        }
+        uint8_t type = payload[i + 1];
+        if (type == AD_TYPE_COMPLETE_NAME || type == AD_TYPE_SHORT_NAME) {
+            size_t n = fieldLength - 1 < size - 1 ? fieldLength - 1 : size - 1;
+            memcpy(out, &payload[i + 2], n);
+            out[n] = '\0';
+            if (type == AD_TYPE_COMPLETE_NAME) {
+                return;
+            }
+        }
+        i += 1 + fieldLength;
+    }
+}
+
 // Client Callback Class
 class ClientCallbacks : public NimBLEClientCallbacks {
     void onConnect(NimBLEClient* pclient_in) {
-        Serial.print("Connected to BLE server: ");
-        Serial.println(pclient_in->getPeerAddress().toString().c_str());
+        char address[BLE_ADDRESS_STRING_LEN];
+        formatAddress(pclient_in->getPeerAddress(), address, sizeof(address));
+        Serial.printf("Connected to BLE server: %s\n", address);
         connected = true;
         // pclient_in->updatePeerMTU(517); // Optional: Request larger MTU.
 
-        if (xSemaphoreTake(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        if (TRACE_MUTEX_TAKE(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
             g_powerCadenceData.bleState = BLE_CONNECTED;
-            std::string name = pclient_in->getPeerAddress().toString();
-            if (myDevice && myDevice->haveName()) {
-                name = myDevice->getName();
-                if (name.empty()) {
-                     name = pclient_in->getPeerAddress().toString();
-                }
-            }
-            strncpy(g_powerCadenceData.connectedDeviceName, name.c_str(), sizeof(g_powerCadenceData.connectedDeviceName) - 1);
+            const char* name = s_deviceName[0] != '\0' ? s_deviceName : address;
+            strncpy(g_powerCadenceData.connectedDeviceName, name, sizeof(g_powerCadenceData.connectedDeviceName) - 1);
             g_powerCadenceData.connectedDeviceName[sizeof(g_powerCadenceData.connectedDeviceName) - 1] = '\0';
             g_powerCadenceData.newData = true;
-            xSemaphoreGive(g_dataMutex);
-            Serial.printf("Device Name/Addr for display: %s\n", name.c_str());
+            TRACE_MUTEX_GIVE(g_dataMutex);
+            displayNotifyDataChanged();
+            Serial.printf("Device Name/Addr for display: %s\n", name);
         }
     }
 
     void onDisconnect(NimBLEClient* pclient_in) {
-        Serial.print("Disconnected from BLE server: ");
-        Serial.println(pclient_in->getPeerAddress().toString().c_str());
+        char address[BLE_ADDRESS_STRING_LEN];
+        formatAddress(pclient_in->getPeerAddress(), address, sizeof(address));
+        Serial.printf("Disconnected from BLE server: %s\n", address);
         connected = false;
-        pClient = nullptr;
-        doConnect = false;
+        doConnect = false; // The client object is kept and reused for the next connection
+        s_meanMaxSavePending = true;
 
-        if (xSemaphoreTake(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        if (TRACE_MUTEX_TAKE(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
             g_powerCadenceData.bleState = BLE_DISCONNECTED;
             g_powerCadenceData.newData = true; // Trigger display update
             // Keep device name for info, or clear: memset(g_powerCadenceData.connectedDeviceName, 0, sizeof(g_powerCadenceData.connectedDeviceName));
-            xSemaphoreGive(g_dataMutex);
+            TRACE_MUTEX_GIVE(g_dataMutex);
+            displayNotifyDataChanged();
         }
     }
 };
@@ -278,7 +345,7 @@ class AdvertisedDeviceCallbacks : public NimBLEAdvertisedDeviceCallbacks {
             xSemaphoreGive(g_debugSettingsMutex);
         }
 
-        if (advertisedDevice->isAdvertisingService(NimBLEUUID(CYCLING_POWER_SERVICE_UUID))) {
+        if (advertisedDevice->isAdvertisingService(s_cyclingPowerServiceUuid)) {
             if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
                 if (g_debugSettings.bleActivityStreamOn) {
                      Serial.println("Found Cycling Power Service in advertisement!");
@@ -306,6 +373,7 @@ class AdvertisedDeviceCallbacks : public NimBLEAdvertisedDeviceCallbacks {
             }
             // myDevice = new NimBLEAdvertisedDevice(*advertisedDevice); // Make a copy for long term storage
             myDevice = advertisedDevice;
+            copyAdvertisedName(advertisedDevice, s_deviceName, sizeof(s_deviceName));
             doConnect = true;
             if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
                 if (g_debugSettings.bleActivityStreamOn) {
@@ -314,7 +382,7 @@ class AdvertisedDeviceCallbacks : public NimBLEAdvertisedDeviceCallbacks {
                 xSemaphoreGive(g_debugSettingsMutex);
             }
 
-            if (xSemaphoreTake(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            if (TRACE_MUTEX_TAKE(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
                 g_powerCadenceData.bleState = BLE_CONNECTING;
                 // Optionally, attempt to set name here if it's usually available and useful
                 // For example:
@@ -325,12 +393,59 @@ class AdvertisedDeviceCallbacks : public NimBLEAdvertisedDeviceCallbacks {
                 //    memset(g_powerCadenceData.connectedDeviceName, 0, sizeof(g_powerCadenceData.connectedDeviceName)); // Clear if no name
                 // }
                 g_powerCadenceData.newData = true;
-                xSemaphoreGive(g_dataMutex);
+                TRACE_MUTEX_GIVE(g_dataMutex);
+                displayNotifyDataChanged();
             }
         }
     }
 };
 
+// Callback objects live for the whole run rather than being allocated per client or scan
+static ClientCallbacks s_clientCallbacks;
+static AdvertisedDeviceCallbacks s_advertisedDeviceCallbacks;
+
+// Cycling Power Feature read straight through the GATT client: NimBLERemoteCharacteristic::
+// readValue() (and readValue<T>(), which wraps it) builds a heap-backed value on every call.
+struct FeatureRead {
+    int status;
+    uint16_t length;
+    uint32_t value;
+};
+static FeatureRead s_featureRead;
+static StaticSemaphore_t s_featureReadDoneBuffer;
+static SemaphoreHandle_t s_featureReadDone = NULL;
+
+static int onFeatureRead(uint16_t connHandle, const struct ble_gatt_error* error, struct ble_gatt_attr* attr, void* arg) {
+    FeatureRead* read = (FeatureRead*)arg;
+    read->status = error->status;
+    if (error->status == 0 && attr != nullptr) {
+        uint8_t bytes[4] = {0};
+        read->length = OS_MBUF_PKTLEN(attr->om);
+        os_mbuf_copydata(attr->om, 0, read->length < sizeof(bytes) ? read->length : sizeof(bytes), bytes);
+        read->value = (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+    }
+    xSemaphoreGive(s_featureReadDone);
+    return 0;
+}
+
+// True with the little-endian feature bitmask if the peer returned at least four bytes
+static bool readFeatureBitmask(BLERemoteCharacteristic* pFeatureChar, uint32_t* bitmask) {
+    s_featureRead.status = -1;
+    s_featureRead.length = 0;
+    xSemaphoreTake(s_featureReadDone, 0); // Drop a completion left over from a timed-out read
+    if (ble_gattc_read(pClient->getConnId(), pFeatureChar->getHandle(), onFeatureRead, &s_featureRead) != 0) {
+        return false;
+    }
+    if (xSemaphoreTake(s_featureReadDone, pdMS_TO_TICKS(BLE_FEATURE_READ_TIMEOUT_MS)) != pdTRUE) {
+        return false;
+    }
+    if (s_featureRead.status != 0 || s_featureRead.length < 4) {
+        return false;
+    }
+    *bitmask = s_featureRead.value;
+    return true;
+}
+
 // Function to connect to the server
 bool connectToServer() {
     if (myDevice == nullptr) {
@@ -338,14 +453,15 @@ bool connectToServer() {
         return false;
     }
 
-    // If pClient is null, create a new client. If it exists, ensure it's disconnected before trying to connect.
+    // The client is created once and reused: NimBLE keeps every client it creates until
+    // deleteClient(), and each one is a heap object.
     if (pClient == nullptr) {
         pClient = NimBLEDevice::createClient();
         if (!pClient) {
             Serial.println("Failed to create NimBLE client."); // Critical Error
             return false;
         }
-        pClient->setClientCallbacks(new ClientCallbacks(), false); // false to not delete callbacks on disconnect
+        pClient->setClientCallbacks(&s_clientCallbacks, false); // Static instance, never deleted
         Serial.println("BLE Client created."); // One-time status
     } else {
         if (pClient->isConnected() && pClient->getPeerAddress().equals(myDevice->getAddress())) {
@@ -357,15 +473,14 @@ bool connectToServer() {
             }
             return true; // Already connected
         }
-        // If client exists but is for a different device or disconnected, it should be cleaned up.
-        // The onDisconnect callback sets pClient to nullptr.
-        // Or if connection fails, it's deleted.
+        // A disconnected client connects again below; connect() drops the old peer's services.
     }
 
     if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
         if (g_debugSettings.bleActivityStreamOn) {
-            Serial.print("Attempting to connect to device: ");
-            Serial.println(myDevice->getAddress().toString().c_str());
+            char address[BLE_ADDRESS_STRING_LEN];
+            formatAddress(myDevice->getAddress(), address, sizeof(address));
+            Serial.printf("Attempting to connect to device: %s\n", address);
         }
         xSemaphoreGive(g_debugSettingsMutex);
     }
@@ -381,9 +496,7 @@ bool connectToServer() {
             }
             xSemaphoreGive(g_debugSettingsMutex);
         }
-        NimBLEDevice::deleteClient(pClient); // Delete client if connection failed
-        pClient = nullptr;
-        return false;
+        return false; // The client stays for the next attempt
     }
     if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
         if (g_debugSettings.bleActivityStreamOn) {
@@ -394,8 +507,9 @@ bool connectToServer() {
 
     BLERemoteService* pSvc = nullptr;
     s_deadSpotAnglesSupported = false; // Reset before checking features of newly connected device
+    s_cpFeatures = 0;
     try {
-        pSvc = pClient->getService(CYCLING_POWER_SERVICE_UUID);
+        pSvc = pClient->getService(s_cyclingPowerServiceUuid);
     } catch (const std::exception& e) { // NimBLE uses exceptions for some errors
         Serial.print("Exception while getting service: "); // Error
         Serial.println(e.what());
@@ -412,29 +526,25 @@ bool connectToServer() {
         // Attempt to read Cycling Power Feature characteristic (0x2A65)
         BLERemoteCharacteristic* pFeatureChar = nullptr;
         try {
-            pFeatureChar = pSvc->getCharacteristic(NimBLEUUID((uint16_t)0x2A65));
+            pFeatureChar = pSvc->getCharacteristic(s_cyclingPowerFeatureUuid);
         } catch (const std::exception& e) {
             Serial.print("Exception getting Feature characteristic: "); // Error
             Serial.println(e.what());
         }
 
         if (pFeatureChar && pFeatureChar->canRead()) {
-            std::string featuresValue = pFeatureChar->readValue();
-            if (featuresValue.length() >= 4) { // Feature is uint32_t
-                uint32_t featuresBitmask = 0;
-                // Assuming little-endian encoding for the characteristic value
-                featuresBitmask |= (uint32_t)featuresValue[0];
-                featuresBitmask |= (uint32_t)featuresValue[1] << 8;
-                featuresBitmask |= (uint32_t)featuresValue[2] << 16;
-                featuresBitmask |= (uint32_t)featuresValue[3] << 24;
+            uint32_t featuresBitmask = 0;
+            if (readFeatureBitmask(pFeatureChar, &featuresBitmask)) { // Feature is uint32_t
+                s_cpFeatures = featuresBitmask;
+                s_cpFeaturesCaptured = 0; // New meter: captured again before its next notification
                 if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
                     if (g_debugSettings.bleActivityStreamOn) {
                         Serial.printf("Cycling Power Features Bitmask: 0x%08X\n", featuresBitmask);
                     }
                     xSemaphoreGive(g_debugSettingsMutex);
                 }
-                // Check Bit 6 for "Top and Bottom Dead Spot Angles Supported"
-                if (featuresBitmask & (1 << 6)) {
+                // "Top and Bottom Dead Spot Angles Supported"
+                if (featuresBitmask & CP_FEATURE_DEAD_SPOT_ANGLES) {
                     s_deadSpotAnglesSupported = true;
                     if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
                         if (g_debugSettings.bleActivityStreamOn) {
@@ -452,9 +562,9 @@ bool connectToServer() {
                     }
                 }
                 // Update shared struct, useful for display task to know support without waiting for data
-                if (xSemaphoreTake(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+                if (TRACE_MUTEX_TAKE(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
                     g_powerCadenceData.dead_spot_angles_supported = s_deadSpotAnglesSupported;
-                    xSemaphoreGive(g_dataMutex);
+                    TRACE_MUTEX_GIVE(g_dataMutex);
                 }
 
             } else {
@@ -477,7 +587,7 @@ bool connectToServer() {
         }
 
         // Now get the measurement characteristic
-        pCyclingPowerMeasurementChar = pSvc->getCharacteristic(CYCLING_POWER_MEASUREMENT_UUID);
+        pCyclingPowerMeasurementChar = pSvc->getCharacteristic(s_cyclingPowerMeasurementUuid);
         if (!pCyclingPowerMeasurementChar) {
             if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
                 if (g_debugSettings.bleActivityStreamOn) {
@@ -540,17 +650,20 @@ bool connectToServer() {
 
 // BLE Manager Task
 void bleManagerTask(void *pvParameters) {
-    if (xSemaphoreTake(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+    if (TRACE_MUTEX_TAKE(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
         g_powerCadenceData.bleState = BLE_IDLE;
         memset(g_powerCadenceData.connectedDeviceName, 0, sizeof(g_powerCadenceData.connectedDeviceName));
         g_powerCadenceData.newData = true;
-        xSemaphoreGive(g_dataMutex);
+        TRACE_MUTEX_GIVE(g_dataMutex);
+        displayNotifyDataChanged();
     }
     Serial.println("BLE Manager Task started, initial state BLE_IDLE.");
+    initializePowerAnalytics(); // Before the first notification can arrive
     //vTaskDelay(pdMS_TO_TICKS(1000)); // Delay for system to stabilize if needed (already have one before this)
 
     NimBLEDevice::init("");
     Serial.println("NimBLE initialized.");
+    s_featureReadDone = xSemaphoreCreateBinaryStatic(&s_featureReadDoneBuffer);
 
     // Configure the scanner
     pBLEScan = NimBLEDevice::getScan();
@@ -559,7 +672,7 @@ void bleManagerTask(void *pvParameters) {
         vTaskDelete(NULL); // Cannot proceed
         return;
     }
-    pBLEScan->setAdvertisedDeviceCallbacks(new AdvertisedDeviceCallbacks(), true); // true to delete callbacks when scan ends
+    pBLEScan->setAdvertisedDeviceCallbacks(&s_advertisedDeviceCallbacks, false); // Static instance, never deleted
     pBLEScan->setActiveScan(true);  // Active scan uses more power but gets more info (like device name)
     pBLEScan->setInterval(100);     // Scan interval in ms
     pBLEScan->setWindow(99);        // Scan window in ms (must be <= interval)
@@ -570,6 +683,11 @@ void bleManagerTask(void *pvParameters) {
     Serial.println("BLE Scanner configured. Starting main loop."); // One-time status
 
     for (;;) {
+        TRACE_BEGIN(TRACE_BLE_LOOP);
+        if (s_meanMaxSavePending) { // The power meter went away: keep the ride's curve
+            s_meanMaxSavePending = false;
+            saveMeanMaxCurve();
+        }
         if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
             if (g_debugSettings.otherDebugStreamOn) {
                 Serial.println();
@@ -584,7 +702,12 @@ void bleManagerTask(void *pvParameters) {
                 }
                 xSemaphoreGive(g_debugSettingsMutex);
             }
-            if (connectToServer()) {
+            bool connectedNow;
+            {
+                PowerLockScope bleLock(POWER_LOCK_BLE); // Connection set-up and service discovery at full clock
+                connectedNow = connectToServer();
+            }
+            if (connectedNow) {
                 if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
                     if (g_debugSettings.bleActivityStreamOn) {
                         Serial.println("Connection successful. Monitoring connection.");
@@ -600,27 +723,25 @@ void bleManagerTask(void *pvParameters) {
                     }
                     xSemaphoreGive(g_debugSettingsMutex);
                 }
-                if (xSemaphoreTake(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+                if (TRACE_MUTEX_TAKE(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
                     g_powerCadenceData.bleState = BLE_DISCONNECTED;
                     g_powerCadenceData.newData = true;
-                    xSemaphoreGive(g_dataMutex);
-                }
-                // Ensure pClient is cleaned up if connectToServer failed partway
-                if (pClient != nullptr && !pClient->isConnected()) { // Check isConnected before deleting
-                     NimBLEDevice::deleteClient(pClient); // This should trigger onDisconnect if connected
+                    TRACE_MUTEX_GIVE(g_dataMutex);
+                    displayNotifyDataChanged();
                 }
-                pClient = nullptr; // Ensure pClient is null after deletion or if it was not connected
+                // connectToServer() disconnects if set-up failed partway; the client itself is reused
                 myDevice = nullptr;
                 doConnect = false;
                 connected = false;
             }
         } else if (!connected) {
             if (pBLEScan->isScanning() == false) {
-                if (xSemaphoreTake(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+                if (TRACE_MUTEX_TAKE(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
                     g_powerCadenceData.bleState = BLE_SCANNING;
                     memset(g_powerCadenceData.connectedDeviceName, 0, sizeof(g_powerCadenceData.connectedDeviceName));
                     g_powerCadenceData.newData = true;
-                    xSemaphoreGive(g_dataMutex);
+                    TRACE_MUTEX_GIVE(g_dataMutex);
+                    displayNotifyDataChanged();
                 }
 
                 if (!doConnect) {
@@ -633,11 +754,12 @@ void bleManagerTask(void *pvParameters) {
                         xSemaphoreGive(g_debugSettingsMutex);
                     }
 
-                    if (xSemaphoreTake(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+                    if (TRACE_MUTEX_TAKE(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
                         g_powerCadenceData.bleState = BLE_SCANNING;
                         memset(g_powerCadenceData.connectedDeviceName, 0, sizeof(g_powerCadenceData.connectedDeviceName));
                         g_powerCadenceData.newData = true;
-                        xSemaphoreGive(g_dataMutex);
+                        TRACE_MUTEX_GIVE(g_dataMutex);
+                        displayNotifyDataChanged();
                     }
 
                     if (pBLEScan->start(5, nullptr, false) == 0) {
@@ -656,10 +778,11 @@ void bleManagerTask(void *pvParameters) {
                             }
                             xSemaphoreGive(g_debugSettingsMutex);
                          }
-                         if (xSemaphoreTake(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+                         if (TRACE_MUTEX_TAKE(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
                             g_powerCadenceData.bleState = BLE_IDLE;
                             g_powerCadenceData.newData = true;
-                            xSemaphoreGive(g_dataMutex);
+                            TRACE_MUTEX_GIVE(g_dataMutex);
+                            displayNotifyDataChanged();
                          }
                     }
                 }
@@ -681,16 +804,18 @@ void bleManagerTask(void *pvParameters) {
                 }
                 xSemaphoreGive(g_debugSettingsMutex);
              }
-             if (xSemaphoreTake(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+             if (TRACE_MUTEX_TAKE(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
                 if (g_powerCadenceData.bleState != BLE_CONNECTED) { // Update if state was changed elsewhere
                     g_powerCadenceData.bleState = BLE_CONNECTED;
                     g_powerCadenceData.newData = true;
+                    displayNotifyDataChanged();
                 }
                 // Refresh device name if it can change or was not set at connection
                 // This is already handled in onConnect, so might be redundant unless name can change post-connection
-                xSemaphoreGive(g_dataMutex);
+                TRACE_MUTEX_GIVE(g_dataMutex);
              }
         }
+        TRACE_END(TRACE_BLE_LOOP);
         vTaskDelay(pdMS_TO_TICKS(1000)); // Reduced delay for faster state updates if needed
     }
 }
@@ -0,0 +1,143 @@
+#include "DataAcquisitionTask.h"
+#include "config.h"
+#include "DataBuffer.h"     // To write to PSRAM buffer
+#include "BleManagerTask.h" // To get power and cadence data
+#include <HardwareSerial.h> // For GPS
+#include "ImuTask.h"        // For imuReadSamples, imuGetAttitude
+#include "AnalogCaptureTask.h" // For analogGetLatest
+#include "telemetry_stream.h"  // Full records to the live stream
+#include "trace.h"             // Stall tracing
+#include "gps_handler.h"       // For gpsGetElevation
+#include "log_backpressure.h"  // Overflow policy while the SD card stalls
+#include "event_log.h"         // Backpressure level changes
+#include "mem_placement.h"     // Staging ring in internal RAM
+#include "record_assembler.h"  // Record building and storing (shared with the host replay)
+#include "gps_data.h"          // Latest fix
+
+// Sensor library includes will go here
+// e.g. #include <TinyGPS++.h>
+// e.g. #include <Adafruit_MPU6050.h>
+
+// Global or static variables for sensor objects and data
+// TinyGPSPlus gps;
+// HardwareSerial gpsSerial(1); // UART1 for GPS
+
+// IMU samples drained per acquisition tick; sized for one tick at the highest ODR with margin
+#define IMU_SAMPLES_PER_TICK_MAX 32
+static ImuSample imuBatch[IMU_SAMPLES_PER_TICK_MAX];
+
+// First tier: records land here (internal RAM, no cache misses on the 200 Hz path) and are copied
+// to the PSRAM ring in batches. Only this task touches it.
+MEM_HOT static LogRecordV1 s_staging[LOG_STAGING_RECORDS];
+MEM_PLACED(s_staging, MEM_REGION_INTERNAL);
+static RecordAssembler s_assembler(s_staging, LOG_STAGING_RECORDS, LOG_STAGING_SPILL_RECORDS);
+
+extern DataBuffer<LogRecordV1> psramDataBuffer; // Defined and initialized in main.cpp; the SD logging task drains it
+
+static size_t ringWrite(void* context, const LogRecordV1* records, size_t count) {
+    return psramDataBuffer.writeBatch(records, count);
+}
+
+static size_t ringCount(void* context) {
+    return psramDataBuffer.getCount();
+}
+
+static void postBackpressureEvent(void* context, const LogBackpressureTransition& transition, size_t stagingCount) {
+    const LogBackpressureStats& stats = s_assembler.backpressure().stats();
+    BackpressureEvent event;
+    event.from_level = transition.from;
+    event.to_level = transition.to;
+    event.ring_fill_percent = transition.ring_fill_percent;
+    event.staging_count = (uint8_t)stagingCount;
+    event.in_previous_ms = transition.in_previous_ms;
+    event.produced = stats.produced;
+    event.skipped = transition.skipped;
+    event.dropped = transition.dropped;
+    event.ring_peak = transition.ring_peak;
+    eventLogPost(EVENT_BACKPRESSURE, &event, sizeof(event));
+    Serial.printf("Log rate %s -> %s (ring %u%%, %lu dropped)\n", logRateLevelName(transition.from),
+                  logRateLevelName(transition.to), transition.ring_fill_percent, (unsigned long)transition.dropped);
+}
+
+// Latest state of every input, gathered without waiting on any producer
+static void readInputs(RecordInputs* inputs) {
+    inputs->gps_fix = false;
+    inputs->satellites = 0;
+    if (TRACE_MUTEX_TAKE(g_gpsDataMutex, 0) == pdTRUE) {
+        inputs->gps_fix = g_gpsData.is_valid;
+        inputs->latitude_deg = g_gpsData.latitude;
+        inputs->longitude_deg = g_gpsData.longitude;
+        inputs->altitude_m = g_gpsData.altitude_meters;
+        inputs->speed_mps = g_gpsData.speed_mps;
+        inputs->satellites = (uint8_t)g_gpsData.satellites;
+        TRACE_MUTEX_GIVE(g_gpsDataMutex);
+    }
+    gpsGetElevation(&inputs->elevation);
+
+    ImuAttitude attitude;
+    imuGetAttitude(&attitude);
+    inputs->attitude_valid = attitude.valid;
+    inputs->roll_deg = attitude.roll_deg;
+    inputs->pitch_deg = attitude.pitch_deg;
+
+    inputs->power_watts = 0;
+    inputs->cadence_rpm = 0;
+    if (TRACE_MUTEX_TAKE(g_dataMutex, 0) == pdTRUE) {
+        inputs->power_watts = g_powerCadenceData.power;
+        inputs->cadence_rpm = g_powerCadenceData.cadence;
+        TRACE_MUTEX_GIVE(g_dataMutex);
+    }
+
+    analogGetLatest(inputs->analog); // Latest decimated value; NAN for unused channels
+}
+
+void dataAcquisitionTask(void *pvParameters) {
+    Serial.println("Data Acquisition Task started");
+
+    // Initialize sensors
+    // initializeGPS(); // Placeholder
+    // The IMU is initialized and serviced by imuTask; this task only consumes its samples.
+
+    TickType_t xLastWakeTime;
+    const TickType_t xFrequency = pdMS_TO_TICKS(DATA_ACQUISITION_INTERVAL_MS); // Should be 5ms for 200Hz
+    xLastWakeTime = xTaskGetTickCount();
+
+    const LogBackpressureConfig backpressureConfig = {
+        LOG_BP_DECIMATE_PERCENT, LOG_BP_MINIMAL_PERCENT, LOG_BP_RECOVER_PERCENT,
+        LOG_BP_DECIMATED_EVERY, LOG_BP_MINIMAL_EVERY,
+    };
+    const RecordRing ring = { ringWrite, ringCount, psramDataBuffer.getCapacity(), nullptr };
+    if (!s_assembler.begin(backpressureConfig, ring, postBackpressureEvent, nullptr)) {
+        Serial.println("Backpressure marks in config.h are inconsistent; logging at full rate only.");
+    }
+    RecordInputs inputs;
+
+    for (;;) {
+        vTaskDelayUntil(&xLastWakeTime, xFrequency); // Precise 200Hz loop
+        TRACE_SCOPE(TRACE_ACQ_RECORD);
+
+        // IMU: the FIFO samples published since the last tick feed the averaging window
+        size_t imuCount = imuReadSamples(imuBatch, IMU_SAMPLES_PER_TICK_MAX);
+        s_assembler.addImuSamples(imuBatch, imuCount);
+
+        uint32_t now = millis();
+        readInputs(&inputs);
+        const LogRecordV1& record = s_assembler.assemble(now, inputs);
+
+        // Live stream gets every record (dropped whole if the USB link falls behind)
+        uint8_t wireRecord[LOG_RECORD_V1_SIZE];
+        logRecordV1Pack(record, wireRecord);
+        telemetryPublish(TELEM_LOG_RECORD, wireRecord, sizeof(wireRecord));
+
+        // Staging ring -> PSRAM ring under the overflow policy (record_assembler.h)
+        s_assembler.store(now);
+    }
+}
+
+// Ensure these sensor init functions are appropriately defined or commented out
+bool initializeGPS() {
+    // gpsSerial.begin(9600, SERIAL_8N1, GPS_RX_PIN, GPS_TX_PIN);
+    // Serial.println("GPS UART Initialized (Placeholder).");
+    return false; // Placeholder
+}
+
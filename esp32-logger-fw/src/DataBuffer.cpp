@@ -1,4 +1,5 @@
 #include "DataBuffer.h"
+#include "mem_placement.h"
 
 // Explicit template instantiation for LogRecordV1 if needed by the build system,
 // or keep implementation in header for templates. For simplicity with PlatformIO,
@@ -12,14 +13,8 @@ DataBuffer<T>::DataBuffer(size_t size) : buffer(nullptr), capacity(size), head(0
 
 template <typename T>
 DataBuffer<T>::~DataBuffer() {
-    if (buffer) {
-        // In ESP32, PSRAM allocated with ps_malloc should be freed with free()
-        // if (psramFound()) {
-             free(buffer);
-        // } else {
-        //    delete[] buffer; // Should not happen if psram allocation was conditional
-        // }
-    }
+    // The buffer comes from the PSRAM arena (memArenaAlloc) and is never freed
+    buffer = nullptr;
     // if (xMutex) {
     //     vSemaphoreDelete(xMutex);
     // }
@@ -27,21 +22,10 @@ DataBuffer<T>::~DataBuffer() {
 
 template <typename T>
 bool DataBuffer<T>::initialize() {
-    #if CONFIG_SPIRAM_SUPPORT
-    if (psramFound()) {
-        buffer = (T*) ps_malloc(capacity * sizeof(T));
-        Serial.printf("PSRAM: Attempted to allocate %d bytes for buffer.\n", capacity * sizeof(T));
-    } else {
-        Serial.println("PSRAM not available, DataBuffer not allocating in PSRAM.");
-        // Fallback to heap if desired, or fail
-        // buffer = new T[capacity]; // Or handle error: return false;
-        return false; // Require PSRAM
+    if (buffer == nullptr) {
+        buffer = (T*)memArenaAlloc(MEM_REGION_PSRAM, capacity * sizeof(T), "record ring"); // Require PSRAM
+        Serial.printf("PSRAM: Attempted to allocate %u bytes for buffer.\n", (unsigned)(capacity * sizeof(T)));
     }
-    #else
-    Serial.println("PSRAM support not enabled in sdkconfig. DataBuffer cannot use PSRAM.");
-    // buffer = new T[capacity]; // Fallback to heap if desired
-    return false; // Require PSRAM
-    #endif
 
     if (!buffer) {
         Serial.println("Failed to allocate memory for DataBuffer.");
@@ -50,7 +34,7 @@ bool DataBuffer<T>::initialize() {
     head = 0;
     tail = 0;
     count = 0;
-    Serial.printf("DataBuffer initialized with capacity for %d records.\n", capacity);
+    Serial.printf("DataBuffer initialized with capacity for %u records.\n", (unsigned)capacity);
     return true;
 }
 
@@ -87,6 +71,41 @@ bool DataBuffer<T>::read(T& record) {
     // return false;
 }
 
+template <typename T>
+size_t DataBuffer<T>::writeBatch(const T* records, size_t n) {
+    if (buffer == nullptr) {
+        return 0;
+    }
+    size_t room = capacity - count; // Only the consumer changes count meanwhile, and only downwards
+    if (n > room) {
+        n = room;
+    }
+    size_t first = n < capacity - head ? n : capacity - head;
+    memcpy(&buffer[head], records, first * sizeof(T));
+    memcpy(&buffer[0], records + first, (n - first) * sizeof(T));
+    head = (head + n) % capacity;
+    portENTER_CRITICAL(&countMux);
+    count += n;
+    portEXIT_CRITICAL(&countMux);
+    return n;
+}
+
+template <typename T>
+size_t DataBuffer<T>::readBatch(T* out, size_t maxRecords) {
+    size_t n = count; // Only the producer changes count meanwhile, and only upwards
+    if (n > maxRecords) {
+        n = maxRecords;
+    }
+    size_t first = n < capacity - tail ? n : capacity - tail;
+    memcpy(out, &buffer[tail], first * sizeof(T));
+    memcpy(out + first, &buffer[0], (n - first) * sizeof(T));
+    tail = (tail + n) % capacity;
+    portENTER_CRITICAL(&countMux);
+    count -= n;
+    portEXIT_CRITICAL(&countMux);
+    return n;
+}
+
 template <typename T>
 bool DataBuffer<T>::peek(T& record) const {
     // if (xSemaphoreTake(xMutex, portMAX_DELAY) == pdTRUE) {
@@ -2,36 +2,72 @@
 #include "config.h" // Includes types.h (for BleConnectionState)
 #include "gps_data.h" // For GpsData struct and g_gpsDataMutex
 #include "shared_state.h" // Added for g_debugSettings
+#include "I2cBusManager.h" // For cached battery readings
+#include "gps_handler.h" // For the breadcrumb track and fused elevation
+#include "ImuTask.h" // For roll/pitch
+#include "trace.h" // Stall tracing
+#include "power_manager.h" // SPI clock lock while drawing
+#include "mem_placement.h" // Framebuffer placement
 
-#include "Adafruit_MAX1704X.h"
 #include <Adafruit_NeoPixel.h>
 #include "Adafruit_TestBed.h"
-#include <Adafruit_BME280.h>
 #include <Adafruit_ST7789.h> 
 #include <Fonts/FreeSans12pt7b.h>
 #include <cstdio>  // For snprintf
 #include <cstring> // For strcpy, strncpy
 
 
-Adafruit_BME280 bme; // I2C
-bool bmefound = false;
 extern Adafruit_TestBed TB;
 
-Adafruit_MAX17048 lipo;
 Adafruit_ST7789 display = Adafruit_ST7789(TFT_CS, TFT_DC, TFT_RST);
 
-GFXcanvas16 canvas(240, 135);
+// The canvas draws into a framebuffer placed by initializeDisplay() (DISPLAY_FRAMEBUFFER_REGION)
+// rather than one GFXcanvas16 mallocs during static initialization, which always lands in internal
+// RAM because PSRAM is not on the heap yet. Needs Adafruit GFX >= 1.11.4 (external-buffer canvas).
+class PlacedCanvas16 : public GFXcanvas16 {
+public:
+    PlacedCanvas16(uint16_t w, uint16_t h) : GFXcanvas16(w, h, false) {}
+    void setBuffer(uint16_t* framebuffer) { buffer = framebuffer; }
+};
 
-static bool valid_i2c[128]; // File-scope static for access by both functions
+#define DISPLAY_WIDTH 240
+#define DISPLAY_HEIGHT 135
+PlacedCanvas16 canvas(DISPLAY_WIDTH, DISPLAY_HEIGHT);
+
+// Permanent framebuffer: the configured region's arena, else that region's heap, else any heap
+static bool allocateFramebuffer() {
+    const size_t bytes = DISPLAY_WIDTH * DISPLAY_HEIGHT * sizeof(uint16_t);
+    uint16_t* framebuffer = (uint16_t*)memArenaAlloc(DISPLAY_FRAMEBUFFER_REGION, bytes, "display framebuffer");
+    if (framebuffer == nullptr) {
+        framebuffer = (uint16_t*)memRegionMalloc(DISPLAY_FRAMEBUFFER_REGION, bytes);
+        if (framebuffer == nullptr) {
+            framebuffer = (uint16_t*)malloc(bytes);
+        }
+        if (framebuffer == nullptr) {
+            return false;
+        }
+        memPlacementRegister("display framebuffer", framebuffer, bytes, DISPLAY_FRAMEBUFFER_REGION);
+    }
+    memset(framebuffer, 0, bytes);
+    canvas.setBuffer(framebuffer);
+    return true;
+}
 
 // Display mode definitions
 enum DisplayMode { 
     DISPLAY_POWER, 
+    DISPLAY_ATTITUDE,
     DISPLAY_GPS,
+    DISPLAY_CLIMB,
+    DISPLAY_POWER_ANALYTICS,
+    DISPLAY_MEAN_MAX,
+    DISPLAY_SEGMENTS,
+    DISPLAY_MAP,
     // Add new display modes above this line
     DISPLAY_MODE_COUNT // Represents the total number of display modes
 };
 static DisplayMode currentDisplayMode = DISPLAY_POWER;
+static const char* const displayModeNames[DISPLAY_MODE_COUNT] = { "POWER", "LEAN", "GPS", "CLIMB", "ANALYTICS", "BEST POWER", "LAPS", "MAP" };
 
 // Button definitions for screen switching
 const int SCREEN_UP_BUTTON_PIN = BUTTON_B_PIN;   // Use BUTTON_B_PIN for Screen Up
@@ -44,9 +80,172 @@ static bool screenDownButtonAlreadyProcessed = false;
 
 const unsigned long debounceDelay = 10; // milliseconds for button debounce
 
+// Refresh scheduling state
+static TaskHandle_t s_displayTaskHandle = NULL;
+static const uint32_t frameBudgetMs = 1000 / DISPLAY_MAX_FPS;
+static volatile uint32_t s_framesLastMinute = 0;
+static volatile bool s_displayIdle = false;
+
 
 bool initializeDisplay(); // Already in .h but good practice for .cpp internal structure
 
+// Battery figures come from the I2C bus manager's cache; the fuel gauge is never read from this task
+static void formatBatteryString(char* buffer, size_t size) {
+    I2cSensorCache cache;
+    i2cGetSensorCache(&cache);
+    if (cache.batt_valid) {
+        snprintf(buffer, size, "Batt: %.1fV %.0f%%", cache.batt_voltage, cache.batt_percent);
+    } else {
+        snprintf(buffer, size, "Batt: --");
+    }
+}
+
+// m:ss.s
+static void formatLapTime(char* buffer, size_t size, uint32_t ms) {
+    snprintf(buffer, size, "%lu:%02lu.%lu", (unsigned long)(ms / 60000), (unsigned long)((ms / 1000) % 60),
+             (unsigned long)((ms / 100) % 10));
+}
+
+// --- Map screen ---
+// The map is drawn incrementally: the canvas keeps the route drawn so far, new segments are drawn
+// onto both the canvas and the panel, and only the status strip is pushed each frame. A full redraw
+// happens on entering the screen, when the track was re-simplified, or when it leaves the view.
+#define MAP_STRIP_HEIGHT 12
+#define MAP_MARGIN_PX 4
+#define MAP_MIN_SPAN_DM 500   // Never zoom in closer than 50 m across
+#define MAP_CHUNK_POINTS 64
+
+static struct {
+    uint32_t generation;
+    uint32_t drawnCount;     // Track points already on the canvas
+    int32_t centerX, centerY;
+    int32_t scaleQ16;        // Pixels per decimetre, 16.16 fixed point
+} s_mapView;
+
+static void mapProject(const TrackPoint& p, int16_t* px, int16_t* py) {
+    const int32_t areaHeight = 135 - MAP_STRIP_HEIGHT;
+    *px = (int16_t)(120 + (((int64_t)(p.x - s_mapView.centerX) * s_mapView.scaleQ16) >> 16));
+    *py = (int16_t)(MAP_STRIP_HEIGHT + areaHeight / 2 - (((int64_t)(p.y - s_mapView.centerY) * s_mapView.scaleQ16) >> 16));
+}
+
+static bool mapInView(int16_t px, int16_t py) {
+    return px >= 0 && px < 240 && py >= MAP_STRIP_HEIGHT && py < 135;
+}
+
+// Fits the track bounds (plus 25% headroom so the view is not rebuilt on every new extreme)
+static void mapFitView(const GpsTrackInfo& info) {
+    int32_t spanX = info.max_x - info.min_x;
+    int32_t spanY = info.max_y - info.min_y;
+    spanX += spanX / 2;
+    spanY += spanY / 2;
+    if (spanX < MAP_MIN_SPAN_DM) spanX = MAP_MIN_SPAN_DM;
+    if (spanY < MAP_MIN_SPAN_DM) spanY = MAP_MIN_SPAN_DM;
+    int64_t scaleX = ((int64_t)(240 - 2 * MAP_MARGIN_PX) << 16) / spanX;
+    int64_t scaleY = ((int64_t)(135 - MAP_STRIP_HEIGHT - 2 * MAP_MARGIN_PX) << 16) / spanY;
+    s_mapView.scaleQ16 = (int32_t)(scaleX < scaleY ? scaleX : scaleY);
+    if (s_mapView.scaleQ16 < 1) s_mapView.scaleQ16 = 1;
+    s_mapView.centerX = info.min_x + (info.max_x - info.min_x) / 2;
+    s_mapView.centerY = info.min_y + (info.max_y - info.min_y) / 2;
+}
+
+static void mapDrawStrip(const GpsTrackInfo& info, float speedMps) {
+    canvas.fillRect(0, 0, 240, MAP_STRIP_HEIGHT, ST77XX_BLACK);
+    canvas.setFont(); // Built-in 6x8 font
+    canvas.setTextColor(ST77XX_CYAN);
+    canvas.setCursor(2, 2);
+    int32_t widthM = s_mapView.scaleQ16 > 0 ? (int32_t)(((int64_t)240 << 16) / s_mapView.scaleQ16 / 10) : 0;
+    canvas.printf("%.1f km/h  view %ld m  %lu pts", speedMps * 3.6f, (long)widthM, (unsigned long)info.count);
+}
+
+// Returns true if the whole canvas has to be pushed, false if the panel was already updated.
+static bool renderMapScreen(bool fullRedraw, float speedMps) {
+    TrackPoint points[MAP_CHUNK_POINTS];
+    GpsTrackInfo info;
+    uint32_t from = s_mapView.drawnCount > 0 ? s_mapView.drawnCount - 1 : 0; // Include the last drawn point
+    uint32_t got = gpsTrackRead(from, points, MAP_CHUNK_POINTS, &info);
+
+    if (!fullRedraw && (info.generation != s_mapView.generation || info.count < s_mapView.drawnCount)) {
+        fullRedraw = true;
+    }
+    if (!fullRedraw) {
+        // Incremental: only segments added since the last frame
+        for (uint32_t i = 1; i < got && !fullRedraw; i++) {
+            int16_t x0, y0, x1, y1;
+            mapProject(points[i - 1], &x0, &y0);
+            mapProject(points[i], &x1, &y1);
+            if (!mapInView(x1, y1)) {
+                fullRedraw = true; // Rider left the view: rescale
+                break;
+            }
+            canvas.drawLine(x0, y0, x1, y1, ST77XX_YELLOW);
+            display.drawLine(x0, y0, x1, y1, ST77XX_YELLOW);
+            s_mapView.drawnCount = from + i + 1;
+        }
+        if (!fullRedraw) {
+            mapDrawStrip(info, speedMps);
+            TRACE_SCOPE(TRACE_DISPLAY_PUSH);
+            display.drawRGBBitmap(0, 0, canvas.getBuffer(), 240, MAP_STRIP_HEIGHT); // Strip rows are contiguous
+            return false;
+        }
+    }
+
+    // Full redraw, in chunks so the stack stays small. If the track is rewritten meanwhile, the
+    // generation recorded here no longer matches and the next frame redraws again.
+    canvas.fillScreen(ST77XX_BLACK);
+    mapFitView(info);
+    s_mapView.generation = info.generation;
+    from = 0;
+    bool havePrevious = false;
+    int16_t prevX = 0, prevY = 0;
+    while ((got = gpsTrackRead(from, points, MAP_CHUNK_POINTS, &info)) > 0) {
+        for (uint32_t i = 0; i < got; i++) {
+            int16_t x, y;
+            mapProject(points[i], &x, &y);
+            if (havePrevious) {
+                canvas.drawLine(prevX, prevY, x, y, ST77XX_YELLOW);
+            }
+            prevX = x;
+            prevY = y;
+            havePrevious = true;
+        }
+        from += got;
+    }
+    s_mapView.drawnCount = from;
+    if (info.count == 0) {
+        canvas.setFont(&FreeSans12pt7b);
+        canvas.setTextColor(ST77XX_ORANGE);
+        canvas.setCursor(10, 70);
+        canvas.println("Waiting for fix...");
+    }
+    mapDrawStrip(info, speedMps);
+    return true;
+}
+
+void displayNotifyDataChanged() {
+    if (s_displayTaskHandle != NULL) {
+        xTaskNotifyGive(s_displayTaskHandle);
+    }
+}
+
+uint32_t displayGetFramesLastMinute() {
+    return s_framesLastMinute;
+}
+
+bool displayIsIdle() {
+    return s_displayIdle;
+}
+
+// Both edges wake the task: the press starts a mode switch, the release re-arms the debounce logic.
+static void IRAM_ATTR screenButtonIsr() {
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    if (s_displayTaskHandle != NULL) {
+        vTaskNotifyGiveFromISR(s_displayTaskHandle, &higherPriorityTaskWoken);
+    }
+    if (higherPriorityTaskWoken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
 
 
 // --- Main Display Task ---
@@ -76,8 +275,68 @@ void displayUpdateTask(void *pvParameters) {
 
   GpsData localGpsData; // Local copy of GPS data
 
+  unsigned long lastFrameMillis = 0;
+  unsigned long lastActivityMillis = millis();
+  unsigned long minuteStartMillis = millis();
+  uint32_t framesThisMinute = 0;
+  bool forceRedraw = true; // First frame, button presses and wake-ups from idle
+  DisplayMode lastRenderedMode = DISPLAY_MODE_COUNT; // Screens that draw incrementally redraw fully on entry
+
+  // Values seen on the previous wake-up, used to tell real activity from repeated notifications
+  uint16_t lastSeenPower = 0;
+  BleConnectionState lastSeenBleState = BLE_IDLE;
+  unsigned long lastSeenGpsUpdate = 0;
+  bool lastSeenGpsValid = false;
+
+  s_displayTaskHandle = xTaskGetCurrentTaskHandle();
+  attachInterrupt(digitalPinToInterrupt(SCREEN_UP_BUTTON_PIN), screenButtonIsr, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(SCREEN_DOWN_BUTTON_PIN), screenButtonIsr, CHANGE);
 
   for (;;) { // Infinite loop for the task
+    // --- Wait for a data change, a button edge or the refresh deadline ---
+    unsigned long refreshIntervalMs = s_displayIdle ? DISPLAY_IDLE_REFRESH_MS : DISPLAY_MIN_REFRESH_MS;
+    unsigned long sinceFrameMs = millis() - lastFrameMillis;
+    unsigned long waitMs = (sinceFrameMs >= refreshIntervalMs) ? 0 : refreshIntervalMs - sinceFrameMs;
+    bool notified = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs)) > 0;
+
+    // Coalesce bursts: anything arriving within one frame budget of the last frame is drawn together
+    sinceFrameMs = millis() - lastFrameMillis;
+    if (notified && sinceFrameMs < frameBudgetMs) {
+        vTaskDelay(pdMS_TO_TICKS(frameBudgetMs - sinceFrameMs));
+        ulTaskNotifyTake(pdTRUE, 0); // Fold notifications received meanwhile into this frame
+    }
+    unsigned long now = millis();
+    bool deadlineReached = (now - lastFrameMillis) >= refreshIntervalMs;
+    TRACE_SCOPE(TRACE_DISPLAY_FRAME);
+    PowerLockScope spiLock(POWER_LOCK_SPI); // Canvas pushes and the map's direct strokes
+
+    // --- Detect activity (consumes the newData flag set by the BLE callbacks) ---
+    bool dataChanged = false;
+    bool activity = false;
+    if (TRACE_MUTEX_TAKE(g_dataMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+        dataChanged = g_powerCadenceData.newData;
+        g_powerCadenceData.newData = false;
+        if (g_powerCadenceData.power > 0 || g_powerCadenceData.power != lastSeenPower ||
+            g_powerCadenceData.bleState != lastSeenBleState) {
+            activity = true;
+        }
+        lastSeenPower = g_powerCadenceData.power;
+        lastSeenBleState = g_powerCadenceData.bleState;
+        TRACE_MUTEX_GIVE(g_dataMutex);
+    }
+    if (TRACE_MUTEX_TAKE(g_gpsDataMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+        if (g_gpsData.last_update_millis != lastSeenGpsUpdate) {
+            dataChanged = true;
+            lastSeenGpsUpdate = g_gpsData.last_update_millis;
+        }
+        if (g_gpsData.is_valid != lastSeenGpsValid ||
+            (g_gpsData.is_valid && g_gpsData.speed_mps > DISPLAY_IDLE_SPEED_MPS)) {
+            activity = true;
+        }
+        lastSeenGpsValid = g_gpsData.is_valid;
+        TRACE_MUTEX_GIVE(g_gpsDataMutex);
+    }
+
     // --- Button Logic for Mode Switching ---
     if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
         if (g_debugSettings.otherDebugStreamOn) {
@@ -99,8 +358,9 @@ void displayUpdateTask(void *pvParameters) {
                 currentDisplayMode = (DisplayMode)(((int)currentDisplayMode + 1) % DISPLAY_MODE_COUNT);
                 lastScreenUpPressTime = millis(); 
                 Serial.print("Screen UP pressed. Display Mode Switched to: ");
-                Serial.println(currentDisplayMode == DISPLAY_POWER ? "POWER" : (currentDisplayMode == DISPLAY_GPS ? "GPS" : "OTHER")); // Extend as modes grow
+                Serial.println(displayModeNames[currentDisplayMode]);
                 screenUpButtonAlreadyProcessed = true; 
+                forceRedraw = true;
             }
         }
     } else {
@@ -114,8 +374,9 @@ void displayUpdateTask(void *pvParameters) {
                 currentDisplayMode = (DisplayMode)(((int)currentDisplayMode + DISPLAY_MODE_COUNT - 1) % DISPLAY_MODE_COUNT);
                 lastScreenDownPressTime = millis();
                 Serial.print("Screen DOWN pressed. Display Mode Switched to: ");
-                Serial.println(currentDisplayMode == DISPLAY_POWER ? "POWER" : (currentDisplayMode == DISPLAY_GPS ? "GPS" : "OTHER")); // Extend as modes grow
+                Serial.println(displayModeNames[currentDisplayMode]);
                 screenDownButtonAlreadyProcessed = true;
+                forceRedraw = true;
             }
         }
     } else {
@@ -123,7 +384,31 @@ void displayUpdateTask(void *pvParameters) {
     }
 
 
-    canvas.fillScreen(ST77XX_BLACK); // Clear canvas for current mode's content
+    // --- Idle handling: dim the backlight and drop to the idle refresh rate when nothing happens ---
+    if (activity || forceRedraw) {
+        lastActivityMillis = now;
+        if (s_displayIdle) {
+            s_displayIdle = false;
+            analogWrite(TFT_BACKLITE, DISPLAY_BACKLIGHT_ACTIVE);
+            forceRedraw = true;
+        }
+    } else if (!s_displayIdle && (now - lastActivityMillis) > DISPLAY_IDLE_TIMEOUT_MS) {
+        s_displayIdle = true;
+        analogWrite(TFT_BACKLITE, DISPLAY_BACKLIGHT_DIMMED);
+    }
+
+    // While idle, data notifications alone do not trigger a redraw
+    bool shouldRender = forceRedraw || deadlineReached || (dataChanged && !s_displayIdle);
+    if (!shouldRender) {
+        continue;
+    }
+    bool fullRedraw = forceRedraw || currentDisplayMode != lastRenderedMode;
+    forceRedraw = false;
+    bool pushFullCanvas = true;
+
+    if (currentDisplayMode != DISPLAY_MAP) { // The map screen keeps its canvas between frames
+        canvas.fillScreen(ST77XX_BLACK); // Clear canvas for current mode's content
+    }
     canvas.setFont(&FreeSans12pt7b);
     canvas.setTextWrap(false);
     // canvas.setCursor(10, 20); // Reset cursor for each mode's drawing - DO THIS INSIDE MODE BLOCK
@@ -131,7 +416,7 @@ void displayUpdateTask(void *pvParameters) {
     if (currentDisplayMode == DISPLAY_POWER) {
         canvas.setCursor(10, 20); // Set cursor for this mode
         // --- Read shared power data ---
-        if (xSemaphoreTake(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        if (TRACE_MUTEX_TAKE(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
             power = g_powerCadenceData.power;
             cadence = g_powerCadenceData.cadence;
             currentBleState = g_powerCadenceData.bleState;
@@ -140,7 +425,7 @@ void displayUpdateTask(void *pvParameters) {
 
             local_left_balance = g_powerCadenceData.left_pedal_balance_percent;
             local_balance_available = g_powerCadenceData.pedal_balance_available;
-            xSemaphoreGive(g_dataMutex);
+            TRACE_MUTEX_GIVE(g_dataMutex);
         } else {
             Serial.println("Display task (POWER): Failed to get g_dataMutex");
             strcpy(statusString, "Status: Mutex Error");
@@ -196,15 +481,15 @@ void displayUpdateTask(void *pvParameters) {
         // Display Battery Info for Power Mode
         canvas.setCursor(10, 120);
         canvas.setTextColor(ST77XX_YELLOW);
-        snprintf(battString, sizeof(battString), "Batt: %.1fV %.0f%%", lipo.cellVoltage(), lipo.cellPercent());
+        formatBatteryString(battString, sizeof(battString));
         canvas.println(battString);
 
     } else if (currentDisplayMode == DISPLAY_GPS) {
         canvas.setCursor(10, 20); // Set cursor for this mode
         // --- Read shared GPS data ---
-        if (xSemaphoreTake(g_gpsDataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        if (TRACE_MUTEX_TAKE(g_gpsDataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
             localGpsData = g_gpsData; // Copy the global struct
-            xSemaphoreGive(g_gpsDataMutex);
+            TRACE_MUTEX_GIVE(g_gpsDataMutex);
         } else {
             Serial.println("Display task (GPS): Failed to get g_gpsDataMutex");
             localGpsData.is_valid = false; // Mark as invalid if mutex fails
@@ -225,7 +510,7 @@ void displayUpdateTask(void *pvParameters) {
             // Display Battery Info for GPS Acquiring Mode
             canvas.setCursor(10, 70); // Line 3
             canvas.setTextColor(ST77XX_YELLOW);
-            snprintf(battString, sizeof(battString), "Batt: %.1fV %.0f%%", lipo.cellVoltage(), lipo.cellPercent());
+            formatBatteryString(battString, sizeof(battString));
             // Check if it fits; approx 16px font height
             if (canvas.getCursorY() < (135 - 16)) {
                 canvas.println(battString);
@@ -256,11 +541,242 @@ void displayUpdateTask(void *pvParameters) {
             // No space for battery info in GPS valid mode with 5 lines of GPS data and current font.
             // It would overwrite or exceed screen bounds.
         }
-    }
+    } else if (currentDisplayMode == DISPLAY_ATTITUDE) {
+        canvas.setCursor(10, 20);
+        static float peakLeftDeg = 0.0f, peakRightDeg = 0.0f; // Since boot
+        ImuAttitude attitude;
+        imuGetAttitude(&attitude);
+        uint16_t watts = 0;
+        if (TRACE_MUTEX_TAKE(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            watts = g_powerCadenceData.power;
+            TRACE_MUTEX_GIVE(g_dataMutex);
+        } else {
+            Serial.println("Display task (LEAN): Failed to get g_dataMutex");
+        }
+
+        char lineBuffer[50];
+        if (attitude.valid) {
+            if (attitude.roll_deg > peakRightDeg) peakRightDeg = attitude.roll_deg;
+            if (-attitude.roll_deg > peakLeftDeg) peakLeftDeg = -attitude.roll_deg;
+            canvas.setTextColor(ST77XX_GREEN);
+            snprintf(lineBuffer, sizeof(lineBuffer), "Lean: %.0f %s", fabsf(attitude.roll_deg),
+                     attitude.roll_deg >= 0.0f ? "R" : "L");
+            canvas.println(lineBuffer);
+            canvas.setCursor(10, 45);
+            canvas.setTextColor(ST77XX_WHITE);
+            snprintf(lineBuffer, sizeof(lineBuffer), "Pitch: %.1f", attitude.pitch_deg);
+            canvas.println(lineBuffer);
+        } else {
+            canvas.setTextColor(ST77XX_ORANGE);
+            canvas.println("IMU: No data");
+        }
+
+        canvas.setCursor(10, 70);
+        canvas.setTextColor(ST77XX_WHITE);
+        snprintf(lineBuffer, sizeof(lineBuffer), "Peak L/R: %.0f / %.0f", peakLeftDeg, peakRightDeg);
+        canvas.println(lineBuffer);
+
+        canvas.setCursor(10, 95);
+        canvas.setTextColor(ST77XX_GREEN);
+        canvas.print("Power: ");
+        canvas.setTextColor(ST77XX_WHITE);
+        canvas.print(watts);
+        canvas.println(" W");
+
+        canvas.setCursor(10, 120);
+        canvas.setTextColor(ST77XX_YELLOW);
+        formatBatteryString(battString, sizeof(battString));
+        canvas.println(battString);
+    } else if (currentDisplayMode == DISPLAY_CLIMB) {
+        canvas.setCursor(10, 20);
+        ElevationEstimate elevation;
+        gpsGetElevation(&elevation);
+        char lineBuffer[50];
+        if (elevation.valid) {
+            canvas.setTextColor(ST77XX_GREEN);
+            snprintf(lineBuffer, sizeof(lineBuffer), "Elev: %.0f m", elevation.elevation_m);
+            canvas.println(lineBuffer);
+
+            canvas.setCursor(10, 45);
+            canvas.setTextColor(ST77XX_WHITE);
+            snprintf(lineBuffer, sizeof(lineBuffer), "Grade: %.1f%%", elevation.gradient_percent);
+            canvas.println(lineBuffer);
+
+            canvas.setCursor(10, 70);
+            snprintf(lineBuffer, sizeof(lineBuffer), "VAM: %.0f m/h", elevation.vertical_speed_mps * 3600.0f);
+            canvas.println(lineBuffer);
+
+            canvas.setCursor(10, 95);
+            snprintf(lineBuffer, sizeof(lineBuffer), "Ascent: %.0f m", elevation.ascent_m);
+            canvas.println(lineBuffer);
+        } else {
+            canvas.setTextColor(ST77XX_ORANGE);
+            canvas.println("No baro/GPS altitude");
+        }
+
+        canvas.setCursor(10, 120);
+        canvas.setTextColor(ST77XX_YELLOW);
+        formatBatteryString(battString, sizeof(battString));
+        canvas.println(battString);
+    } else if (currentDisplayMode == DISPLAY_POWER_ANALYTICS) {
+        canvas.setCursor(10, 20);
+        PowerMetrics metrics;
+        if (TRACE_MUTEX_TAKE(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            metrics = g_powerCadenceData.metrics;
+            TRACE_MUTEX_GIVE(g_dataMutex);
+        } else {
+            Serial.println("Display task (ANALYTICS): Failed to get g_dataMutex");
+        }
+
+        char lineBuffer[50];
+        canvas.setTextColor(ST77XX_GREEN);
+        snprintf(lineBuffer, sizeof(lineBuffer), "3s %.0f  10s %.0f W", metrics.avg3s_watts, metrics.avg10s_watts);
+        canvas.println(lineBuffer);
+
+        canvas.setCursor(10, 45);
+        snprintf(lineBuffer, sizeof(lineBuffer), "30s %.0f  Avg %.0f W", metrics.avg30s_watts, metrics.avg_watts);
+        canvas.println(lineBuffer);
+
+        canvas.setCursor(10, 70);
+        canvas.setTextColor(ST77XX_WHITE);
+        if (metrics.elapsed_s >= 30) {
+            snprintf(lineBuffer, sizeof(lineBuffer), "NP %.0f  IF %.2f", metrics.normalized_power, metrics.intensity_factor);
+        } else {
+            snprintf(lineBuffer, sizeof(lineBuffer), "NP --  IF --"); // Needs one full 30 s window
+        }
+        canvas.println(lineBuffer);
+
+        canvas.setCursor(10, 95);
+        snprintf(lineBuffer, sizeof(lineBuffer), "TSS %.0f  %.0f kJ", metrics.tss, metrics.work_kj);
+        canvas.println(lineBuffer);
+
+        canvas.setCursor(10, 120);
+        canvas.setTextColor(ST77XX_CYAN);
+        snprintf(lineBuffer, sizeof(lineBuffer), "Time %lu:%02lu:%02lu", (unsigned long)(metrics.elapsed_s / 3600),
+                 (unsigned long)((metrics.elapsed_s / 60) % 60), (unsigned long)(metrics.elapsed_s % 60));
+        canvas.println(lineBuffer);
+    } else if (currentDisplayMode == DISPLAY_MEAN_MAX) {
+        canvas.setCursor(10, 20);
+        MeanMaxPoint curve[MMP_MAX_DURATIONS];
+        uint8_t curveCount = 0;
+        uint32_t elapsed = 0;
+        if (TRACE_MUTEX_TAKE(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            curveCount = g_powerCadenceData.meanMaxCount;
+            memcpy(curve, g_powerCadenceData.meanMax, curveCount * sizeof(MeanMaxPoint));
+            elapsed = g_powerCadenceData.metrics.elapsed_s;
+            TRACE_MUTEX_GIVE(g_dataMutex);
+        } else {
+            Serial.println("Display task (BEST POWER): Failed to get g_dataMutex");
+        }
+
+        char lineBuffer[50];
+        canvas.setTextColor(ST77XX_CYAN);
+        canvas.println("Best power");
+        canvas.setTextColor(ST77XX_WHITE);
+        for (uint8_t i = 0; i < curveCount && i < 4; i++) { // Four rows fit under the title
+            canvas.setCursor(10, 45 + i * 25);
+            char label[8];
+            if (curve[i].duration_s < 60) {
+                snprintf(label, sizeof(label), "%us", curve[i].duration_s);
+            } else {
+                snprintf(label, sizeof(label), "%um", curve[i].duration_s / 60);
+            }
+            if (elapsed >= curve[i].duration_s) {
+                snprintf(lineBuffer, sizeof(lineBuffer), "%-4s %.0f W", label, curve[i].best_watts);
+            } else {
+                snprintf(lineBuffer, sizeof(lineBuffer), "%-4s --", label); // Session shorter than the window
+            }
+            canvas.println(lineBuffer);
+        }
+    } else if (currentDisplayMode == DISPLAY_MAP) {
+        float speedMps = 0.0f;
+        if (TRACE_MUTEX_TAKE(g_gpsDataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            speedMps = g_gpsData.is_valid ? g_gpsData.speed_mps : 0.0f;
+            TRACE_MUTEX_GIVE(g_gpsDataMutex);
+        }
+        pushFullCanvas = renderMapScreen(fullRedraw, speedMps);
+    } else if (currentDisplayMode == DISPLAY_SEGMENTS) {
+        canvas.setCursor(10, 20);
+        SegmentState segments;
+        if (TRACE_MUTEX_TAKE(g_gpsDataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            segments = g_segmentState;
+            TRACE_MUTEX_GIVE(g_gpsDataMutex);
+        } else {
+            Serial.println("Display task (LAPS): Failed to get g_gpsDataMutex");
+        }
+        const SegmentTimerStatus& timer = segments.timer;
+        char lineBuffer[50];
+        char timeA[16], timeB[16];
+
+        if (segments.gate_count == 0) {
+            canvas.setTextColor(ST77XX_ORANGE);
+            canvas.println("No gates loaded");
+            canvas.setCursor(10, 45);
+            canvas.println(GATES_FILE_PATH);
+        } else {
+            // Running times tick with the display's refresh deadline
+            canvas.setTextColor(ST77XX_GREEN);
+            if (timer.lap_running) {
+                formatLapTime(timeA, sizeof(timeA), millis() + segments.gps_clock_offset_ms - timer.lap_start_ms);
+                snprintf(lineBuffer, sizeof(lineBuffer), "Lap %lu  %s", (unsigned long)(timer.lap_count + 1), timeA);
+            } else {
+                snprintf(lineBuffer, sizeof(lineBuffer), "Lap --");
+            }
+            canvas.println(lineBuffer);
+
+            canvas.setCursor(10, 45);
+            canvas.setTextColor(ST77XX_WHITE);
+            if (timer.lap_count > 0) {
+                formatLapTime(timeA, sizeof(timeA), timer.last_lap_ms);
+                formatLapTime(timeB, sizeof(timeB), timer.best_lap_ms);
+                snprintf(lineBuffer, sizeof(lineBuffer), "Last %s B %s", timeA, timeB);
+                canvas.println(lineBuffer);
+            }
+
+            canvas.setCursor(10, 70);
+            canvas.setTextColor(ST77XX_GREEN);
+            if (timer.newest_segment_id >= 0) {
+                formatLapTime(timeA, sizeof(timeA), millis() + segments.gps_clock_offset_ms - timer.newest_segment_start_ms);
+                snprintf(lineBuffer, sizeof(lineBuffer), "Seg %ld  %s", (long)timer.newest_segment_id, timeA);
+                canvas.println(lineBuffer);
+            }
 
-    display.drawRGBBitmap(0, 0, canvas.getBuffer(), 240, 135);
+            canvas.setCursor(10, 95);
+            canvas.setTextColor(ST77XX_WHITE);
+            if (timer.last_segment_id >= 0) {
+                formatLapTime(timeA, sizeof(timeA), timer.last_segment_ms);
+                snprintf(lineBuffer, sizeof(lineBuffer), "Seg %ld done %s", (long)timer.last_segment_id, timeA);
+                canvas.println(lineBuffer);
+            }
 
-    vTaskDelay(pdMS_TO_TICKS(250)); // Update rate (e.g., 4 Hz)
+            canvas.setCursor(10, 120);
+            canvas.setTextColor(ST77XX_CYAN);
+            snprintf(lineBuffer, sizeof(lineBuffer), "Gates: %lu", (unsigned long)segments.gate_count);
+            canvas.println(lineBuffer);
+        }
+    }
+
+    if (pushFullCanvas) {
+        TRACE_SCOPE(TRACE_DISPLAY_PUSH);
+        display.drawRGBBitmap(0, 0, canvas.getBuffer(), 240, 135);
+    }
+    lastRenderedMode = currentDisplayMode;
+    lastFrameMillis = millis();
+    framesThisMinute++;
+
+    // --- Frame rate report ---
+    if (lastFrameMillis - minuteStartMillis >= 60000) {
+        s_framesLastMinute = framesThisMinute;
+        framesThisMinute = 0;
+        minuteStartMillis = lastFrameMillis;
+        if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
+            if (g_debugSettings.otherDebugStreamOn) {
+                Serial.printf("Display: %lu frames in the last minute (%s)\n",
+                              (unsigned long)s_framesLastMinute, s_displayIdle ? "idle" : "active");
+            }
+            xSemaphoreGive(g_debugSettingsMutex);
+        }
+    }
   }
 }
 
@@ -274,9 +790,9 @@ bool initializeDisplay() {
 
   // Initialize Mode Switch Buttons
   pinMode(SCREEN_UP_BUTTON_PIN, INPUT_PULLDOWN);
-  Serial.println("Screen UP button (GPIO" + String(SCREEN_UP_BUTTON_PIN) + ") initialized.");
+  Serial.printf("Screen UP button (GPIO%d) initialized.\n", SCREEN_UP_BUTTON_PIN);
   pinMode(SCREEN_DOWN_BUTTON_PIN, INPUT_PULLDOWN);
-  Serial.println("Screen DOWN button (GPIO" + String(SCREEN_DOWN_BUTTON_PIN) + ") initialized.");
+  Serial.printf("Screen DOWN button (GPIO%d) initialized.\n", SCREEN_DOWN_BUTTON_PIN);
 
   TB.neopixelPin = PIN_NEOPIXEL;
   TB.neopixelNum = 1;
@@ -286,54 +802,21 @@ bool initializeDisplay() {
 
   display.init(135, 240);           // Init ST7789 240x135 TFT
   display.setRotation(3);           // Rotate to landscape
+  if (!allocateFramebuffer()) {
+      Serial.println("No memory for the display framebuffer!");
+      return false;
+  }
   canvas.setFont(&FreeSans12pt7b);  // Set font for the canvas
   canvas.setTextColor(ST77XX_WHITE); // Default text color
   canvas.setTextWrap(false);        // Disable text wrap to control layout
 
-  // Initialize MAX17048 Lipo Fuel Gauge
-  if (!lipo.begin()) {
-    Serial.println(F("Could not find Adafruit MAX17048. Check wiring and ensure battery is connected."));
-    // Depending on requirements, may want to return false or set an error state
-    // For now, continue, but battery readings will be invalid.
-  } else {
-    Serial.print(F("Found MAX17048. Chip ID: 0x"));
-    Serial.println(lipo.getChipID(), HEX);
-  }
-    
-  // Initialize BME280 (optional, based on your hardware setup)
-  // Keeping the BME280 init code, but ensure it doesn't halt if not found.
-  if (TB.scanI2CBus(BME280_ADDRESS_ALTERNATE)) { // Check if BME280 is present at its typical address
-    unsigned status = bme.begin(BME280_ADDRESS_ALTERNATE);
-    if (!status) {
-      Serial.println("Could not find a valid BME280 sensor, check wiring, address, sensor ID!");
-      // Log details if needed, but don't halt
-    } else {
-      Serial.println("BME280 found and initialized.");
-      bmefound = true; // Assuming bmefound is a global/static variable
-    }
-  } else {
-    Serial.println("BME280 not found at default address during scan.");
-  }
+  // MAX17048 and BME280 are owned by the I2C bus manager (see initializeI2cBus())
 
   // Initialize Buttons (already done in original code, just ensure it's logical)
   pinMode(BUTTON_A_PIN, INPUT_PULLUP); // Assuming BUTTON_A_PIN is 0
   // Add other button pins if used
 
-  // Perform I2C scan (can be useful for debugging, but might not be needed in final version)
-  Serial.println("I2C Scan Results:");
-  for (uint8_t i = 0x01; i <= 0x7F; i++) {
-    if (TB.scanI2CBus(i, 0)) { // Scan without writing
-      Serial.print("Found I2C device at 0x");
-      if (i < 0x10) Serial.print("0");
-      Serial.print(i, HEX);
-      Serial.println();
-      valid_i2c[i] = true; // Assuming valid_i2c is a global/static array
-    } else {
-      valid_i2c[i] = false;
-    }
-  }
-  
-  digitalWrite(TFT_BACKLITE, HIGH); // Ensure backlight is on
+  analogWrite(TFT_BACKLITE, DISPLAY_BACKLIGHT_ACTIVE); // Ensure backlight is on (PWM so it can be dimmed when idle)
   TB.setColor(0x000000); // Turn off Neopixel after init
   Serial.println("Display Initialization Complete.");
   return true; // Successfully initialized display components
@@ -0,0 +1,277 @@
+#include "I2cBusManager.h"
+#include "config.h"
+#include "shared_state.h" // For g_debugSettings
+#include "trace.h"
+#include "power_manager.h"
+
+#include <Wire.h>
+#include "Adafruit_MAX1704X.h"
+#include <Adafruit_BME280.h>
+#include <esp_timer.h> // For esp_timer_get_time
+
+// Devices owned by the bus manager (previously set up by the display task)
+Adafruit_BME280 bme; // I2C
+bool bmefound = false;
+Adafruit_MAX17048 lipo;
+static bool lipofound = false;
+
+static bool valid_i2c[128]; // Result of the boot-time bus scan
+
+static TaskHandle_t s_managerTaskHandle = NULL;
+static QueueHandle_t s_queues[I2C_PRIORITY_COUNT] = {NULL};
+
+// Cache and statistics are shared with other tasks; copies are taken under a spinlock so reads stay O(1)
+static portMUX_TYPE s_cacheMux = portMUX_INITIALIZER_UNLOCKED;
+static I2cSensorCache s_cache;
+static portMUX_TYPE s_statsMux = portMUX_INITIALIZER_UNLOCKED;
+static I2cBusStats s_stats;
+static unsigned long s_statsWindowStart = 0;
+
+// --- Scheduled polls ---
+struct I2cPollEntry {
+    const char* name;
+    uint32_t periodMs;
+    unsigned long nextDueMillis;
+    bool (*poll)();
+};
+
+static bool pollFuelGauge() {
+    if (!lipofound) return false;
+    float voltage = lipo.cellVoltage();
+    float percent = lipo.cellPercent();
+    float chargeRate = lipo.chargeRate();
+    portENTER_CRITICAL(&s_cacheMux);
+    s_cache.batt_voltage = voltage;
+    s_cache.batt_percent = percent;
+    s_cache.batt_charge_rate = chargeRate;
+    s_cache.batt_valid = true;
+    s_cache.batt_update_millis = millis();
+    portEXIT_CRITICAL(&s_cacheMux);
+    return true;
+}
+
+static bool pollBme280() {
+    if (!bmefound) return false;
+    float temperature = bme.readTemperature(); // Must come first, it updates the compensation value
+    float pressure = bme.readPressure();
+    float humidity = bme.readHumidity();
+    portENTER_CRITICAL(&s_cacheMux);
+    s_cache.bme_temperature_c = temperature;
+    s_cache.bme_pressure_pa = pressure;
+    s_cache.bme_humidity_percent = humidity;
+    s_cache.bme_valid = true;
+    s_cache.bme_update_millis = millis();
+    portEXIT_CRITICAL(&s_cacheMux);
+    return true;
+}
+
+static I2cPollEntry s_polls[] = {
+    { "MAX17048", I2C_FUEL_GAUGE_POLL_MS, 0, pollFuelGauge },
+    { "BME280",   I2C_BME280_POLL_MS,     0, pollBme280 },
+};
+static const size_t s_pollCount = sizeof(s_polls) / sizeof(s_polls[0]);
+
+// --- Initialization ---
+bool initializeI2cBus() {
+    Wire.setBufferSize(I2C_BUS_BUFFER_SIZE); // Must precede begin(); IMU FIFO bursts exceed the 128 byte default
+    if (!Wire.begin()) {
+        Serial.println("I2C: Wire.begin() failed!");
+        return false;
+    }
+    Wire.setClock(I2C_BUS_CLOCK_HZ);
+
+    for (int i = 0; i < I2C_PRIORITY_COUNT; i++) {
+        s_queues[i] = xQueueCreate(I2C_QUEUE_DEPTH, sizeof(I2cTransaction*));
+        if (s_queues[i] == NULL) {
+            Serial.println("I2C: Failed to create transaction queue!");
+            return false;
+        }
+    }
+
+    // Initialize MAX17048 Lipo Fuel Gauge
+    if (!lipo.begin()) {
+        Serial.println(F("Could not find Adafruit MAX17048. Check wiring and ensure battery is connected."));
+        // Continue, battery readings will simply stay invalid in the cache.
+    } else {
+        lipofound = true;
+        Serial.print(F("Found MAX17048. Chip ID: 0x"));
+        Serial.println(lipo.getChipID(), HEX);
+    }
+
+    // Initialize BME280 (optional, based on your hardware setup)
+    Wire.beginTransmission(BME280_ADDRESS_ALTERNATE);
+    if (Wire.endTransmission() == 0) { // Check if BME280 is present at its typical address
+        unsigned status = bme.begin(BME280_ADDRESS_ALTERNATE, &Wire);
+        if (!status) {
+            Serial.println("Could not find a valid BME280 sensor, check wiring, address, sensor ID!");
+        } else {
+            Serial.println("BME280 found and initialized.");
+            bmefound = true;
+        }
+    } else {
+        Serial.println("BME280 not found at default address during scan.");
+    }
+
+    // Perform I2C scan (useful for debugging which devices share the bus)
+    Serial.println("I2C Scan Results:");
+    for (uint8_t i = 0x01; i <= 0x7F; i++) {
+        Wire.beginTransmission(i);
+        if (Wire.endTransmission() == 0) {
+            Serial.print("Found I2C device at 0x");
+            if (i < 0x10) Serial.print("0");
+            Serial.print(i, HEX);
+            Serial.println();
+            valid_i2c[i] = true;
+        } else {
+            valid_i2c[i] = false;
+        }
+    }
+
+    s_statsWindowStart = millis();
+    return true;
+}
+
+bool i2cTransactionInit(I2cTransaction& txn) {
+    if (txn.done == NULL) {
+        txn.done = xSemaphoreCreateBinary();
+    }
+    return txn.done != NULL;
+}
+
+// --- Transaction execution (manager task only) ---
+static bool executeTransaction(I2cTransaction* txn) {
+    Wire.beginTransmission(txn->address);
+    if (txn->txLen > 0) {
+        Wire.write(txn->txData, txn->txLen);
+    }
+    // Keep the bus (repeated start) when a read follows
+    if (Wire.endTransmission(txn->rxLen == 0) != 0) {
+        return false;
+    }
+    if (txn->rxLen == 0) {
+        return true;
+    }
+    size_t received = Wire.requestFrom(txn->address, txn->rxLen);
+    if (received != txn->rxLen) {
+        return false;
+    }
+    for (size_t i = 0; i < received; i++) {
+        txn->rxData[i] = (uint8_t)Wire.read();
+    }
+    return true;
+}
+
+static void recordBusTime(int64_t startUs, int64_t endUs, bool ok) {
+    portENTER_CRITICAL(&s_statsMux);
+    s_stats.busy_us += (uint32_t)(endUs - startUs);
+    if (!ok) s_stats.errors++;
+    portEXIT_CRITICAL(&s_statsMux);
+}
+
+// Serve the highest-priority queued transaction. Returns false when all queues are empty.
+static bool serveOneTransaction() {
+    for (int prio = 0; prio < I2C_PRIORITY_COUNT; prio++) {
+        I2cTransaction* txn = nullptr;
+        if (xQueueReceive(s_queues[prio], &txn, 0) == pdTRUE) {
+            int64_t startUs = esp_timer_get_time();
+            txn->success = executeTransaction(txn);
+            int64_t endUs = esp_timer_get_time();
+            recordBusTime(startUs, endUs, txn->success);
+
+            uint32_t latencyUs = (uint32_t)(endUs - txn->queuedAtUs);
+            portENTER_CRITICAL(&s_statsMux);
+            s_stats.transactions[prio]++;
+            s_stats.latency_sum_us[prio] += latencyUs;
+            if (latencyUs > s_stats.latency_max_us[prio]) s_stats.latency_max_us[prio] = latencyUs;
+            portEXIT_CRITICAL(&s_statsMux);
+
+            xSemaphoreGive(txn->done);
+            return true;
+        }
+    }
+    return false;
+}
+
+void i2cBusManagerTask(void *pvParameters) {
+    Serial.println("I2C Bus Manager Task started");
+    s_managerTaskHandle = xTaskGetCurrentTaskHandle();
+
+    unsigned long now = millis();
+    for (size_t i = 0; i < s_pollCount; i++) {
+        s_polls[i].nextDueMillis = now; // Fill the cache right away
+    }
+
+    for (;;) {
+        // Sleep until a transaction is submitted or the next poll is due
+        now = millis();
+        unsigned long waitMs = 1000;
+        for (size_t i = 0; i < s_pollCount; i++) {
+            long untilDue = (long)(s_polls[i].nextDueMillis - now);
+            if (untilDue <= 0) {
+                waitMs = 0;
+                break;
+            }
+            if ((unsigned long)untilDue < waitMs) waitMs = untilDue;
+        }
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs));
+        TRACE_SCOPE(TRACE_I2C_SERVICE);
+        PowerLockScope busLock(POWER_LOCK_I2C); // Waiting on a transfer must not end in light sleep
+
+        while (serveOneTransaction()) {
+        }
+
+        // Run due polls one at a time, serving queued (IMU) transactions in between
+        for (size_t i = 0; i < s_pollCount; i++) {
+            now = millis();
+            if ((long)(s_polls[i].nextDueMillis - now) > 0) continue;
+            s_polls[i].nextDueMillis = now + s_polls[i].periodMs;
+
+            int64_t startUs = esp_timer_get_time();
+            bool ok = s_polls[i].poll();
+            recordBusTime(startUs, esp_timer_get_time(), ok);
+            portENTER_CRITICAL(&s_statsMux);
+            s_stats.polls++;
+            portEXIT_CRITICAL(&s_statsMux);
+
+            while (serveOneTransaction()) {
+            }
+        }
+    }
+}
+
+// --- Public API for other tasks ---
+bool i2cBusTransfer(I2cTransaction& txn, I2cPriority priority, TickType_t timeout) {
+    if (s_managerTaskHandle == NULL || txn.done == NULL || priority >= I2C_PRIORITY_COUNT) {
+        return false;
+    }
+    I2cTransaction* ptr = &txn;
+    txn.success = false;
+    txn.queuedAtUs = esp_timer_get_time();
+    xSemaphoreTake(txn.done, 0); // Drop a stale completion left by an earlier timed-out transfer
+    if (xQueueSend(s_queues[priority], &ptr, timeout) != pdTRUE) {
+        return false;
+    }
+    xTaskNotifyGive(s_managerTaskHandle);
+    if (xSemaphoreTake(txn.done, timeout) != pdTRUE) {
+        return false;
+    }
+    return txn.success;
+}
+
+void i2cGetSensorCache(I2cSensorCache* out) {
+    portENTER_CRITICAL(&s_cacheMux);
+    *out = s_cache;
+    portEXIT_CRITICAL(&s_cacheMux);
+}
+
+void i2cGetBusStats(I2cBusStats* out, bool resetWindow) {
+    unsigned long now = millis();
+    portENTER_CRITICAL(&s_statsMux);
+    *out = s_stats;
+    out->window_ms = now - s_statsWindowStart;
+    if (resetWindow) {
+        s_stats = I2cBusStats();
+        s_statsWindowStart = now;
+    }
+    portEXIT_CRITICAL(&s_statsMux);
+}
@@ -0,0 +1,309 @@
+#include "ImuTask.h"
+#include "config.h"
+#include "I2cBusManager.h"
+#include "telemetry_stream.h"
+#include "trace.h"
+#include "attitude_filter.h"
+#include "gps_data.h" // Ground speed for centripetal compensation
+#include "mem_placement.h"
+#include "raw_capture.h" // FIFO bursts for raw capture
+
+#include <esp_cpu.h>   // For esp_cpu_get_ccount
+#include <esp_timer.h> // For esp_timer_get_time
+
+// LSM6DSO register map (subset)
+#define LSM6DSO_FIFO_CTRL1     0x07 // WTM[7:0]
+#define LSM6DSO_FIFO_CTRL2     0x08 // WTM8 in bit 0
+#define LSM6DSO_FIFO_CTRL3     0x09 // BDR_GY[7:4] | BDR_XL[3:0]
+#define LSM6DSO_FIFO_CTRL4     0x0A // FIFO_MODE[2:0]
+#define LSM6DSO_INT1_CTRL      0x0D
+#define LSM6DSO_WHO_AM_I       0x0F
+#define LSM6DSO_CTRL1_XL       0x10
+#define LSM6DSO_CTRL2_G        0x11
+#define LSM6DSO_CTRL3_C        0x12
+#define LSM6DSO_FIFO_STATUS1   0x3A
+#define LSM6DSO_FIFO_DATA_OUT  0x78 // TAG, then X/Y/Z; burst reads roll back to the TAG register
+
+#define LSM6DSO_WHO_AM_I_VALUE 0x6C
+#define LSM6DSO_FIFO_MODE_CONTINUOUS 0x06
+#define LSM6DSO_INT1_FIFO_TH   0x08
+#define LSM6DSO_CTRL3_BDU      0x40
+#define LSM6DSO_CTRL3_IF_INC   0x04
+#define LSM6DSO_CTRL3_SW_RESET 0x01
+#define LSM6DSO_FIFO_OVR_IA    0x40 // FIFO_STATUS2
+
+// ODR / batch-rate code shared by CTRL1_XL, CTRL2_G and FIFO_CTRL3
+#if IMU_ODR_HZ == 416
+#define LSM6DSO_ODR_CODE 0x6
+#elif IMU_ODR_HZ == 833
+#define LSM6DSO_ODR_CODE 0x7
+#elif IMU_ODR_HZ == 1666
+#define LSM6DSO_ODR_CODE 0x8
+#else
+#error "IMU_ODR_HZ must be 416, 833 or 1666"
+#endif
+
+#define LSM6DSO_FS_XL_8G    0x0C // CTRL1_XL FS_XL = 11
+#define LSM6DSO_FS_G_2000   0x0C // CTRL2_G FS_G = 110 (scales: ACCEL_MPS2_PER_LSB / GYRO_RADPS_PER_LSB in config.h)
+
+#define IMU_MAX_WORDS_PER_BURST (I2C_BUS_BUFFER_SIZE / IMU_FIFO_WORD_SIZE)
+
+static TaskHandle_t s_imuTaskHandle = NULL;
+static volatile int64_t s_lastIrqUs = 0;
+
+// Bus transaction reused for every access; buffers are static so they outlive any timed-out transfer
+static I2cTransaction s_txn;
+static uint8_t s_txBuffer[2];
+MEM_HOT static uint8_t s_rxBuffer[IMU_MAX_WORDS_PER_BURST * IMU_FIFO_WORD_SIZE];
+MEM_PLACED(s_rxBuffer, MEM_REGION_INTERNAL);
+
+static ImuFifoParser s_parser({ ACCEL_MPS2_PER_LSB, GYRO_RADPS_PER_LSB, IMU_SAMPLE_PERIOD_US });
+MEM_HOT static ImuSample s_parsed[IMU_MAX_WORDS_PER_BURST / 2 + 1];
+MEM_PLACED(s_parsed, MEM_REGION_INTERNAL);
+
+// Published samples: written by the IMU task, drained in bulk by the acquisition path
+MEM_HOT static ImuSample s_ring[IMU_SAMPLE_RING_SIZE];
+MEM_PLACED(s_ring, MEM_REGION_INTERNAL);
+static size_t s_ringHead = 0;
+static size_t s_ringCount = 0;
+static bool s_ringConsumed = false; // Set by the first imuReadSamples(); until then nothing is queued
+static portMUX_TYPE s_ringMux = portMUX_INITIALIZER_UNLOCKED;
+
+static ImuStats s_stats;
+
+// Attitude filter state: only the IMU task touches s_ahrs; s_attitude is published under s_ringMux
+static AttitudeFilter s_ahrs(AHRS_BETA);
+static ImuAttitude s_attitude;
+
+static bool writeRegister(uint8_t reg, uint8_t value) {
+    s_txBuffer[0] = reg;
+    s_txBuffer[1] = value;
+    s_txn.address = IMU_I2C_ADDRESS;
+    s_txn.txData = s_txBuffer;
+    s_txn.txLen = 2;
+    s_txn.rxData = nullptr;
+    s_txn.rxLen = 0;
+    return i2cBusTransfer(s_txn, I2C_PRIORITY_IMU, pdMS_TO_TICKS(50));
+}
+
+static bool readRegisters(uint8_t reg, uint8_t* out, size_t len) {
+    s_txBuffer[0] = reg;
+    s_txn.address = IMU_I2C_ADDRESS;
+    s_txn.txData = s_txBuffer;
+    s_txn.txLen = 1;
+    s_txn.rxData = out;
+    s_txn.rxLen = len;
+    return i2cBusTransfer(s_txn, I2C_PRIORITY_IMU, pdMS_TO_TICKS(50));
+}
+
+static void IRAM_ATTR imuInt1Isr() {
+    s_lastIrqUs = esp_timer_get_time();
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    if (s_imuTaskHandle != NULL) {
+        vTaskNotifyGiveFromISR(s_imuTaskHandle, &higherPriorityTaskWoken);
+    }
+    if (higherPriorityTaskWoken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+bool initializeIMU() {
+    if (!i2cTransactionInit(s_txn)) {
+        Serial.println("IMU: Failed to create I2C transaction semaphore.");
+        return false;
+    }
+
+    uint8_t whoAmI = 0;
+    if (!readRegisters(LSM6DSO_WHO_AM_I, &whoAmI, 1) || whoAmI != LSM6DSO_WHO_AM_I_VALUE) {
+        Serial.printf("IMU: LSM6DSO not found at 0x%02X (WHO_AM_I=0x%02X)\n", IMU_I2C_ADDRESS, whoAmI);
+        return false;
+    }
+
+    // Reset, then keep register auto-increment (needed for burst reads) and block data update
+    writeRegister(LSM6DSO_CTRL3_C, LSM6DSO_CTRL3_SW_RESET);
+    vTaskDelay(pdMS_TO_TICKS(10));
+
+    const uint16_t watermark = IMU_FIFO_WATERMARK_WORDS;
+    bool ok = writeRegister(LSM6DSO_CTRL3_C, LSM6DSO_CTRL3_BDU | LSM6DSO_CTRL3_IF_INC);
+    ok = ok && writeRegister(LSM6DSO_FIFO_CTRL1, watermark & 0xFF);
+    ok = ok && writeRegister(LSM6DSO_FIFO_CTRL2, (watermark >> 8) & 0x01);
+    ok = ok && writeRegister(LSM6DSO_FIFO_CTRL3, (LSM6DSO_ODR_CODE << 4) | LSM6DSO_ODR_CODE); // Batch gyro + accel
+    ok = ok && writeRegister(LSM6DSO_FIFO_CTRL4, LSM6DSO_FIFO_MODE_CONTINUOUS);
+    ok = ok && writeRegister(LSM6DSO_INT1_CTRL, LSM6DSO_INT1_FIFO_TH);
+    ok = ok && writeRegister(LSM6DSO_CTRL1_XL, (LSM6DSO_ODR_CODE << 4) | LSM6DSO_FS_XL_8G);
+    ok = ok && writeRegister(LSM6DSO_CTRL2_G, (LSM6DSO_ODR_CODE << 4) | LSM6DSO_FS_G_2000);
+    if (!ok) {
+        Serial.println("IMU: Failed to configure LSM6DSO FIFO.");
+        return false;
+    }
+
+    Serial.printf("IMU: LSM6DSO configured, ODR %d Hz, FIFO watermark %u words.\n", IMU_ODR_HZ, watermark);
+    return true;
+}
+
+static void updateAttitude(const ImuSample* samples, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    const float dt = IMU_SAMPLE_PERIOD_US * 1e-6f; // FIFO samples are paced by the sensor clock
+    uint32_t worstCycles = 0;
+    uint32_t start = esp_cpu_get_ccount();
+    for (size_t i = 0; i < count; i++) {
+        uint32_t before = esp_cpu_get_ccount();
+        s_ahrs.update(samples[i].gyro_radps, samples[i].accel_mps2, dt);
+        uint32_t cycles = esp_cpu_get_ccount() - before;
+        if (cycles > worstCycles) worstCycles = cycles;
+    }
+    uint32_t totalCycles = esp_cpu_get_ccount() - start;
+    float cyclesPerUs = (float)getCpuFrequencyMhz();
+    float roll = s_ahrs.rollDeg();
+    float pitch = s_ahrs.pitchDeg();
+
+    portENTER_CRITICAL(&s_ringMux);
+    s_stats.ahrs_update_us_avg = totalCycles / cyclesPerUs / count;
+    if (worstCycles / cyclesPerUs > s_stats.ahrs_update_us_max) {
+        s_stats.ahrs_update_us_max = worstCycles / cyclesPerUs;
+    }
+    s_attitude.valid = s_ahrs.initialized();
+    s_attitude.timestamp_us = samples[count - 1].timestamp_us;
+    s_attitude.roll_deg = roll;
+    s_attitude.pitch_deg = pitch;
+    portEXIT_CRITICAL(&s_ringMux);
+}
+
+static void publishSamples(const ImuSample* samples, size_t count) {
+    updateAttitude(samples, count);
+
+    portENTER_CRITICAL(&s_ringMux);
+    for (size_t i = 0; s_ringConsumed && i < count; i++) {
+        s_ring[s_ringHead] = samples[i];
+        s_ringHead = (s_ringHead + 1) % IMU_SAMPLE_RING_SIZE;
+        if (s_ringCount < IMU_SAMPLE_RING_SIZE) {
+            s_ringCount++;
+        } else {
+            s_stats.ring_dropped++; // Oldest sample overwritten
+        }
+    }
+    s_stats.samples += count;
+    portEXIT_CRITICAL(&s_ringMux);
+
+    if (telemetryEnabled()) {
+        uint8_t payload[1 + TELEMETRY_IMU_BATCH_MAX * sizeof(TelemetryImuSample)];
+        for (size_t offset = 0; offset < count; offset += TELEMETRY_IMU_BATCH_MAX) {
+            size_t batch = count - offset < TELEMETRY_IMU_BATCH_MAX ? count - offset : TELEMETRY_IMU_BATCH_MAX;
+            payload[0] = (uint8_t)batch;
+            for (size_t i = 0; i < batch; i++) {
+                TelemetryImuSample out;
+                out.timestamp_us = samples[offset + i].timestamp_us;
+                memcpy(out.accel_mps2, samples[offset + i].accel_mps2, sizeof(out.accel_mps2));
+                memcpy(out.gyro_radps, samples[offset + i].gyro_radps, sizeof(out.gyro_radps));
+                memcpy(&payload[1 + i * sizeof(TelemetryImuSample)], &out, sizeof(out));
+            }
+            telemetryPublish(TELEM_IMU, payload, (uint16_t)(1 + batch * sizeof(TelemetryImuSample)));
+        }
+    }
+}
+
+// Drain everything the FIFO holds, in bursts no larger than the Wire buffer.
+static void drainFifo(bool woke_by_interrupt) {
+    uint8_t status[2];
+    if (!readRegisters(LSM6DSO_FIFO_STATUS1, status, sizeof(status))) {
+        s_stats.bus_errors++;
+        return;
+    }
+    uint16_t words = ((uint16_t)(status[1] & 0x03) << 8) | status[0];
+    if (status[1] & LSM6DSO_FIFO_OVR_IA) {
+        s_stats.overruns++;
+        s_parser.reset();
+    }
+    if (words == 0) {
+        return;
+    }
+
+    // Latest ground speed; a busy mutex just keeps the previous value for this burst
+    if (g_gpsDataMutex != NULL && TRACE_MUTEX_TAKE(g_gpsDataMutex, 0) == pdTRUE) {
+        float speed = g_gpsData.is_valid ? g_gpsData.speed_mps : 0.0f;
+        TRACE_MUTEX_GIVE(g_gpsDataMutex);
+        s_ahrs.setForwardSpeed(speed >= AHRS_COMPENSATION_MIN_SPEED_MPS ? speed : 0.0f);
+    }
+
+    // The watermark word arrived at the interrupt; samples are spaced one ODR period apart.
+    int64_t firstSampleUs;
+    if (woke_by_interrupt) {
+        firstSampleUs = imuFifoWatermarkFirstSampleUs(s_lastIrqUs, IMU_FIFO_WATERMARK_WORDS, IMU_SAMPLE_PERIOD_US);
+    } else {
+        firstSampleUs = esp_timer_get_time() - (int64_t)(words / 2) * IMU_SAMPLE_PERIOD_US;
+    }
+
+    size_t producedTotal = 0;
+    while (words > 0) {
+        uint16_t burstWords = words > IMU_MAX_WORDS_PER_BURST ? IMU_MAX_WORDS_PER_BURST : words;
+        if (!readRegisters(LSM6DSO_FIFO_DATA_OUT, s_rxBuffer, (size_t)burstWords * IMU_FIFO_WORD_SIZE)) {
+            s_stats.bus_errors++;
+            s_parser.reset();
+            return;
+        }
+        s_stats.bursts++;
+        int64_t chunkStartUs = firstSampleUs + (int64_t)producedTotal * IMU_SAMPLE_PERIOD_US;
+        rawCaptureAppend((uint32_t)(chunkStartUs / 1000), CAPTURE_IMU_FIFO, s_rxBuffer,
+                         (size_t)burstWords * IMU_FIFO_WORD_SIZE);
+        size_t produced = s_parser.parse(s_rxBuffer, burstWords, chunkStartUs, 0,
+                                         s_parsed, sizeof(s_parsed) / sizeof(s_parsed[0]));
+        publishSamples(s_parsed, produced);
+        producedTotal += produced;
+        words -= burstWords;
+    }
+}
+
+void imuTask(void *pvParameters) {
+    Serial.println("IMU Task started");
+    s_imuTaskHandle = xTaskGetCurrentTaskHandle();
+
+    if (!initializeIMU()) {
+        Serial.println("IMU Initialization Failed! IMU task exiting.");
+        s_imuTaskHandle = NULL;
+        vTaskDelete(NULL);
+        return;
+    }
+
+    pinMode(IMU_INT1_PIN, INPUT);
+    attachInterrupt(digitalPinToInterrupt(IMU_INT1_PIN), imuInt1Isr, RISING);
+
+    // If an edge is missed (INT1 stays high while the FIFO is above the watermark) the timeout drains anyway
+    const uint32_t watermarkPeriodMs = (IMU_FIFO_WATERMARK_WORDS / 2) * IMU_SAMPLE_PERIOD_US / 1000;
+    const TickType_t timeoutTicks = pdMS_TO_TICKS(watermarkPeriodMs * 2) + 1;
+
+    for (;;) {
+        bool woke_by_interrupt = ulTaskNotifyTake(pdTRUE, timeoutTicks) > 0;
+        if (woke_by_interrupt) {
+            s_stats.interrupts++;
+        }
+        TRACE_SCOPE(TRACE_IMU_DRAIN);
+        drainFifo(woke_by_interrupt);
+    }
+}
+
+size_t imuReadSamples(ImuSample* out, size_t maxSamples) {
+    portENTER_CRITICAL(&s_ringMux);
+    s_ringConsumed = true;
+    size_t count = s_ringCount < maxSamples ? s_ringCount : maxSamples;
+    size_t tail = (s_ringHead + IMU_SAMPLE_RING_SIZE - s_ringCount) % IMU_SAMPLE_RING_SIZE;
+    for (size_t i = 0; i < count; i++) {
+        out[i] = s_ring[(tail + i) % IMU_SAMPLE_RING_SIZE];
+    }
+    s_ringCount -= count;
+    portEXIT_CRITICAL(&s_ringMux);
+    return count;
+}
+
+void imuGetStats(ImuStats* out) {
+    portENTER_CRITICAL(&s_ringMux);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_ringMux);
+}
+
+void imuGetAttitude(ImuAttitude* out) {
+    portENTER_CRITICAL(&s_ringMux);
+    *out = s_attitude;
+    portEXIT_CRITICAL(&s_ringMux);
+}
@@ -0,0 +1,76 @@
+#include "SdLoggingTask.h"
+#include "config.h"
+#include "DataBuffer.h" // To read from PSRAM buffer
+#include "event_log.h"  // Low-rate summary records for the event sidecar
+#include "BleManagerTask.h" // For postMeanMaxSummary
+#include "trace.h"          // Stall tracing
+#include "sd_card.h"        // Card mount (shared with the other card users)
+#include "log_rotation.h"   // File naming, preallocation and rotation
+#include "log_writer.h"     // The loop body (shared with the host replay)
+
+extern DataBuffer<LogRecordV1> psramDataBuffer; // Defined in main.cpp, filled by the acquisition task
+static bool sdCardPresent = false;
+
+void sdLoggingTask(void *pvParameters) {
+    Serial.println("SD Logging Task started");
+
+    if (initializeSDCard()) {
+        sdCardPresent = createNewLogFile(); // Without a file the ring is left to the backpressure policy
+    } else {
+        currentSystemState = STATE_SD_CARD_ERROR;
+        Serial.println("SD Card Initialization Failed!");
+    }
+
+    for (;;) {
+        TRACE_BEGIN(TRACE_SD_WRITE);
+        size_t batch = 0;
+        if (sdCardPresent) {
+            bool ok;
+            batch = logWriterService(psramDataBuffer, millis(), &ok);
+            if (!ok) {
+                Serial.println("SD Card write error!");
+                currentSystemState = STATE_SD_CARD_ERROR;
+            }
+        } else {
+            EventRecord discarded[8];
+            eventLogRead(discarded, sizeof(discarded) / sizeof(discarded[0]), 0); // No card; keep the queue moving
+        }
+        TRACE_END(TRACE_SD_WRITE);
+
+        if (!sdCardPresent) {
+            vTaskDelay(pdMS_TO_TICKS(5000)); // Retry the card periodically
+            if (initializeSDCard()) {
+                sdCardPresent = createNewLogFile();
+            }
+        } else if (batch < LOG_STAGING_SPILL_RECORDS) {
+            vTaskDelay(pdMS_TO_TICKS(SD_LOG_IDLE_POLL_MS)); // Ring drained; a full batch means we are behind, so loop at once
+        }
+    }
+}
+
+bool initializeSDCard() {
+    return sdCardBegin(); // SdFat on the SPI pins from config.h; prints the card type and size
+}
+
+// Names come from the counter on the card and the files are prepared by the rotation task
+// (log_rotation.h); no directory walk and no file creation happens on the logging path.
+bool createNewLogFile() {
+    if (!logRotationBegin()) {
+        currentSystemState = STATE_SD_CARD_ERROR;
+        Serial.println("Could not open a log file!");
+        return false;
+    }
+    logWriterBegin(millis());
+    currentSystemState = STATE_LOGGING;
+    return true;
+}
+
+void closeLogFile() {
+    // Persist the session's mean-maximal curve as the last event record before closing
+    postMeanMaxSummary();
+    logWriterFlush(psramDataBuffer, millis()); // Records still in the ring, then the queued events
+
+    // Truncates the preallocated tails and closes both files; an unused prepared pair is deleted
+    logRotationEnd();
+    Serial.println("Log file closed.");
+}
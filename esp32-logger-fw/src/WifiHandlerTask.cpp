@@ -0,0 +1,258 @@
+#include "WifiHandlerTask.h"
+#include "config.h"
+#include "sd_card.h"
+#include "http_file_server.h"
+#include "trace.h"
+#include "mem_placement.h"
+
+#include <WiFi.h>
+#include <Preferences.h> // Per-unit AP password
+#include <esp_system.h> // For esp_random
+#include <esp_timer.h> // For esp_timer_get_time
+
+// SdFat-backed file source. The card lock is taken per call, so the logger is never held off the
+// card for longer than one chunk read.
+class SdLogSource : public HttpFileSource {
+public:
+    bool open(const char* name, uint64_t* size) override {
+        char path[HTTP_MAX_PATH + 16];
+        snprintf(path, sizeof(path), "%s%s%s", LOG_DIRECTORY,
+                 LOG_DIRECTORY[strlen(LOG_DIRECTORY) - 1] == '/' ? "" : "/", name);
+        if (!sdCardBegin() || !sdCardLock(pdMS_TO_TICKS(1000))) {
+            return false;
+        }
+        bool ok = _file.open(&sdCardFs(), path, O_RDONLY) && !_file.isDirectory();
+        if (ok) {
+            *size = _file.fileSize();
+        } else {
+            _file.close();
+        }
+        sdCardUnlock();
+        return ok;
+    }
+    bool seek(uint64_t offset) override {
+        sdCardLock(portMAX_DELAY);
+        bool ok = _file.seekSet(offset);
+        sdCardUnlock();
+        return ok;
+    }
+    int32_t read(uint8_t* buffer, uint32_t length) override {
+        sdCardLock(portMAX_DELAY);
+        int32_t n = _file.read(buffer, length);
+        sdCardUnlock();
+        return n;
+    }
+    void close() override {
+        sdCardLock(portMAX_DELAY);
+        _file.close();
+        sdCardUnlock();
+    }
+
+    bool listBegin() override {
+        if (!sdCardBegin() || !sdCardLock(pdMS_TO_TICKS(1000))) {
+            return false;
+        }
+        bool ok = _dir.open(&sdCardFs(), LOG_DIRECTORY, O_RDONLY) && _dir.isDirectory();
+        sdCardUnlock();
+        return ok;
+    }
+    bool listNext(char* name, size_t nameSize, uint64_t* size) override {
+        sdCardLock(portMAX_DELAY);
+        bool found = false;
+        FsFile entry;
+        while (!found && entry.openNext(&_dir, O_RDONLY)) {
+            if (!entry.isDirectory() && !entry.isHidden()) {
+                entry.getName(name, nameSize);
+                *size = entry.fileSize();
+                found = true;
+            }
+            entry.close();
+        }
+        sdCardUnlock();
+        return found;
+    }
+    void listEnd() override {
+        sdCardLock(portMAX_DELAY);
+        _dir.close();
+        sdCardUnlock();
+    }
+
+private:
+    FsFile _file;
+    FsFile _dir;
+};
+
+class WifiClientSink : public HttpByteSink {
+public:
+    explicit WifiClientSink(WiFiClient& client) : _client(client) {}
+    bool write(const uint8_t* data, size_t length) override {
+        unsigned long lastProgress = millis();
+        while (length > 0) {
+            size_t n = _client.write(data, length);
+            if (n > 0) {
+                data += n;
+                length -= n;
+                lastProgress = millis();
+            } else if (!_client.connected() || millis() - lastProgress > WIFI_CLIENT_TIMEOUT_MS) {
+                return false;
+            } else {
+                vTaskDelay(1);
+            }
+        }
+        return true;
+    }
+
+private:
+    WiFiClient& _client;
+};
+
+static TaskHandle_t s_wifiTaskHandle = NULL;
+static volatile bool s_offloadRequested = false;
+static WifiOffloadStats s_stats;
+static portMUX_TYPE s_statsMux = portMUX_INITIALIZER_UNLOCKED;
+
+// DMA-capable internal RAM: SdFat reads straight into it and the Wi-Fi stack copies out of it
+MEM_DMA_BUFFER static uint8_t s_httpBuffer[WIFI_HTTP_BUFFER_BYTES];
+MEM_PLACED(s_httpBuffer, MEM_REGION_DMA);
+
+void wifiOffloadSetEnabled(bool enabled) {
+    s_offloadRequested = enabled;
+    if (s_wifiTaskHandle != NULL) {
+        xTaskNotifyGive(s_wifiTaskHandle);
+    }
+}
+
+void wifiOffloadGetStats(WifiOffloadStats* out) {
+    portENTER_CRITICAL(&s_statsMux);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_statsMux);
+    out->stations = out->active ? WiFi.softAPgetStationNum() : 0;
+}
+
+// AP name and password for this unit. Every logger used to share one fixed password; now the SSID
+// carries the last two MAC bytes and, unless WIFI_AP_PASSWORD is set, the password is drawn from
+// the hardware RNG the first time (the radio is on by then, so it is true random) and kept in NVS.
+// Not derived from the MAC: the AP broadcasts that as its BSSID.
+static bool apCredentials(char* ssid, size_t ssidSize, char* password, size_t passwordSize) {
+    uint64_t mac = ESP.getEfuseMac(); // Byte 0 of the MAC in the low bits
+    snprintf(ssid, ssidSize, "%s-%02X%02X", WIFI_AP_SSID, (unsigned)((mac >> 32) & 0xFF), (unsigned)((mac >> 40) & 0xFF));
+    if (strlen(WIFI_AP_PASSWORD) > 0) {
+        snprintf(password, passwordSize, "%s", WIFI_AP_PASSWORD);
+        return true;
+    }
+
+    static const char alphabet[] = "abcdefghjkmnpqrstuvwxyz23456789"; // No look-alike characters
+    static_assert(WIFI_AP_PASSWORD_LENGTH >= 8 && WIFI_AP_PASSWORD_LENGTH <= 63, "WPA2 passphrases are 8-63 characters");
+    Preferences prefs;
+    if (!prefs.begin("wifi", false)) {
+        return false;
+    }
+    size_t length = prefs.getString("ap_password", password, passwordSize);
+    if (length < 8 + 1) { // Counts the terminator; nothing stored yet
+        size_t n = WIFI_AP_PASSWORD_LENGTH < passwordSize - 1 ? WIFI_AP_PASSWORD_LENGTH : passwordSize - 1;
+        for (size_t i = 0; i < n; i++) {
+            password[i] = alphabet[esp_random() % (sizeof(alphabet) - 1)];
+        }
+        password[n] = '\0';
+        prefs.putString("ap_password", password);
+    }
+    prefs.end();
+    return true;
+}
+
+static void serveClient(WiFiClient& client, HttpFileServer& http) {
+    char head[HTTP_MAX_HEAD];
+    size_t used = 0;
+    size_t headEnd = 0;
+    unsigned long start = millis();
+    while (used < sizeof(head) && (headEnd = httpFindHeadEnd(head, used)) == 0) {
+        int available = client.available();
+        if (available > 0) {
+            int n = client.read((uint8_t*)head + used, min((size_t)available, sizeof(head) - used));
+            if (n > 0) used += n;
+        } else if (!client.connected() || millis() - start > WIFI_CLIENT_TIMEOUT_MS) {
+            return;
+        } else {
+            vTaskDelay(1);
+        }
+    }
+
+    WifiClientSink sink(client);
+    HttpRequest request;
+    if (headEnd == 0 || !httpParseRequest(head, headEnd, &request)) {
+        http.sendError(sink, 400);
+        return;
+    }
+
+    TRACE_SCOPE(TRACE_WIFI_REQUEST);
+    int64_t startUs = esp_timer_get_time();
+    HttpTransferResult result = http.handle(request, sink);
+    float seconds = (esp_timer_get_time() - startUs) / 1e6f;
+    float mbps = seconds > 0.0f ? result.body_bytes / seconds / 1e6f : 0.0f;
+
+    portENTER_CRITICAL(&s_statsMux);
+    s_stats.requests++;
+    s_stats.bytes_served += result.body_bytes;
+    if (result.body_bytes > 0) s_stats.last_mbps = mbps;
+    portEXIT_CRITICAL(&s_statsMux);
+
+    if (result.body_bytes > 0) {
+        Serial.printf("WiFi: %s %s -> %d, %llu bytes in %.1f s (%.2f MB/s)\n", request.method, request.path,
+                      result.status, (unsigned long long)result.body_bytes, seconds, mbps);
+    }
+}
+
+void wifiHandlerTask(void *pvParameters) {
+    s_wifiTaskHandle = xTaskGetCurrentTaskHandle();
+    SdLogSource source;
+    HttpFileServer http(source, s_httpBuffer, sizeof(s_httpBuffer));
+    WiFiServer server(WIFI_HTTP_PORT);
+    SystemState stateBeforeOffload = currentSystemState;
+
+    for (;;) {
+        // Off: sleep until offload is requested
+        while (!s_offloadRequested) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+
+        stateBeforeOffload = currentSystemState;
+        currentSystemState = STATE_WIFI_MODE;
+        WiFi.mode(WIFI_AP);
+        WiFi.setSleep(false); // Throughput over power while offloading
+        char ssid[33];
+        char password[64];
+        if (!apCredentials(ssid, sizeof(ssid), password, sizeof(password)) || !WiFi.softAP(ssid, password)) {
+            Serial.println("WiFi: soft AP start failed.");
+            WiFi.mode(WIFI_OFF);
+            currentSystemState = stateBeforeOffload;
+            s_offloadRequested = false;
+            continue;
+        }
+        server.begin();
+        server.setNoDelay(true);
+        portENTER_CRITICAL(&s_statsMux);
+        s_stats.active = true;
+        portEXIT_CRITICAL(&s_statsMux);
+        Serial.printf("WiFi offload: join '%s' (password %s) and open http://%s/\n", ssid, password,
+                      WiFi.softAPIP().toString().c_str());
+
+        while (s_offloadRequested) {
+            WiFiClient client = server.available();
+            if (client) {
+                serveClient(client, http);
+                client.stop();
+            } else {
+                ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(20)); // Poll for clients; wakes at once on 'wifi off'
+            }
+        }
+
+        server.end();
+        WiFi.softAPdisconnect(true);
+        WiFi.mode(WIFI_OFF);
+        portENTER_CRITICAL(&s_statsMux);
+        s_stats.active = false;
+        portEXIT_CRITICAL(&s_statsMux);
+        currentSystemState = stateBeforeOffload;
+        Serial.println("WiFi offload stopped.");
+    }
+}
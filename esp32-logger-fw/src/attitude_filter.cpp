@@ -0,0 +1,116 @@
+#include "attitude_filter.h"
+#include <math.h>
+
+#define RAD_TO_DEG_F 57.29577951f
+
+static inline float invSqrt(float x) {
+    return 1.0f / sqrtf(x); // Hardware sqrt.s/div.s on the S3; the bit-trick approximation is slower there
+}
+
+AttitudeFilter::AttitudeFilter(float beta) : _beta(beta), _speedMps(0.0f) {
+    reset();
+}
+
+void AttitudeFilter::reset() {
+    _q[0] = 1.0f;
+    _q[1] = _q[2] = _q[3] = 0.0f;
+    _initialized = false;
+}
+
+void AttitudeFilter::seedFromAccel(const float accel[3]) {
+    float roll = atan2f(accel[1], accel[2]);
+    float pitch = atan2f(-accel[0], sqrtf(accel[1] * accel[1] + accel[2] * accel[2]));
+    float cr = cosf(roll * 0.5f), sr = sinf(roll * 0.5f);
+    float cp = cosf(pitch * 0.5f), sp = sinf(pitch * 0.5f);
+    _q[0] = cr * cp;
+    _q[1] = sr * cp;
+    _q[2] = cr * sp;
+    _q[3] = -sr * sp;
+    _initialized = true;
+}
+
+void AttitudeFilter::update(const float gyro[3], const float accel[3], float dt) {
+    float ax = accel[0], ay = accel[1], az = accel[2];
+    if (!_initialized) {
+        if (ax == 0.0f && ay == 0.0f && az == 0.0f) {
+            return;
+        }
+        seedFromAccel(accel);
+        return;
+    }
+
+    float q0 = _q[0], q1 = _q[1], q2 = _q[2], q3 = _q[3];
+    const float gx = gyro[0], gy = gyro[1], gz = gyro[2];
+
+    if (_speedMps > 0.0f) {
+        // Rows/columns of the sensor-to-earth rotation needed for the centripetal term
+        float r00 = 1.0f - 2.0f * (q2 * q2 + q3 * q3), r01 = 2.0f * (q1 * q2 - q0 * q3), r02 = 2.0f * (q1 * q3 + q0 * q2);
+        float r10 = 2.0f * (q1 * q2 + q0 * q3), r11 = 1.0f - 2.0f * (q1 * q1 + q3 * q3), r12 = 2.0f * (q2 * q3 - q0 * q1);
+        float r20 = 2.0f * (q1 * q3 - q0 * q2), r21 = 2.0f * (q2 * q3 + q0 * q1), r22 = 1.0f - 2.0f * (q1 * q1 + q2 * q2);
+        float headingNorm = r00 * r00 + r10 * r10;
+        if (headingNorm > 1e-6f) {
+            // Earth-frame yaw rate and horizontal heading; centripetal = v * yawRate * (z x heading)
+            float yawRate = r20 * gx + r21 * gy + r22 * gz;
+            float k = _speedMps * yawRate * invSqrt(headingNorm);
+            float cx = -r10 * k, cy = r00 * k; // Earth frame, horizontal
+            ax -= r00 * cx + r10 * cy;
+            ay -= r01 * cx + r11 * cy;
+            az -= r02 * cx + r12 * cy;
+        }
+    }
+
+    // Rate of change of the quaternion from the gyroscope
+    float qDot0 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+    float qDot1 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+    float qDot2 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+    float qDot3 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+    float aNorm = ax * ax + ay * ay + az * az;
+    if (aNorm > 0.0f) {
+        float recip = invSqrt(aNorm);
+        ax *= recip;
+        ay *= recip;
+        az *= recip;
+
+        // Gradient of the error between the measured and the predicted gravity direction
+        float _2q0 = 2.0f * q0, _2q1 = 2.0f * q1, _2q2 = 2.0f * q2, _2q3 = 2.0f * q3;
+        float _4q0 = 4.0f * q0, _4q1 = 4.0f * q1, _4q2 = 4.0f * q2;
+        float _8q1 = 8.0f * q1, _8q2 = 8.0f * q2;
+        float q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+
+        float s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+        float s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+        float s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+        float s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
+        float sNorm = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+        if (sNorm > 0.0f) {
+            recip = invSqrt(sNorm);
+            qDot0 -= _beta * s0 * recip;
+            qDot1 -= _beta * s1 * recip;
+            qDot2 -= _beta * s2 * recip;
+            qDot3 -= _beta * s3 * recip;
+        }
+    }
+
+    q0 += qDot0 * dt;
+    q1 += qDot1 * dt;
+    q2 += qDot2 * dt;
+    q3 += qDot3 * dt;
+    float recip = invSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+    _q[0] = q0 * recip;
+    _q[1] = q1 * recip;
+    _q[2] = q2 * recip;
+    _q[3] = q3 * recip;
+}
+
+float AttitudeFilter::rollDeg() const {
+    return atan2f(2.0f * (_q[0] * _q[1] + _q[2] * _q[3]),
+                  1.0f - 2.0f * (_q[1] * _q[1] + _q[2] * _q[2])) * RAD_TO_DEG_F;
+}
+
+float AttitudeFilter::pitchDeg() const {
+    float s = 2.0f * (_q[0] * _q[2] - _q[1] * _q[3]);
+    if (s > 1.0f) s = 1.0f;
+    if (s < -1.0f) s = -1.0f;
+    return asinf(s) * RAD_TO_DEG_F;
+}
@@ -0,0 +1,126 @@
+#include "breadcrumb_track.h"
+#include <math.h>
+
+#define DM_PER_DEG_LAT 1111949.0 // Decimetres per degree of latitude (spherical earth)
+
+BreadcrumbTrack::BreadcrumbTrack(TrackPoint* storage, uint32_t capacity, TrackPoint* pending, uint32_t pendingCapacity,
+                                 int32_t initialToleranceDm)
+    : _points(storage), _capacity(capacity), _pending(pending), _pendingCapacity(pendingCapacity),
+      _initialTolerance(initialToleranceDm), _generation(0) {
+    reset();
+}
+
+void BreadcrumbTrack::reset() {
+    _count = 0;
+    _pendingCount = 0;
+    _tolerance = _initialTolerance;
+    _generation++;
+    _haveOrigin = false;
+    _minX = _minY = _maxX = _maxY = 0;
+}
+
+void BreadcrumbTrack::project(double latitude, double longitude, TrackPoint* out) const {
+    out->x = (int32_t)lround((longitude - _originLon) * _dmPerDegLon);
+    out->y = (int32_t)lround((latitude - _originLat) * DM_PER_DEG_LAT);
+}
+
+void BreadcrumbTrack::bounds(int32_t* minX, int32_t* minY, int32_t* maxX, int32_t* maxY) const {
+    *minX = _minX;
+    *minY = _minY;
+    *maxX = _maxX;
+    *maxY = _maxY;
+}
+
+void BreadcrumbTrack::append(const TrackPoint& p) {
+    if (_count == _capacity) {
+        resimplify();
+        if (_count == _capacity) {
+            return; // Nothing could be merged (pending window of 1); drop rather than overflow
+        }
+    }
+    _points[_count++] = p;
+    if (p.x < _minX) _minX = p.x;
+    if (p.x > _maxX) _maxX = p.x;
+    if (p.y < _minY) _minY = p.y;
+    if (p.y > _maxY) _maxY = p.y;
+}
+
+// True if any candidate lies further than the tolerance from the segment a->b
+bool BreadcrumbTrack::deviates(const TrackPoint& a, const TrackPoint& b, const TrackPoint* candidates, uint32_t n) const {
+    const double dx = (double)b.x - a.x, dy = (double)b.y - a.y;
+    const double lengthSq = dx * dx + dy * dy;
+    const double tolSq = (double)_tolerance * _tolerance;
+    for (uint32_t i = 0; i < n; i++) {
+        const double px = (double)candidates[i].x - a.x, py = (double)candidates[i].y - a.y;
+        double distSq;
+        double along = px * dx + py * dy;
+        if (lengthSq == 0.0 || along <= 0.0) {
+            distSq = px * px + py * py;
+        } else if (along >= lengthSq) {
+            const double qx = (double)candidates[i].x - b.x, qy = (double)candidates[i].y - b.y;
+            distSq = qx * qx + qy * qy;
+        } else {
+            const double cross = px * dy - py * dx;
+            distSq = cross * cross / lengthSq;
+        }
+        if (distSq > tolSq) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void BreadcrumbTrack::addFix(double latitude, double longitude) {
+    if (!_haveOrigin) {
+        _haveOrigin = true;
+        _originLat = latitude;
+        _originLon = longitude;
+        _dmPerDegLon = DM_PER_DEG_LAT * cos(latitude * 3.14159265358979323846 / 180.0);
+        TrackPoint origin = { 0, 0 };
+        append(origin);
+        return;
+    }
+
+    TrackPoint q;
+    project(latitude, longitude, &q);
+
+    // Radial pre-filter: jitter while stopped never reaches the buffers
+    const TrackPoint& last = _pendingCount > 0 ? _pending[_pendingCount - 1] : _points[_count - 1];
+    const double rx = (double)q.x - last.x, ry = (double)q.y - last.y;
+    if (rx * rx + ry * ry < (double)_tolerance * _tolerance / 4.0) {
+        return;
+    }
+
+    const TrackPoint anchor = _points[_count - 1];
+    if (_pendingCount > 0 && deviates(anchor, q, _pending, _pendingCount)) {
+        // The straight line no longer covers the pending fixes: keep the last one that did
+        append(_pending[_pendingCount - 1]);
+        _pendingCount = 0;
+    } else if (_pendingCount == _pendingCapacity) {
+        append(_pending[_pendingCount - 1]);
+        _pendingCount = 0;
+    }
+    _pending[_pendingCount++] = q;
+}
+
+// Buffer full: double the tolerance and re-run the same simplification over the stored points.
+// O(capacity), but only once per doubling of the tolerance.
+void BreadcrumbTrack::resimplify() {
+    _tolerance *= 2;
+    _generation++;
+
+    uint32_t kept = 1; // First point always stays
+    uint32_t windowStart = 1;
+    for (uint32_t i = 2; i < _count; i++) {
+        uint32_t windowLength = i - windowStart;
+        if (deviates(_points[kept - 1], _points[i], &_points[windowStart], windowLength) ||
+            windowLength >= _pendingCapacity) {
+            _points[kept++] = _points[i - 1];
+            windowStart = i;
+        }
+    }
+    if (_count > 1) {
+        _points[kept++] = _points[_count - 1];
+    }
+    _count = kept;
+}
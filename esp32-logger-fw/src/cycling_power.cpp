@@ -0,0 +1,122 @@
+#include "cycling_power.h"
+
+static uint16_t readU16(const uint8_t* p) {
+    return (uint16_t)((p[1] << 8) | p[0]);
+}
+
+CyclingPowerDecoder::CyclingPowerDecoder() : _deadSpotAnglesSupported(false) {
+    reset();
+}
+
+void CyclingPowerDecoder::reset() {
+    _haveCrank = false;
+    _prevCrankRevolutions = 0;
+    _prevCrankEventTime = 0;
+}
+
+uint8_t CyclingPowerDecoder::decode(const uint8_t* data, size_t length, CyclingPowerMeasurement* out) {
+    out->flags = 0;
+    out->power_watts = 0;
+    out->cadence_rpm = 0;
+    out->left_balance_percent = 50.0f;
+    out->balance_available = false;
+    out->top_dead_spot_deg = 0;
+    out->top_dead_spot_available = false;
+    out->bottom_dead_spot_deg = 0;
+    out->bottom_dead_spot_available = false;
+    if (length < 2) {
+        return CP_SHORT_FLAGS;
+    }
+
+    uint8_t issues = 0;
+    uint16_t flags = readU16(data);
+    out->flags = flags;
+
+    // Instantaneous power (sint16)
+    if (length >= 4) {
+        int16_t rawPower = (int16_t)readU16(data + 2);
+        out->power_watts = rawPower < 0 ? 0 : (uint16_t)rawPower;
+    } else {
+        issues |= CP_SHORT_POWER;
+    }
+    size_t offset = 4;
+
+    // Pedal power balance, 1/2 percent
+    if (flags & CP_FLAG_BALANCE) {
+        if (length >= offset + 1) {
+            out->left_balance_percent = data[offset] / 2.0f;
+            out->balance_available = true;
+        } else {
+            issues |= CP_SHORT_BALANCE;
+        }
+        offset += 1;
+    }
+
+    // Fields ahead of the crank data that are not decoded, only stepped over
+    if (flags & CP_FLAG_ACCUMULATED_TORQUE) {
+        offset += 2;                           // uint16, 1/32 Nm
+    }
+    if (flags & CP_FLAG_WHEEL_REVOLUTIONS) {
+        offset += 6;                           // uint32 revolutions, uint16 event time (1/2048 s)
+    }
+
+    // Crank revolutions (uint16) and last crank event time (uint16, 1/1024 s); both wrap
+    if (flags & CP_FLAG_CRANK_REVOLUTIONS) {
+        if (length >= offset + 4) {
+            uint16_t revolutions = readU16(data + offset);
+            uint16_t eventTime = readU16(data + offset + 2);
+            if (_haveCrank) {
+                uint16_t deltaRevolutions = (uint16_t)(revolutions - _prevCrankRevolutions);
+                uint16_t deltaEventTime = (uint16_t)(eventTime - _prevCrankEventTime);
+                if (deltaRevolutions > 0 && deltaEventTime > 0) {
+                    double deltaTimeSeconds = (double)deltaEventTime / 1024.0;
+                    out->cadence_rpm = (uint8_t)(((double)deltaRevolutions / deltaTimeSeconds) * 60.0);
+                }
+            }
+            _haveCrank = true;
+            _prevCrankRevolutions = revolutions;
+            _prevCrankEventTime = eventTime;
+        } else {
+            issues |= CP_SHORT_CRANK;
+            _haveCrank = false;
+        }
+        offset += 4;
+    } else {
+        _haveCrank = false;
+    }
+
+    if (flags & CP_FLAG_EXTREME_FORCES) {
+        offset += 4;                           // sint16 max, sint16 min, N
+    }
+    if (flags & CP_FLAG_EXTREME_TORQUES) {
+        offset += 4;                           // sint16 max, sint16 min, 1/32 Nm
+    }
+    if (flags & CP_FLAG_EXTREME_ANGLES) {
+        offset += 3;                           // Two uint12 angles packed in 3 bytes
+    }
+
+    // Top / bottom dead spot angles (uint16 degrees), each behind its own flag
+    if (flags & CP_FLAG_TOP_DEAD_SPOT) {
+        if (_deadSpotAnglesSupported) {
+            if (length >= offset + 2) {
+                out->top_dead_spot_deg = readU16(data + offset);
+                out->top_dead_spot_available = true;
+            } else {
+                issues |= CP_SHORT_TOP_DEAD;
+            }
+        }
+        offset += 2;
+    }
+    if (flags & CP_FLAG_BOTTOM_DEAD_SPOT) {
+        if (_deadSpotAnglesSupported) {
+            if (length >= offset + 2) {
+                out->bottom_dead_spot_deg = readU16(data + offset);
+                out->bottom_dead_spot_available = true;
+            } else {
+                issues |= CP_SHORT_BOTTOM_DEAD;
+            }
+        }
+        offset += 2;
+    }
+    return issues;
+}
@@ -0,0 +1,161 @@
+#include "elevation_filter.h"
+#include <math.h>
+#include <string.h>
+
+#define INITIAL_SIGMA_M 300.0f       // Prior for elevation and baro offset (covers weather extremes)
+#define INITIAL_SIGMA_MPS 2.0f
+#define GPS_REJECTS_BEFORE_RESYNC 10 // A run of outliers means the prediction is what's wrong
+
+float pressureAltitudeM(float pressurePa) {
+    return 44330.0f * (1.0f - powf(pressurePa / 101325.0f, 0.190295f));
+}
+
+ElevationFilter::ElevationFilter(const ElevationFilterConfig& config) : _config(config) {
+    reset();
+}
+
+void ElevationFilter::reset() {
+    _initialized = false;
+    _timeMs = 0;
+    memset(_x, 0, sizeof(_x));
+    memset(_p, 0, sizeof(_p));
+    _groundSpeedMps = 0.0f;
+    _ascentReferenceM = 0.0f;
+    _climbing = false;
+    _consecutiveGpsRejects = 0;
+    _estimate = ElevationEstimate();
+}
+
+void ElevationFilter::initialize(uint32_t timestampMs, float elevationM) {
+    _initialized = true;
+    _timeMs = timestampMs;
+    _x[0] = elevationM;
+    _x[1] = 0.0f;
+    _x[2] = 0.0f;
+    memset(_p, 0, sizeof(_p));
+    _p[0][0] = INITIAL_SIGMA_M * INITIAL_SIGMA_M;
+    _p[1][1] = INITIAL_SIGMA_MPS * INITIAL_SIGMA_MPS;
+    _p[2][2] = INITIAL_SIGMA_M * INITIAL_SIGMA_M;
+    _ascentReferenceM = elevationM;
+    _climbing = false;
+}
+
+void ElevationFilter::predictTo(uint32_t timestampMs) {
+    int32_t elapsedMs = (int32_t)(timestampMs - _timeMs);
+    if (elapsedMs <= 0) {
+        return;
+    }
+    _timeMs = timestampMs;
+    const float dt = elapsedMs * 0.001f;
+    const float dt2 = dt * dt;
+    const float q = _config.accel_noise_mps2 * _config.accel_noise_mps2;
+
+    _x[0] += _x[1] * dt;
+
+    // P = F P F' + Q with F = [1 dt 0; 0 1 0; 0 0 1] and white-acceleration Q
+    _p[0][0] += 2.0f * dt * _p[0][1] + dt2 * _p[1][1] + 0.25f * dt2 * dt2 * q;
+    _p[0][1] += dt * _p[1][1] + 0.5f * dt2 * dt * q;
+    _p[0][2] += dt * _p[1][2];
+    _p[1][1] += dt2 * q;
+    _p[2][2] += _config.offset_drift_m * _config.offset_drift_m * dt;
+    _p[1][0] = _p[0][1];
+    _p[2][0] = _p[0][2];
+}
+
+bool ElevationFilter::update(const float h[3], float z, float variance, float gateSigma) {
+    float ph[3];
+    for (int i = 0; i < 3; i++) {
+        ph[i] = _p[i][0] * h[0] + _p[i][1] * h[1] + _p[i][2] * h[2];
+    }
+    float s = h[0] * ph[0] + h[1] * ph[1] + h[2] * ph[2] + variance;
+    float innovation = z - (h[0] * _x[0] + h[1] * _x[1] + h[2] * _x[2]);
+    if (gateSigma > 0.0f && innovation * innovation > gateSigma * gateSigma * s) {
+        return false;
+    }
+    float k[3] = { ph[0] / s, ph[1] / s, ph[2] / s };
+    for (int i = 0; i < 3; i++) {
+        _x[i] += k[i] * innovation;
+    }
+    for (int i = 0; i < 3; i++) {
+        for (int j = i; j < 3; j++) {
+            _p[i][j] -= k[i] * ph[j];
+            _p[j][i] = _p[i][j];
+        }
+    }
+    return true;
+}
+
+void ElevationFilter::addPressure(uint32_t timestampMs, float pressurePa) {
+    if (!(pressurePa > 0.0f)) {
+        return;
+    }
+    static const float H_BARO[3] = { 1.0f, 0.0f, 1.0f };
+    float altitude = pressureAltitudeM(pressurePa);
+    uint32_t previousMs = _timeMs;
+    if (!_initialized) {
+        initialize(timestampMs, altitude);
+        previousMs = timestampMs;
+    }
+    predictTo(timestampMs);
+    update(H_BARO, altitude, _config.baro_noise_m * _config.baro_noise_m, 0.0f);
+    _estimate.baro_updates++;
+    publish((int32_t)(_timeMs - previousMs) * 0.001f);
+}
+
+void ElevationFilter::addGps(uint32_t timestampMs, float altitudeM, float groundSpeedMps) {
+    static const float H_GPS[3] = { 1.0f, 0.0f, 0.0f };
+    _groundSpeedMps = groundSpeedMps;
+    uint32_t previousMs = _timeMs;
+    if (!_initialized) {
+        initialize(timestampMs, altitudeM);
+        previousMs = timestampMs;
+    }
+    predictTo(timestampMs);
+    // No gate until GPS has pinned the offset once: the prior may be hundreds of metres out
+    bool gated = _estimate.gps_updates > 0 && _consecutiveGpsRejects < GPS_REJECTS_BEFORE_RESYNC;
+    if (update(H_GPS, altitudeM, _config.gps_noise_m * _config.gps_noise_m, gated ? _config.gps_gate_sigma : 0.0f)) {
+        _estimate.gps_updates++;
+        _consecutiveGpsRejects = 0;
+        if (_estimate.gps_updates == 1) {
+            _ascentReferenceM = _x[0]; // The first fix moves the datum, it is not a climb
+        }
+    } else {
+        _estimate.gps_rejected++;
+        _consecutiveGpsRejects++;
+    }
+    publish((int32_t)(_timeMs - previousMs) * 0.001f);
+}
+
+void ElevationFilter::publish(float dtS) {
+    _estimate.valid = true;
+    _estimate.elevation_m = _x[0];
+    _estimate.vertical_speed_mps = _x[1];
+    _estimate.baro_offset_m = _x[2];
+    _estimate.elevation_sigma_m = sqrtf(_p[0][0] > 0.0f ? _p[0][0] : 0.0f);
+
+    float gradient = 0.0f;
+    if (_groundSpeedMps >= _config.gradient_min_speed_mps) {
+        gradient = 100.0f * _x[1] / _groundSpeedMps;
+    }
+    float alpha = dtS / (_config.gradient_tau_s + dtS);
+    _estimate.gradient_percent += alpha * (gradient - _estimate.gradient_percent);
+
+    // The reference follows the current trend; a reversal only counts past the hysteresis
+    if (_climbing) {
+        if (_x[0] > _ascentReferenceM) {
+            _estimate.ascent_m += _x[0] - _ascentReferenceM;
+            _ascentReferenceM = _x[0];
+        } else if (_x[0] < _ascentReferenceM - _config.ascent_hysteresis_m) {
+            _climbing = false;
+            _ascentReferenceM = _x[0];
+        }
+    } else {
+        if (_x[0] < _ascentReferenceM) {
+            _ascentReferenceM = _x[0];
+        } else if (_x[0] > _ascentReferenceM + _config.ascent_hysteresis_m) {
+            _climbing = true;
+            _estimate.ascent_m += _x[0] - _ascentReferenceM;
+            _ascentReferenceM = _x[0];
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#include "event_log.h"
+#include "config.h"
+#include <cstring> // For memcpy
+
+static QueueHandle_t s_eventQueue = NULL;
+static volatile uint32_t s_eventsDropped = 0;
+
+bool initializeEventLog() {
+    if (s_eventQueue == NULL) {
+        s_eventQueue = xQueueCreate(EVENT_LOG_QUEUE_DEPTH, sizeof(EventRecord));
+    }
+    return s_eventQueue != NULL;
+}
+
+bool eventLogPost(EventType type, const void* payload, uint16_t length) {
+    if (s_eventQueue == NULL || length > EVENT_PAYLOAD_MAX) {
+        s_eventsDropped++;
+        return false;
+    }
+    EventRecord record;
+    record.timestamp_ms = millis();
+    record.type = type;
+    record.length = length;
+    memcpy(record.payload, payload, length);
+    memset(record.payload + length, 0, EVENT_PAYLOAD_MAX - length);
+    if (xQueueSend(s_eventQueue, &record, 0) != pdTRUE) {
+        s_eventsDropped++;
+        return false;
+    }
+    return true;
+}
+
+size_t eventLogRead(EventRecord* out, size_t maxRecords, TickType_t timeout) {
+    if (s_eventQueue == NULL || maxRecords == 0) {
+        return 0;
+    }
+    size_t count = 0;
+    if (xQueueReceive(s_eventQueue, &out[count], timeout) == pdTRUE) {
+        count++;
+        while (count < maxRecords && xQueueReceive(s_eventQueue, &out[count], 0) == pdTRUE) {
+            count++;
+        }
+    }
+    return count;
+}
+
+uint32_t eventLogDropped() {
+    return s_eventsDropped;
+}
+
+uint32_t eventLogPending() {
+    return s_eventQueue != NULL ? uxQueueMessagesWaiting(s_eventQueue) : 0;
+}
@@ -0,0 +1,86 @@
+#include "fir_decimator.h"
+#include <math.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#include "esp_dsp.h" // dsps_dotprod_f32 (ESP32-S3 SIMD implementation selected automatically)
+#endif
+
+static inline void dotProduct(const float* a, const float* b, float* out, int len) {
+#ifdef ARDUINO
+    dsps_dotprod_f32(a, b, out, len);
+#else
+    float acc = 0.0f;
+    for (int i = 0; i < len; i++) acc += a[i] * b[i];
+    *out = acc;
+#endif
+}
+
+void firDesignLowpass(float* taps, int numTaps, float cutoff) {
+    const double pi = 3.14159265358979323846;
+    const double center = (numTaps - 1) / 2.0;
+    double sum = 0.0;
+    for (int n = 0; n < numTaps; n++) {
+        double x = n - center;
+        double sinc = (x == 0.0) ? 2.0 * cutoff : sin(2.0 * pi * cutoff * x) / (pi * x);
+        double window = 0.42 - 0.5 * cos(2.0 * pi * n / (numTaps - 1)) + 0.08 * cos(4.0 * pi * n / (numTaps - 1));
+        taps[n] = (float)(sinc * window);
+        sum += taps[n];
+    }
+    for (int n = 0; n < numTaps; n++) {
+        taps[n] = (float)(taps[n] / sum); // Unity gain at DC
+    }
+}
+
+void firDecimatorRefInit(FirDecimatorRef* fir, const float* taps, float* delay, int numTaps, int decim) {
+    fir->taps = taps;
+    fir->delay = delay;
+    fir->numTaps = numTaps;
+    fir->decim = decim;
+    fir->pos = 0;
+    for (int i = 0; i < numTaps; i++) {
+        delay[i] = 0.0f;
+    }
+}
+
+int firDecimatorRefProcess(FirDecimatorRef* fir, const float* in, float* out, int outLen) {
+    for (int i = 0; i < outLen; i++) {
+        for (int k = 0; k < fir->decim; k++) {
+            fir->delay[fir->pos++] = *in++;
+            if (fir->pos >= fir->numTaps) fir->pos = 0;
+        }
+        // Oldest sample (at pos) meets the last tap, newest meets taps[0]
+        float acc = 0.0f;
+        int tap = fir->numTaps - 1;
+        for (int n = fir->pos; n < fir->numTaps; n++) acc += fir->taps[tap--] * fir->delay[n];
+        for (int n = 0; n < fir->pos; n++) acc += fir->taps[tap--] * fir->delay[n];
+        out[i] = acc;
+    }
+    return outLen;
+}
+
+void firDecimatorInit(FirDecimator* fir, const float* tapsReversed, float* history, int historyLen, int numTaps,
+                      int decim) {
+    fir->tapsReversed = tapsReversed;
+    fir->numTaps = numTaps;
+    fir->decim = decim;
+    fir->history = history;
+    fir->pending = 0;
+    memset(history, 0, historyLen * sizeof(float));
+}
+
+int firDecimatorProcess(FirDecimator* fir, const float* in, int count, float* out) {
+    memcpy(fir->history + fir->numTaps - 1 + fir->pending, in, count * sizeof(float));
+    fir->pending += count;
+    int outputs = fir->pending / fir->decim;
+    for (int j = 0; j < outputs; j++) {
+        // Window ends at the last input of period j; it starts numTaps - 1 samples earlier
+        dotProduct(fir->history + (j + 1) * fir->decim - 1, fir->tapsReversed, &out[j], fir->numTaps);
+    }
+    // Keep numTaps - 1 samples of history plus any inputs not yet covering a full period
+    int consumed = outputs * fir->decim;
+    int keep = fir->numTaps - 1 + (fir->pending - consumed);
+    memmove(fir->history, fir->history + consumed, keep * sizeof(float));
+    fir->pending -= consumed;
+    return outputs;
+}
@@ -0,0 +1,77 @@
+#include "frame_codec.h"
+#include <string.h>
+
+uint32_t crc32Update(uint32_t crc, const void* data, size_t len) {
+    static uint32_t table[256];
+    static bool tableReady = false;
+    if (!tableReady) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            table[i] = c;
+        }
+        tableReady = true; // Benign race: concurrent first callers compute identical tables
+    }
+    const uint8_t* p = (const uint8_t*)data;
+    crc = ~crc;
+    while (len--) {
+        crc = table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+size_t cobsEncode(const uint8_t* in, size_t len, uint8_t* out) {
+    size_t codeIndex = 0;
+    size_t outIndex = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] == 0) {
+            out[codeIndex] = code;
+            codeIndex = outIndex++;
+            code = 1;
+        } else {
+            out[outIndex++] = in[i];
+            code++;
+            if (code == 0xFF) {
+                out[codeIndex] = code;
+                codeIndex = outIndex++;
+                code = 1;
+            }
+        }
+    }
+    out[codeIndex] = code;
+    return outIndex;
+}
+
+size_t cobsDecode(const uint8_t* in, size_t len, uint8_t* out) {
+    size_t inIndex = 0;
+    size_t outIndex = 0;
+    while (inIndex < len) {
+        uint8_t code = in[inIndex++];
+        if (code == 0 || inIndex + code - 1 > len) {
+            return 0;
+        }
+        for (uint8_t i = 1; i < code; i++) {
+            out[outIndex++] = in[inIndex++];
+        }
+        if (code < 0xFF && inIndex < len) {
+            out[outIndex++] = 0;
+        }
+    }
+    return outIndex;
+}
+
+size_t frameEncode(uint8_t type, uint16_t seq, const void* payload, uint16_t length, uint8_t* scratch, uint8_t* out) {
+    FrameHeader header = { type, 0, seq, length };
+    memcpy(scratch, &header, FRAME_HEADER_SIZE);
+    if (length > 0) {
+        memcpy(scratch + FRAME_HEADER_SIZE, payload, length);
+    }
+    uint32_t crc = crc32Update(0, scratch, FRAME_HEADER_SIZE + length);
+    memcpy(scratch + FRAME_HEADER_SIZE + length, &crc, FRAME_CRC_SIZE); // Little-endian on both ends
+    size_t encoded = cobsEncode(scratch, FRAME_HEADER_SIZE + length + FRAME_CRC_SIZE, out);
+    out[encoded++] = 0x00;
+    return encoded;
+}
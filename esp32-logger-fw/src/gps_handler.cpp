@@ -2,14 +2,26 @@
 #include "shared_state.h" // Added for g_debugSettings
 #include "gps_data.h" // For GpsData struct and g_gpsData externs
 #include "config.h"   // For GPS_RX_PIN, GPS_TX_PIN if used directly (or through defines below)
+#include "DisplayUpdateTask.h" // For displayNotifyDataChanged()
+#include "segment_gates.h"     // Gate index and lap/segment timing
+#include "sd_card.h"           // Gate definitions are read from the card
+#include "event_log.h"         // Gate crossings are logged as events
+#include "telemetry_stream.h"  // Live binary stream
+#include "trace.h"             // Stall tracing
+#include "I2cBusManager.h"     // Cached BME280 pressure
+#include "power_manager.h"     // UART wake-up and light-sleep lock
+#include "mem_placement.h"     // Gate index and track storage in PSRAM
+#include "nmea_parser.h"       // RMC/GGA parsing (shared with the host replay)
+#include "raw_capture.h"       // UART bytes and pressure for raw capture
 
 #include <Arduino.h>
 #include <HardwareSerial.h> // For Serial2
-#include <Adafruit_GPS.h>   // Adafruit GPS library
+#include <Adafruit_GPS.h>   // Adafruit GPS library (PMTK configuration commands)
 
 // Define GPS UART settings
 // #define GPS_SERIAL_NUM 2 // Using Serial2 - Serial2 is directly used
 #define GPS_BAUD_RATE 9600 // Default baud rate, user to verify from datasheet
+#define GPS_UART_READ_BYTES 128 // UART bytes taken per read (~130 ms at 9600 baud)
 
 // Use pins from config.h. These are already defined there.
 // #define GPS_RX_PIN_CONFIG GPS_RX_PIN // GPIO18 in config.h
@@ -20,17 +32,227 @@
 GpsData g_gpsData; // Definition of the global GPS data structure
 SemaphoreHandle_t g_gpsDataMutex; // Definition of the global GPS data mutex
 
-Adafruit_GPS GPS(&Serial2); // Adafruit GPS object using Serial2
+Adafruit_GPS GPS(&Serial2); // Adafruit GPS object using Serial2; sends the PMTK setup commands
+static NmeaParser s_nmea;   // Parses what the module sends back; only the GPS task feeds it
+static uint8_t s_uartBlock[GPS_UART_READ_BYTES]; // GPS task only
+
+SegmentState g_segmentState;
+
+// Gate index storage lives in PSRAM when available (10,000 gates is a few hundred KB). It is rebuilt
+// when gates change, so it comes from the PSRAM heap rather than the permanent arena.
+static void* gateAlloc(size_t bytes) {
+    void* p = memRegionMalloc(MEM_REGION_PSRAM, bytes);
+    return p != nullptr ? p : malloc(bytes);
+}
+
+static GateIndex s_gateIndex(GATE_CELL_SIZE_M, GATE_HASH_BUCKETS, gateAlloc, free);
+static SegmentTimer s_segmentTimer(GATE_MIN_LAP_MS);
+
+// Breadcrumb trail for the map screen; guarded by g_gpsDataMutex. Touched at 1 Hz and by the map redraw.
+MEM_BULK static TrackPoint s_trackPoints[TRACK_MAX_POINTS];
+MEM_PLACED(s_trackPoints, MEM_REGION_PSRAM);
+static TrackPoint s_trackPending[TRACK_PENDING_FIXES];
+static BreadcrumbTrack s_track(s_trackPoints, TRACK_MAX_POINTS, s_trackPending, TRACK_PENDING_FIXES, TRACK_TOLERANCE_DM);
+
+uint32_t gpsTrackRead(uint32_t from, TrackPoint* out, uint32_t maxPoints, GpsTrackInfo* info) {
+    uint32_t copied = 0;
+    if (TRACE_MUTEX_TAKE(g_gpsDataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        info->count = s_track.count();
+        info->generation = s_track.generation();
+        info->tolerance_dm = s_track.toleranceDm();
+        s_track.bounds(&info->min_x, &info->min_y, &info->max_x, &info->max_y);
+        while (from + copied < info->count && copied < maxPoints) {
+            out[copied] = s_track.points()[from + copied];
+            copied++;
+        }
+        TRACE_MUTEX_GIVE(g_gpsDataMutex);
+    } else {
+        memset(info, 0, sizeof(*info));
+    }
+    return copied;
+}
+
+// Fused elevation: only the GPS task runs the filter; s_elevationEstimate is published under s_elevationMux
+static ElevationFilter s_elevation({ ELEVATION_ACCEL_NOISE_MPS2, ELEVATION_BARO_NOISE_M, ELEVATION_GPS_NOISE_M,
+                                     ELEVATION_OFFSET_DRIFT_M, ELEVATION_GPS_GATE_SIGMA, ELEVATION_GRADIENT_TAU_S,
+                                     ELEVATION_GRADIENT_MIN_SPEED_MPS, ELEVATION_ASCENT_HYSTERESIS_M });
+static ElevationEstimate s_elevationEstimate;
+static portMUX_TYPE s_elevationMux = portMUX_INITIALIZER_UNLOCKED;
+static unsigned long s_lastPressureMillis = 0;
+
+static void publishElevation() {
+    ElevationEstimate estimate;
+    s_elevation.getEstimate(&estimate);
+    portENTER_CRITICAL(&s_elevationMux);
+    s_elevationEstimate = estimate;
+    portEXIT_CRITICAL(&s_elevationMux);
+}
+
+// Feeds each new BME280 reading (polled by the I2C bus manager at I2C_BME280_POLL_MS) once
+static void serviceBarometer() {
+    I2cSensorCache cache;
+    i2cGetSensorCache(&cache);
+    if (!cache.bme_valid || cache.bme_update_millis == s_lastPressureMillis) {
+        return;
+    }
+    s_lastPressureMillis = cache.bme_update_millis;
+    rawCaptureAppend(cache.bme_update_millis, CAPTURE_PRESSURE, &cache.bme_pressure_pa, sizeof(cache.bme_pressure_pa));
+    s_elevation.addPressure(cache.bme_update_millis, cache.bme_pressure_pa);
+    publishElevation();
+}
+
+void gpsGetElevation(ElevationEstimate* out) {
+    portENTER_CRITICAL(&s_elevationMux);
+    *out = s_elevationEstimate;
+    portEXIT_CRITICAL(&s_elevationMux);
+}
+
+// Previous fix in the gate index's metric frame
+static bool s_havePreviousFix = false;
+static float s_previousX = 0.0f, s_previousY = 0.0f;
+static uint32_t s_previousFixMs = 0;
+static uint32_t s_gpsTimeMs = 0; // Continuous GPS time of the latest fix (gateContinuousTimeMs)
+
+// Parses one gate line: segment_id,kind,lat1,lon1,lat2,lon2 (kind is S, F or L). '#' starts a comment.
+static bool parseGateLine(char* line, GateDef* def) {
+    if (line[0] == '#' || line[0] == '\0' || line[0] == '\r' || line[0] == '\n') {
+        return false;
+    }
+    char* saveptr;
+    char* fields[6];
+    char* token = strtok_r(line, ",", &saveptr);
+    int n = 0;
+    while (token != NULL && n < 6) {
+        fields[n++] = token;
+        token = strtok_r(NULL, ",", &saveptr);
+    }
+    if (n < 6) {
+        return false;
+    }
+    switch (fields[1][0]) {
+        case 'S': def->kind = GATE_START; break;
+        case 'F': def->kind = GATE_FINISH; break;
+        case 'L': def->kind = GATE_LAP; break;
+        default: return false;
+    }
+    def->segment_id = atoi(fields[0]);
+    def->lat1 = strtod(fields[2], NULL);
+    def->lon1 = strtod(fields[3], NULL);
+    def->lat2 = strtod(fields[4], NULL);
+    def->lon2 = strtod(fields[5], NULL);
+    return true;
+}
+
+// Two passes over the file: count, then parse into a temporary PSRAM array handed to the index.
+static void loadSegmentGates() {
+    if (!sdCardBegin() || !sdCardLock(pdMS_TO_TICKS(1000))) {
+        Serial.println("GPS Handler: no SD card, segment gates disabled.");
+        return;
+    }
+    FsFile file = sdCardFs().open(GATES_FILE_PATH, O_RDONLY);
+    if (!file) {
+        sdCardUnlock();
+        Serial.println("GPS Handler: " GATES_FILE_PATH " not found, segment gates disabled.");
+        return;
+    }
+
+    char line[128];
+    uint32_t lines = 0;
+    while (file.fgets(line, sizeof(line)) > 0) {
+        lines++;
+    }
+    GateDef* defs = lines > 0 ? (GateDef*)gateAlloc(lines * sizeof(GateDef)) : nullptr;
+    uint32_t count = 0;
+    if (defs != nullptr) {
+        file.rewind();
+        while (count < lines && file.fgets(line, sizeof(line)) > 0) {
+            if (parseGateLine(line, &defs[count])) {
+                count++;
+            }
+        }
+    }
+    file.close();
+    sdCardUnlock();
+
+    bool built = count > 0 && s_gateIndex.build(defs, count);
+    free(defs);
+    if (!built) {
+        Serial.printf("GPS Handler: no usable gates in " GATES_FILE_PATH " (%lu lines).\n", (unsigned long)lines);
+        return;
+    }
+    if (TRACE_MUTEX_TAKE(g_gpsDataMutex, portMAX_DELAY) == pdTRUE) {
+        g_segmentState.gate_count = count;
+        TRACE_MUTEX_GIVE(g_gpsDataMutex);
+    }
+    Serial.printf("GPS Handler: %lu segment gates loaded.\n", (unsigned long)count);
+}
+
+// Tests the movement since the previous fix against the gates along it. Fixes are timed by the
+// receiver's UTC epoch, not by when the sentence got through the UART and parser.
+static void matchSegmentGates(double latitude, double longitude, uint32_t utcTimeOfDayMs) {
+    if (s_gateIndex.gateCount() == 0) {
+        return;
+    }
+    uint32_t fixMs = gateContinuousTimeMs(s_gpsTimeMs, utcTimeOfDayMs);
+    if (s_havePreviousFix && fixMs == s_previousFixMs) {
+        return; // Same fix reported by another sentence (RMC and GGA)
+    }
+    s_gpsTimeMs = fixMs;
+    float x, y;
+    s_gateIndex.project(latitude, longitude, &x, &y);
+
+    bool changed = false;
+    if (s_havePreviousFix) {
+        GateCrossing crossings[4];
+        size_t found = s_gateIndex.findCrossings(s_previousX, s_previousY, s_previousFixMs, x, y, fixMs,
+                                                 crossings, sizeof(crossings) / sizeof(crossings[0]));
+        for (size_t i = 0; i < found; i++) {
+            SegmentResult result;
+            GateCrossingEvent event;
+            event.segment_id = crossings[i].segment_id;
+            event.kind = crossings[i].kind;
+            event.crossing_ms = crossings[i].time_ms;
+            event.elapsed_ms = s_segmentTimer.onCrossing(crossings[i], &result) ? result.elapsed_ms : 0;
+            eventLogPost(EVENT_GATE_CROSSING, &event, sizeof(event));
+            changed = true;
+        }
+    }
+    s_havePreviousFix = true;
+    s_previousX = x;
+    s_previousY = y;
+    s_previousFixMs = fixMs;
+
+    if (TRACE_MUTEX_TAKE(g_gpsDataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        g_segmentState.gps_clock_offset_ms = (int32_t)(fixMs - (uint32_t)millis());
+        if (changed) {
+            g_segmentState.timer = s_segmentTimer.status();
+        }
+        TRACE_MUTEX_GIVE(g_gpsDataMutex);
+    }
+}
+
+static TaskHandle_t s_gpsTaskHandle = NULL;
+static bool s_uartLockHeld = false;
+static unsigned long s_lastCharMillis = 0;
+
+// Runs in the UART driver's event task
+static void gpsUartReceived() {
+    if (s_gpsTaskHandle != NULL) {
+        xTaskNotifyGive(s_gpsTaskHandle);
+    }
+}
 
 // Initialization function for GPS module specific commands (e.g., update rate)
 // This will be called once from the gpsTask.
 static void initializeGpsModule() {
     // Initialize Serial2 for GPS communication
     Serial2.begin(GPS_BAUD_RATE, SERIAL_8N1, GPS_RX_PIN, GPS_TX_PIN);
-    Serial.println("GPS Handler: Serial2 initialized with pins RX=" + String(GPS_RX_PIN) + ", TX=" + String(GPS_TX_PIN) + " at " + String(GPS_BAUD_RATE) + " baud.");
+    Serial.printf("GPS Handler: Serial2 initialized with pins RX=%d, TX=%d at %d baud.\n", GPS_RX_PIN, GPS_TX_PIN, GPS_BAUD_RATE);
 
     // Initialize Adafruit_GPS library
     GPS.begin(GPS_BAUD_RATE); // Initialize library's internal state for the baud rate
+    Serial2.onReceive(gpsUartReceived); // FIFO threshold or end of a burst (RX timeout)
+    powerEnableUartWakeup(UART_NUM_2);
 
     // Configure GPS module
     GPS.sendCommand(PMTK_SET_NMEA_OUTPUT_RMCGGA); // Request RMC and GGA sentences
@@ -43,108 +265,155 @@ static void initializeGpsModule() {
     // delay(100); // Usually not strictly necessary for these commands
 }
 
+// Handles one complete NMEA sentence; `type` is what the parser made of it
+static void processNmeaSentence(NmeaSentenceType type) {
+    // Conditional printing for each received sentence
+    if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
+        if (g_debugSettings.gpsDebugStreamOn) {
+            Serial.println("GPS DEBUG: NMEA sentence received.");
+        }
+        xSemaphoreGive(g_debugSettingsMutex);
+    }
+
+    const NmeaFix& fix = s_nmea.fix();
+
+    // Conditional printing for the NMEA sentence itself
+    if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
+        if (g_debugSettings.gpsDebugStreamOn) {
+            // Serial.print("NMEA: "); Serial.println(s_nmea.lastSentence());
+        }
+        xSemaphoreGive(g_debugSettingsMutex);
+    }
+
+    if (type != NMEA_INVALID) {
+        // Conditional printing for "NMEA sentence PARSED successfully"
+        if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
+            if (g_debugSettings.gpsDebugStreamOn) {
+                Serial.println("GPS DEBUG: NMEA sentence PARSED successfully!");
+            }
+            xSemaphoreGive(g_debugSettingsMutex);
+        }
+        if (TRACE_MUTEX_TAKE(g_gpsDataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            GpsReading reading = nmeaGpsReading(fix); // Same mapping as the host replay's record inputs
+            g_gpsData.is_valid = reading.valid;
+            g_gpsData.latitude = reading.latitude_deg;
+            g_gpsData.longitude = reading.longitude_deg;
+            g_gpsData.altitude_meters = reading.altitude_m;
+            g_gpsData.speed_mps = reading.speed_mps;
+            g_gpsData.satellites = reading.satellites; // Still useful to know how many sats are visible without a fix
+            g_gpsData.fix_quality = reading.fix_quality;
+            if (reading.valid) {
+                s_track.addFix(fix.latitude_deg, fix.longitude_deg); // Bounded cost; repeats are filtered
+            }
+            g_gpsData.last_update_millis = millis();
+
+            TRACE_MUTEX_GIVE(g_gpsDataMutex);
+            displayNotifyDataChanged(); // GPS screen has fresh data to show
+
+            if (fix.fix) {
+                matchSegmentGates(fix.latitude_deg, fix.longitude_deg, fix.utc_time_ms);
+                if (type == NMEA_GGA) { // Altitude only comes with GGA; RMC repeats it
+                    s_elevation.addGps(millis(), fix.altitude_m, fix.speed_knots * NMEA_KNOTS_TO_MPS);
+                    publishElevation();
+                }
+                if (telemetryEnabled()) {
+                    TelemetryGps telemetry;
+                    telemetry.timestamp_ms = millis();
+                    telemetry.latitude = fix.latitude_deg;
+                    telemetry.longitude = fix.longitude_deg;
+                    telemetry.altitude_m = fix.altitude_m;
+                    telemetry.speed_mps = fix.speed_knots * NMEA_KNOTS_TO_MPS;
+                    telemetry.satellites = fix.satellites;
+                    telemetry.fix_quality = fix.fix_quality;
+                    telemetryPublish(TELEM_GPS, &telemetry, sizeof(telemetry));
+                }
+            } else {
+                s_havePreviousFix = false; // Never interpolate across a lost fix
+            }
+
+            // Conditional printing for parsed GPS data
+            if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
+                if (g_debugSettings.gpsDebugStreamOn) {
+                    Serial.printf("GPS DEBUG: g_gpsData updated. Fix: %d, Q: %d, Sats: %d, Lat: %f, Lon: %f, Alt: %.1f, Spd: %.1f\n",
+                                  (int)fix.fix, (int)fix.fix_quality, (int)fix.satellites,
+                                  fix.latitude_deg, fix.longitude_deg, fix.altitude_m, fix.speed_knots * NMEA_KNOTS_TO_MPS);
+                }
+                xSemaphoreGive(g_debugSettingsMutex);
+            }
+        } else {
+            // This is an operational message, not a continuous stream, so leave as is or make conditional if desired
+            Serial.println("GPS DEBUG: Failed to take g_gpsDataMutex to update g_gpsData.");
+        }
+    } else {
+        // Conditional printing for "NMEA sentence FAILED to parse"
+        if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
+            if (g_debugSettings.gpsDebugStreamOn) {
+                Serial.println("GPS DEBUG: NMEA sentence FAILED to parse.");
+                // Optional: Print the sentence that failed to parse
+                // Serial.print("Failed NMEA: "); Serial.println(s_nmea.lastSentence());
+            }
+            xSemaphoreGive(g_debugSettingsMutex);
+        }
+    }
+}
+
 void gpsTask(void *pvParameters) {
     Serial.println("GPS Task started.");
+    s_gpsTaskHandle = xTaskGetCurrentTaskHandle();
     initializeGpsModule();
+    loadSegmentGates();
 
     for (;;) {
+        TRACE_BEGIN(TRACE_GPS_LOOP);
         // GPS Task Loop Alive and Serial2 Available messages are general debug, not continuous stream
         // Serial.println("GPS Task Loop Alive");
         // Serial.printf("GPS Serial2 Available (Before Read Loop): %d\n", Serial2.available());
 
+        // Read in blocks: raw capture stores each block as one chunk, and the per-byte work is the
+        // parser alone (none at all in capture-only mode)
         bool char_read_this_cycle = false;
-        while (Serial2.available() > 0) {
-            char c = GPS.read();
+        int available;
+        while ((available = Serial2.available()) > 0) {
+            size_t n = Serial2.read(s_uartBlock, min((size_t)available, sizeof(s_uartBlock)));
+            if (n == 0) {
+                break;
+            }
             char_read_this_cycle = true;
+            rawCaptureAppend(millis(), CAPTURE_NMEA, s_uartBlock, n);
             // Conditional printing for raw NMEA character stream
             if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
                 if (g_debugSettings.gpsDebugStreamOn) {
-                    // Serial.print(c); // Example: If you want to print raw NMEA stream
+                    // Serial.write(s_uartBlock, n); // Example: If you want to print raw NMEA stream
                 }
                 xSemaphoreGive(g_debugSettingsMutex);
             }
-        }
-
-        if (GPS.newNMEAreceived()) {
-            // Conditional printing for "newNMEAreceived"
-            if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
-                if (g_debugSettings.gpsDebugStreamOn) {
-                    Serial.println("GPS DEBUG: newNMEAreceived() is TRUE.");
-                }
-                xSemaphoreGive(g_debugSettingsMutex);
+            if (!rawCaptureDecoding()) {
+                continue;
             }
-
-            char *lastNmeaSentence = GPS.lastNMEA();
-
-            // Conditional printing for the NMEA sentence itself
-            if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
-                if (g_debugSettings.gpsDebugStreamOn) {
-                    // Serial.print("NMEA: "); Serial.println(lastNmeaSentence);
+            // A wake-up can deliver several sentences; handle each as it completes
+            for (size_t i = 0; i < n; i++) {
+                NmeaSentenceType type = s_nmea.feed((char)s_uartBlock[i]);
+                if (type != NMEA_NONE) {
+                    processNmeaSentence(type);
                 }
-                xSemaphoreGive(g_debugSettingsMutex);
             }
+        }
 
-            if (GPS.parse(lastNmeaSentence)) {
-                // Conditional printing for "NMEA sentence PARSED successfully"
-                if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
-                    if (g_debugSettings.gpsDebugStreamOn) {
-                        Serial.println("GPS DEBUG: NMEA sentence PARSED successfully!");
-                    }
-                    xSemaphoreGive(g_debugSettingsMutex);
-                }
-                if (xSemaphoreTake(g_gpsDataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                    g_gpsData.is_valid = GPS.fix;
-
-                    if (g_gpsData.is_valid) {
-                        g_gpsData.latitude = GPS.latitudeDegrees;
-                        g_gpsData.longitude = GPS.longitudeDegrees;
-                        g_gpsData.altitude_meters = GPS.altitude;
-                        g_gpsData.speed_mps = GPS.speed * 0.514444f;
-                        g_gpsData.satellites = GPS.satellites;
-                        g_gpsData.fix_quality = GPS.fixquality;
-                    } else {
-                        // Keep old data or clear some fields if no fix
-                        g_gpsData.latitude = 0.0; // Or keep stale data
-                        g_gpsData.longitude = 0.0; // Or keep stale data
-                        g_gpsData.altitude_meters = 0.0f;
-                        g_gpsData.speed_mps = 0.0f;
-                        g_gpsData.satellites = GPS.satellites; // Still useful to know how many sats are visible
-                        g_gpsData.fix_quality = 0; // No fix
-                    }
-                    g_gpsData.last_update_millis = millis();
-
-                    xSemaphoreGive(g_gpsDataMutex);
-
-                    // Conditional printing for parsed GPS data
-                    if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
-                        if (g_debugSettings.gpsDebugStreamOn) {
-                            Serial.printf("GPS DEBUG: g_gpsData updated. Fix: %d, Q: %d, Sats: %d, Lat: %f, Lon: %f, Alt: %.1f, Spd: %.1f\n",
-                                          (int)GPS.fix, (int)GPS.fixquality, (int)GPS.satellites,
-                                          GPS.latitudeDegrees, GPS.longitudeDegrees, GPS.altitude, GPS.speed * 0.514444f);
-                        }
-                        xSemaphoreGive(g_debugSettingsMutex);
-                    }
-                } else {
-                    // This is an operational message, not a continuous stream, so leave as is or make conditional if desired
-                    Serial.println("GPS DEBUG: Failed to take g_gpsDataMutex to update g_gpsData.");
-                }
-            } else {
-                // Conditional printing for "NMEA sentence FAILED to parse"
-                if (xSemaphoreTake(g_debugSettingsMutex, (TickType_t)10) == pdTRUE) {
-                    if (g_debugSettings.gpsDebugStreamOn) {
-                        Serial.println("GPS DEBUG: NMEA sentence FAILED to parse.");
-                        // Optional: Print the sentence that failed to parse
-                        // Serial.print("Failed NMEA: "); Serial.println(lastNmeaSentence);
-                    }
-                    xSemaphoreGive(g_debugSettingsMutex);
-                }
+        // Keep light sleep away while NMEA is streaming; UART wake-up restarts it after a pause
+        if (char_read_this_cycle) {
+            s_lastCharMillis = millis();
+            if (!s_uartLockHeld) {
+                powerLockAcquire(POWER_LOCK_GPS_UART);
+                s_uartLockHeld = true;
             }
+        } else if (s_uartLockHeld && millis() - s_lastCharMillis > POWER_GPS_IDLE_MS) {
+            powerLockRelease(POWER_LOCK_GPS_UART);
+            s_uartLockHeld = false;
         }
-        // No 'else' here for newNMEAreceived() being false, to reduce log spam.
-        // We are primarily interested in what happens when a sentence *is* supposedly received.
-        // unsigned long chars_read_in_while_loop = 0; // if you implement counting inside while
-        // Serial.printf("GPS Serial2 Available (After Read Loop): %d, Chars Read This Iter: %lu\n", Serial2.available(), chars_read_in_while_loop); // DEBUG
 
-        vTaskDelay(pdMS_TO_TICKS(1));
+        serviceBarometer();
+
+        TRACE_END(TRACE_GPS_LOOP);
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(GPS_WAIT_MS)); // Woken by the UART driver when data arrives
     }
 }
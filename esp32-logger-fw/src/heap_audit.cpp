@@ -0,0 +1,202 @@
+#include "heap_audit.h"
+#include "config.h"
+#include <esp_heap_caps.h>
+#include <string.h>
+
+#define SOAK_WINDOW_MS 60000UL
+#define ACTIVITY_REPORT_INTERVAL_MS 60000UL
+
+static HeapAuditStats s_stats;
+static portMUX_TYPE s_auditMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Soak and reporting state, touched only by the task calling heapAuditService()
+static uint16_t s_soakMinutes = 0;
+static uint16_t s_soakMinute = 0;
+static uint16_t s_soakDirtyMinutes = 0;
+static uint32_t s_soakWindowStartMs = 0;
+static uint32_t s_soakWindowStartCount = 0;
+static uint32_t s_reportedAllocations = 0;
+static uint32_t s_lastReportMs = 0;
+
+#ifdef ENABLE_HEAP_AUDIT
+
+static void IRAM_ATTR recordAllocation(size_t size, void* result, void* caller) {
+    portENTER_CRITICAL_SAFE(&s_auditMux);
+    s_stats.allocations++;
+    s_stats.bytes += size;
+    if (result == NULL && size > 0) {
+        s_stats.failures++;
+    }
+    if (s_stats.steady) {
+        // Details only after the marker: the boot-time flood is expected, and before the
+        // scheduler starts there is no current task to name
+        s_stats.last_caller = (uint32_t)caller;
+        const char* name = xPortInIsrContext() ? "" : pcTaskGetName(NULL);
+        strncpy(s_stats.last_task, name, sizeof(s_stats.last_task) - 1);
+    }
+    portEXIT_CRITICAL_SAFE(&s_auditMux);
+}
+
+static void IRAM_ATTR recordFree(void* ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    portENTER_CRITICAL_SAFE(&s_auditMux);
+    s_stats.frees++;
+    portEXIT_CRITICAL_SAFE(&s_auditMux);
+}
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void* __real_heap_caps_malloc(size_t size, uint32_t caps);
+void* __real_heap_caps_calloc(size_t n, size_t size, uint32_t caps);
+void* __real_heap_caps_realloc(void* ptr, size_t size, uint32_t caps);
+void __real_heap_caps_free(void* ptr);
+
+void* IRAM_ATTR __wrap_malloc(size_t size) {
+    void* result = __real_malloc(size);
+    recordAllocation(size, result, __builtin_return_address(0));
+    return result;
+}
+
+void* IRAM_ATTR __wrap_calloc(size_t n, size_t size) {
+    void* result = __real_calloc(n, size);
+    recordAllocation(n * size, result, __builtin_return_address(0));
+    return result;
+}
+
+void* IRAM_ATTR __wrap_realloc(void* ptr, size_t size) {
+    void* result = __real_realloc(ptr, size);
+    recordAllocation(size, result, __builtin_return_address(0));
+    return result;
+}
+
+void* IRAM_ATTR __wrap_heap_caps_malloc(size_t size, uint32_t caps) {
+    void* result = __real_heap_caps_malloc(size, caps);
+    recordAllocation(size, result, __builtin_return_address(0));
+    return result;
+}
+
+void* IRAM_ATTR __wrap_heap_caps_calloc(size_t n, size_t size, uint32_t caps) {
+    void* result = __real_heap_caps_calloc(n, size, caps);
+    recordAllocation(n * size, result, __builtin_return_address(0));
+    return result;
+}
+
+void* IRAM_ATTR __wrap_heap_caps_realloc(void* ptr, size_t size, uint32_t caps) {
+    void* result = __real_heap_caps_realloc(ptr, size, caps);
+    recordAllocation(size, result, __builtin_return_address(0));
+    return result;
+}
+
+void IRAM_ATTR __wrap_heap_caps_free(void* ptr) {
+    recordFree(ptr);
+    __real_heap_caps_free(ptr);
+}
+} // extern "C"
+
+#endif // ENABLE_HEAP_AUDIT
+
+void heapAuditMarkSteadyState() {
+    portENTER_CRITICAL(&s_auditMux);
+    s_stats = HeapAuditStats();
+#ifdef ENABLE_HEAP_AUDIT
+    s_stats.enabled = true;
+    s_stats.steady = true;
+    s_stats.marker_ms = millis();
+#endif
+    portEXIT_CRITICAL(&s_auditMux);
+    s_reportedAllocations = 0;
+    s_lastReportMs = millis();
+}
+
+void heapAuditGetStats(HeapAuditStats* out) {
+    portENTER_CRITICAL(&s_auditMux);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_auditMux);
+#ifdef ENABLE_HEAP_AUDIT
+    out->enabled = true;
+#endif
+}
+
+void heapAuditStartSoak(uint16_t minutes) {
+    HeapAuditStats stats;
+    heapAuditGetStats(&stats);
+    if (!stats.steady) {
+        heapAuditMarkSteadyState();
+        stats.allocations = 0;
+    }
+    s_soakMinutes = minutes;
+    s_soakMinute = 0;
+    s_soakDirtyMinutes = 0;
+    s_soakWindowStartMs = millis();
+    s_soakWindowStartCount = stats.allocations;
+}
+
+void heapAuditService(Print& out) {
+#ifdef ENABLE_HEAP_AUDIT
+    HeapAuditStats stats;
+    heapAuditGetStats(&stats);
+    uint32_t now = millis();
+
+    if (!stats.steady && HEAP_AUDIT_AUTO_MARK_S > 0 && now >= HEAP_AUDIT_AUTO_MARK_S * 1000UL) {
+        heapAuditMarkSteadyState();
+        out.println("Heap audit: steady state marked.");
+        return;
+    }
+
+    if (s_soakMinutes > 0 && now - s_soakWindowStartMs >= SOAK_WINDOW_MS) {
+        uint32_t count = stats.allocations - s_soakWindowStartCount;
+        s_soakMinute++;
+        if (count > 0) {
+            s_soakDirtyMinutes++;
+        }
+        out.printf("Soak %u/%u: %lu allocs\n", s_soakMinute, s_soakMinutes, (unsigned long)count);
+        if (s_soakMinute >= s_soakMinutes) {
+            out.printf("Soak %s: %u of %u minutes clean\n", s_soakDirtyMinutes == 0 ? "PASS" : "FAIL",
+                       s_soakMinutes - s_soakDirtyMinutes, s_soakMinutes);
+            s_soakMinutes = 0;
+        }
+        s_soakWindowStartMs += SOAK_WINDOW_MS;
+        s_soakWindowStartCount = stats.allocations;
+        s_reportedAllocations = stats.allocations; // The soak lines already say it
+        return;
+    }
+
+    // Outside a soak, flag steady-state activity at most once a minute
+    if (stats.steady && stats.allocations != s_reportedAllocations &&
+        now - s_lastReportMs >= ACTIVITY_REPORT_INTERVAL_MS) {
+        out.printf("Heap audit: %lu allocs, last 0x%08lx\n", (unsigned long)(stats.allocations - s_reportedAllocations),
+                   (unsigned long)stats.last_caller);
+        s_reportedAllocations = stats.allocations;
+        s_lastReportMs = now;
+    }
+#else
+    (void)out;
+#endif
+}
+
+void heapAuditPrint(Print& out) {
+    HeapAuditStats stats;
+    heapAuditGetStats(&stats); // Before printing: a long line would count itself
+    if (!stats.enabled) {
+        out.println("Heap audit not compiled in; build the heap_audit environment.");
+        return;
+    }
+    if (stats.steady) {
+        out.printf("Since marker (%lu s ago):\n", (unsigned long)((millis() - stats.marker_ms) / 1000));
+    } else {
+        out.println("Since boot (no marker yet):");
+    }
+    out.printf("  %lu allocs, %lu frees, %lu failed\n", (unsigned long)stats.allocations,
+               (unsigned long)stats.frees, (unsigned long)stats.failures);
+    out.printf("  %llu bytes requested\n", (unsigned long long)stats.bytes);
+    if (stats.steady && stats.allocations > 0) {
+        out.printf("  last 0x%08lx in '%s'\n", (unsigned long)stats.last_caller, stats.last_task);
+    }
+    if (s_soakMinutes > 0) {
+        out.printf("  soak minute %u of %u running\n", s_soakMinute + 1, s_soakMinutes);
+    }
+}
@@ -0,0 +1,233 @@
+#include "http_file_server.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h> // For strncasecmp
+
+static const char* statusText(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 206: return "Partial Content";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 416: return "Range Not Satisfiable";
+        default:  return "Internal Server Error";
+    }
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+size_t httpFindHeadEnd(const char* data, size_t length) {
+    for (size_t i = 3; i < length; i++) {
+        if (data[i - 3] == '\r' && data[i - 2] == '\n' && data[i - 1] == '\r' && data[i] == '\n') {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+// Parses "bytes=first-last", "bytes=first-" or "bytes=-suffix". Multiple ranges are not supported.
+static bool parseRange(const char* value, HttpRequest* out) {
+    while (*value == ' ') value++;
+    if (strncmp(value, "bytes=", 6) != 0) return false;
+    value += 6;
+    if (strchr(value, ',') != NULL) return false; // Serve the whole file instead
+    char* end;
+    if (*value == '-') {
+        out->range_suffix = true;
+        out->range_first = strtoull(value + 1, &end, 10);
+        out->range_last = UINT64_MAX;
+        return end != value + 1;
+    }
+    out->range_suffix = false;
+    out->range_first = strtoull(value, &end, 10);
+    if (end == value || *end != '-') return false;
+    value = end + 1;
+    if (*value == '\0' || *value == '\r') {
+        out->range_last = UINT64_MAX;
+        return true;
+    }
+    out->range_last = strtoull(value, &end, 10);
+    return end != value && out->range_last >= out->range_first;
+}
+
+bool httpParseRequest(const char* head, size_t length, HttpRequest* out) {
+    memset(out, 0, sizeof(*out));
+    const char* lineEnd = (const char*)memchr(head, '\r', length);
+    if (lineEnd == NULL) return false;
+
+    // Request line: METHOD SP target SP version
+    const char* sp1 = (const char*)memchr(head, ' ', lineEnd - head);
+    if (sp1 == NULL || (size_t)(sp1 - head) >= sizeof(out->method)) return false;
+    memcpy(out->method, head, sp1 - head);
+    const char* target = sp1 + 1;
+    const char* sp2 = (const char*)memchr(target, ' ', lineEnd - target);
+    if (sp2 == NULL || *target != '/') return false;
+    const char* query = (const char*)memchr(target, '?', sp2 - target);
+    const char* targetEnd = query != NULL ? query : sp2;
+
+    size_t n = 0;
+    for (const char* p = target; p < targetEnd; p++) {
+        char c = *p;
+        if (c == '%' && p + 2 < targetEnd && hexValue(p[1]) >= 0 && hexValue(p[2]) >= 0) {
+            c = (char)(hexValue(p[1]) * 16 + hexValue(p[2]));
+            p += 2;
+        }
+        if (n + 1 >= sizeof(out->path)) return false;
+        out->path[n++] = c;
+    }
+    out->path[n] = '\0';
+
+    // Headers: only Range matters
+    const char* p = lineEnd + 2;
+    const char* end = head + length;
+    while (p < end) {
+        const char* eol = (const char*)memchr(p, '\r', end - p);
+        if (eol == NULL || eol == p) break;
+        if (eol - p > 6 && strncasecmp(p, "Range:", 6) == 0) {
+            char value[64];
+            size_t valueLen = (size_t)(eol - p - 6) < sizeof(value) - 1 ? (size_t)(eol - p - 6) : sizeof(value) - 1;
+            memcpy(value, p + 6, valueLen);
+            value[valueLen] = '\0';
+            out->has_range = parseRange(value, out);
+        }
+        p = eol + 2;
+    }
+    return true;
+}
+
+HttpFileServer::HttpFileServer(HttpFileSource& source, uint8_t* buffer, size_t bufferSize)
+    : _source(source), _buffer(buffer), _bufferSize(bufferSize) {
+}
+
+bool HttpFileServer::sendHead(HttpByteSink& sink, int status, const char* contentType, uint64_t contentLength,
+                              const char* extraHeaders) {
+    char lengthHeader[40] = "";
+    if (contentLength != UINT64_MAX) {
+        snprintf(lengthHeader, sizeof(lengthHeader), "Content-Length: %llu\r\n", (unsigned long long)contentLength);
+    }
+    int n = snprintf((char*)_buffer, _bufferSize,
+                     "HTTP/1.1 %d %s\r\nContent-Type: %s\r\n%sAccept-Ranges: bytes\r\n%sConnection: close\r\n\r\n",
+                     status, statusText(status), contentType, lengthHeader, extraHeaders ? extraHeaders : "");
+    return n > 0 && (size_t)n < _bufferSize && sink.write(_buffer, n);
+}
+
+void HttpFileServer::sendError(HttpByteSink& sink, int status) {
+    char body[48];
+    int n = snprintf(body, sizeof(body), "%d %s\n", status, statusText(status));
+    if (sendHead(sink, status, "text/plain", n, NULL)) {
+        sink.write((const uint8_t*)body, n);
+    }
+}
+
+HttpTransferResult HttpFileServer::handle(const HttpRequest& request, HttpByteSink& sink) {
+    HttpTransferResult result = { 0, 0 };
+    if (strcmp(request.method, "GET") != 0 && strcmp(request.method, "HEAD") != 0) {
+        sendError(sink, 405);
+        result.status = 405;
+        return result;
+    }
+    if (strcmp(request.path, "/") == 0) {
+        return serveIndex(request, sink);
+    }
+    const char* name = request.path + 1;
+    // Flat directory only: no nested paths, no way out of it
+    if (*name == '\0' || strchr(name, '/') != NULL || strchr(name, '\\') != NULL || strcmp(name, "..") == 0) {
+        sendError(sink, 404);
+        result.status = 404;
+        return result;
+    }
+    return serveFile(request, name, sink);
+}
+
+HttpTransferResult HttpFileServer::serveIndex(const HttpRequest& request, HttpByteSink& sink) {
+    HttpTransferResult result = { 200, 0 };
+    // Length is not known up front; the body ends when the connection closes
+    if (!sendHead(sink, 200, "text/html; charset=utf-8", UINT64_MAX, NULL) || strcmp(request.method, "HEAD") == 0) {
+        return result;
+    }
+    static const char header[] = "<!DOCTYPE html><html><head><title>Logs</title></head><body><h1>Logs</h1><table>\n";
+    if (!sink.write((const uint8_t*)header, sizeof(header) - 1)) return result;
+    if (_source.listBegin()) {
+        char name[64];
+        uint64_t size;
+        while (_source.listNext(name, sizeof(name), &size)) {
+            int n = snprintf((char*)_buffer, _bufferSize, "<tr><td><a href=\"/%s\">%s</a></td><td align=\"right\">%llu</td></tr>\n",
+                             name, name, (unsigned long long)size);
+            if (n <= 0 || (size_t)n >= _bufferSize || !sink.write(_buffer, n)) break;
+        }
+        _source.listEnd();
+    }
+    static const char footer[] = "</table></body></html>\n";
+    sink.write((const uint8_t*)footer, sizeof(footer) - 1);
+    return result;
+}
+
+HttpTransferResult HttpFileServer::serveFile(const HttpRequest& request, const char* name, HttpByteSink& sink) {
+    HttpTransferResult result = { 0, 0 };
+    uint64_t size = 0;
+    if (!_source.open(name, &size)) {
+        sendError(sink, 404);
+        result.status = 404;
+        return result;
+    }
+
+    uint64_t first = 0;
+    uint64_t last = size > 0 ? size - 1 : 0;
+    char extra[80] = "";
+    result.status = 200;
+    if (request.has_range) {
+        if (request.range_suffix) {
+            uint64_t count = request.range_first < size ? request.range_first : size;
+            first = size - count;
+        } else {
+            first = request.range_first;
+            if (request.range_last < last) last = request.range_last;
+        }
+        if (size == 0 || first >= size || (request.range_suffix && request.range_first == 0)) {
+            snprintf(extra, sizeof(extra), "Content-Range: bytes */%llu\r\n", (unsigned long long)size);
+            _source.close();
+            sendHead(sink, 416, "text/plain", 0, extra);
+            result.status = 416;
+            return result;
+        }
+        snprintf(extra, sizeof(extra), "Content-Range: bytes %llu-%llu/%llu\r\n", (unsigned long long)first,
+                 (unsigned long long)last, (unsigned long long)size);
+        result.status = 206;
+    }
+    uint64_t remaining = size > 0 ? last - first + 1 : 0;
+
+    if (!sendHead(sink, result.status, "application/octet-stream", remaining, extra) ||
+        strcmp(request.method, "HEAD") == 0 || remaining == 0) {
+        _source.close();
+        return result;
+    }
+    if (!_source.seek(first)) {
+        _source.close();
+        return result; // Headers already sent; the short body tells the client
+    }
+
+    // First read stops at an alignment boundary so every later read covers whole sectors
+    uint64_t position = first;
+    size_t chunkSize = _bufferSize - (_bufferSize % HTTP_READ_ALIGN);
+    if (chunkSize == 0) chunkSize = _bufferSize;
+    while (remaining > 0) {
+        uint64_t want = chunkSize - (position % HTTP_READ_ALIGN);
+        if (want > remaining) want = remaining;
+        int32_t got = _source.read(_buffer, (uint32_t)want);
+        if (got <= 0 || !sink.write(_buffer, got)) {
+            break;
+        }
+        position += got;
+        remaining -= got;
+        result.body_bytes += got;
+    }
+    _source.close();
+    return result;
+}
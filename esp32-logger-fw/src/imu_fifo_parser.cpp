@@ -0,0 +1,73 @@
+#include "imu_fifo_parser.h"
+
+static inline int16_t readInt16LE(const uint8_t* p) {
+    return (int16_t)((uint16_t)p[0] | ((uint16_t)p[1] << 8));
+}
+
+ImuFifoParser::ImuFifoParser(const ImuFifoParserConfig& config)
+    : config_(config), haveAccel_(false), haveGyro_(false), pendingCounter_(0), unknownWords_(0), unpairedWords_(0) {
+    for (int i = 0; i < 3; i++) {
+        accel_[i] = 0.0f;
+        gyro_[i] = 0.0f;
+    }
+}
+
+void ImuFifoParser::reset() {
+    haveAccel_ = false;
+    haveGyro_ = false;
+}
+
+size_t ImuFifoParser::parse(const uint8_t* data, size_t wordCount, int64_t anchorTimeUs, size_t anchorIndex,
+                            ImuSample* out, size_t maxOut) {
+    size_t produced = 0;
+    for (size_t w = 0; w < wordCount; w++) {
+        const uint8_t* word = data + w * IMU_FIFO_WORD_SIZE;
+        uint8_t tag = word[0] >> 3;
+        if (tag != IMU_FIFO_TAG_ACCEL && tag != IMU_FIFO_TAG_GYRO) {
+            unknownWords_++; // Temperature, timestamp or empty words are not batched by our config
+            continue;
+        }
+
+        uint8_t counter = (word[0] >> 1) & 0x03;
+        if ((haveAccel_ || haveGyro_) && counter != pendingCounter_) {
+            unpairedWords_++; // The pending half belongs to an earlier batch period
+            haveAccel_ = false;
+            haveGyro_ = false;
+        }
+        pendingCounter_ = counter;
+
+        if (tag == IMU_FIFO_TAG_ACCEL) {
+            if (haveAccel_) unpairedWords_++; // Previous accel word never got its gyro partner
+            for (int i = 0; i < 3; i++) {
+                accel_[i] = readInt16LE(word + 1 + 2 * i) * config_.accel_mps2_per_lsb;
+            }
+            haveAccel_ = true;
+        } else {
+            if (haveGyro_) unpairedWords_++;
+            for (int i = 0; i < 3; i++) {
+                gyro_[i] = readInt16LE(word + 1 + 2 * i) * config_.gyro_radps_per_lsb;
+            }
+            haveGyro_ = true;
+        }
+
+        if (haveAccel_ && haveGyro_) {
+            if (produced < maxOut) {
+                ImuSample& s = out[produced];
+                s.timestamp_us = anchorTimeUs +
+                                 ((int64_t)produced - (int64_t)anchorIndex) * (int64_t)config_.sample_period_us;
+                for (int i = 0; i < 3; i++) {
+                    s.accel_mps2[i] = accel_[i];
+                    s.gyro_radps[i] = gyro_[i];
+                }
+                produced++;
+            }
+            haveAccel_ = false;
+            haveGyro_ = false;
+        }
+    }
+    return produced;
+}
+
+int64_t imuFifoWatermarkFirstSampleUs(int64_t irqTimeUs, uint16_t watermarkWords, uint32_t samplePeriodUs) {
+    return irqTimeUs - (int64_t)(watermarkWords / 2 - 1) * (int64_t)samplePeriodUs;
+}
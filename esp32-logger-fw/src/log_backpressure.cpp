@@ -0,0 +1,91 @@
+#include "log_backpressure.h"
+#include <string.h>
+
+LogBackpressure::LogBackpressure() : _phase(0), _levelSinceMs(0) {
+    memset(&_config, 0, sizeof(_config));
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+bool LogBackpressure::begin(const LogBackpressureConfig& config) {
+    if (!(config.recover_percent < config.decimate_percent && config.decimate_percent < config.minimal_percent &&
+          config.minimal_percent <= 100) ||
+        config.decimated_every == 0 || config.minimal_every == 0) {
+        return false;
+    }
+    _config = config;
+    memset(&_stats, 0, sizeof(_stats));
+    _stats.level = LOG_RATE_FULL;
+    _phase = 0;
+    _levelSinceMs = 0;
+    return true;
+}
+
+bool LogBackpressure::admit(bool priority) {
+    _stats.produced++;
+    uint16_t every;
+    switch (_stats.level) {
+        case LOG_RATE_DECIMATED: every = _config.decimated_every; break;
+        case LOG_RATE_MINIMAL: every = _config.minimal_every; break;
+        default: return true; // Full rate; while dropping, whatever still fits is kept
+    }
+    if (priority || ++_phase >= every) {
+        _phase = 0;
+        return true;
+    }
+    _stats.skipped++;
+    return false;
+}
+
+// Rising marks switch immediately; falling back needs the fill to clear the next mark down, so the
+// level does not chatter while the writer hovers around a threshold.
+LogRateLevel LogBackpressure::levelForFill(uint8_t fillPercent, bool stagingFull) const {
+    if (stagingFull) {
+        return LOG_RATE_DROPPING;
+    }
+    if (fillPercent >= _config.minimal_percent) {
+        return LOG_RATE_MINIMAL;
+    }
+    if (fillPercent >= _config.decimate_percent) {
+        return _stats.level >= LOG_RATE_MINIMAL ? LOG_RATE_MINIMAL : LOG_RATE_DECIMATED;
+    }
+    if (fillPercent <= _config.recover_percent) {
+        return LOG_RATE_FULL;
+    }
+    return _stats.level == LOG_RATE_FULL ? LOG_RATE_FULL : LOG_RATE_DECIMATED;
+}
+
+bool LogBackpressure::update(size_t ringCount, size_t ringCapacity, bool stagingFull, uint32_t nowMs,
+                             LogBackpressureTransition* out) {
+    if (ringCount > _stats.ring_peak) {
+        _stats.ring_peak = (uint32_t)ringCount;
+    }
+    uint8_t fill = ringCapacity > 0 ? (uint8_t)(ringCount * 100 / ringCapacity) : 100;
+    LogRateLevel next = levelForFill(fill, stagingFull);
+    if (next == _stats.level) {
+        return false;
+    }
+    if (out != nullptr) {
+        out->from = _stats.level;
+        out->to = next;
+        out->ring_fill_percent = fill;
+        out->in_previous_ms = nowMs - _levelSinceMs;
+        out->skipped = _stats.skipped;
+        out->dropped = _stats.dropped;
+        out->ring_peak = _stats.ring_peak;
+    }
+    _stats.level = next;
+    _stats.transitions++;
+    _levelSinceMs = nowMs;
+    _phase = 0;
+    return true;
+}
+
+const char* logRateLevelName(LogRateLevel level) {
+    switch (level) {
+        case LOG_RATE_FULL: return "full";
+        case LOG_RATE_DECIMATED: return "decimated";
+        case LOG_RATE_MINIMAL: return "minimal";
+        case LOG_RATE_DROPPING: return "dropping";
+        default: return "?";
+    }
+}
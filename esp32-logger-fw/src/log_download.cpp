@@ -0,0 +1,143 @@
+#include "log_download.h"
+#include "config.h"
+#include "sd_card.h"
+#include "frame_codec.h"
+#include "mem_placement.h"
+#include <string.h> // For strlen, strchr
+
+#define DL_DATA_HEADER_BYTES sizeof(uint32_t)
+
+// Too large for the terminal task's stack; only the terminal task downloads. SdFat reads into s_chunk.
+MEM_DMA_BUFFER static uint8_t s_chunk[DL_DATA_HEADER_BYTES + LOG_DOWNLOAD_CHUNK_BYTES];
+MEM_PLACED(s_chunk, MEM_REGION_DMA);
+static uint8_t s_scratch[FRAME_HEADER_SIZE + DL_DATA_HEADER_BYTES + LOG_DOWNLOAD_CHUNK_BYTES + FRAME_CRC_SIZE];
+static uint8_t s_encoded[FRAME_ENCODED_MAX(DL_DATA_HEADER_BYTES + LOG_DOWNLOAD_CHUNK_BYTES)];
+static uint16_t s_seq = 0;
+
+// Serial.write drops bytes once its own timeout expires; wait for room instead, up to a stall limit
+static bool writeAll(const uint8_t* data, size_t len) {
+    unsigned long lastProgress = millis();
+    while (len > 0) {
+        int room = Serial.availableForWrite();
+        if (room <= 0) {
+            if (millis() - lastProgress > LOG_DOWNLOAD_STALL_MS) {
+                return false; // Host stopped reading
+            }
+            vTaskDelay(1);
+            continue;
+        }
+        size_t written = Serial.write(data, len < (size_t)room ? len : (size_t)room);
+        data += written;
+        len -= written;
+        if (written > 0) {
+            lastProgress = millis();
+        }
+    }
+    return true;
+}
+
+static bool sendFrame(uint8_t type, const void* payload, uint16_t length) {
+    size_t n = frameEncode(type, s_seq++, payload, length, s_scratch, s_encoded);
+    return writeAll(s_encoded, n);
+}
+
+static void sendError(const char* message) {
+    sendFrame(DL_FRAME_ERROR, message, (uint16_t)strlen(message));
+}
+
+void logDownloadList(Print& out) {
+    if (!sdCardBegin() || !sdCardLock(pdMS_TO_TICKS(1000))) {
+        out.println("SD card not available.");
+        return;
+    }
+    FsFile dir = sdCardFs().open(LOG_DIRECTORY);
+    if (!dir || !dir.isDirectory()) {
+        sdCardUnlock();
+        out.printf("Log directory %s not found.\n", LOG_DIRECTORY);
+        return;
+    }
+    out.printf("Files in %s:\n", LOG_DIRECTORY);
+    uint32_t files = 0;
+    uint64_t bytes = 0;
+    FsFile entry;
+    char name[64];
+    while (entry.openNext(&dir, O_RDONLY)) {
+        if (!entry.isDirectory() && !entry.isHidden()) {
+            entry.getName(name, sizeof(name));
+            out.printf("  %-32s %10llu\n", name, (unsigned long long)entry.fileSize());
+            files++;
+            bytes += entry.fileSize();
+        }
+        entry.close();
+    }
+    dir.close();
+    sdCardUnlock();
+    out.printf("%lu files, %llu bytes\n", (unsigned long)files, (unsigned long long)bytes);
+}
+
+void logDownloadSend(const char* name, uint32_t offset, uint32_t length) {
+    uint8_t delimiter = 0;
+    writeAll(&delimiter, 1); // Ends whatever text precedes the first frame
+
+    if (strchr(name, '/') != NULL) {
+        sendError("name must not contain '/'");
+        return;
+    }
+    char path[96];
+    snprintf(path, sizeof(path), "%s%s%s", LOG_DIRECTORY,
+             LOG_DIRECTORY[strlen(LOG_DIRECTORY) - 1] == '/' ? "" : "/", name);
+
+    if (!sdCardBegin() || !sdCardLock(pdMS_TO_TICKS(1000))) {
+        sendError("SD card not available");
+        return;
+    }
+    FsFile file = sdCardFs().open(path, O_RDONLY);
+    uint64_t fileSize = file ? file.fileSize() : 0;
+    bool seekOk = file && offset <= fileSize && file.seekSet(offset);
+    sdCardUnlock();
+    if (!file) {
+        sendError("file not found");
+        return;
+    }
+    if (!seekOk) {
+        sdCardLock(portMAX_DELAY);
+        file.close();
+        sdCardUnlock();
+        sendError("offset beyond end of file");
+        return;
+    }
+
+    uint32_t remaining = (uint32_t)(fileSize - offset);
+    if (length != 0 && length < remaining) {
+        remaining = length;
+    }
+    DownloadInfo info = { offset, remaining, (uint32_t)fileSize };
+    bool linkOk = sendFrame(DL_FRAME_INFO, &info, sizeof(info));
+
+    uint32_t crc = 0;
+    uint32_t position = offset;
+    while (linkOk && remaining > 0) {
+        uint32_t want = remaining < LOG_DOWNLOAD_CHUNK_BYTES ? remaining : LOG_DOWNLOAD_CHUNK_BYTES;
+        // Lock per chunk so the logger is never kept off the card for long
+        sdCardLock(portMAX_DELAY);
+        int got = file.read(&s_chunk[DL_DATA_HEADER_BYTES], want);
+        sdCardUnlock();
+        if (got <= 0) {
+            sendError("read error");
+            break;
+        }
+        memcpy(s_chunk, &position, sizeof(position));
+        crc = crc32Update(crc, &s_chunk[DL_DATA_HEADER_BYTES], got);
+        linkOk = sendFrame(DL_FRAME_DATA, s_chunk, (uint16_t)(DL_DATA_HEADER_BYTES + got));
+        position += got;
+        remaining -= got;
+    }
+    if (linkOk && remaining == 0) {
+        DownloadEnd end = { position, crc };
+        sendFrame(DL_FRAME_END, &end, sizeof(end));
+    }
+
+    sdCardLock(portMAX_DELAY);
+    file.close();
+    sdCardUnlock();
+}
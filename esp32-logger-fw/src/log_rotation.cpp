@@ -0,0 +1,493 @@
+#include "log_rotation.h"
+#include "config.h"
+#include "sd_card.h"
+#include "event_log.h"  // EVENT_LOG_ROTATION
+#include "log_schema.h" // Schema blob at the start of each log file
+#include "log_summary.h" // Level-of-detail sidecar kept alongside each log
+
+#include <esp_timer.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LOG_SLOT_COUNT 3     // Active, prepared next, retiring previous
+#define LOG_NAME_MAX 32
+
+// Retirement closes one file per card lock (retireStep()); a slot's step is reset when it is prepared
+enum LogRetireStep : uint8_t {
+    RETIRE_LOG = 0,
+    RETIRE_EVENTS,
+    RETIRE_SUMMARY,
+    RETIRE_DONE
+};
+
+struct LogFileSlot {
+    FsFile log;
+    FsFile events;
+    FsFile summary;
+    uint32_t index;
+    uint64_t bytes;          // Written to the log file, schema blob included
+    uint32_t prepareMs;
+    LogSummary lod;          // Fed with every record written to `log`
+    LogSummaryFileHeader lodHeader; // Region layout and bucket counts of `summary`
+    uint8_t retireStep;      // LogRetireStep
+};
+
+// Slot roles change only under the SD card lock, which also serializes every SdFat call
+static LogFileSlot s_slots[LOG_SLOT_COUNT];
+static LogFileSlot* s_active = nullptr;
+static LogFileSlot* s_next = nullptr;
+static LogFileSlot* s_retiring = nullptr;
+static uint32_t s_counter = 0;          // Next number to try
+static uint32_t s_activeOpenedMs = 0;
+static bool s_deferredCounted = false;  // One deferral per due rotation
+static volatile bool s_running = false;
+static TaskHandle_t s_taskHandle = NULL;
+static volatile uint32_t s_retireSteps = 0; // Bumped under the card lock by every retire step
+
+static LogRotationStats s_stats;
+static portMUX_TYPE s_statsMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void formatName(char* out, uint32_t index, const char* extension) {
+    snprintf(out, LOG_NAME_MAX, "%slog_%03lu.%s", LOG_DIRECTORY, (unsigned long)index, extension);
+}
+
+static void countFailure() {
+    portENTER_CRITICAL(&s_statsMux);
+    s_stats.failures++;
+    portEXIT_CRITICAL(&s_statsMux);
+}
+
+// --- Counter file (card lock held) ---
+
+static uint32_t readCounter() {
+    FsFile file;
+    char text[16] = "";
+    if (file.open(&sdCardFs(), LOG_COUNTER_FILE, O_RDONLY)) {
+        int n = file.read(text, sizeof(text) - 1);
+        text[n > 0 ? n : 0] = '\0';
+        file.close();
+    }
+    return strtoul(text, NULL, 10);
+}
+
+static bool writeCounter(uint32_t value) {
+    FsFile file;
+    char text[16];
+    int length = snprintf(text, sizeof(text), "%lu\n", (unsigned long)value);
+    bool ok = file.open(&sdCardFs(), LOG_COUNTER_FILE, O_WRONLY | O_CREAT | O_TRUNC) &&
+              file.write(text, length) == (size_t)length;
+    file.close();
+    return ok;
+}
+
+// Recovery only (counter file lost or stale): one pass over the directory for the highest number
+static uint32_t scanForFreeNumber() {
+    FsFile dir = sdCardFs().open(LOG_DIRECTORY);
+    uint32_t highest = 0;
+    bool any = false;
+    FsFile entry;
+    char name[64];
+    while (dir && entry.openNext(&dir, O_RDONLY)) {
+        unsigned long index;
+        entry.getName(name, sizeof(name));
+        if (sscanf(name, "log_%lu.", &index) == 1 && (!any || index > highest)) {
+            highest = (uint32_t)index;
+            any = true;
+        }
+        entry.close();
+    }
+    dir.close();
+    return any ? highest + 1 : 0;
+}
+
+// --- Summary sidecar (card lock held) ---
+
+// LogSummary sink: buckets go straight to their slot in the preallocated level region
+static void writeSummaryBucket(void* context, uint8_t level, const LogSummaryBucket& bucket) {
+    LogFileSlot* slot = (LogFileSlot*)context;
+    LogSummaryLevelInfo& info = slot->lodHeader.levels[level];
+    if (info.count >= info.capacity) {
+        slot->lodHeader.flags |= LOG_SUMMARY_FLAG_OVERFLOW; // Rotation deferred well past the span
+        return;
+    }
+    uint8_t encoded[LOG_SUMMARY_BUCKET_SIZE];
+    logSummaryEncodeBucket(bucket, encoded);
+    if (slot->summary.seekSet(info.offset + info.count * LOG_SUMMARY_BUCKET_SIZE) &&
+        slot->summary.write(encoded, sizeof(encoded)) == sizeof(encoded)) {
+        info.count++;
+    } else {
+        countFailure();
+    }
+}
+
+// --- Preparation and retirement ---
+
+// Creates, preallocates and heads a log/event/summary set in `slot`. Each step takes the card lock
+// on its own, so the writer is held up for one metadata operation at a time at most.
+static bool prepareSlot(LogFileSlot* slot) {
+    int64_t start = esp_timer_get_time();
+    char name[LOG_NAME_MAX];
+
+    sdCardLock(portMAX_DELAY);
+    bool created = false;
+    for (int attempt = 0; !created && attempt < 2 * LOG_ROTATE_NAME_ATTEMPTS; attempt++) {
+        if (attempt == LOG_ROTATE_NAME_ATTEMPTS) {
+            s_counter = scanForFreeNumber(); // Every guess was taken; the counter is stale
+        }
+        slot->index = s_counter++;
+        formatName(name, slot->index, "bin");
+        created = slot->log.open(&sdCardFs(), name, O_RDWR | O_CREAT | O_EXCL);
+    }
+    slot->retireStep = RETIRE_LOG;
+    if (created) {
+        formatName(name, slot->index, "evt");
+        created = slot->events.open(&sdCardFs(), name, O_RDWR | O_CREAT | O_TRUNC);
+        formatName(name, slot->index, "lod");
+        created = created && slot->summary.open(&sdCardFs(), name, O_RDWR | O_CREAT | O_TRUNC);
+        if (!created) {
+            slot->log.close();
+            slot->events.close();
+        }
+    }
+    sdCardUnlock();
+    if (!created) {
+        Serial.println("Log rotation: could not create the next log file.");
+        countFailure();
+        return false;
+    }
+
+    sdCardLock(portMAX_DELAY);
+    bool contiguous = slot->log.preAllocate(LOG_ROTATE_BYTES);
+    sdCardUnlock();
+    sdCardLock(portMAX_DELAY);
+    contiguous = slot->events.preAllocate(LOG_ROTATE_EVENT_BYTES) && contiguous;
+    sdCardUnlock();
+
+    // Level regions sit at fixed offsets inside the extent, so buckets are written in place
+    static uint8_t schemaBlob[LOG_SCHEMA_BLOB_MAX]; // Rotation task only
+    size_t blobLength = logSchemaWriteBlob(schemaBlob, sizeof(schemaBlob));
+    uint32_t summaryBytes = logSummaryLayout((uint32_t)LOG_SUMMARY_SPAN_MINUTES * 60000UL, blobLength, &slot->lodHeader);
+    slot->lod.begin(writeSummaryBucket, slot);
+    sdCardLock(portMAX_DELAY);
+    contiguous = slot->summary.preAllocate(summaryBytes) && contiguous;
+    sdCardUnlock();
+    if (!contiguous) {
+        Serial.printf("Log rotation: log_%03lu not preallocated (card full or fragmented).\n",
+                      (unsigned long)slot->index);
+    }
+
+    // Self-describing files: the schema blob comes first, records follow (tools/log_schema.py); the
+    // summary header is rewritten with its counts when the log is closed (tools/log_summary.py)
+    sdCardLock(portMAX_DELAY);
+    bool ok = slot->log.write(schemaBlob, blobLength) == blobLength && slot->log.sync() && slot->events.sync();
+    ok = slot->summary.write(&slot->lodHeader, sizeof(slot->lodHeader)) == sizeof(slot->lodHeader) &&
+         slot->summary.write(schemaBlob, blobLength) == blobLength && slot->summary.sync() && ok;
+    slot->bytes = blobLength;
+    ok = writeCounter(s_counter) && ok;
+    sdCardUnlock();
+    slot->prepareMs = (uint32_t)((esp_timer_get_time() - start) / 1000);
+    if (!ok) {
+        countFailure();
+    }
+    return true; // A pair without preallocation or counter update is still usable
+}
+
+// Truncates the preallocated tail of one file and closes it (card lock held); returns the step
+// after it. The summary gets its open buckets and final counts; the finest level is the last
+// region, so its end is the file end.
+static uint8_t retireStep(LogFileSlot* slot) {
+    switch (slot->retireStep) {
+    case RETIRE_LOG:
+        slot->log.truncate(slot->bytes);
+        slot->log.close();
+        break;
+    case RETIRE_EVENTS:
+        slot->events.truncate(slot->events.curPosition());
+        slot->events.close();
+        break;
+    case RETIRE_SUMMARY: {
+        slot->lod.finish();
+        LogSummaryFileHeader& header = slot->lodHeader;
+        header.t0_ms = slot->lod.origin();
+        header.flags |= LOG_SUMMARY_FLAG_COMPLETE;
+        slot->summary.seekSet(0);
+        slot->summary.write(&header, sizeof(header));
+        slot->summary.truncate(header.levels[0].offset + header.levels[0].count * LOG_SUMMARY_BUCKET_SIZE);
+        slot->summary.close();
+        break;
+    }
+    default:
+        return RETIRE_DONE;
+    }
+    s_retireSteps++;
+    return ++slot->retireStep;
+}
+
+// Every remaining step at once (card lock held); for logRotationEnd(), where nobody is writing
+static void closeSlot(LogFileSlot* slot) {
+    while (retireStep(slot) != RETIRE_DONE) {
+    }
+}
+
+// Deletes a prepared pair that was never written (card lock held)
+static void discardSlot(LogFileSlot* slot) {
+    char name[LOG_NAME_MAX];
+    slot->log.close();
+    slot->events.close();
+    slot->summary.close();
+    formatName(name, slot->index, "bin");
+    sdCardFs().remove(name);
+    formatName(name, slot->index, "evt");
+    sdCardFs().remove(name);
+    formatName(name, slot->index, "lod");
+    sdCardFs().remove(name);
+}
+
+static LogFileSlot* freeSlot() {
+    for (int i = 0; i < LOG_SLOT_COUNT; i++) {
+        LogFileSlot* slot = &s_slots[i];
+        if (slot != s_active && slot != s_next && slot != s_retiring) {
+            return slot;
+        }
+    }
+    return nullptr;
+}
+
+// --- Writer side (card lock held) ---
+
+// The switch itself is a slot swap; the first write into the new file completes the rotation and
+// is included in the reported latency (logRotationWrite)
+static void switchFiles(uint32_t nowMs) {
+    s_retiring = s_active;
+    s_active = s_next;
+    s_next = nullptr;
+    s_activeOpenedMs = nowMs;
+    s_deferredCounted = false;
+}
+
+// The writer waited for the card lock while the rotation task retired a file
+static void reportRetireStall(uint32_t stallUs) {
+    portENTER_CRITICAL(&s_statsMux);
+    s_stats.last_retire_stall_us = stallUs;
+    if (stallUs > s_stats.max_retire_stall_us) s_stats.max_retire_stall_us = stallUs;
+    portEXIT_CRITICAL(&s_statsMux);
+}
+
+static void reportRotation(uint32_t switchUs) {
+    portENTER_CRITICAL(&s_statsMux);
+    s_stats.rotations++;
+    s_stats.last_switch_us = switchUs;
+    if (switchUs > s_stats.max_switch_us) s_stats.max_switch_us = switchUs;
+    s_stats.last_prepare_ms = s_active->prepareMs;
+    if (s_active->prepareMs > s_stats.max_prepare_ms) s_stats.max_prepare_ms = s_active->prepareMs;
+    portEXIT_CRITICAL(&s_statsMux);
+
+    LogRotationEvent event = { s_retiring->index, s_active->index, switchUs, s_active->prepareMs, s_retiring->bytes };
+    eventLogPost(EVENT_LOG_ROTATION, &event, sizeof(event));
+    if (s_taskHandle != NULL) {
+        xTaskNotifyGive(s_taskHandle); // Retire the old pair, prepare the one after
+    }
+}
+
+// True if the writer switched to the next pair
+static bool rotateIfDue(size_t incoming) {
+    uint32_t now = millis();
+    bool due = s_active->bytes + incoming > LOG_ROTATE_BYTES ||
+               now - s_activeOpenedMs >= (uint32_t)LOG_ROTATE_MINUTES * 60000UL;
+    if (!due) {
+        return false;
+    }
+    if (s_next != nullptr && s_retiring == nullptr) {
+        switchFiles(now);
+        return true;
+    } else if (!s_deferredCounted) {
+        s_deferredCounted = true;
+        portENTER_CRITICAL(&s_statsMux);
+        s_stats.deferred++;
+        portEXIT_CRITICAL(&s_statsMux);
+        if (s_taskHandle != NULL) {
+            xTaskNotifyGive(s_taskHandle);
+        }
+    }
+    return false;
+}
+
+bool logRotationBegin() {
+    if (s_running || !sdCardBegin()) {
+        return s_running;
+    }
+    sdCardLock(portMAX_DELAY);
+    s_counter = readCounter();
+    sdCardUnlock();
+
+    LogFileSlot* first = &s_slots[0];
+    if (!prepareSlot(first)) {
+        return false;
+    }
+    sdCardLock(portMAX_DELAY);
+    s_active = first;
+    s_activeOpenedMs = millis();
+    s_deferredCounted = false;
+    s_running = true;
+    sdCardUnlock();
+    Serial.printf("Logging to log_%03lu.bin (schema v%u, %u-byte records)\n", (unsigned long)first->index,
+                  (unsigned)LOG_SCHEMA_VERSION, (unsigned)LOG_RECORD_V1_SIZE);
+    if (s_taskHandle != NULL) {
+        xTaskNotifyGive(s_taskHandle);
+    }
+    return true;
+}
+
+bool logRotationWrite(const void* data, size_t length) {
+    uint32_t retireSteps = s_retireSteps;
+    int64_t start = esp_timer_get_time();
+    sdCardLock(portMAX_DELAY);
+    if (s_retireSteps != retireSteps) {
+        reportRetireStall((uint32_t)(esp_timer_get_time() - start));
+    }
+    if (s_active == nullptr) {
+        sdCardUnlock();
+        return false;
+    }
+    start = esp_timer_get_time();
+    bool rotated = rotateIfDue(length);
+    bool ok = s_active->log.write(data, length) == length;
+    s_active->bytes += ok ? length : 0;
+    if (rotated) {
+        reportRotation((uint32_t)(esp_timer_get_time() - start));
+    }
+    for (size_t offset = 0; ok && offset + LOG_RECORD_V1_SIZE <= length; offset += LOG_RECORD_V1_SIZE) {
+        s_active->lod.add((const uint8_t*)data + offset); // Writes a bucket about once a second
+    }
+    sdCardUnlock();
+    if (!ok) {
+        countFailure();
+    }
+    return ok;
+}
+
+bool logRotationWriteEvents(const void* data, size_t length) {
+    sdCardLock(portMAX_DELAY);
+    bool ok = s_active != nullptr && s_active->events.write(data, length) == length;
+    sdCardUnlock();
+    return ok;
+}
+
+bool logRotationSync() {
+    sdCardLock(portMAX_DELAY);
+    bool ok = s_active != nullptr && s_active->log.sync() && s_active->events.sync();
+    if (ok) {
+        // Bucket counts so far, so the summary of a log cut short by power loss is still readable
+        s_active->lodHeader.t0_ms = s_active->lod.origin();
+        s_active->summary.seekSet(0);
+        ok = s_active->summary.write(&s_active->lodHeader, sizeof(s_active->lodHeader)) == sizeof(s_active->lodHeader) &&
+             s_active->summary.sync();
+    }
+    sdCardUnlock();
+    return ok;
+}
+
+void logRotationEnd() {
+    sdCardLock(portMAX_DELAY);
+    s_running = false;
+    if (s_retiring != nullptr) {
+        closeSlot(s_retiring);
+        s_retiring = nullptr;
+    }
+    if (s_active != nullptr) {
+        closeSlot(s_active);
+        s_active = nullptr;
+    }
+    if (s_next != nullptr) {
+        discardSlot(s_next);
+        s_counter = s_next->index; // Next session reuses the number
+        writeCounter(s_counter);
+        s_next = nullptr;
+    }
+    sdCardUnlock();
+}
+
+void logRotationGetStats(LogRotationStats* out) {
+    portENTER_CRITICAL(&s_statsMux);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_statsMux);
+    // Role pointers are only read here; a stale value is harmless for a status display
+    LogFileSlot* active = s_active;
+    out->active = active != nullptr;
+    out->next_ready = s_next != nullptr;
+    out->active_index = active != nullptr ? active->index : 0;
+    out->active_bytes = active != nullptr ? active->bytes : 0;
+    out->active_age_ms = active != nullptr ? millis() - s_activeOpenedMs : 0;
+}
+
+void logRotationPrint(Print& out) {
+    LogRotationStats stats;
+    logRotationGetStats(&stats);
+    if (!stats.active) {
+        out.println("Log rotation: not logging.");
+        return;
+    }
+    out.printf("Active: log_%03lu.bin, %llu KB, %lu s old; next %s\n", (unsigned long)stats.active_index,
+               (unsigned long long)(stats.active_bytes / 1024), (unsigned long)(stats.active_age_ms / 1000),
+               stats.next_ready ? "ready" : "being prepared");
+    out.printf("Rotations: %lu, deferred %lu, failures %lu\n", (unsigned long)stats.rotations,
+               (unsigned long)stats.deferred, (unsigned long)stats.failures);
+    out.printf("Switch: last %lu us, max %lu us; retire stall: last %lu us, max %lu us\n",
+               (unsigned long)stats.last_switch_us, (unsigned long)stats.max_switch_us,
+               (unsigned long)stats.last_retire_stall_us, (unsigned long)stats.max_retire_stall_us);
+    out.printf("Prepare: last %lu ms, max %lu ms; retire: last %lu ms\n", (unsigned long)stats.last_prepare_ms,
+               (unsigned long)stats.max_prepare_ms, (unsigned long)stats.last_retire_ms);
+}
+
+bool logRotationService() {
+    if (!s_running) {
+        return true;
+    }
+
+    if (s_retiring != nullptr) {
+        // One file per lock, like prepareSlot(), so the writer waits for one truncate + close at most
+        int64_t start = esp_timer_get_time();
+        bool retired = false;
+        while (!retired) {
+            sdCardLock(portMAX_DELAY);
+            if (s_retiring == nullptr) { // logRotationEnd() may have beaten us to it
+                retired = true;
+            } else if (retireStep(s_retiring) == RETIRE_DONE) {
+                s_retiring = nullptr;
+                retired = true;
+            }
+            sdCardUnlock();
+        }
+        uint32_t retireMs = (uint32_t)((esp_timer_get_time() - start) / 1000);
+        portENTER_CRITICAL(&s_statsMux);
+        s_stats.last_retire_ms = retireMs;
+        portEXIT_CRITICAL(&s_statsMux);
+    }
+
+    if (s_next == nullptr) {
+        LogFileSlot* slot = freeSlot();
+        if (slot == nullptr || !prepareSlot(slot)) {
+            return false;
+        }
+        sdCardLock(portMAX_DELAY);
+        if (s_running) {
+            s_next = slot;
+        } else {
+            discardSlot(slot); // Logging stopped while we were preparing
+            s_counter = slot->index;
+            writeCounter(s_counter);
+        }
+        sdCardUnlock();
+    }
+    return true;
+}
+
+void logRotationTask(void* pvParameters) {
+    s_taskHandle = xTaskGetCurrentTaskHandle();
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LOG_ROTATION_POLL_MS));
+        if (!logRotationService()) {
+            vTaskDelay(pdMS_TO_TICKS(10 * LOG_ROTATION_POLL_MS)); // Card full or gone; don't spin on it
+        }
+    }
+}
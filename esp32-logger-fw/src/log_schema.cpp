@@ -0,0 +1,106 @@
+#include "log_schema.h"
+#include <stdio.h>
+
+const char* logFieldTypeName(LogFieldType type) {
+    switch (type) {
+        case LOG_TYPE_U8: return "u8";
+        case LOG_TYPE_I8: return "i8";
+        case LOG_TYPE_U16: return "u16";
+        case LOG_TYPE_I16: return "i16";
+        case LOG_TYPE_U32: return "u32";
+        case LOG_TYPE_I32: return "i32";
+        case LOG_TYPE_F32: return "f32";
+        case LOG_TYPE_F64: return "f64";
+    }
+    return "?";
+}
+
+static bool appendBytes(uint8_t* out, size_t capacity, size_t* pos, const void* data, size_t length) {
+    if (*pos + length > capacity) {
+        return false;
+    }
+    memcpy(out + *pos, data, length);
+    *pos += length;
+    return true;
+}
+
+static bool appendString(uint8_t* out, size_t capacity, size_t* pos, const char* text) {
+    size_t length = strlen(text);
+    uint8_t length8 = (uint8_t)length;
+    return length <= 255 && appendBytes(out, capacity, pos, &length8, 1) && appendBytes(out, capacity, pos, text, length);
+}
+
+size_t logSchemaWriteBlob(uint8_t* out, size_t capacity) {
+    LogSchemaBlobHeader header;
+    memcpy(header.magic, LOG_SCHEMA_MAGIC, sizeof(header.magic));
+    header.blob_length = 0; // Filled in below
+    header.schema_version = LOG_SCHEMA_VERSION;
+    header.record_size = sizeof(LogRecordV1);
+    header.field_count = LOG_RECORD_V1_FIELD_COUNT;
+    header.reserved = 0;
+
+    size_t pos = sizeof(header);
+    if (pos > capacity) {
+        return 0;
+    }
+    for (size_t i = 0; i < LOG_RECORD_V1_FIELD_COUNT; i++) {
+        const LogFieldInfo& field = LOG_RECORD_V1_SCHEMA[i];
+        uint8_t type = field.type;
+        if (!appendBytes(out, capacity, &pos, &type, 1) ||
+            !appendBytes(out, capacity, &pos, &field.count, 1) ||
+            !appendBytes(out, capacity, &pos, &field.offset, 2) ||
+            !appendBytes(out, capacity, &pos, &field.scale, 4) ||
+            !appendString(out, capacity, &pos, field.name) ||
+            !appendString(out, capacity, &pos, field.unit)) {
+            return 0;
+        }
+    }
+    header.blob_length = (uint16_t)pos;
+    memcpy(out, &header, sizeof(header));
+    return pos;
+}
+
+size_t logSchemaCsvHeader(char* out, size_t size) {
+    size_t pos = 0;
+    for (size_t i = 0; i < LOG_RECORD_V1_FIELD_COUNT; i++) {
+        const LogFieldInfo& field = LOG_RECORD_V1_SCHEMA[i];
+        for (uint8_t element = 0; element < field.count; element++) {
+            char index[4] = "";
+            if (field.count > 1) {
+                snprintf(index, sizeof(index), "%u", element);
+            }
+            int written = snprintf(out + pos, size - pos, "%s%s%s%s%s%s", pos > 0 ? "," : "", field.name, index,
+                                   field.unit[0] != '\0' ? "[" : "", field.unit, field.unit[0] != '\0' ? "]" : "");
+            if (written < 0 || (size_t)written >= size - pos) {
+                return 0;
+            }
+            pos += written;
+        }
+    }
+    return pos;
+}
+
+size_t logSchemaJson(char* out, size_t size) {
+    int written = snprintf(out, size, "{\"version\":%d,\"record_size\":%u,\"fields\":[", LOG_SCHEMA_VERSION,
+                           (unsigned)sizeof(LogRecordV1));
+    if (written < 0 || (size_t)written >= size) {
+        return 0;
+    }
+    size_t pos = written;
+    for (size_t i = 0; i < LOG_RECORD_V1_FIELD_COUNT; i++) {
+        const LogFieldInfo& field = LOG_RECORD_V1_SCHEMA[i];
+        written = snprintf(out + pos, size - pos,
+                           "%s{\"name\":\"%s\",\"type\":\"%s\",\"count\":%u,\"offset\":%u,\"scale\":%g,\"unit\":\"%s\"}",
+                           i > 0 ? "," : "", field.name, logFieldTypeName(field.type), field.count, field.offset,
+                           (double)field.scale, field.unit);
+        if (written < 0 || (size_t)written >= size - pos) {
+            return 0;
+        }
+        pos += written;
+    }
+    if (pos + 2 >= size) {
+        return 0;
+    }
+    memcpy(out + pos, "]}", 3);
+    return pos + 2;
+}
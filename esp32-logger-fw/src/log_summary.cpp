@@ -0,0 +1,159 @@
+#include "log_summary.h"
+
+#include <math.h>
+
+static float elementValue(const LogFieldInfo& field, const uint8_t* p) {
+    switch (field.type) {
+        case LOG_TYPE_U8: return *p * field.scale;
+        case LOG_TYPE_I8: return (int8_t)*p * field.scale;
+        case LOG_TYPE_U16: { uint16_t v; memcpy(&v, p, 2); return v * field.scale; }
+        case LOG_TYPE_I16: { int16_t v; memcpy(&v, p, 2); return v * field.scale; }
+        case LOG_TYPE_U32: { uint32_t v; memcpy(&v, p, 4); return (float)v * field.scale; }
+        case LOG_TYPE_I32: { int32_t v; memcpy(&v, p, 4); return (float)v * field.scale; }
+        case LOG_TYPE_F32: { float v; memcpy(&v, p, 4); return v * field.scale; }
+        case LOG_TYPE_F64: { double v; memcpy(&v, p, 8); return (float)(v * field.scale); }
+    }
+    return NAN;
+}
+
+LogSummary::LogSummary() {
+    begin(nullptr, nullptr);
+}
+
+void LogSummary::begin(Sink sink, void* context) {
+    _sink = sink;
+    _context = context;
+    _started = false;
+    _t0 = 0;
+    for (uint8_t level = 0; level < LOG_SUMMARY_LEVELS; level++) {
+        _open[level] = false;
+    }
+}
+
+void LogSummary::open(uint8_t level, uint32_t start) {
+    LogSummaryBucket& bucket = _buckets[level];
+    bucket.start_ms = start;
+    bucket.records = 0;
+    for (int c = 0; c < LOG_SUMMARY_CHANNELS; c++) {
+        bucket.channels[c].min = INFINITY;
+        bucket.channels[c].max = -INFINITY;
+        bucket.channels[c].sum = 0.0f;
+        bucket.channels[c].samples = 0;
+    }
+    _open[level] = true;
+}
+
+// Times before the open bucket (clock stepped back) are folded into it rather than reopening
+// an earlier bucket, so every level stays in time order
+bool LogSummary::route(uint8_t level, uint32_t timeMs) {
+    uint32_t period = LOG_SUMMARY_PERIODS_MS[level];
+    uint32_t start = _t0 + (timeMs - _t0) / period * period;
+    if (_open[level] && (start == _buckets[level].start_ms || (int32_t)(start - _buckets[level].start_ms) < 0)) {
+        return false;
+    }
+    if (_open[level]) {
+        emit(level);
+    }
+    open(level, start);
+    return true;
+}
+
+void LogSummary::emit(uint8_t level) {
+    _open[level] = false;
+    if (_sink != nullptr) {
+        _sink(_context, level, _buckets[level]);
+    }
+    if (level + 1 < LOG_SUMMARY_LEVELS) {
+        merge(level + 1, _buckets[level]);
+    }
+}
+
+void LogSummary::add(const uint8_t* record) {
+    uint32_t timeMs;
+    memcpy(&timeMs, record, sizeof(timeMs));
+    if (!_started) {
+        _t0 = timeMs;
+        _started = true;
+    }
+    route(0, timeMs);
+
+    LogSummaryBucket& bucket = _buckets[0];
+    bucket.records++;
+    int c = 0;
+    for (size_t f = 1; f < LOG_RECORD_V1_FIELD_COUNT; f++) {
+        const LogFieldInfo& field = LOG_RECORD_V1_SCHEMA[f];
+        for (uint8_t element = 0; element < field.count; element++, c++) {
+            float v = elementValue(field, record + field.offset + element * field.element_size);
+            if (isnan(v)) {
+                continue;
+            }
+            LogSummaryChannel& channel = bucket.channels[c];
+            if (v < channel.min) channel.min = v;
+            if (v > channel.max) channel.max = v;
+            channel.sum += v;
+            channel.samples++;
+        }
+    }
+}
+
+void LogSummary::merge(uint8_t level, const LogSummaryBucket& from) {
+    route(level, from.start_ms);
+    LogSummaryBucket& bucket = _buckets[level];
+    bucket.records += from.records;
+    for (int c = 0; c < LOG_SUMMARY_CHANNELS; c++) {
+        const LogSummaryChannel& in = from.channels[c];
+        LogSummaryChannel& channel = bucket.channels[c];
+        if (in.samples == 0) {
+            continue;
+        }
+        if (in.min < channel.min) channel.min = in.min;
+        if (in.max > channel.max) channel.max = in.max;
+        channel.sum += in.sum;
+        channel.samples += in.samples;
+    }
+}
+
+void LogSummary::finish() {
+    for (uint8_t level = 0; level < LOG_SUMMARY_LEVELS; level++) {
+        if (_open[level]) {
+            emit(level); // Merges into the next level before that one is emitted
+        }
+    }
+}
+
+uint32_t logSummaryLayout(uint32_t spanMs, size_t blobLength, LogSummaryFileHeader* header) {
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, LOG_SUMMARY_MAGIC, sizeof(header->magic));
+    header->header_length = (uint16_t)(sizeof(*header) + blobLength);
+    header->bucket_size = LOG_SUMMARY_BUCKET_SIZE;
+    header->channel_count = LOG_SUMMARY_CHANNELS;
+    header->level_count = LOG_SUMMARY_LEVELS;
+
+    // Coarsest first: an overview reads the header and the first few kilobytes
+    uint32_t offset = header->header_length;
+    for (int level = LOG_SUMMARY_LEVELS - 1; level >= 0; level--) {
+        LogSummaryLevelInfo& info = header->levels[level];
+        info.period_ms = LOG_SUMMARY_PERIODS_MS[level];
+        info.offset = offset;
+        info.capacity = spanMs / info.period_ms + 2; // Partial buckets at both ends
+        offset += info.capacity * LOG_SUMMARY_BUCKET_SIZE;
+    }
+    return offset;
+}
+
+void logSummaryEncodeBucket(const LogSummaryBucket& bucket, uint8_t* out) {
+    memcpy(out, &bucket.start_ms, 4);
+    memcpy(out + 4, &bucket.records, 4);
+    uint8_t* p = out + 8;
+    for (int c = 0; c < LOG_SUMMARY_CHANNELS; c++) {
+        const LogSummaryChannel& channel = bucket.channels[c];
+        float values[3] = { NAN, NAN, NAN };
+        if (channel.samples > 0) {
+            values[0] = channel.min;
+            values[1] = channel.max;
+            values[2] = channel.sum / channel.samples;
+        }
+        memcpy(p, values, sizeof(values));
+        p += sizeof(values);
+    }
+}
@@ -0,0 +1,51 @@
+#include "log_writer.h"
+#include "config.h"
+#include "event_log.h"    // Low-rate summary records for the event sidecar
+#include "log_schema.h"   // Records are packed to the schema's wire layout
+#include "log_rotation.h" // File naming, preallocation and rotation
+
+#define LOG_WRITER_EVENT_BATCH 8
+
+static uint32_t s_lastSyncMs = 0;
+
+void logWriterBegin(uint32_t nowMs) {
+    s_lastSyncMs = nowMs;
+}
+
+size_t logWriterService(DataBuffer<LogRecordV1>& ring, uint32_t nowMs, bool* ok) {
+    // Drained in batches so one SD write covers many records; the acquisition task decimates while
+    // the ring is backed up (log_backpressure.h), so a stall here costs resolution, not data.
+    static LogRecordV1 records[LOG_STAGING_SPILL_RECORDS];
+    static uint8_t wire[LOG_STAGING_SPILL_RECORDS * LOG_RECORD_V1_SIZE];
+    *ok = true;
+    size_t batch = ring.readBatch(records, LOG_STAGING_SPILL_RECORDS);
+    if (batch > 0) {
+        for (size_t i = 0; i < batch; i++) {
+            logRecordV1Pack(records[i], wire + i * LOG_RECORD_V1_SIZE);
+        }
+        *ok = logRotationWrite(wire, batch * LOG_RECORD_V1_SIZE);
+    }
+
+    // Event records are low rate; drain whatever is queued without waiting
+    EventRecord events[LOG_WRITER_EVENT_BATCH];
+    size_t eventCount = eventLogRead(events, LOG_WRITER_EVENT_BATCH, 0);
+    if (eventCount > 0) {
+        logRotationWriteEvents(events, eventCount * sizeof(EventRecord));
+    }
+
+    if (nowMs - s_lastSyncMs >= SD_LOG_SYNC_INTERVAL_MS) {
+        logRotationSync();
+        s_lastSyncMs = nowMs;
+    }
+    return batch;
+}
+
+bool logWriterFlush(DataBuffer<LogRecordV1>& ring, uint32_t nowMs) {
+    bool allOk = true;
+    while (ring.getCount() > 0 || eventLogPending() > 0) {
+        bool ok;
+        logWriterService(ring, nowMs, &ok);
+        allOk = allOk && ok;
+    }
+    return allOk;
+}
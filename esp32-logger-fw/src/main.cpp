@@ -6,6 +6,19 @@
 #include "gps_data.h"       // For g_gpsDataMutex
 #include "shared_state.h"
 #include "terminal_manager.h"
+#include "I2cBusManager.h"
+#include "ImuTask.h"
+#include "AnalogCaptureTask.h"
+#include "event_log.h"
+#include "trace.h"
+#include "mem_placement.h"
+#include "WifiHandlerTask.h"
+#include "power_manager.h"
+#include "raw_capture.h"
+#include "DataBuffer.h"
+#include "DataAcquisitionTask.h"
+#include "SdLoggingTask.h"
+#include "log_rotation.h"
 
 
 // Global variable definitions
@@ -16,6 +29,7 @@ SemaphoreHandle_t g_dataMutex;
 // GpsData g_gpsData is defined in gps_handler.cpp, declared extern in gps_data.h
 volatile DebugSettings g_debugSettings;
 SemaphoreHandle_t g_debugSettingsMutex = NULL;
+DataBuffer<LogRecordV1> psramDataBuffer(PSRAM_BUFFER_SIZE_RECORDS); // Acquisition -> SD logging, storage from the PSRAM arena
 
 
 void setup() {
@@ -50,44 +64,58 @@ void setup() {
         Serial.println("Debug settings mutex created successfully.");
     }
 
-    // Initialize PSRAM if available
-    #if CONFIG_SPIRAM_SUPPORT
-    if (psramFound()) {
-        Serial.println("PSRAM found");
-        if(!psramDataBuffer.initialize()){ 
-            Serial.println("PSRAM Buffer initialization failed!");
-            // Handle error - perhaps by halting or indicating via LED
-            // For now, continue, but logging/data storage will fail.
-            // Consider setting an error state: currentSystemState = STATE_PSRAM_ERROR; (new state needed)
-        } else {
-           Serial.println("PSRAM Buffer initialized.");
-        }
-    } else {
-        Serial.println("PSRAM not found!"); // Simplified message
-        // Handle error - PSRAM is critical for the buffer
-        // currentSystemState = STATE_PSRAM_ERROR; 
+    if (!initializeEventLog()) {
+        Serial.println("Failed to create event log queue! Summary records will be dropped.");
+    }
+
+    // Memory arenas; everything permanent in PSRAM (trace rings, framebuffer, ...) is carved from them
+    if (!psramFound()) {
+        Serial.println("PSRAM not found! Bulk buffers fall back to internal RAM where they fit.");
+    }
+    if (!memPlacementInit()) {
+        Serial.println("Memory placement: running with heap fallbacks.");
+    }
+    if (MEM_BENCH_AT_BOOT) {
+        memBenchmarkPrint(Serial, MEM_BENCH_BYTES);
+    }
+    if (!psramDataBuffer.initialize()) {
+        Serial.println("Record ring does not fit the PSRAM arena! Records will be dropped.");
+    }
+
+    #ifdef ENABLE_TRACE
+    if (!traceInit()) {
+        Serial.println("Trace rings do not fit the PSRAM arena! Tracing disabled.");
     }
-    #else
-    Serial.println("PSRAM support not compiled.");
-    // PSRAM is critical, if not compiled in, this is a configuration error for this app.
-    // currentSystemState = STATE_PSRAM_ERROR;
     #endif
 
+    // DFS / light sleep; the locks must exist before any task takes them
+    powerManagerInit();
+
+    // Shared I2C bus: bring up Wire and the on-board devices before any task can touch them
+    if (!initializeI2cBus()) {
+        Serial.println("I2C bus initialization failed! Battery and environment readings unavailable.");
+    }
+
     // Create FreeRTOS Tasks
     // Priority reminder: Higher number = higher priority
     // Core 0 for time-critical tasks if any, Core 1 for others / comms
-    // xTaskCreatePinnedToCore(dataAcquisitionTask, "DataAcqTask", 4096, NULL, 5, NULL, 0);
-    // xTaskCreatePinnedToCore(sdLoggingTask, "SDLogTask", 4096, NULL, 3, NULL, 1);
+    xTaskCreatePinnedToCore(dataAcquisitionTask, "DataAcqTask", 4096, NULL, 5, NULL, 0); // 200 Hz records into psramDataBuffer
+    xTaskCreatePinnedToCore(logRotationTask, "LogRotTask", 4096, NULL, 1, NULL, 1);       // Prepares the next log file, retires the last
+    xTaskCreatePinnedToCore(sdLoggingTask, "SDLogTask", 4096, NULL, 3, NULL, 1);          // Drains psramDataBuffer to the card
+    xTaskCreatePinnedToCore(i2cBusManagerTask, "I2CBusTask", 4096, NULL, 5, NULL, 0);    // Sole owner of Wire
+    xTaskCreatePinnedToCore(imuTask, "IMUTask", 4096, NULL, 6, NULL, 0);                  // FIFO drains via I2C bus manager
+    xTaskCreatePinnedToCore(analogCaptureTask, "AnalogTask", 8192, NULL, 5, NULL, 0);     // ADC DMA + FIR decimation
     xTaskCreatePinnedToCore(displayUpdateTask, "DisplayTask", 4096, NULL, 2, NULL, 0); // Uses g_dataMutex & g_gpsDataMutex
     xTaskCreatePinnedToCore(bleManagerTask, "BLETask", 8192, NULL, 4, NULL, 1);    // Uses g_dataMutex
     xTaskCreatePinnedToCore(gpsTask, "GPSTask", 4096, NULL, 3, NULL, 1);           // Uses g_gpsDataMutex
     Serial.println("GPS Task creation attempted."); // Confirmation message
-    // xTaskCreatePinnedToCore(wifiHandlerTask, "WiFiTask", 4096, NULL, 3, NULL, 1);
+    xTaskCreatePinnedToCore(wifiHandlerTask, "WiFiTask", 8192, NULL, 3, NULL, 1);  // Idle until 'wifi on'; reads the SD card
+    xTaskCreatePinnedToCore(rawCaptureTask, "CaptureTask", 4096, NULL, 1, NULL, 0); // Idle until 'capture on'; writes the SD card
 
     xTaskCreate(
         terminal_task,          // Task function
         "TerminalTask",         // Name of the task (for debugging)
-        4096,                   // Stack size in words
+        4096,                   // Stack size in bytes (ESP-IDF FreeRTOS)
         NULL,                   // Task input parameter
         1,                      // Priority of the task
         NULL                    // Task handle (optional)
@@ -0,0 +1,102 @@
+#include "mean_max_power.h"
+#include <string.h>
+
+MeanMaxPower::MeanMaxPower()
+    : _count(0), _maxDuration(0), _ring(nullptr), _ringLength(0), _pos(0), _seconds(0) {
+}
+
+bool MeanMaxPower::begin(const uint16_t* durations, size_t count, uint16_t* ring, uint32_t ringLength) {
+    if (count == 0 || count > MMP_MAX_DURATIONS || ring == nullptr) {
+        return false;
+    }
+    uint32_t longest = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (durations[i] == 0) return false;
+        if (durations[i] > longest) longest = durations[i];
+        _durations[i] = durations[i];
+    }
+    if (ringLength < longest) {
+        return false;
+    }
+    _count = count;
+    _maxDuration = longest;
+    _ring = ring;
+    _ringLength = ringLength;
+    reset();
+    return true;
+}
+
+void MeanMaxPower::reset() {
+    if (_ring != nullptr) {
+        memset(_ring, 0, _ringLength * sizeof(uint16_t));
+    }
+    memset(_sums, 0, sizeof(_sums));
+    memset(_bestSums, 0, sizeof(_bestSums));
+    memset(_bestEnd, 0, sizeof(_bestEnd));
+    _pos = 0;
+    _seconds = 0;
+}
+
+void MeanMaxPower::push(uint16_t watts) {
+    if (_ring == nullptr) return;
+    _seconds++;
+    for (size_t i = 0; i < _count; i++) {
+        // The ring starts zeroed, so a window that is not yet full simply sums fewer samples
+        uint32_t leaving = _ring[(_pos + _ringLength - _durations[i]) % _ringLength];
+        _sums[i] += watts - leaving;
+        if (_seconds >= _durations[i] && _sums[i] > _bestSums[i]) {
+            _bestSums[i] = _sums[i];
+            _bestEnd[i] = _seconds;
+        }
+    }
+    _ring[_pos] = watts;
+    _pos = (_pos + 1) % _ringLength;
+}
+
+void MeanMaxPower::pushZeros(uint32_t count) {
+    if (_ring == nullptr) return;
+    if (count < _maxDuration) {
+        while (count-- > 0) push(0);
+        return;
+    }
+    // A window that reaches full length inside the dropout counts once, at that second: it holds
+    // everything ridden so far, and later windows in the dropout only lose samples
+    for (size_t i = 0; i < _count; i++) {
+        if (_seconds < _durations[i] && _sums[i] > _bestSums[i]) {
+            _bestSums[i] = _sums[i];
+            _bestEnd[i] = _durations[i];
+        }
+    }
+    // Every window is now all zeros; zeros can never raise a best, so just clear and advance
+    memset(_ring, 0, _ringLength * sizeof(uint16_t));
+    memset(_sums, 0, sizeof(_sums));
+    _seconds += count;
+    _pos = (_pos + count) % _ringLength;
+}
+
+size_t MeanMaxPower::getCurve(MeanMaxPoint* out, size_t maxPoints) const {
+    size_t n = _count < maxPoints ? _count : maxPoints;
+    for (size_t i = 0; i < n; i++) {
+        out[i].duration_s = _durations[i];
+        out[i].best_watts = (float)_bestSums[i] / _durations[i];
+        out[i].best_end_s = _bestEnd[i];
+    }
+    return n;
+}
+
+uint32_t meanMaxLongestDuration(const uint16_t* durations, size_t count) {
+    uint32_t longest = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (durations[i] > longest) longest = durations[i];
+    }
+    return longest;
+}
+
+void meanMaxPowerSecondSink(uint16_t watts, uint32_t repeat, void* context) {
+    MeanMaxPower* mmp = (MeanMaxPower*)context;
+    if (repeat == 1) {
+        mmp->push(watts);
+    } else {
+        mmp->pushZeros(repeat); // PowerAnalytics only repeats zero-power dropouts
+    }
+}
@@ -0,0 +1,279 @@
+#include "mem_placement.h"
+#include "config.h"
+
+#include <esp_heap_caps.h>
+#include <esp_idf_version.h>
+#include <esp_timer.h>
+#if ESP_IDF_VERSION_MAJOR >= 5
+#include <esp_memory_utils.h> // For esp_ptr_internal and friends
+#else
+#include <soc/soc_memory_layout.h>
+#endif
+
+#define MEM_PLACEMENT_MAX_ENTRIES 32
+#define MEM_BENCH_PASSES 4
+#define MEM_BENCH_LINE_BYTES 64
+
+enum MemPlacementKind : uint8_t { MEM_KIND_STATIC, MEM_KIND_ARENA };
+
+struct MemPlacementEntry {
+    const char* owner;
+    const void* ptr;
+    uint32_t bytes;
+    MemRegion intended;
+    MemPlacementKind kind;
+};
+
+struct MemArena {
+    uint8_t* base;
+    size_t capacity;
+    size_t used;
+    uint32_t failures;
+};
+
+static const uint32_t s_regionCaps[MEM_REGION_COUNT] = {
+    MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT,
+    MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT,
+    MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT,
+};
+static const size_t s_arenaBytes[MEM_REGION_COUNT] = {
+    MEM_ARENA_INTERNAL_BYTES,
+    MEM_ARENA_DMA_BYTES,
+    MEM_ARENA_PSRAM_BYTES,
+};
+static const char* const s_regionNames[MEM_REGION_COUNT] = { "internal", "dma", "psram" };
+
+// Plain zero-initialized storage: statics register during static initialization
+static MemArena s_arenas[MEM_REGION_COUNT];
+static MemPlacementEntry s_entries[MEM_PLACEMENT_MAX_ENTRIES];
+static size_t s_entryCount = 0;
+static uint32_t s_entriesDropped = 0;
+static portMUX_TYPE s_placementMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void registerEntry(const char* owner, const void* ptr, size_t bytes, MemRegion intended, MemPlacementKind kind) {
+    portENTER_CRITICAL_SAFE(&s_placementMux);
+    if (s_entryCount < MEM_PLACEMENT_MAX_ENTRIES) {
+        s_entries[s_entryCount++] = { owner, ptr, (uint32_t)bytes, intended, kind };
+    } else {
+        s_entriesDropped++;
+    }
+    portEXIT_CRITICAL_SAFE(&s_placementMux);
+}
+
+bool memPlacementInit() {
+    bool ok = true;
+    for (int region = 0; region < MEM_REGION_COUNT; region++) {
+        MemArena& arena = s_arenas[region];
+        if (arena.base != nullptr || s_arenaBytes[region] == 0) {
+            continue;
+        }
+        arena.base = (uint8_t*)heap_caps_malloc(s_arenaBytes[region], s_regionCaps[region]);
+        if (arena.base == nullptr) {
+            Serial.printf("Memory placement: could not reserve the %u-byte %s arena.\n",
+                          (unsigned)s_arenaBytes[region], s_regionNames[region]);
+            ok = false;
+            continue;
+        }
+        arena.capacity = s_arenaBytes[region];
+    }
+    return ok;
+}
+
+void* memArenaAlloc(MemRegion region, size_t bytes, const char* owner, size_t align) {
+    if (region >= MEM_REGION_COUNT) {
+        return nullptr;
+    }
+    MemArena& arena = s_arenas[region];
+    void* result = nullptr;
+    portENTER_CRITICAL(&s_placementMux);
+    if (arena.base != nullptr) {
+        size_t start = (arena.used + align - 1) & ~(align - 1);
+        if (start + bytes <= arena.capacity) {
+            result = arena.base + start;
+            arena.used = start + bytes;
+        }
+    }
+    if (result == nullptr) {
+        arena.failures++;
+    }
+    portEXIT_CRITICAL(&s_placementMux);
+    if (result != nullptr) {
+        registerEntry(owner, result, bytes, region, MEM_KIND_ARENA);
+    }
+    return result;
+}
+
+void* memRegionMalloc(MemRegion region, size_t bytes) {
+    return region < MEM_REGION_COUNT ? heap_caps_malloc(bytes, s_regionCaps[region]) : nullptr;
+}
+
+MemRegion memRegionOf(const void* ptr) {
+    if (esp_ptr_external_ram(ptr)) {
+        return MEM_REGION_PSRAM;
+    }
+    if (esp_ptr_internal(ptr)) {
+        return esp_ptr_dma_capable(ptr) ? MEM_REGION_DMA : MEM_REGION_INTERNAL;
+    }
+    return MEM_REGION_UNKNOWN;
+}
+
+const char* memRegionName(MemRegion region) {
+    return region < MEM_REGION_COUNT ? s_regionNames[region] : "other";
+}
+
+void memArenaGetStats(MemRegion region, MemArenaStats* out) {
+    *out = MemArenaStats();
+    if (region >= MEM_REGION_COUNT) {
+        return;
+    }
+    portENTER_CRITICAL(&s_placementMux);
+    out->capacity = s_arenas[region].capacity;
+    out->used = s_arenas[region].used;
+    out->failures = s_arenas[region].failures;
+    portEXIT_CRITICAL(&s_placementMux);
+}
+
+void memPlacementRegister(const char* owner, const void* ptr, size_t bytes, MemRegion intended) {
+    registerEntry(owner, ptr, bytes, intended, MEM_KIND_STATIC);
+}
+
+// Internal data may sit in DMA-capable RAM (on the S3 most of it is); the reverse is a mistake
+static bool placementSatisfied(MemRegion intended, MemRegion actual) {
+    if (intended == MEM_REGION_INTERNAL) {
+        return actual == MEM_REGION_INTERNAL || actual == MEM_REGION_DMA;
+    }
+    return intended == actual;
+}
+
+void memPlacementPrint(Print& out) {
+    out.println("Arenas:");
+    for (int region = 0; region < MEM_REGION_COUNT; region++) {
+        MemArenaStats stats;
+        memArenaGetStats((MemRegion)region, &stats);
+        if (stats.capacity == 0) {
+            out.printf("  %-9s not reserved (heap free %u KB)\n", s_regionNames[region],
+                       (unsigned)(heap_caps_get_free_size(s_regionCaps[region]) / 1024));
+            continue;
+        }
+        out.printf("  %-9s %7u / %7u bytes used, %lu failed (heap free %u KB)\n", s_regionNames[region],
+                   (unsigned)stats.used, (unsigned)stats.capacity, (unsigned long)stats.failures,
+                   (unsigned)(heap_caps_get_free_size(s_regionCaps[region]) / 1024));
+    }
+
+    size_t count;
+    portENTER_CRITICAL(&s_placementMux);
+    count = s_entryCount;
+    portEXIT_CRITICAL(&s_placementMux);
+    out.println("Placement (! = not where it was meant to be):");
+    for (size_t i = 0; i < count; i++) {
+        const MemPlacementEntry& entry = s_entries[i]; // Entries never change once added
+        MemRegion actual = memRegionOf(entry.ptr);
+        out.printf(" %c %-24s %7lu bytes  %-6s want %-8s have %-8s\n",
+                   placementSatisfied(entry.intended, actual) ? ' ' : '!', entry.owner, (unsigned long)entry.bytes,
+                   entry.kind == MEM_KIND_ARENA ? "arena" : "static", memRegionName(entry.intended),
+                   memRegionName(actual));
+    }
+    if (s_entriesDropped > 0) {
+        out.printf("  (%lu registrations dropped, raise MEM_PLACEMENT_MAX_ENTRIES)\n", (unsigned long)s_entriesDropped);
+    }
+}
+
+static size_t gcd(size_t a, size_t b) {
+    while (b != 0) {
+        size_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static float throughputMbps(size_t bytes, int64_t elapsedUs) {
+    return elapsedUs > 0 ? (float)bytes / (float)elapsedUs : 0.0f; // bytes/us == MB/s
+}
+
+bool memBenchmarkRun(MemRegion region, size_t bytes, MemBenchResult* out) {
+    *out = MemBenchResult();
+    bytes &= ~(size_t)(MEM_BENCH_LINE_BYTES - 1);
+    if (region >= MEM_REGION_COUNT || bytes == 0) {
+        return false;
+    }
+    uint8_t* a = (uint8_t*)heap_caps_malloc(bytes, s_regionCaps[region]);
+    uint8_t* b = (uint8_t*)heap_caps_malloc(bytes, s_regionCaps[region]);
+    if (a == nullptr || b == nullptr) {
+        free(a);
+        free(b);
+        return false;
+    }
+    const size_t words = bytes / sizeof(uint32_t);
+    const size_t total = bytes * MEM_BENCH_PASSES;
+
+    int64_t start = esp_timer_get_time();
+    for (int pass = 0; pass < MEM_BENCH_PASSES; pass++) {
+        volatile uint32_t* p = (volatile uint32_t*)a;
+        for (size_t i = 0; i < words; i++) {
+            p[i] = (uint32_t)(i + pass);
+        }
+    }
+    out->write_mbps = throughputMbps(total, esp_timer_get_time() - start);
+
+    start = esp_timer_get_time();
+    uint32_t sum = 0;
+    for (int pass = 0; pass < MEM_BENCH_PASSES; pass++) {
+        const volatile uint32_t* p = (const volatile uint32_t*)a;
+        for (size_t i = 0; i < words; i++) {
+            sum += p[i];
+        }
+    }
+    out->read_mbps = throughputMbps(total, esp_timer_get_time() - start);
+
+    start = esp_timer_get_time();
+    for (int pass = 0; pass < MEM_BENCH_PASSES; pass++) {
+        memcpy(pass & 1 ? a : b, pass & 1 ? b : a, bytes);
+    }
+    out->memcpy_mbps = throughputMbps(total, esp_timer_get_time() - start);
+
+    // Pointer chase over both buffers, one line at a time in a scattered order: twice the buffer
+    // size in flight defeats the data cache when the buffers are larger than half of it.
+    const size_t lines = 2 * bytes / MEM_BENCH_LINE_BYTES;
+    size_t stride = lines * 5 / 8 + 1;
+    while (gcd(stride, lines) != 1) {
+        stride++; // Coprime, so the walk visits every line once before repeating
+    }
+    auto line = [&](size_t k) -> uint8_t* {
+        size_t half = lines / 2;
+        return (k < half ? a : b) + (k % half) * MEM_BENCH_LINE_BYTES;
+    };
+    size_t k = 0;
+    for (size_t i = 0; i < lines; i++) {
+        size_t next = (k + stride) % lines;
+        *(uint8_t**)line(k) = line(next);
+        k = next;
+    }
+    uint8_t* cursor = line(0);
+    start = esp_timer_get_time();
+    for (size_t i = 0; i < lines; i++) {
+        cursor = *(uint8_t* volatile*)cursor;
+    }
+    int64_t chaseUs = esp_timer_get_time() - start;
+    out->miss_ns = chaseUs * 1000.0f / lines;
+
+    volatile uintptr_t sink = sum + (uintptr_t)cursor;
+    (void)sink;
+    free(a);
+    free(b);
+    out->valid = true;
+    return true;
+}
+
+void memBenchmarkPrint(Print& out, size_t bytes) {
+    out.printf("Memory benchmark, %u KB buffers (MB/s; chase = ns per scattered line read):\n", (unsigned)(bytes / 1024));
+    for (int region = 0; region < MEM_REGION_COUNT; region++) {
+        MemBenchResult result;
+        if (!memBenchmarkRun((MemRegion)region, bytes, &result)) {
+            out.printf("  %-9s no room for two %u KB buffers\n", s_regionNames[region], (unsigned)(bytes / 1024));
+            continue;
+        }
+        out.printf("  %-9s memcpy %7.1f  read %7.1f  write %7.1f  chase %6.1f ns\n", s_regionNames[region],
+                   result.memcpy_mbps, result.read_mbps, result.write_mbps, result.miss_ns);
+    }
+}
@@ -0,0 +1,161 @@
+#include "nmea_parser.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define NMEA_MAX_FIELDS 20
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// "ddmm.mmmm" / "dddmm.mmmm" plus hemisphere; false for an empty field
+static bool parseCoordinate(const char* value, const char* hemisphere, double* out) {
+    if (value[0] == '\0' || hemisphere[0] == '\0') {
+        return false;
+    }
+    double raw = strtod(value, NULL);
+    int degrees = (int)(raw / 100.0);
+    double result = degrees + (raw - degrees * 100.0) / 60.0;
+    *out = (hemisphere[0] == 'S' || hemisphere[0] == 'W') ? -result : result;
+    return true;
+}
+
+// "hhmmss.sss"
+static bool parseTime(const char* value, uint32_t* out) {
+    if (strlen(value) < 6) {
+        return false;
+    }
+    uint32_t hms = (uint32_t)atol(value);
+    double seconds = strtod(value + 4, NULL);
+    *out = ((hms / 10000) * 3600 + (hms / 100 % 100) * 60) * 1000 + (uint32_t)(seconds * 1000.0 + 0.5);
+    return true;
+}
+
+NmeaParser::NmeaParser() {
+    reset();
+    memset(&_fix, 0, sizeof(_fix));
+    _sentences = 0;
+    _rejected = 0;
+}
+
+void NmeaParser::reset() {
+    _length = 0;
+    _overflow = false;
+    _last[0] = '\0';
+}
+
+NmeaSentenceType NmeaParser::feed(char c) {
+    if (c == '$') {
+        _length = 0; // A new sentence also ends one that lost its line ending
+        _overflow = false;
+    }
+    if (c == '\r') {
+        return NMEA_NONE;
+    }
+    if (c != '\n') {
+        if (_length < NMEA_MAX_SENTENCE) {
+            _line[_length++] = c;
+        } else {
+            _overflow = true;
+        }
+        return NMEA_NONE;
+    }
+    if (_length == 0) {
+        return NMEA_NONE;
+    }
+    _line[_length] = '\0';
+    NmeaSentenceType type = _overflow ? NMEA_INVALID : parseLine();
+    _length = 0;
+    _overflow = false;
+    if (type == NMEA_INVALID) {
+        _rejected++;
+    } else {
+        _sentences++;
+    }
+    return type;
+}
+
+NmeaSentenceType NmeaParser::parseLine() {
+    memcpy(_last, _line, _length + 1);
+    if (_line[0] != '$') {
+        return NMEA_INVALID;
+    }
+
+    // Checksum: XOR of everything between '$' and '*'
+    char* star = strchr(_line, '*');
+    if (star == NULL || star[1] == '\0' || star[2] == '\0') {
+        return NMEA_INVALID;
+    }
+    uint8_t checksum = 0;
+    for (const char* p = _line + 1; p < star; p++) {
+        checksum ^= (uint8_t)*p;
+    }
+    int high = hexValue(star[1]);
+    int low = hexValue(star[2]);
+    if (high < 0 || low < 0 || checksum != (uint8_t)(high << 4 | low)) {
+        return NMEA_INVALID;
+    }
+    *star = '\0';
+
+    // Split in place; empty fields stay as empty strings
+    char* fields[NMEA_MAX_FIELDS];
+    size_t count = 0;
+    char* p = _line + 1;
+    fields[count++] = p;
+    while ((p = strchr(p, ',')) != NULL && count < NMEA_MAX_FIELDS) {
+        *p++ = '\0';
+        fields[count++] = p;
+    }
+    size_t idLength = strlen(fields[0]);
+    if (idLength != 5) {
+        return NMEA_INVALID; // Talker (GP, GN, ...) plus a three-letter type
+    }
+    const char* kind = fields[0] + 2;
+
+    if (strcmp(kind, "RMC") == 0) {
+        // time, status, lat, N/S, lon, E/W, speed, course, date, ...
+        if (count < 10) {
+            return NMEA_INVALID;
+        }
+        parseTime(fields[1], &_fix.utc_time_ms);
+        _fix.fix = fields[2][0] == 'A';
+        parseCoordinate(fields[3], fields[4], &_fix.latitude_deg);
+        parseCoordinate(fields[5], fields[6], &_fix.longitude_deg);
+        if (fields[7][0] != '\0') _fix.speed_knots = strtof(fields[7], NULL);
+        if (fields[8][0] != '\0') _fix.course_deg = strtof(fields[8], NULL);
+        return NMEA_RMC;
+    }
+    if (strcmp(kind, "GGA") == 0) {
+        // time, lat, N/S, lon, E/W, quality, satellites, hdop, altitude, M, ...
+        if (count < 11) {
+            return NMEA_INVALID;
+        }
+        parseTime(fields[1], &_fix.utc_time_ms);
+        parseCoordinate(fields[2], fields[3], &_fix.latitude_deg);
+        parseCoordinate(fields[4], fields[5], &_fix.longitude_deg);
+        _fix.fix_quality = (uint8_t)atoi(fields[6]);
+        _fix.fix = _fix.fix_quality > 0;
+        _fix.satellites = (uint8_t)atoi(fields[7]);
+        if (fields[9][0] != '\0') _fix.altitude_m = strtof(fields[9], NULL);
+        return NMEA_GGA;
+    }
+    return NMEA_INVALID;
+}
+
+GpsReading nmeaGpsReading(const NmeaFix& fix) {
+    GpsReading reading = {};
+    reading.valid = fix.fix;
+    reading.satellites = fix.satellites;
+    if (fix.fix) {
+        reading.latitude_deg = fix.latitude_deg;
+        reading.longitude_deg = fix.longitude_deg;
+        reading.altitude_m = fix.altitude_m;
+        reading.speed_mps = fix.speed_knots * NMEA_KNOTS_TO_MPS;
+        reading.fix_quality = fix.fix_quality;
+    }
+    return reading;
+}
@@ -0,0 +1,115 @@
+#include "power_analytics.h"
+#include <math.h>
+#include <string.h>
+
+PowerAnalytics::PowerAnalytics(uint16_t ftpWatts, uint32_t dropoutMs)
+    : _ftpWatts(ftpWatts), _dropoutMs(dropoutMs), _sink(nullptr), _sinkContext(nullptr) {
+    reset();
+}
+
+void PowerAnalytics::reset() {
+    _started = false;
+    _secondStartMs = 0;
+    _lastSampleMs = 0;
+    _heldWatts = 0;
+    _slotSum = 0;
+    _slotCount = 0;
+    memset(_ring, 0, sizeof(_ring));
+    _ringPos = 0;
+    _sum3 = _sum10 = _sum30 = 0;
+    _seconds = 0;
+    _totalJoules = 0;
+    _sumFourthPower = 0.0;
+    _fourthPowerCount = 0;
+}
+
+void PowerAnalytics::pushSecond(uint16_t watts) {
+    // Samples leaving each window; the ring starts zeroed so partial windows need no special case
+    const uint32_t n = POWER_ANALYTICS_WINDOW_S;
+    _sum3 += watts - _ring[(_ringPos + n - 3) % n];
+    _sum10 += watts - _ring[(_ringPos + n - 10) % n];
+    _sum30 += watts - _ring[_ringPos];
+    _ring[_ringPos] = watts;
+    _ringPos = (_ringPos + 1) % n;
+
+    _seconds++;
+    _totalJoules += watts;
+    if (_seconds >= POWER_ANALYTICS_WINDOW_S) {
+        double avg30 = _sum30 / (double)POWER_ANALYTICS_WINDOW_S;
+        double sq = avg30 * avg30;
+        _sumFourthPower += sq * sq;
+        _fourthPowerCount++;
+    }
+    if (_sink != nullptr) {
+        _sink(watts, 1, _sinkContext);
+    }
+}
+
+uint32_t PowerAnalytics::addSample(uint32_t timestampMs, uint16_t watts) {
+    if (!_started) {
+        _started = true;
+        _secondStartMs = timestampMs;
+        _lastSampleMs = timestampMs;
+        _slotSum = watts;
+        _slotCount = 1;
+        _heldWatts = watts;
+        return 0;
+    }
+
+    uint32_t completed = 0;
+    while (timestampMs - _secondStartMs >= 1000) {
+        // Slot value: mean of the notifications inside it, else the held value until the dropout expires
+        uint16_t value;
+        if (_slotCount > 0) {
+            value = (uint16_t)((_slotSum + _slotCount / 2) / _slotCount);
+            _heldWatts = value;
+        } else if (_secondStartMs - _lastSampleMs < _dropoutMs) {
+            value = _heldWatts;
+        } else {
+            value = 0;
+        }
+        _slotSum = 0;
+        _slotCount = 0;
+
+        // A long dropout is all zeros once the window has drained: account for it in one step
+        if (value == 0 && _sum30 == 0 && _seconds >= POWER_ANALYTICS_WINDOW_S) {
+            uint32_t skipped = (timestampMs - _secondStartMs) / 1000;
+            _seconds += skipped;
+            _fourthPowerCount += skipped;
+            _secondStartMs += skipped * 1000;
+            completed += skipped;
+            if (_sink != nullptr && skipped > 0) {
+                _sink(0, skipped, _sinkContext);
+            }
+            break;
+        }
+
+        pushSecond(value);
+        _secondStartMs += 1000;
+        completed++;
+    }
+
+    _slotSum += watts;
+    _slotCount++;
+    _lastSampleMs = timestampMs;
+    return completed;
+}
+
+void PowerAnalytics::getMetrics(PowerMetrics* out) const {
+    uint32_t n3 = _seconds < 3 ? _seconds : 3;
+    uint32_t n10 = _seconds < 10 ? _seconds : 10;
+    uint32_t n30 = _seconds < POWER_ANALYTICS_WINDOW_S ? _seconds : POWER_ANALYTICS_WINDOW_S;
+    out->avg3s_watts = n3 > 0 ? (float)_sum3 / n3 : 0.0f;
+    out->avg10s_watts = n10 > 0 ? (float)_sum10 / n10 : 0.0f;
+    out->avg30s_watts = n30 > 0 ? (float)_sum30 / n30 : 0.0f;
+    out->avg_watts = _seconds > 0 ? (float)((double)_totalJoules / _seconds) : 0.0f;
+
+    double np = _fourthPowerCount > 0 ? pow(_sumFourthPower / _fourthPowerCount, 0.25) : 0.0;
+    double intensity = _ftpWatts > 0 ? np / _ftpWatts : 0.0;
+    out->normalized_power = (float)np;
+    out->intensity_factor = (float)intensity;
+    // TSS = (seconds * NP * IF) / (FTP * 3600) * 100
+    out->tss = _ftpWatts > 0 ? (float)((_seconds * np * intensity) / (_ftpWatts * 3600.0) * 100.0) : 0.0f;
+    out->work_kj = (float)(_totalJoules / 1000.0);
+    out->elapsed_s = _seconds;
+}
@@ -0,0 +1,141 @@
+#include "power_manager.h"
+#include "config.h"
+
+#include <esp_idf_version.h>
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#include <esp_timer.h> // For esp_timer_get_time
+#if ESP_IDF_VERSION_MAJOR < 5
+#include <esp32s3/pm.h> // For esp_pm_config_esp32s3_t
+#endif
+
+struct PowerLockDef {
+    const char* name;
+    esp_pm_lock_type_t type;
+};
+
+static const PowerLockDef s_lockDefs[POWER_LOCK_COUNT] = {
+    { "i2c",      ESP_PM_NO_LIGHT_SLEEP },
+    { "spi",      ESP_PM_APB_FREQ_MAX },
+    { "ble",      ESP_PM_CPU_FREQ_MAX },
+    { "gps_uart", ESP_PM_NO_LIGHT_SLEEP },
+    { "usb",      ESP_PM_NO_LIGHT_SLEEP },
+};
+
+static esp_pm_lock_handle_t s_locks[POWER_LOCK_COUNT] = {NULL};
+static uint16_t s_depth[POWER_LOCK_COUNT] = {0};
+static int64_t s_heldSinceUs[POWER_LOCK_COUNT] = {0};
+static PowerLockStats s_stats[POWER_LOCK_COUNT];
+static PowerManagerStatus s_status;
+static portMUX_TYPE s_lockMux = portMUX_INITIALIZER_UNLOCKED;
+
+bool powerManagerInit() {
+#if CONFIG_PM_ENABLE
+    for (int i = 0; i < POWER_LOCK_COUNT; i++) {
+        if (esp_pm_lock_create(s_lockDefs[i].type, 0, s_lockDefs[i].name, &s_locks[i]) != ESP_OK) {
+            s_locks[i] = NULL;
+        }
+    }
+
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_pm_config_t config = {};
+#else
+    esp_pm_config_esp32s3_t config = {};
+#endif
+    config.max_freq_mhz = POWER_CPU_MAX_MHZ;
+    config.min_freq_mhz = POWER_CPU_MIN_MHZ;
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    config.light_sleep_enable = POWER_LIGHT_SLEEP_ENABLE;
+#else
+    config.light_sleep_enable = false; // Light sleep needs tickless idle
+#endif
+    esp_err_t err = esp_pm_configure(&config);
+    if (err != ESP_OK) {
+        Serial.printf("Power manager: esp_pm_configure failed (%s), running at a fixed clock.\n", esp_err_to_name(err));
+        return false;
+    }
+    s_status.dfs_enabled = true;
+    s_status.light_sleep_enabled = config.light_sleep_enable;
+    s_status.max_mhz = POWER_CPU_MAX_MHZ;
+    s_status.min_mhz = POWER_CPU_MIN_MHZ;
+    Serial.printf("Power manager: DFS %d-%d MHz, light sleep %s.\n", POWER_CPU_MIN_MHZ, POWER_CPU_MAX_MHZ,
+                  config.light_sleep_enable ? "on, held off while analog DMA runs" : "off");
+    return true;
+#else
+    s_status.max_mhz = s_status.min_mhz = getCpuFrequencyMhz();
+    Serial.println("Power manager: not available in this build (CONFIG_PM_ENABLE unset), fixed clock.");
+    return false;
+#endif
+}
+
+void powerGetStatus(PowerManagerStatus* out) {
+    *out = s_status;
+}
+
+void IRAM_ATTR powerLockAcquire(PowerLockId id) {
+    portENTER_CRITICAL_SAFE(&s_lockMux);
+    if (s_depth[id]++ == 0) {
+        s_heldSinceUs[id] = esp_timer_get_time();
+        s_stats[id].acquisitions++;
+    }
+    portEXIT_CRITICAL_SAFE(&s_lockMux);
+    if (s_locks[id] != NULL) {
+        esp_pm_lock_acquire(s_locks[id]);
+    }
+}
+
+void IRAM_ATTR powerLockRelease(PowerLockId id) {
+    if (s_locks[id] != NULL) {
+        esp_pm_lock_release(s_locks[id]);
+    }
+    portENTER_CRITICAL_SAFE(&s_lockMux);
+    if (s_depth[id] > 0 && --s_depth[id] == 0) {
+        s_stats[id].held_us += esp_timer_get_time() - s_heldSinceUs[id];
+    }
+    portEXIT_CRITICAL_SAFE(&s_lockMux);
+}
+
+const char* powerLockName(PowerLockId id) {
+    return id < POWER_LOCK_COUNT ? s_lockDefs[id].name : "?";
+}
+
+void powerGetLockStats(PowerLockStats out[POWER_LOCK_COUNT]) {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_lockMux);
+    for (int i = 0; i < POWER_LOCK_COUNT; i++) {
+        out[i] = s_stats[i];
+        if (s_depth[i] > 0) {
+            out[i].held_us += now - s_heldSinceUs[i];
+        }
+    }
+    portEXIT_CRITICAL(&s_lockMux);
+}
+
+void powerEnableUartWakeup(uart_port_t port) {
+#if CONFIG_PM_ENABLE
+    if (s_status.light_sleep_enabled) {
+        uart_set_wakeup_threshold(port, 3); // Edges needed to wake; those characters are lost
+        esp_sleep_enable_uart_wakeup(port);
+    }
+#else
+    (void)port;
+#endif
+}
+
+bool powerPrintProfile(Print& out) {
+#if CONFIG_PM_ENABLE && CONFIG_PM_PROFILING
+    static char text[1024]; // Only the terminal task prints profiles
+    FILE* stream = fmemopen(text, sizeof(text), "w");
+    if (stream == NULL) {
+        return false;
+    }
+    esp_pm_dump_locks(stream);
+    size_t length = ftell(stream);
+    fclose(stream);
+    out.write((const uint8_t*)text, length < sizeof(text) ? length : sizeof(text) - 1);
+    return true;
+#else
+    (void)out;
+    return false;
+#endif
+}
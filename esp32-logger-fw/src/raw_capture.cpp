@@ -0,0 +1,288 @@
+#include "raw_capture.h"
+#include "config.h"
+#include "sd_card.h"
+#include "mem_placement.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define RAW_CAPTURE_NAME_MAX 32
+
+// Internal RAM: producers copy into it inside a critical section, and SdFat writes straight out
+// of it, so neither side pays for PSRAM misses
+MEM_HOT static uint8_t s_ring[RAW_CAPTURE_RING_BYTES];
+MEM_PLACED(s_ring, MEM_REGION_INTERNAL);
+static size_t s_ringHead = 0;   // Next write
+static size_t s_ringCount = 0;
+static volatile RawCaptureMode s_mode = RAW_CAPTURE_OFF;      // What producers see
+static volatile RawCaptureMode s_requested = RAW_CAPTURE_OFF; // What the terminal asked for
+static volatile uint32_t s_session = 0;
+static RawCaptureStats s_stats;
+static portMUX_TYPE s_ringMux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t s_taskHandle = NULL;
+
+// Capture task only
+static FsFile s_file;
+static uint32_t s_nextIndex = 0;
+
+void rawCaptureSetMode(RawCaptureMode mode) {
+    s_requested = mode;
+    if (s_taskHandle != NULL) {
+        xTaskNotifyGive(s_taskHandle);
+    }
+}
+
+RawCaptureMode rawCaptureMode() {
+    return s_mode;
+}
+
+bool rawCaptureDecoding() {
+    return s_mode != RAW_CAPTURE_ONLY;
+}
+
+uint32_t rawCaptureSession() {
+    return s_session;
+}
+
+// Copies into the ring at the head (ring lock held, room checked)
+static void ringCopyIn(const uint8_t* data, size_t length) {
+    size_t first = RAW_CAPTURE_RING_BYTES - s_ringHead;
+    if (first > length) first = length;
+    memcpy(&s_ring[s_ringHead], data, first);
+    memcpy(&s_ring[0], data + first, length - first);
+    s_ringHead = (s_ringHead + length) % RAW_CAPTURE_RING_BYTES;
+    s_ringCount += length;
+}
+
+bool rawCaptureAppend(uint32_t tMs, CaptureType type, const void* payload, size_t length) {
+    if (s_mode == RAW_CAPTURE_OFF || length > CAPTURE_MAX_PAYLOAD) {
+        return false;
+    }
+    uint8_t header[CAPTURE_CHUNK_HEADER_SIZE];
+    captureEncodeChunkHeader(tMs, type, (uint16_t)length, header);
+
+    bool queued = false;
+    portENTER_CRITICAL(&s_ringMux);
+    if (s_mode != RAW_CAPTURE_OFF) {
+        if (RAW_CAPTURE_RING_BYTES - s_ringCount >= sizeof(header) + length) {
+            ringCopyIn(header, sizeof(header));
+            ringCopyIn((const uint8_t*)payload, length);
+            if (s_ringCount > s_stats.ring_high_water) s_stats.ring_high_water = s_ringCount;
+            s_stats.chunks++;
+            queued = true;
+        } else {
+            s_stats.chunks_dropped++; // Whole chunk; the file never holds a partial one
+        }
+    }
+    portEXIT_CRITICAL(&s_ringMux);
+    return queued;
+}
+
+void rawCaptureGetStats(RawCaptureStats* out) {
+    portENTER_CRITICAL(&s_ringMux);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_ringMux);
+    out->mode = s_mode;
+}
+
+void rawCapturePrint(Print& out) {
+    RawCaptureStats stats;
+    rawCaptureGetStats(&stats);
+    static const char* const modeNames[] = { "off", "on", "only (GPS and power not decoded)" };
+    out.printf("Capture %s", modeNames[stats.mode]);
+    if (stats.file_open) {
+        out.printf(": cap_%03lu.cap", (unsigned long)stats.file_index);
+    }
+    out.printf("\n%lu chunks, %lu dropped, %llu KB written, %lu write errors; ring high-water %lu/%u bytes\n",
+               (unsigned long)stats.chunks, (unsigned long)stats.chunks_dropped,
+               (unsigned long long)(stats.bytes_written / 1024), (unsigned long)stats.write_errors,
+               (unsigned long)stats.ring_high_water, RAW_CAPTURE_RING_BYTES);
+}
+
+// --- Counter file (card lock held), as log_rotation keeps LOG_COUNTER_FILE ---
+
+static uint32_t readCounter() {
+    FsFile file;
+    char text[16] = "";
+    if (file.open(&sdCardFs(), RAW_CAPTURE_COUNTER_FILE, O_RDONLY)) {
+        int n = file.read(text, sizeof(text) - 1);
+        text[n > 0 ? n : 0] = '\0';
+        file.close();
+    }
+    return strtoul(text, NULL, 10);
+}
+
+static bool writeCounter(uint32_t value) {
+    FsFile file;
+    char text[16];
+    int length = snprintf(text, sizeof(text), "%lu\n", (unsigned long)value);
+    bool ok = file.open(&sdCardFs(), RAW_CAPTURE_COUNTER_FILE, O_WRONLY | O_CREAT | O_TRUNC) &&
+              file.write(text, length) == (size_t)length;
+    file.close();
+    return ok;
+}
+
+// Recovery only (counter file lost or stale): one pass over the directory for the highest number
+static uint32_t scanForFreeNumber() {
+    FsFile dir = sdCardFs().open(LOG_DIRECTORY);
+    uint32_t highest = 0;
+    bool any = false;
+    FsFile entry;
+    char name[64];
+    while (dir && entry.openNext(&dir, O_RDONLY)) {
+        unsigned long index;
+        entry.getName(name, sizeof(name));
+        if (sscanf(name, "cap_%lu.", &index) == 1 && (!any || index > highest)) {
+            highest = (uint32_t)index;
+            any = true;
+        }
+        entry.close();
+    }
+    dir.close();
+    return any ? highest + 1 : 0;
+}
+
+// --- Capture task ---
+
+// Creates the next free cap_NNN.cap, preallocates it and writes the header. The number comes from
+// RAW_CAPTURE_COUNTER_FILE; each step takes the card lock on its own, like log rotation's.
+static bool openCaptureFile() {
+    if (!sdCardBegin()) {
+        return false;
+    }
+    char name[RAW_CAPTURE_NAME_MAX];
+    sdCardLock(portMAX_DELAY);
+    s_nextIndex = readCounter(); // Per session: the card may have been swapped since the last one
+    bool created = false;
+    for (int attempt = 0; !created && attempt < 2 * RAW_CAPTURE_NAME_ATTEMPTS; attempt++) {
+        if (attempt == RAW_CAPTURE_NAME_ATTEMPTS) {
+            s_nextIndex = scanForFreeNumber(); // Every guess was taken; the counter is stale
+        }
+        snprintf(name, sizeof(name), "%scap_%03lu.cap", LOG_DIRECTORY, (unsigned long)s_nextIndex);
+        created = s_file.open(&sdCardFs(), name, O_RDWR | O_CREAT | O_EXCL);
+        s_nextIndex++;
+    }
+    sdCardUnlock();
+    if (!created) {
+        return false;
+    }
+
+    sdCardLock(portMAX_DELAY);
+    bool contiguous = s_file.preAllocate(RAW_CAPTURE_PREALLOC_BYTES);
+    sdCardUnlock();
+    if (!contiguous) {
+        Serial.println("Capture: file not preallocated (card full or fragmented).");
+    }
+
+    CaptureFileHeader header;
+    memcpy(header.magic, CAPTURE_MAGIC, sizeof(header.magic));
+    header.version = CAPTURE_VERSION;
+    header.header_length = sizeof(header);
+    header.start_ms = millis();
+    sdCardLock(portMAX_DELAY);
+    bool ok = s_file.write(&header, sizeof(header)) == sizeof(header) && s_file.sync();
+    if (!ok) {
+        s_file.close();
+        sdCardFs().remove(name);
+    }
+    if (!writeCounter(s_nextIndex)) {
+        Serial.println("Capture: could not update " RAW_CAPTURE_COUNTER_FILE ".");
+    }
+    sdCardUnlock();
+    if (!ok) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&s_ringMux);
+    s_stats = RawCaptureStats();
+    s_stats.file_open = true;
+    s_stats.file_index = s_nextIndex - 1;
+    s_stats.bytes_written = sizeof(CaptureFileHeader);
+    s_ringHead = 0;
+    s_ringCount = 0;
+    portEXIT_CRITICAL(&s_ringMux);
+    s_session++;
+    Serial.printf("Capturing to %s\n", name);
+    return true;
+}
+
+// Writes ring contents to the file: whole RAW_CAPTURE_WRITE_BYTES blocks, or everything with `all`.
+// Only this task consumes, so the bytes at the tail stay put while they are written.
+static void drainRing(bool all) {
+    for (;;) {
+        portENTER_CRITICAL(&s_ringMux);
+        size_t count = s_ringCount;
+        size_t tail = (s_ringHead + RAW_CAPTURE_RING_BYTES - count) % RAW_CAPTURE_RING_BYTES;
+        portEXIT_CRITICAL(&s_ringMux);
+        if (count == 0 || (!all && count < RAW_CAPTURE_WRITE_BYTES)) {
+            return;
+        }
+        size_t span = RAW_CAPTURE_RING_BYTES - tail;
+        if (span > count) span = count;
+        if (span > RAW_CAPTURE_WRITE_BYTES) span = RAW_CAPTURE_WRITE_BYTES;
+
+        sdCardLock(portMAX_DELAY);
+        bool ok = s_file.write(&s_ring[tail], span) == span;
+        sdCardUnlock();
+
+        portENTER_CRITICAL(&s_ringMux);
+        s_ringCount -= span; // Consumed either way; a failed write is counted, not retried
+        if (ok) {
+            s_stats.bytes_written += span;
+        } else {
+            s_stats.write_errors++;
+        }
+        portEXIT_CRITICAL(&s_ringMux);
+    }
+}
+
+static void closeCaptureFile() {
+    sdCardLock(portMAX_DELAY);
+    s_file.truncate(s_file.curPosition()); // Drop the preallocated tail
+    s_file.close();
+    sdCardUnlock();
+    portENTER_CRITICAL(&s_ringMux);
+    s_stats.file_open = false;
+    portEXIT_CRITICAL(&s_ringMux);
+    rawCapturePrint(Serial);
+}
+
+void rawCaptureTask(void* pvParameters) {
+    s_taskHandle = xTaskGetCurrentTaskHandle();
+    uint32_t lastSyncMs = 0;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, s_file.isOpen() ? pdMS_TO_TICKS(RAW_CAPTURE_POLL_MS) : portMAX_DELAY);
+        RawCaptureMode requested = s_requested;
+
+        if (!s_file.isOpen()) {
+            if (requested == RAW_CAPTURE_OFF) {
+                continue;
+            }
+            if (!openCaptureFile()) {
+                Serial.println("Capture: could not create a capture file on the SD card.");
+                s_requested = RAW_CAPTURE_OFF;
+                continue;
+            }
+            lastSyncMs = millis();
+        }
+
+        s_mode = requested; // Producers stop here when switched off; the rest is drained below
+        bool closing = requested == RAW_CAPTURE_OFF;
+        bool syncDue = closing || millis() - lastSyncMs >= RAW_CAPTURE_SYNC_MS;
+        drainRing(syncDue);
+        if (syncDue) {
+            sdCardLock(portMAX_DELAY);
+            bool ok = s_file.sync();
+            sdCardUnlock();
+            if (!ok) {
+                portENTER_CRITICAL(&s_ringMux);
+                s_stats.write_errors++;
+                portEXIT_CRITICAL(&s_ringMux);
+            }
+            lastSyncMs = millis();
+        }
+        if (closing) {
+            closeCaptureFile();
+        }
+    }
+}
@@ -0,0 +1,117 @@
+#include "record_assembler.h"
+
+#include <math.h>
+
+RecordAssembler::RecordAssembler(LogRecordV1* staging, size_t stagingCapacity, size_t spillRecords)
+    : _staging(staging), _stagingCapacity(stagingCapacity), _spillRecords(spillRecords), _stagingCount(0),
+      _ring(), _sink(nullptr), _context(nullptr), _current(), _lastStored(), _imuSum(), _imuSumCount(0) {}
+
+bool RecordAssembler::begin(const LogBackpressureConfig& config, const RecordRing& ring, RecordTransitionSink sink,
+                            void* context) {
+    _ring = ring;
+    _sink = sink;
+    _context = context;
+    _stagingCount = 0;
+    memset(&_lastStored, 0, sizeof(_lastStored));
+    memset(_imuSum, 0, sizeof(_imuSum));
+    _imuSumCount = 0;
+    return _backpressure.begin(config);
+}
+
+void RecordAssembler::addImuSamples(const ImuSample* samples, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        for (int axis = 0; axis < 3; axis++) {
+            _imuSum[axis] += samples[i].accel_mps2[axis];
+            _imuSum[3 + axis] += samples[i].gyro_radps[axis];
+        }
+    }
+    _imuSumCount += count;
+}
+
+const LogRecordV1& RecordAssembler::assemble(uint32_t nowMs, const RecordInputs& inputs) {
+    LogRecordV1& record = _current;
+    record.system_timestamp_ms = nowMs;
+
+    // RMC/GGA carry no 2D/3D distinction; a fix comes with altitude, so it is logged as 3D
+    record.gps_latitude = inputs.gps_fix ? (float)inputs.latitude_deg : 0.0f;
+    record.gps_longitude = inputs.gps_fix ? (float)inputs.longitude_deg : 0.0f;
+    record.gps_altitude = inputs.gps_fix ? inputs.altitude_m : 0.0f;
+    record.gps_speed_mps = inputs.gps_fix ? inputs.speed_mps : 0.0f;
+    record.gps_sats = inputs.satellites;
+    record.gps_fix_type = inputs.gps_fix ? 3 : 0;
+
+    const ElevationEstimate& elevation = inputs.elevation;
+    record.elevation_m = elevation.valid ? elevation.elevation_m : NAN;
+    record.vertical_speed_mps = elevation.valid ? elevation.vertical_speed_mps : NAN;
+    record.gradient_percent = elevation.valid ? elevation.gradient_percent : NAN;
+
+    // Average of the IMU samples since the last stored record; NAN when none arrived (IMU absent or stalled)
+    if (_imuSumCount > 0) {
+        record.imu_accel_x_mps2 = _imuSum[0] / _imuSumCount;
+        record.imu_accel_y_mps2 = _imuSum[1] / _imuSumCount;
+        record.imu_accel_z_mps2 = _imuSum[2] / _imuSumCount;
+        record.imu_gyro_x_radps = _imuSum[3] / _imuSumCount;
+        record.imu_gyro_y_radps = _imuSum[4] / _imuSumCount;
+        record.imu_gyro_z_radps = _imuSum[5] / _imuSumCount;
+    } else {
+        record.imu_accel_x_mps2 = NAN;
+        record.imu_accel_y_mps2 = NAN;
+        record.imu_accel_z_mps2 = NAN;
+        record.imu_gyro_x_radps = NAN;
+        record.imu_gyro_y_radps = NAN;
+        record.imu_gyro_z_radps = NAN;
+    }
+    record.roll_deg = inputs.attitude_valid ? inputs.roll_deg : NAN;
+    record.pitch_deg = inputs.attitude_valid ? inputs.pitch_deg : NAN;
+
+    record.power_watts = inputs.power_watts;
+    record.cadence_rpm = inputs.cadence_rpm;
+    memcpy(record.analog_ch, inputs.analog, sizeof(record.analog_ch));
+    return record;
+}
+
+// Moves staged records into the ring; with `force` even a partial batch (ring has room)
+void RecordAssembler::spill(bool force) {
+    if (_stagingCount == 0 || (!force && _stagingCount < _spillRecords)) {
+        return;
+    }
+    size_t moved = _ring.write(_ring.context, _staging, _stagingCount);
+    if (moved > 0 && moved < _stagingCount) {
+        memmove(_staging, _staging + moved, (_stagingCount - moved) * sizeof(LogRecordV1));
+    }
+    _stagingCount -= moved;
+}
+
+bool RecordAssembler::store(uint32_t nowMs) {
+    const LogRecordV1& record = _current;
+    bool priority = record.power_watts != _lastStored.power_watts ||
+                    record.cadence_rpm != _lastStored.cadence_rpm ||
+                    record.gps_latitude != _lastStored.gps_latitude ||
+                    record.gps_longitude != _lastStored.gps_longitude ||
+                    record.gps_speed_mps != _lastStored.gps_speed_mps ||
+                    record.gps_fix_type != _lastStored.gps_fix_type;
+    if (!_backpressure.admit(priority)) {
+        return false;
+    }
+    if (_stagingCount == _stagingCapacity) {
+        spill(true);
+    }
+    if (_stagingCount < _stagingCapacity) {
+        _staging[_stagingCount++] = record;
+    } else {
+        _backpressure.recordDropped(); // Admitted but lost; it is in the stats
+    }
+    spill(_backpressure.level() != LOG_RATE_FULL); // Degraded: don't sit on records
+
+    LogBackpressureTransition transition;
+    if (_backpressure.update(_ring.count(_ring.context), _ring.capacity, _stagingCount == _stagingCapacity, nowMs,
+                             &transition) &&
+        _sink != nullptr) {
+        _sink(_context, transition, _stagingCount);
+    }
+
+    _lastStored = record; // Start a new IMU averaging window
+    memset(_imuSum, 0, sizeof(_imuSum));
+    _imuSumCount = 0;
+    return true;
+}
@@ -0,0 +1,339 @@
+#include "sd_bench.h"
+#include "config.h"
+#include "sd_card.h"
+#include "mem_placement.h"
+#include "log_schema.h" // Record size for the logger's data rate
+
+#include <esp_timer.h>
+#include <math.h>
+
+#define SD_BENCH_MIN_BLOCK 512
+#define SD_BENCH_MAX_BLOCK (SD_BENCH_MIN_BLOCK << (SD_BENCH_BLOCK_SIZES - 1))
+#define SD_BENCH_YIELD_BYTES (256 * 1024)    // Sequential phases give the idle task a tick this often
+#define SD_BENCH_BUCKET_US 250
+#define SD_BENCH_BUCKETS 1024                // 256 ms of resolution; slower writes still count toward max
+#define SD_BENCH_LOCK_MS 5000
+
+// Logger write pattern: one staging spill of records per write
+#define SD_BENCH_BATCH_BYTES (LOG_STAGING_SPILL_RECORDS * LOG_RECORD_V1_SIZE)
+#define SD_BENCH_LOGGER_BYTES_PER_S (LOG_RECORD_V1_SIZE * 1000 / DATA_ACQUISITION_INTERVAL_MS)
+
+static float kbps(uint64_t bytes, int64_t elapsedUs) {
+    return elapsedUs > 0 ? (float)bytes * 1000000.0f / 1024.0f / (float)elapsedUs : 0.0f;
+}
+
+static bool lockCard(Print& out) {
+    if (!sdCardLock(pdMS_TO_TICKS(SD_BENCH_LOCK_MS))) {
+        out.println("sdbench: SD card busy.");
+        return false;
+    }
+    return true;
+}
+
+// Creates (truncating) the scratch file, optionally reserving `preallocate` contiguous bytes
+static bool openScratch(FsFile& file, uint64_t preallocate, Print& out) {
+    if (!file.open(&sdCardFs(), SD_BENCH_FILE, O_RDWR | O_CREAT | O_TRUNC)) {
+        out.println("sdbench: cannot create " SD_BENCH_FILE);
+        return false;
+    }
+    if (preallocate > 0 && !file.preAllocate(preallocate)) {
+        out.println("sdbench: preallocation failed (no contiguous space?), appending instead.");
+    }
+    return true;
+}
+
+// Sequential write then read-back of `total` bytes in `block`-sized calls. The card lock is held
+// for the whole measurement; yields happen outside the timed intervals.
+static bool measureThroughput(uint8_t* buffer, uint32_t block, uint32_t total, SdBenchThroughput* result,
+                              Print& out) {
+    result->block_bytes = block;
+    if (!lockCard(out)) {
+        return false;
+    }
+    FsFile file;
+    if (!openScratch(file, total, out)) {
+        sdCardUnlock();
+        return false;
+    }
+    int64_t elapsed = 0;
+    uint32_t done = 0;
+    bool ok = true;
+    while (ok && done < total) {
+        int64_t start = esp_timer_get_time();
+        for (uint32_t chunk = 0; ok && chunk < SD_BENCH_YIELD_BYTES && done < total; chunk += block, done += block) {
+            ok = file.write(buffer, block) == block;
+        }
+        if (done >= total) {
+            ok = ok && file.sync(); // Data is on the card before the clock stops
+        }
+        elapsed += esp_timer_get_time() - start;
+        vTaskDelay(1);
+    }
+    result->write_kbps = ok ? kbps(total, elapsed) : 0.0f;
+
+    elapsed = 0;
+    done = 0;
+    ok = ok && file.seekSet(0);
+    while (ok && done < total) {
+        int64_t start = esp_timer_get_time();
+        for (uint32_t chunk = 0; ok && chunk < SD_BENCH_YIELD_BYTES && done < total; chunk += block, done += block) {
+            ok = file.read(buffer, block) == (int)block;
+        }
+        elapsed += esp_timer_get_time() - start;
+        vTaskDelay(1);
+    }
+    result->read_kbps = ok ? kbps(total, elapsed) : 0.0f;
+    file.close();
+    sdCardUnlock();
+    if (!ok) {
+        out.printf("sdbench: I/O error at %u-byte blocks.\n", (unsigned)block);
+    }
+    return ok;
+}
+
+static uint32_t percentile(const uint32_t* histogram, uint32_t count, uint32_t maxUs, float fraction) {
+    uint32_t target = (uint32_t)ceilf(count * fraction);
+    uint32_t seen = 0;
+    for (uint32_t i = 0; i < SD_BENCH_BUCKETS; i++) {
+        seen += histogram[i];
+        if (seen >= target) {
+            uint32_t upper = (i + 1) * SD_BENCH_BUCKET_US;
+            return upper < maxUs ? upper : maxUs;
+        }
+    }
+    return maxUs; // In the overflow range; the maximum is the best bound there is
+}
+
+// SD_BENCH_SUSTAINED_WRITES logger-sized writes back to back, each timed individually
+static bool measureLatency(uint8_t* buffer, uint32_t* histogram, bool preallocate, SdBenchLatency* result,
+                           Print& out) {
+    memset(result, 0, sizeof(*result));
+    memset(histogram, 0, SD_BENCH_BUCKETS * sizeof(uint32_t));
+    if (!lockCard(out)) {
+        return false;
+    }
+    FsFile file;
+    const uint64_t total = (uint64_t)SD_BENCH_SUSTAINED_WRITES * SD_BENCH_BATCH_BYTES;
+    if (!openScratch(file, preallocate ? total : 0, out)) {
+        sdCardUnlock();
+        return false;
+    }
+    bool ok = true;
+    int64_t busyUs = 0;
+    for (uint32_t i = 0; ok && i < SD_BENCH_SUSTAINED_WRITES; i++) {
+        int64_t start = esp_timer_get_time();
+        ok = file.write(buffer, SD_BENCH_BATCH_BYTES) == SD_BENCH_BATCH_BYTES;
+        uint32_t us = (uint32_t)(esp_timer_get_time() - start);
+        busyUs += us;
+        uint32_t bucket = us / SD_BENCH_BUCKET_US;
+        if (bucket < SD_BENCH_BUCKETS) {
+            histogram[bucket]++;
+        }
+        if (us > result->max_us) {
+            result->max_us = us;
+        }
+        result->writes++;
+        if ((i & 0x3F) == 0x3F) {
+            vTaskDelay(1); // Outside the timed write
+        }
+    }
+    ok = ok && file.sync();
+    file.close();
+    sdCardUnlock();
+    if (!ok) {
+        out.println("sdbench: I/O error in the latency run.");
+        return false;
+    }
+    result->p50_us = percentile(histogram, result->writes, result->max_us, 0.50f);
+    result->p99_us = percentile(histogram, result->writes, result->max_us, 0.99f);
+    result->kbps = kbps(total, busyUs);
+    result->valid = true;
+    return true;
+}
+
+static void recommend(SdBenchProfile* profile) {
+    float best = 0.0f;
+    for (uint8_t i = 0; i < profile->throughput_count; i++) {
+        best = fmaxf(best, profile->throughput[i].write_kbps);
+    }
+    // Smallest block within 10% of the best: larger ones only cost RAM
+    profile->recommended_block_bytes = SD_BENCH_MAX_BLOCK;
+    for (uint8_t i = 0; i < profile->throughput_count; i++) {
+        if (profile->throughput[i].write_kbps >= 0.9f * best) {
+            profile->recommended_block_bytes = profile->throughput[i].block_bytes;
+            break;
+        }
+    }
+    profile->recommend_preallocate = profile->preallocated.valid &&
+        (!profile->appending.valid || profile->preallocated.p99_us < profile->appending.p99_us ||
+         profile->preallocated.max_us < profile->appending.max_us);
+    const SdBenchLatency& chosen = profile->recommend_preallocate ? profile->preallocated : profile->appending;
+    // Records arriving during the worst stall, with margin, and never less than one spill batch
+    uint64_t stallRecords = (uint64_t)chosen.max_us * (1000 / DATA_ACQUISITION_INTERVAL_MS) / 1000000ULL + 1;
+    uint64_t records = stallRecords * SD_BENCH_RING_MARGIN;
+    profile->recommended_ring_records = (uint32_t)(records > LOG_STAGING_SPILL_RECORDS ? records : LOG_STAGING_SPILL_RECORDS);
+}
+
+static size_t profileJson(const SdBenchProfile& p, char* out, size_t size) {
+    size_t pos = 0;
+    int written = snprintf(out, size,
+                           "{\"card\":\"%s\",\"sectors\":%llu,\"sequential_bytes\":%lu,\"throughput\":[",
+                           p.card, (unsigned long long)p.sectors, (unsigned long)p.sequential_bytes);
+    if (written < 0 || (size_t)written >= size) return 0;
+    pos = written;
+    for (uint8_t i = 0; i < p.throughput_count; i++) {
+        written = snprintf(out + pos, size - pos, "%s{\"block\":%lu,\"write_kbps\":%.0f,\"read_kbps\":%.0f}",
+                           i > 0 ? "," : "", (unsigned long)p.throughput[i].block_bytes, p.throughput[i].write_kbps,
+                           p.throughput[i].read_kbps);
+        if (written < 0 || (size_t)written >= size - pos) return 0;
+        pos += written;
+    }
+    const SdBenchLatency* runs[2] = { &p.appending, &p.preallocated };
+    const char* names[2] = { "appending", "preallocated" };
+    written = snprintf(out + pos, size - pos, "],\"batch_bytes\":%lu", (unsigned long)p.batch_bytes);
+    if (written < 0 || (size_t)written >= size - pos) return 0;
+    pos += written;
+    for (int i = 0; i < 2; i++) {
+        written = snprintf(out + pos, size - pos,
+                           ",\"%s\":{\"writes\":%lu,\"p50_us\":%lu,\"p99_us\":%lu,\"max_us\":%lu,\"kbps\":%.0f}",
+                           names[i], (unsigned long)runs[i]->writes, (unsigned long)runs[i]->p50_us,
+                           (unsigned long)runs[i]->p99_us, (unsigned long)runs[i]->max_us, runs[i]->kbps);
+        if (written < 0 || (size_t)written >= size - pos) return 0;
+        pos += written;
+    }
+    written = snprintf(out + pos, size - pos,
+                       ",\"recommended\":{\"block_bytes\":%lu,\"ring_records\":%lu,\"preallocate\":%s}}\n",
+                       (unsigned long)p.recommended_block_bytes, (unsigned long)p.recommended_ring_records,
+                       p.recommend_preallocate ? "true" : "false");
+    if (written < 0 || (size_t)written >= size - pos) return 0;
+    return pos + written;
+}
+
+static bool saveProfile(const SdBenchProfile& profile, Print& out) {
+    static char json[1024]; // Terminal task only
+    size_t length = profileJson(profile, json, sizeof(json));
+    if (length == 0 || !lockCard(out)) {
+        return false;
+    }
+    FsFile file;
+    bool ok = file.open(&sdCardFs(), SD_BENCH_PROFILE_FILE, O_WRONLY | O_CREAT | O_TRUNC) &&
+              file.write(json, length) == length;
+    file.close();
+    sdCardFs().remove(SD_BENCH_FILE);
+    sdCardUnlock();
+    return ok;
+}
+
+static void printLatency(Print& out, const char* name, const SdBenchLatency& latency) {
+    out.printf("  %-12s p50 %6.1f ms  p99 %6.1f ms  max %6.1f ms  %6.0f KB/s\n", name, latency.p50_us / 1000.0f,
+               latency.p99_us / 1000.0f, latency.max_us / 1000.0f, latency.kbps);
+}
+
+bool sdBenchRun(Print& out, uint32_t sequentialBytes, SdBenchProfile* result) {
+    if (!sdCardBegin()) {
+        out.println("SD card not available.");
+        return false;
+    }
+    sequentialBytes = (sequentialBytes + SD_BENCH_MAX_BLOCK - 1) / SD_BENCH_MAX_BLOCK * SD_BENCH_MAX_BLOCK;
+    uint8_t* buffer = (uint8_t*)memRegionMalloc(MEM_REGION_PSRAM, SD_BENCH_MAX_BLOCK);
+    if (buffer == nullptr) {
+        buffer = (uint8_t*)malloc(SD_BENCH_MAX_BLOCK);
+    }
+    uint32_t* histogram = (uint32_t*)malloc(SD_BENCH_BUCKETS * sizeof(uint32_t));
+    if (buffer == nullptr || histogram == nullptr) {
+        out.println("sdbench: not enough memory.");
+        free(buffer);
+        free(histogram);
+        return false;
+    }
+    for (uint32_t i = 0; i < SD_BENCH_MAX_BLOCK; i++) {
+        buffer[i] = (uint8_t)(i * 31 + 7); // Not all zeros, in case the card compresses or skips them
+    }
+
+    SdBenchProfile profile;
+    memset(&profile, 0, sizeof(profile));
+    profile.sequential_bytes = sequentialBytes;
+    profile.batch_bytes = SD_BENCH_BATCH_BYTES;
+    if (lockCard(out)) {
+        cid_t cid;
+        if (sdCardFs().card()->readCID(&cid)) {
+            snprintf(profile.card, sizeof(profile.card), "%02X-%c%c-%.5s", cid.mid, cid.oid[0], cid.oid[1], cid.pnm);
+        }
+        profile.sectors = sdCardFs().card()->sectorCount();
+        sdCardUnlock();
+    }
+
+    out.printf("sdbench on %s (%llu MB): %lu KB per block size, preallocated file\n", profile.card,
+               (unsigned long long)(profile.sectors / 2048), (unsigned long)(sequentialBytes / 1024));
+    bool ok = true;
+    for (uint32_t block = SD_BENCH_MIN_BLOCK; ok && block <= SD_BENCH_MAX_BLOCK; block <<= 1) {
+        SdBenchThroughput& t = profile.throughput[profile.throughput_count];
+        ok = measureThroughput(buffer, block, sequentialBytes, &t, out);
+        if (ok) {
+            profile.throughput_count++;
+            out.printf("  %5lu B   write %7.0f KB/s   read %7.0f KB/s\n", (unsigned long)block, t.write_kbps,
+                       t.read_kbps);
+        }
+    }
+
+    out.printf("Write latency, %u x %lu-byte writes (logger batch):\n", (unsigned)SD_BENCH_SUSTAINED_WRITES,
+               (unsigned long)SD_BENCH_BATCH_BYTES);
+    if (ok && (ok = measureLatency(buffer, histogram, false, &profile.appending, out))) {
+        printLatency(out, "appending", profile.appending);
+    }
+    if (ok && (ok = measureLatency(buffer, histogram, true, &profile.preallocated, out))) {
+        printLatency(out, "preallocated", profile.preallocated);
+    }
+    free(buffer);
+    free(histogram);
+    if (!ok) {
+        if (sdCardLock(pdMS_TO_TICKS(SD_BENCH_LOCK_MS))) {
+            sdCardFs().remove(SD_BENCH_FILE);
+            sdCardUnlock();
+        }
+        return false;
+    }
+
+    recommend(&profile);
+    out.println("Recommended for this card:");
+    out.printf("  write block    %lu B\n", (unsigned long)profile.recommended_block_bytes);
+    out.printf("  preallocate    %s\n", profile.recommend_preallocate ? "yes" : "no");
+    out.printf("  PSRAM ring     %lu records (configured %u)\n", (unsigned long)profile.recommended_ring_records,
+               (unsigned)PSRAM_BUFFER_SIZE_RECORDS);
+    const SdBenchLatency& chosen = profile.recommend_preallocate ? profile.preallocated : profile.appending;
+    out.printf("  headroom       %.1fx the logger's %u B/s\n",
+               chosen.kbps * 1024.0f / SD_BENCH_LOGGER_BYTES_PER_S, (unsigned)SD_BENCH_LOGGER_BYTES_PER_S);
+    if (saveProfile(profile, out)) {
+        out.println("Profile saved to " SD_BENCH_PROFILE_FILE);
+    } else {
+        out.println("sdbench: could not save the profile.");
+    }
+    if (result != nullptr) {
+        *result = profile;
+    }
+    return true;
+}
+
+bool sdBenchPrintStored(Print& out) {
+    if (!sdCardBegin()) {
+        out.println("SD card not available.");
+        return false;
+    }
+    if (!lockCard(out)) {
+        return false;
+    }
+    FsFile file;
+    if (!file.open(&sdCardFs(), SD_BENCH_PROFILE_FILE, O_RDONLY)) {
+        sdCardUnlock();
+        out.println("No stored profile; run 'sdbench' first.");
+        return false;
+    }
+    char chunk[128];
+    int n;
+    while ((n = file.read(chunk, sizeof(chunk))) > 0) {
+        out.write((const uint8_t*)chunk, n);
+    }
+    file.close();
+    sdCardUnlock();
+    return true;
+}
@@ -0,0 +1,53 @@
+#include "sd_card.h"
+#include "config.h"
+#include "power_manager.h"
+
+static SdFs s_sd;
+static SemaphoreHandle_t s_sdMutex = NULL;
+static bool s_sdMounted = false;
+
+bool sdCardBegin() {
+    if (s_sdMutex == NULL) {
+        s_sdMutex = xSemaphoreCreateMutex();
+        if (s_sdMutex == NULL) {
+            return false;
+        }
+    }
+    if (!sdCardLock(pdMS_TO_TICKS(1000))) {
+        return false;
+    }
+    if (!s_sdMounted) {
+        SPI.begin(SD_SCK_PIN, SD_MISO_PIN, SD_MOSI_PIN); // No-op if the display already started the bus
+        s_sdMounted = s_sd.begin(SdSpiConfig(SD_CS_PIN, SHARED_SPI, SD_SCK_MHZ(SD_SPI_CLOCK_MHZ), &SPI));
+        if (s_sdMounted) {
+            Serial.printf("SD card mounted (%s, %llu MB).\n", s_sd.fatType() == FAT_TYPE_EXFAT ? "exFAT" : "FAT",
+                          (unsigned long long)s_sd.card()->sectorCount() / 2048ULL);
+        } else {
+            Serial.println("SD card mount failed (no card or unsupported filesystem).");
+        }
+    }
+    bool mounted = s_sdMounted;
+    sdCardUnlock();
+    return mounted;
+}
+
+bool sdCardMounted() {
+    return s_sdMounted;
+}
+
+SdFs& sdCardFs() {
+    return s_sd;
+}
+
+bool sdCardLock(TickType_t timeout) {
+    if (s_sdMutex == NULL || xSemaphoreTake(s_sdMutex, timeout) != pdTRUE) {
+        return false;
+    }
+    powerLockAcquire(POWER_LOCK_SPI); // Card transfers need the full APB clock and no light sleep
+    return true;
+}
+
+void sdCardUnlock() {
+    powerLockRelease(POWER_LOCK_SPI);
+    xSemaphoreGive(s_sdMutex);
+}
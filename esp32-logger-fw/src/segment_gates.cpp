@@ -0,0 +1,299 @@
+#include "segment_gates.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EARTH_RADIUS_M 6371000.0
+#define DEG_TO_RAD_D (3.14159265358979323846 / 180.0)
+#define MS_PER_DAY 86400000UL
+
+uint32_t gateContinuousTimeMs(uint32_t previousMs, uint32_t timeOfDayMs) {
+    uint32_t t = previousMs - previousMs % MS_PER_DAY + timeOfDayMs;
+    if ((int32_t)(previousMs - t) > (int32_t)(MS_PER_DAY / 2)) {
+        t += MS_PER_DAY; // Passed midnight
+    }
+    return t;
+}
+
+GateIndex::GateIndex(float cellSizeM, uint32_t bucketCount, GateAllocFn allocFn, GateFreeFn freeFn)
+    : _cellSize(cellSizeM), _bucketCount(bucketCount), _alloc(allocFn), _free(freeFn),
+      _originLat(0.0), _originLon(0.0), _metersPerDegLon(0.0),
+      _gates(nullptr), _gateCount(0), _bucketStart(nullptr), _entries(nullptr),
+      _lastCandidates(0), _lastCells(0), _seenCount(0) {
+}
+
+GateIndex::~GateIndex() {
+    clear();
+}
+
+void GateIndex::clear() {
+    if (_gates) _free(_gates);
+    if (_bucketStart) _free(_bucketStart);
+    if (_entries) _free(_entries);
+    _gates = nullptr;
+    _bucketStart = nullptr;
+    _entries = nullptr;
+    _gateCount = 0;
+}
+
+uint32_t GateIndex::bucketOf(int32_t cx, int32_t cy) const {
+    uint32_t h = (uint32_t)cx * 73856093u ^ (uint32_t)cy * 19349663u;
+    return h & (_bucketCount - 1);
+}
+
+int32_t GateIndex::cellOf(float v) const {
+    return (int32_t)floorf(v / _cellSize);
+}
+
+void GateIndex::project(double lat, double lon, float* x, float* y) const {
+    *x = (float)((lon - _originLon) * _metersPerDegLon);
+    *y = (float)((lat - _originLat) * EARTH_RADIUS_M * DEG_TO_RAD_D);
+}
+
+bool GateIndex::build(const GateDef* defs, uint32_t count) {
+    clear();
+    if (count == 0 || _bucketCount == 0 || (_bucketCount & (_bucketCount - 1)) != 0) {
+        return false;
+    }
+
+    _originLat = defs[0].lat1;
+    _originLon = defs[0].lon1;
+    _metersPerDegLon = EARTH_RADIUS_M * DEG_TO_RAD_D * cos(_originLat * DEG_TO_RAD_D);
+
+    _gates = (Gate*)_alloc(count * sizeof(Gate));
+    _bucketStart = (uint32_t*)_alloc((_bucketCount + 1) * sizeof(uint32_t));
+    if (!_gates || !_bucketStart) {
+        clear();
+        return false;
+    }
+
+    // Pass 1: project and count cell entries per bucket
+    memset(_bucketStart, 0, (_bucketCount + 1) * sizeof(uint32_t));
+    uint32_t totalEntries = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        Gate& g = _gates[i];
+        project(defs[i].lat1, defs[i].lon1, &g.x1, &g.y1);
+        project(defs[i].lat2, defs[i].lon2, &g.x2, &g.y2);
+        g.segment_id = defs[i].segment_id;
+        g.kind = defs[i].kind;
+        for (int32_t cx = cellOf(fminf(g.x1, g.x2)); cx <= cellOf(fmaxf(g.x1, g.x2)); cx++) {
+            for (int32_t cy = cellOf(fminf(g.y1, g.y2)); cy <= cellOf(fmaxf(g.y1, g.y2)); cy++) {
+                _bucketStart[bucketOf(cx, cy) + 1]++;
+                totalEntries++;
+            }
+        }
+    }
+    for (uint32_t b = 0; b < _bucketCount; b++) {
+        _bucketStart[b + 1] += _bucketStart[b];
+    }
+
+    // Pass 2: fill (compressed rows, one contiguous run per bucket)
+    _entries = (CellEntry*)_alloc(totalEntries * sizeof(CellEntry));
+    uint32_t* fill = (uint32_t*)_alloc(_bucketCount * sizeof(uint32_t));
+    if (!_entries || !fill) {
+        if (fill) _free(fill);
+        clear();
+        return false;
+    }
+    memcpy(fill, _bucketStart, _bucketCount * sizeof(uint32_t));
+    for (uint32_t i = 0; i < count; i++) {
+        const Gate& g = _gates[i];
+        for (int32_t cx = cellOf(fminf(g.x1, g.x2)); cx <= cellOf(fmaxf(g.x1, g.x2)); cx++) {
+            for (int32_t cy = cellOf(fminf(g.y1, g.y2)); cy <= cellOf(fmaxf(g.y1, g.y2)); cy++) {
+                CellEntry& e = _entries[fill[bucketOf(cx, cy)]++];
+                e.cx = cx;
+                e.cy = cy;
+                e.gate = i;
+            }
+        }
+    }
+    _free(fill);
+    _gateCount = count;
+    return true;
+}
+
+// Tests the gates listed under one cell against the movement
+void GateIndex::testCell(int32_t cx, int32_t cy, float x0, float y0, uint32_t t0, float x1, float y1, uint32_t t1,
+                         GateCrossing* out, size_t maxOut, size_t* found) {
+    _lastCells++;
+    const float dx = x1 - x0, dy = y1 - y0;
+    uint32_t b = bucketOf(cx, cy);
+    for (uint32_t k = _bucketStart[b]; k < _bucketStart[b + 1]; k++) {
+        const CellEntry& e = _entries[k];
+        if (e.cx != cx || e.cy != cy) continue; // Another cell hashed to this bucket
+
+        bool duplicate = false;
+        for (uint32_t s = 0; s < _seenCount; s++) {
+            if (_seen[s] == e.gate) { duplicate = true; break; }
+        }
+        if (!duplicate && _seenCount == GATE_QUERY_MAX_GATES) {
+            for (size_t i = 0; i < *found; i++) { // List full: at least never report a crossing twice
+                if (out[i].gate == e.gate) { duplicate = true; break; }
+            }
+        }
+        if (duplicate) continue;
+        if (_seenCount < GATE_QUERY_MAX_GATES) _seen[_seenCount++] = e.gate;
+        _lastCandidates++;
+
+        // Segment/segment intersection: movement P0 + t*D against gate G1 + u*E
+        const Gate& g = _gates[e.gate];
+        const float ex = g.x2 - g.x1, ey = g.y2 - g.y1;
+        const float denom = dx * ey - dy * ex;
+        if (denom == 0.0f) continue; // Parallel
+        const float qx = g.x1 - x0, qy = g.y1 - y0;
+        const float t = (qx * ey - qy * ex) / denom;
+        const float u = (qx * dy - qy * dx) / denom;
+        // Half-open in t so a fix lying exactly on a gate is counted once, not twice
+        if (t <= 0.0f || t > 1.0f || u < 0.0f || u > 1.0f) continue;
+
+        if (*found < maxOut) {
+            GateCrossing& c = out[(*found)++];
+            c.gate = e.gate;
+            c.segment_id = g.segment_id;
+            c.kind = g.kind;
+            c.time_ms = t0 + (uint32_t)lroundf(t * (float)(t1 - t0));
+        }
+    }
+}
+
+size_t GateIndex::findCrossings(float x0, float y0, uint32_t t0, float x1, float y1, uint32_t t1,
+                                GateCrossing* out, size_t maxOut) {
+    _lastCandidates = 0;
+    _lastCells = 0;
+    _seenCount = 0;
+    if (_gateCount == 0) {
+        return 0;
+    }
+    size_t found = 0;
+
+    // Grid traversal (Amanatides-Woo): step to whichever cell boundary the line reaches first.
+    // tMax is the fraction of the movement at the next x/y boundary, tDelta the fraction per cell.
+    int32_t cx = cellOf(x0), cy = cellOf(y0);
+    const int32_t endX = cellOf(x1), endY = cellOf(y1);
+    const float dx = x1 - x0, dy = y1 - y0;
+    const int32_t stepX = dx > 0.0f ? 1 : -1, stepY = dy > 0.0f ? 1 : -1;
+    const float tDeltaX = dx != 0.0f ? _cellSize / fabsf(dx) : INFINITY;
+    const float tDeltaY = dy != 0.0f ? _cellSize / fabsf(dy) : INFINITY;
+    float tMaxX = dx != 0.0f ? ((float)(stepX > 0 ? cx + 1 : cx) * _cellSize - x0) / dx : INFINITY;
+    float tMaxY = dy != 0.0f ? ((float)(stepY > 0 ? cy + 1 : cy) * _cellSize - y0) / dy : INFINITY;
+    const uint32_t cellCount = (uint32_t)(abs(endX - cx) + abs(endY - cy)) + 1;
+
+    testCell(cx, cy, x0, y0, t0, x1, y1, t1, out, maxOut, &found);
+    for (uint32_t n = 1; n < cellCount; n++) {
+        if (tMaxX < tMaxY) {
+            cx += stepX;
+            tMaxX += tDeltaX;
+        } else if (tMaxY < tMaxX) {
+            cy += stepY;
+            tMaxY += tDeltaY;
+        } else {
+            // Through a corner: both neighbours touch the line there, so test them before the diagonal
+            testCell(cx + stepX, cy, x0, y0, t0, x1, y1, t1, out, maxOut, &found);
+            cx += stepX;
+            cy += stepY;
+            tMaxX += tDeltaX;
+            tMaxY += tDeltaY;
+            n++; // The diagonal step covers two of the counted cells
+            testCell(cx - stepX, cy, x0, y0, t0, x1, y1, t1, out, maxOut, &found);
+        }
+        testCell(cx, cy, x0, y0, t0, x1, y1, t1, out, maxOut, &found);
+    }
+    if (cx != endX || cy != endY) { // Rounding took a different path; the end cell must still be seen
+        testCell(endX, endY, x0, y0, t0, x1, y1, t1, out, maxOut, &found);
+    }
+
+    // Time order (found is tiny; insertion sort)
+    for (size_t i = 1; i < found; i++) {
+        GateCrossing c = out[i];
+        size_t j = i;
+        while (j > 0 && out[j - 1].time_ms > c.time_ms) {
+            out[j] = out[j - 1];
+            j--;
+        }
+        out[j] = c;
+    }
+    return found;
+}
+
+SegmentTimer::SegmentTimer(uint32_t minLapMs) : _minLapMs(minLapMs) {
+    reset();
+}
+
+void SegmentTimer::reset() {
+    for (int i = 0; i < SEGMENT_TIMER_MAX_ACTIVE; i++) {
+        _active[i].segment_id = -1;
+        _active[i].start_ms = 0;
+    }
+    _status = SegmentTimerStatus();
+}
+
+void SegmentTimer::refreshNewest() {
+    _status.active_segments = 0;
+    _status.newest_segment_id = -1;
+    for (int i = 0; i < SEGMENT_TIMER_MAX_ACTIVE; i++) {
+        if (_active[i].segment_id < 0) continue;
+        if (_status.active_segments == 0 || (int32_t)(_active[i].start_ms - _status.newest_segment_start_ms) > 0) {
+            _status.newest_segment_id = _active[i].segment_id;
+            _status.newest_segment_start_ms = _active[i].start_ms;
+        }
+        _status.active_segments++;
+    }
+}
+
+bool SegmentTimer::onCrossing(const GateCrossing& crossing, SegmentResult* result) {
+    bool completed = false;
+
+    if (crossing.kind == GATE_LAP) {
+        if (_status.lap_running) {
+            uint32_t elapsed = crossing.time_ms - _status.lap_start_ms;
+            if (elapsed < _minLapMs) {
+                return false;
+            }
+            _status.lap_count++;
+            _status.last_lap_ms = elapsed;
+            if (_status.best_lap_ms == 0 || elapsed < _status.best_lap_ms) {
+                _status.best_lap_ms = elapsed;
+            }
+            result->segment_id = -1;
+            result->kind = GATE_LAP;
+            result->elapsed_ms = elapsed;
+            completed = true;
+        }
+        _status.lap_running = true;
+        _status.lap_start_ms = crossing.time_ms;
+        return completed;
+    }
+
+    // Find the segment's slot (or a free one / the oldest one for a start)
+    int slot = -1;
+    for (int i = 0; i < SEGMENT_TIMER_MAX_ACTIVE; i++) {
+        if (_active[i].segment_id == crossing.segment_id) { slot = i; break; }
+    }
+
+    if (crossing.kind == GATE_START) {
+        if (slot < 0) {
+            for (int i = 0; i < SEGMENT_TIMER_MAX_ACTIVE; i++) {
+                if (_active[i].segment_id < 0) { slot = i; break; }
+            }
+        }
+        if (slot < 0) {
+            slot = 0; // All slots busy: drop the segment that started first
+            for (int i = 1; i < SEGMENT_TIMER_MAX_ACTIVE; i++) {
+                if ((int32_t)(_active[i].start_ms - _active[slot].start_ms) < 0) slot = i;
+            }
+        }
+        _active[slot].segment_id = crossing.segment_id;
+        _active[slot].start_ms = crossing.time_ms; // Re-crossing a start restarts the segment
+    } else if (crossing.kind == GATE_FINISH && slot >= 0) {
+        result->segment_id = crossing.segment_id;
+        result->kind = GATE_FINISH;
+        result->elapsed_ms = crossing.time_ms - _active[slot].start_ms;
+        _status.last_segment_id = crossing.segment_id;
+        _status.last_segment_ms = result->elapsed_ms;
+        _active[slot].segment_id = -1;
+        completed = true;
+    }
+
+    refreshNewest();
+    return completed;
+}
@@ -0,0 +1,64 @@
+#include "sensor_capture.h"
+
+#include <string.h>
+
+void captureEncodeChunkHeader(uint32_t tMs, CaptureType type, uint16_t length, uint8_t* out) {
+    memcpy(out, &tMs, 4);
+    out[4] = type;
+    memcpy(out + 5, &length, 2);
+}
+
+size_t captureEncodeChunk(uint32_t tMs, CaptureType type, const void* payload, size_t length, uint8_t* out,
+                          size_t capacity) {
+    if (length > CAPTURE_MAX_PAYLOAD || capacity < CAPTURE_CHUNK_HEADER_SIZE + length) {
+        return 0;
+    }
+    captureEncodeChunkHeader(tMs, type, (uint16_t)length, out);
+    memcpy(out + CAPTURE_CHUNK_HEADER_SIZE, payload, length);
+    return CAPTURE_CHUNK_HEADER_SIZE + length;
+}
+
+const char* captureTypeName(CaptureType type) {
+    switch (type) {
+        case CAPTURE_NMEA: return "nmea";
+        case CAPTURE_CP_MEASUREMENT: return "cp_measurement";
+        case CAPTURE_CP_FEATURE: return "cp_feature";
+        case CAPTURE_IMU_FIFO: return "imu_fifo";
+        case CAPTURE_PRESSURE: return "pressure";
+        case CAPTURE_ANALOG: return "analog";
+        default: return "?";
+    }
+}
+
+bool CaptureReader::begin(const uint8_t* data, size_t length) {
+    _data = data;
+    _length = length;
+    _truncated = false;
+    if (length < sizeof(CaptureFileHeader)) {
+        return false;
+    }
+    memcpy(&_header, data, sizeof(_header));
+    if (memcmp(_header.magic, CAPTURE_MAGIC, sizeof(_header.magic)) != 0 || _header.header_length > length) {
+        return false;
+    }
+    _pos = _header.header_length;
+    return true;
+}
+
+bool CaptureReader::next(CaptureChunk* out) {
+    if (_pos + CAPTURE_CHUNK_HEADER_SIZE > _length) {
+        _truncated = _pos != _length;
+        return false;
+    }
+    const uint8_t* p = _data + _pos;
+    memcpy(&out->t_ms, p, 4);
+    out->type = (CaptureType)p[4];
+    memcpy(&out->length, p + 5, 2);
+    if (_pos + CAPTURE_CHUNK_HEADER_SIZE + out->length > _length) {
+        _truncated = true; // Power cut mid-chunk; everything before it is usable
+        return false;
+    }
+    out->payload = p + CAPTURE_CHUNK_HEADER_SIZE;
+    _pos += CAPTURE_CHUNK_HEADER_SIZE + out->length;
+    return true;
+}
@@ -0,0 +1,107 @@
+#include "task_monitor.h"
+#include <esp_heap_caps.h>
+#include <string.h> // For strncpy
+
+static TaskStatus_t s_status[TASK_MONITOR_MAX_TASKS];
+
+bool taskMonitorCapture(TaskMonitorSnapshot* snapshot) {
+#if configUSE_TRACE_FACILITY
+    uint32_t totalRunTime = 0;
+    UBaseType_t count = uxTaskGetSystemState(s_status, TASK_MONITOR_MAX_TASKS, &totalRunTime);
+    if (count == 0) {
+        snapshot->count = 0; // More tasks than TASK_MONITOR_MAX_TASKS
+        return false;
+    }
+    snapshot->count = (uint8_t)count;
+    snapshot->total_run_time = totalRunTime;
+    snapshot->taken_ms = millis();
+    for (UBaseType_t i = 0; i < count; i++) {
+        TaskMonitorTask& t = snapshot->tasks[i];
+        t.handle = s_status[i].xHandle;
+        strncpy(t.name, s_status[i].pcTaskName, sizeof(t.name) - 1);
+        t.name[sizeof(t.name) - 1] = '\0';
+        BaseType_t affinity = xTaskGetAffinity(s_status[i].xHandle);
+        t.core = (affinity == tskNO_AFFINITY) ? TASK_MONITOR_ANY_CORE : (int8_t)affinity;
+        t.state = s_status[i].eCurrentState;
+        t.priority = s_status[i].uxCurrentPriority;
+        t.stack_free_min_bytes = s_status[i].usStackHighWaterMark * sizeof(StackType_t);
+        t.run_time = s_status[i].ulRunTimeCounter;
+    }
+    return true;
+#else
+    snapshot->count = 0;
+    return false;
+#endif
+}
+
+void taskMonitorCompare(const TaskMonitorSnapshot* before, const TaskMonitorSnapshot* after, TaskMonitorReport* out) {
+    *out = TaskMonitorReport();
+    out->window_ms = after->taken_ms - before->taken_ms;
+#if configGENERATE_RUN_TIME_STATS
+    uint32_t window = after->total_run_time - before->total_run_time;
+    out->cpu_available = window > 0;
+#else
+    uint32_t window = 0;
+#endif
+
+    for (uint8_t i = 0; i < after->count; i++) {
+        const TaskMonitorTask& t = after->tasks[i];
+        uint32_t previous = 0;
+        for (uint8_t j = 0; j < before->count; j++) {
+            if (before->tasks[j].handle == t.handle) {
+                previous = before->tasks[j].run_time;
+                break;
+            }
+        }
+        TaskMonitorUsage& usage = out->tasks[out->count++];
+        usage.task = &t;
+        usage.cpu_percent = out->cpu_available ? (t.run_time - previous) * 100.0f / window : -1.0f;
+
+        if (t.state == eReady || t.state == eRunning) {
+            if (t.core == TASK_MONITOR_ANY_CORE) {
+                out->ready_any_core++;
+            } else if (t.core < TASK_MONITOR_CORES) {
+                out->ready_tasks[t.core]++;
+            }
+        }
+    }
+
+    // Core load from each core's idle task, which is always pinned
+    for (int core = 0; core < TASK_MONITOR_CORES; core++) {
+        TaskHandle_t idle = xTaskGetIdleTaskHandleForCPU(core);
+        for (uint8_t i = 0; i < out->count; i++) {
+            if (out->tasks[i].task->handle == idle && out->cpu_available) {
+                float load = 100.0f - out->tasks[i].cpu_percent;
+                out->core_load_percent[core] = load < 0.0f ? 0.0f : load;
+            }
+        }
+    }
+
+    // Busiest first (insertion sort; a couple of dozen entries)
+    for (uint8_t i = 1; i < out->count; i++) {
+        TaskMonitorUsage u = out->tasks[i];
+        uint8_t j = i;
+        while (j > 0 && out->tasks[j - 1].cpu_percent < u.cpu_percent) {
+            out->tasks[j] = out->tasks[j - 1];
+            j--;
+        }
+        out->tasks[j] = u;
+    }
+
+    out->heap_internal_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    out->heap_internal_largest = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    out->heap_internal_min_free = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    out->heap_psram_free = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    out->heap_psram_largest = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM);
+}
+
+const char* taskMonitorStateName(eTaskState state) {
+    switch (state) {
+        case eRunning:   return "run";
+        case eReady:     return "ready";
+        case eBlocked:   return "block";
+        case eSuspended: return "susp";
+        case eDeleted:   return "del";
+        default:         return "?";
+    }
+}
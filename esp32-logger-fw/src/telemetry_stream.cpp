@@ -0,0 +1,90 @@
+#include "telemetry_stream.h"
+#include "config.h"
+#include "mem_placement.h"
+
+MEM_HOT static uint8_t s_ring[TELEMETRY_TX_RING_BYTES]; // Written from the 200 Hz path under a spinlock
+MEM_PLACED(s_ring, MEM_REGION_INTERNAL);
+static size_t s_ringHead = 0;   // Next write
+static size_t s_ringCount = 0;
+static uint16_t s_seq = 0;
+static volatile bool s_enabled = false;
+static TelemetryStats s_stats;
+static portMUX_TYPE s_ringMux = portMUX_INITIALIZER_UNLOCKED;
+
+void telemetrySetEnabled(bool enabled) {
+    portENTER_CRITICAL(&s_ringMux);
+    s_enabled = enabled;
+    if (!enabled) {
+        s_ringCount = 0; // Do not leave half a stream behind for the next session
+    }
+    portEXIT_CRITICAL(&s_ringMux);
+}
+
+bool telemetryEnabled() {
+    return s_enabled;
+}
+
+bool telemetryPublish(TelemetryType type, const void* payload, uint16_t length) {
+    if (!s_enabled || length > TELEMETRY_MAX_PAYLOAD) {
+        return false;
+    }
+    uint8_t scratch[FRAME_HEADER_SIZE + TELEMETRY_MAX_PAYLOAD + FRAME_CRC_SIZE];
+    uint8_t frame[FRAME_ENCODED_MAX(TELEMETRY_MAX_PAYLOAD)];
+
+    portENTER_CRITICAL(&s_ringMux);
+    uint16_t seq = s_seq++;
+    portEXIT_CRITICAL(&s_ringMux);
+
+    size_t frameLen = frameEncode(type, seq, payload, length, scratch, frame);
+
+    bool queued = false;
+    portENTER_CRITICAL(&s_ringMux);
+    if (s_enabled && TELEMETRY_TX_RING_BYTES - s_ringCount >= frameLen) {
+        size_t first = TELEMETRY_TX_RING_BYTES - s_ringHead;
+        if (first > frameLen) first = frameLen;
+        memcpy(&s_ring[s_ringHead], frame, first);
+        memcpy(&s_ring[0], frame + first, frameLen - first);
+        s_ringHead = (s_ringHead + frameLen) % TELEMETRY_TX_RING_BYTES;
+        s_ringCount += frameLen;
+        if (s_ringCount > s_stats.ring_high_water) s_stats.ring_high_water = s_ringCount;
+        queued = true;
+    } else {
+        s_stats.frames_dropped++; // Whole frame; never a partial one
+    }
+    if (queued) s_stats.frames_queued++;
+    portEXIT_CRITICAL(&s_ringMux);
+    return queued;
+}
+
+void telemetryDrain() {
+    for (;;) {
+        int writable = Serial.availableForWrite();
+        if (writable <= 0) {
+            return;
+        }
+        portENTER_CRITICAL(&s_ringMux);
+        size_t tail = (s_ringHead + TELEMETRY_TX_RING_BYTES - s_ringCount) % TELEMETRY_TX_RING_BYTES;
+        size_t contiguous = TELEMETRY_TX_RING_BYTES - tail;
+        if (contiguous > s_ringCount) contiguous = s_ringCount;
+        portEXIT_CRITICAL(&s_ringMux);
+        if (contiguous == 0) {
+            return;
+        }
+        // Only this task consumes, so the bytes at tail stay put while we write them
+        size_t chunk = contiguous < (size_t)writable ? contiguous : (size_t)writable;
+        size_t written = Serial.write(&s_ring[tail], chunk);
+        portENTER_CRITICAL(&s_ringMux);
+        s_ringCount = s_ringCount >= written ? s_ringCount - written : 0;
+        s_stats.bytes_sent += written;
+        portEXIT_CRITICAL(&s_ringMux);
+        if (written < chunk) {
+            return;
+        }
+    }
+}
+
+void telemetryGetStats(TelemetryStats* out) {
+    portENTER_CRITICAL(&s_ringMux);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_ringMux);
+}
@@ -1,5 +1,26 @@
 #include "terminal_manager.h"
 #include "shared_state.h"
+#include "DisplayUpdateTask.h" // For display refresh statistics
+#include "I2cBusManager.h"     // For I2C bus statistics
+#include "ImuTask.h"           // For IMU FIFO statistics
+#include "AnalogCaptureTask.h" // For ADC capture statistics and benchmark
+#include "config.h"            // For ANALOG_CHANNEL_COUNT
+#include "BleManagerTask.h"    // For the power analytics FTP setting
+#include "event_log.h"         // For dropped event counts
+#include "gps_data.h"          // For segment/lap timing state
+#include "telemetry_stream.h"  // For the binary stream mode
+#include "task_monitor.h"      // For the top command and periodic task records
+#include "trace.h"             // For the trace command
+#include "log_download.h"      // For ls/get
+#include "WifiHandlerTask.h"   // For the Wi-Fi offload mode
+#include "gps_handler.h"       // For the fused elevation estimate
+#include "power_manager.h"     // For the pm command and the USB light-sleep lock
+#include "heap_audit.h"        // For the heap_audit command and soak reports
+#include "log_schema.h"        // For the schema command
+#include "mem_placement.h"     // For the mem and membench commands
+#include "sd_bench.h"          // For the sdbench command
+#include "log_rotation.h"      // For the rotation command
+#include "raw_capture.h"       // For the capture command
 #include <Arduino.h> // For Serial object
 #include <string.h>  // For strcmp, strtok_r
 
@@ -7,6 +28,12 @@
 static char command_buffer[128];
 static uint8_t buffer_pos = 0;
 
+// Task monitor snapshots (too large for the terminal task's stack)
+static TaskMonitorSnapshot s_topBefore;
+static TaskMonitorSnapshot s_topAfter;
+static TaskMonitorSnapshot s_logBaseline;
+static TaskMonitorReport s_monitorReport;
+
 void print_help() {
     Serial.println("Available commands:");
     Serial.println("  help (or h)          - Prints this help message.");
@@ -14,6 +41,204 @@ void print_help() {
     Serial.println("  ble_debug <on|off>   - Enables/disables BLE debug stream.");
     Serial.println("  other_debug <on|off> - Enables/disables other generic debug streams.");
     Serial.println("  ble_stream <on|off>  - Enables/disables verbose BLE activity stream.");
+    Serial.println("  display_stats        - Shows display frames rendered in the last minute.");
+    Serial.println("  i2c_stats            - Shows I2C bus utilization and latency since the last call.");
+    Serial.println("  imu_stats            - Shows IMU FIFO counters, current roll/pitch and filter cost.");
+    Serial.println("  adc_stats            - Shows analog capture counters and the latest channel voltages.");
+    Serial.println("  adc_bench            - Benchmarks the ADC decimation chain against the scalar reference.");
+    Serial.println("  power_stats          - Shows rolling power averages, NP, IF, TSS and work.");
+    Serial.println("  mmp [save]           - Shows the session's mean-maximal power curve, or appends it to the SD card.");
+    Serial.println("  gates                - Shows loaded segment gates and lap/segment timing.");
+    Serial.println("  elevation            - Shows fused elevation, vertical speed, gradient and baro offset.");
+    Serial.println("  ftp <watts>          - Sets the FTP used for IF and TSS.");
+    Serial.println("  stream <on|off>      - Starts/stops the binary telemetry stream (no argument: stats).");
+    Serial.println("  top [ms]             - Shows per-task CPU, stack high-water and heap over a sampling window.");
+    Serial.println("  pm [ms]              - Shows time per CPU frequency, power lock usage and battery current.");
+    Serial.println("  heap_audit [mark|soak <minutes>] - Heap activity since the steady-state marker (heap_audit build).");
+    Serial.println("  mem                  - Shows arena usage and where each large buffer actually lives.");
+    Serial.println("  membench [kb]        - Measures memcpy/read/write throughput and miss latency per memory region.");
+    Serial.println("  trace <on|off|dump|clear> - Controls the event trace (build with ENABLE_TRACE).");
+    Serial.println("  wifi <on|off>        - Starts/stops the Wi-Fi log offload server (no argument: status).");
+    Serial.println("  schema <csv|json>    - Prints the log record CSV header or the schema as JSON.");
+    Serial.println("  ls                   - Lists the log files on the SD card.");
+    Serial.println("  rotation             - Shows the active log file, rotation count and switch latency.");
+    Serial.println("  capture <on|only|off> - Raw sensor capture to cap_NNN.cap; 'only' skips GPS/power decoding (no argument: stats).");
+    Serial.println("  sdbench [mb|show]    - Benchmarks the SD card, saves its profile on the card (show: print it).");
+    Serial.println("  get <file> [offset] [length] - Sends a log file as binary frames (tools/log_download.py).");
+}
+
+void print_top(uint32_t windowMs) {
+    if (!taskMonitorCapture(&s_topBefore)) {
+        Serial.println("Task monitor: unable to read task states (more than TASK_MONITOR_MAX_TASKS tasks?).");
+        return;
+    }
+    vTaskDelay(pdMS_TO_TICKS(windowMs));
+    taskMonitorCapture(&s_topAfter);
+    TaskMonitorReport& report = s_monitorReport;
+    taskMonitorCompare(&s_topBefore, &s_topAfter, &report);
+
+    if (report.cpu_available) {
+        Serial.printf("Over %lu ms: core 0 %.1f%% busy, core 1 %.1f%% busy\n", (unsigned long)report.window_ms,
+                      report.core_load_percent[0], report.core_load_percent[1]);
+    } else {
+        Serial.printf("Over %lu ms: CPU usage unavailable (FreeRTOS run-time stats not enabled)\n",
+                      (unsigned long)report.window_ms);
+    }
+    Serial.printf("Run queue: %u ready on core 0, %u on core 1, %u unpinned\n", report.ready_tasks[0],
+                  report.ready_tasks[1], report.ready_any_core);
+    Serial.println("  Task             Core  Prio  State   CPU%  Stack free (min)");
+    for (uint8_t i = 0; i < report.count; i++) {
+        const TaskMonitorTask* t = report.tasks[i].task;
+        char core[4];
+        if (t->core == TASK_MONITOR_ANY_CORE) {
+            strcpy(core, "-");
+        } else {
+            snprintf(core, sizeof(core), "%d", t->core);
+        }
+        char cpu[8];
+        if (report.tasks[i].cpu_percent < 0.0f) {
+            strcpy(cpu, "n/a");
+        } else {
+            snprintf(cpu, sizeof(cpu), "%.1f", report.tasks[i].cpu_percent);
+        }
+        Serial.printf("  %-16s %4s  %4u  %-5s %6s  %6lu B\n", t->name, core, (unsigned)t->priority,
+                      taskMonitorStateName(t->state), cpu, (unsigned long)t->stack_free_min_bytes);
+    }
+    Serial.printf("Internal heap: %lu B free, largest block %lu B, minimum ever %lu B\n",
+                  (unsigned long)report.heap_internal_free, (unsigned long)report.heap_internal_largest,
+                  (unsigned long)report.heap_internal_min_free);
+    Serial.printf("PSRAM: %lu B free, largest block %lu B\n", (unsigned long)report.heap_psram_free,
+                  (unsigned long)report.heap_psram_largest);
+    Serial.printf("Event queue: %lu/%d pending, %lu dropped\n", (unsigned long)eventLogPending(),
+                  EVENT_LOG_QUEUE_DEPTH, (unsigned long)eventLogDropped());
+}
+
+// Samples lock and core residency over `windowMs`, then prints them with the clock and battery drain
+void print_power(uint32_t windowMs) {
+    PowerManagerStatus status;
+    powerGetStatus(&status);
+    PowerLockStats before[POWER_LOCK_COUNT], after[POWER_LOCK_COUNT];
+    if (!taskMonitorCapture(&s_topBefore)) {
+        Serial.println("Task monitor: unable to read task states (more than TASK_MONITOR_MAX_TASKS tasks?).");
+        return;
+    }
+    powerGetLockStats(before);
+    vTaskDelay(pdMS_TO_TICKS(windowMs));
+    taskMonitorCapture(&s_topAfter);
+    powerGetLockStats(after);
+    TaskMonitorReport& report = s_monitorReport;
+    taskMonitorCompare(&s_topBefore, &s_topAfter, &report);
+
+    if (status.dfs_enabled) {
+        Serial.printf("Power: DFS %u-%u MHz, light sleep %s\n", status.min_mhz, status.max_mhz,
+                      status.light_sleep_enabled ? "enabled" : "disabled");
+    } else {
+        Serial.printf("Power: fixed %u MHz (CONFIG_PM_ENABLE not set in this build; locks are only counted)\n",
+                      status.max_mhz);
+    }
+
+    // The kernel keeps a core at the maximum clock whenever it is not idle
+    if (report.cpu_available) {
+        for (int core = 0; core < TASK_MONITOR_CORES; core++) {
+            float busy = report.core_load_percent[core];
+            if (status.dfs_enabled) {
+                Serial.printf("  Core %d: %.1f%% at %u MHz, %.1f%% at %u MHz or light sleep\n", core, busy,
+                              status.max_mhz, 100.0f - busy, status.min_mhz);
+            } else {
+                Serial.printf("  Core %d: %.1f%% busy, %.1f%% idle\n", core, busy, 100.0f - busy);
+            }
+        }
+    } else {
+        Serial.println("  Frequency residency unavailable (FreeRTOS run-time stats not enabled)");
+    }
+
+    uint64_t windowUs = (uint64_t)report.window_ms * 1000ULL;
+    Serial.printf("  Locks over %lu ms:\n", (unsigned long)report.window_ms);
+    for (int i = 0; i < POWER_LOCK_COUNT; i++) {
+        uint64_t heldUs = after[i].held_us - before[i].held_us;
+        Serial.printf("    %-9s held %5.1f%%, %lu acquisitions\n", powerLockName((PowerLockId)i),
+                      windowUs > 0 ? 100.0f * heldUs / windowUs : 0.0f,
+                      (unsigned long)(after[i].acquisitions - before[i].acquisitions));
+    }
+    powerPrintProfile(Serial); // Exact per-mode times when CONFIG_PM_PROFILING is set
+
+    I2cSensorCache cache;
+    i2cGetSensorCache(&cache);
+    if (!cache.batt_valid) {
+        Serial.println("  Battery: fuel gauge not available");
+    } else if (cache.batt_charge_rate >= 0.0f) {
+        Serial.printf("  Battery: %.2f V, %.0f%%, charging at %.1f%%/h\n", cache.batt_voltage, cache.batt_percent,
+                      cache.batt_charge_rate);
+    } else {
+        Serial.printf("  Battery: %.2f V, %.0f%%, %.1f%%/h -> %.0f mA average (%d mAh cell)\n", cache.batt_voltage,
+                      cache.batt_percent, cache.batt_charge_rate,
+                      -cache.batt_charge_rate / 100.0f * BATTERY_CAPACITY_MAH, BATTERY_CAPACITY_MAH);
+    }
+}
+
+// Writes the task monitor figures for the window since the previous call to the event log
+static void logTaskStats() {
+    TaskMonitorSnapshot& now = s_topAfter;
+    if (!taskMonitorCapture(&now)) {
+        return;
+    }
+    if (s_logBaseline.count > 0) {
+        TaskMonitorReport& report = s_monitorReport;
+        taskMonitorCompare(&s_logBaseline, &now, &report);
+
+        SystemStatsEvent system;
+        system.window_ms = report.window_ms;
+        for (int core = 0; core < TASK_MONITOR_CORES; core++) {
+            system.core_load_permille[core] = report.cpu_available ? (uint16_t)(report.core_load_percent[core] * 10.0f) : 0xFFFF;
+        }
+        system.task_count = report.count;
+        system.event_queue_depth = (uint8_t)eventLogPending();
+        system.heap_internal_free = report.heap_internal_free;
+        system.heap_internal_largest = report.heap_internal_largest;
+        system.heap_internal_min_free = report.heap_internal_min_free;
+        system.heap_psram_free = report.heap_psram_free;
+        system.heap_psram_largest = report.heap_psram_largest;
+        eventLogPost(EVENT_SYSTEM_STATS, &system, sizeof(system));
+
+        for (uint8_t i = 0; i < report.count; i++) {
+            const TaskMonitorTask* t = report.tasks[i].task;
+            TaskStatsEvent task;
+            memset(task.name, 0, sizeof(task.name));
+            strncpy(task.name, t->name, sizeof(task.name) - 1);
+            task.core = t->core == TASK_MONITOR_ANY_CORE ? 0xFF : (uint8_t)t->core;
+            task.state = (uint8_t)t->state;
+            task.priority = (uint8_t)t->priority;
+            task.cpu_permille = report.tasks[i].cpu_percent < 0.0f ? 0xFFFF : (uint16_t)(report.tasks[i].cpu_percent * 10.0f);
+            task.stack_free_min_bytes = t->stack_free_min_bytes;
+            eventLogPost(EVENT_TASK_STATS, &task, sizeof(task));
+        }
+    }
+    memcpy(&s_logBaseline, &now, sizeof(now));
+}
+
+void print_i2c_stats() {
+    static const char* priorityNames[I2C_PRIORITY_COUNT] = {"IMU", "normal", "background"};
+    I2cBusStats stats;
+    i2cGetBusStats(&stats, true);
+    float utilization = stats.window_ms > 0 ? (stats.busy_us / 10.0f) / stats.window_ms : 0.0f;
+    Serial.printf("I2C bus over %lu ms: %.1f%% busy, %lu polls, %lu errors\n",
+                  (unsigned long)stats.window_ms, utilization, (unsigned long)stats.polls, (unsigned long)stats.errors);
+    for (int i = 0; i < I2C_PRIORITY_COUNT; i++) {
+        uint32_t avg = stats.transactions[i] > 0 ? (uint32_t)(stats.latency_sum_us[i] / stats.transactions[i]) : 0;
+        Serial.printf("  %-10s %7lu txns, latency avg %5lu us, max %5lu us\n", priorityNames[i],
+                      (unsigned long)stats.transactions[i], (unsigned long)avg, (unsigned long)stats.latency_max_us[i]);
+    }
+
+    I2cSensorCache cache;
+    i2cGetSensorCache(&cache);
+    if (cache.batt_valid) {
+        Serial.printf("  MAX17048: %.2f V, %.1f%% (%lu ms ago)\n", cache.batt_voltage, cache.batt_percent,
+                      (unsigned long)(millis() - cache.batt_update_millis));
+    }
+    if (cache.bme_valid) {
+        Serial.printf("  BME280:   %.1f C, %.0f Pa, %.0f%% RH (%lu ms ago)\n", cache.bme_temperature_c,
+                      cache.bme_pressure_pa, cache.bme_humidity_percent, (unsigned long)(millis() - cache.bme_update_millis));
+    }
 }
 
 void process_command(char *command_line) {
@@ -32,6 +257,128 @@ void process_command(char *command_line) {
         print_help();
         return; // Explicitly return after handling no-argument command
     }
+    if (strcmp(command, "display_stats") == 0) {
+        Serial.printf("Display: %lu frames in the last minute, state: %s\n",
+                      (unsigned long)displayGetFramesLastMinute(), displayIsIdle() ? "idle (dimmed)" : "active");
+        return;
+    }
+    if (strcmp(command, "i2c_stats") == 0) {
+        print_i2c_stats();
+        return;
+    }
+    if (strcmp(command, "imu_stats") == 0) {
+        ImuStats stats;
+        imuGetStats(&stats);
+        Serial.printf("IMU: %lu interrupts, %lu bursts, %lu samples, %lu FIFO overruns, %lu ring drops, %lu bus errors\n",
+                      (unsigned long)stats.interrupts, (unsigned long)stats.bursts, (unsigned long)stats.samples,
+                      (unsigned long)stats.overruns, (unsigned long)stats.ring_dropped, (unsigned long)stats.bus_errors);
+        ImuAttitude attitude;
+        imuGetAttitude(&attitude);
+        if (attitude.valid) {
+            Serial.printf("AHRS: roll %.1f deg, pitch %.1f deg, update %.2f us avg / %.2f us max\n",
+                          attitude.roll_deg, attitude.pitch_deg, stats.ahrs_update_us_avg, stats.ahrs_update_us_max);
+        } else {
+            Serial.println("AHRS: no samples yet");
+        }
+        return;
+    }
+
+    if (strcmp(command, "adc_stats") == 0) {
+        AnalogCaptureStats stats;
+        float volts[ANALOG_MAX_CHANNELS];
+        analogGetStats(&stats);
+        analogGetLatest(volts);
+        Serial.printf("ADC: %lu frames, %lu conversions, %lu outputs/channel, %lu overflows, %lu discarded\n",
+                      (unsigned long)stats.frames, (unsigned long)stats.samples, (unsigned long)stats.outputs,
+                      (unsigned long)stats.overflows, (unsigned long)stats.discarded);
+        for (int i = 0; i < ANALOG_CHANNEL_COUNT; i++) {
+            Serial.printf("  ch%d: %.3f V\n", i, volts[i]);
+        }
+        return;
+    }
+    if (strcmp(command, "adc_bench") == 0) {
+        analogRunBenchmark();
+        return;
+    }
+    if (strcmp(command, "power_stats") == 0) {
+        PowerMetrics metrics;
+        if (TRACE_MUTEX_TAKE(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            metrics = g_powerCadenceData.metrics;
+            TRACE_MUTEX_GIVE(g_dataMutex);
+        }
+        Serial.printf("Power over %lu s: 3s %.0f W, 10s %.0f W, 30s %.0f W, avg %.0f W\n", (unsigned long)metrics.elapsed_s,
+                      metrics.avg3s_watts, metrics.avg10s_watts, metrics.avg30s_watts, metrics.avg_watts);
+        Serial.printf("  NP %.0f W, IF %.2f (FTP %u W), TSS %.1f, work %.1f kJ, %lu events dropped\n",
+                      metrics.normalized_power, metrics.intensity_factor, getPowerAnalyticsFtp(), metrics.tss,
+                      metrics.work_kj, (unsigned long)eventLogDropped());
+        return;
+    }
+    if (strcmp(command, "mmp") == 0) {
+        char *mmpArgument = strtok_r(NULL, " ", &saveptr);
+        if (mmpArgument != NULL && strcmp(mmpArgument, "save") == 0) {
+            saveMeanMaxCurve();
+            return;
+        }
+        MeanMaxPoint curve[MMP_MAX_DURATIONS];
+        uint8_t curveCount = 0;
+        if (TRACE_MUTEX_TAKE(g_dataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            curveCount = g_powerCadenceData.meanMaxCount;
+            memcpy(curve, g_powerCadenceData.meanMax, curveCount * sizeof(MeanMaxPoint));
+            TRACE_MUTEX_GIVE(g_dataMutex);
+        }
+        Serial.println("Mean-maximal power:");
+        for (uint8_t i = 0; i < curveCount; i++) {
+            Serial.printf("  %5u s: %4.0f W (window ending at %lu s)\n", curve[i].duration_s, curve[i].best_watts,
+                          (unsigned long)curve[i].best_end_s);
+        }
+        return;
+    }
+    if (strcmp(command, "gates") == 0) {
+        SegmentState segments;
+        if (TRACE_MUTEX_TAKE(g_gpsDataMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            segments = g_segmentState;
+            TRACE_MUTEX_GIVE(g_gpsDataMutex);
+        }
+        const SegmentTimerStatus& timer = segments.timer;
+        Serial.printf("Gates: %lu loaded, %u segments running\n", (unsigned long)segments.gate_count, timer.active_segments);
+        Serial.printf("  Laps: %lu completed, last %lu ms, best %lu ms%s\n", (unsigned long)timer.lap_count,
+                      (unsigned long)timer.last_lap_ms, (unsigned long)timer.best_lap_ms, timer.lap_running ? ", running" : "");
+        if (timer.last_segment_id >= 0) {
+            Serial.printf("  Last segment: %ld in %lu ms\n", (long)timer.last_segment_id, (unsigned long)timer.last_segment_ms);
+        }
+        return;
+    }
+
+    if (strcmp(command, "elevation") == 0) {
+        ElevationEstimate estimate;
+        gpsGetElevation(&estimate);
+        if (!estimate.valid) {
+            Serial.println("Elevation: no pressure or GPS altitude yet");
+            return;
+        }
+        Serial.printf("Elevation: %.1f m (+/- %.1f), vertical %.2f m/s, gradient %.1f%%, ascent %.0f m\n",
+                      estimate.elevation_m, estimate.elevation_sigma_m, estimate.vertical_speed_mps,
+                      estimate.gradient_percent, estimate.ascent_m);
+        Serial.printf("  Baro offset %.1f m, %lu pressure updates, %lu GPS updates, %lu GPS rejected\n",
+                      estimate.baro_offset_m, (unsigned long)estimate.baro_updates,
+                      (unsigned long)estimate.gps_updates, (unsigned long)estimate.gps_rejected);
+        return;
+    }
+
+    if (strcmp(command, "ls") == 0) {
+        logDownloadList(Serial);
+        return;
+    }
+
+    if (strcmp(command, "rotation") == 0) {
+        logRotationPrint(Serial);
+        return;
+    }
+
+    if (strcmp(command, "mem") == 0) {
+        memPlacementPrint(Serial);
+        return;
+    }
 
     // For commands that require arguments, now attempt to get the argument
     argument = strtok_r(NULL, " ", &saveptr);
@@ -108,6 +455,158 @@ void process_command(char *command_line) {
         } else {
             Serial.println("Missing argument for ble_stream. Use 'on' or 'off'.");
         }
+    } else if (strcmp(command, "ftp") == 0) {
+        int ftpWatts = argument != NULL ? atoi(argument) : 0;
+        if (ftpWatts > 0 && ftpWatts < 2000) {
+            setPowerAnalyticsFtp((uint16_t)ftpWatts);
+            Serial.printf("FTP set to %d W.\n", ftpWatts);
+        } else {
+            Serial.println("Invalid or missing argument for ftp. Use a value in watts, e.g. 'ftp 250'.");
+        }
+    } else if (strcmp(command, "top") == 0) {
+        long windowMs = argument != NULL ? atol(argument) : TASK_MONITOR_WINDOW_MS;
+        if (windowMs > 0 && windowMs <= 60000) {
+            print_top((uint32_t)windowMs);
+        } else {
+            Serial.println("Invalid window for top. Use 1..60000 ms, e.g. 'top 2000'.");
+        }
+    } else if (strcmp(command, "pm") == 0) {
+        long windowMs = argument != NULL ? atol(argument) : TASK_MONITOR_WINDOW_MS;
+        if (windowMs > 0 && windowMs <= 60000) {
+            print_power((uint32_t)windowMs);
+        } else {
+            Serial.println("Invalid window for pm. Use 1..60000 ms, e.g. 'pm 5000'.");
+        }
+    } else if (strcmp(command, "membench") == 0) {
+        long kilobytes = argument != NULL ? atol(argument) : MEM_BENCH_BYTES / 1024;
+        if (kilobytes > 0 && kilobytes <= 1024) {
+            memBenchmarkPrint(Serial, (size_t)kilobytes * 1024);
+        } else {
+            Serial.println("Invalid buffer size for membench. Use 1..1024 KB, e.g. 'membench 256'.");
+        }
+    } else if (strcmp(command, "sdbench") == 0) {
+        if (argument != NULL && strcmp(argument, "show") == 0) {
+            sdBenchPrintStored(Serial);
+        } else {
+            long megabytes = argument != NULL ? atol(argument) : SD_BENCH_SEQUENTIAL_BYTES / (1024 * 1024);
+            if (megabytes > 0 && megabytes <= 64) {
+                sdBenchRun(Serial, (uint32_t)megabytes * 1024 * 1024, NULL);
+            } else {
+                Serial.println("Invalid size for sdbench. Use 1..64 MB per block size, or 'sdbench show'.");
+            }
+        }
+    } else if (strcmp(command, "schema") == 0) {
+        static char text[LOG_SCHEMA_BLOB_MAX * 3]; // Terminal task only
+        size_t length = 0;
+        if (argument != NULL && strcmp(argument, "csv") == 0) {
+            length = logSchemaCsvHeader(text, sizeof(text));
+        } else if (argument != NULL && strcmp(argument, "json") == 0) {
+            length = logSchemaJson(text, sizeof(text));
+        } else {
+            Serial.println("Invalid or missing argument for schema. Use 'csv' or 'json'.");
+            return;
+        }
+        if (length > 0) {
+            Serial.println(text);
+        } else {
+            Serial.println("Schema text does not fit the buffer.");
+        }
+    } else if (strcmp(command, "heap_audit") == 0) {
+        if (argument != NULL && strcmp(argument, "mark") == 0) {
+            heapAuditMarkSteadyState();
+            Serial.println("Heap audit: steady state marked, counters zeroed.");
+        } else if (argument != NULL && strcmp(argument, "soak") == 0) {
+            char *minutesArg = strtok_r(NULL, " ", &saveptr);
+            long minutes = minutesArg != NULL ? atol(minutesArg) : 0;
+            HeapAuditStats stats;
+            heapAuditGetStats(&stats);
+            if (!stats.enabled) {
+                heapAuditPrint(Serial);
+            } else if (minutes > 0 && minutes <= 1440) {
+                heapAuditStartSoak((uint16_t)minutes);
+                Serial.printf("Soak started: %ld minutes, zero allocations expected.\n", minutes);
+            } else {
+                Serial.println("Invalid soak length. Use 1..1440 minutes, e.g. 'heap_audit soak 60'.");
+            }
+        } else if (argument == NULL) {
+            heapAuditPrint(Serial);
+        } else {
+            Serial.println("Invalid argument for heap_audit. Use 'mark' or 'soak <minutes>'.");
+        }
+    } else if (strcmp(command, "wifi") == 0) {
+        if (argument != NULL && strcmp(argument, "on") == 0) {
+            wifiOffloadSetEnabled(true);
+            Serial.println("Starting Wi-Fi log offload...");
+        } else if (argument != NULL && strcmp(argument, "off") == 0) {
+            wifiOffloadSetEnabled(false);
+            Serial.println("Stopping Wi-Fi log offload...");
+        } else {
+            WifiOffloadStats stats;
+            wifiOffloadGetStats(&stats);
+            Serial.printf("WiFi offload %s: %u stations, %lu requests, %llu bytes served, last transfer %.2f MB/s\n",
+                          stats.active ? "on" : "off", stats.stations, (unsigned long)stats.requests,
+                          (unsigned long long)stats.bytes_served, stats.last_mbps);
+        }
+    } else if (strcmp(command, "get") == 0) {
+        if (argument != NULL) {
+            char *offsetArg = strtok_r(NULL, " ", &saveptr);
+            char *lengthArg = strtok_r(NULL, " ", &saveptr);
+            uint32_t offset = offsetArg != NULL ? strtoul(offsetArg, NULL, 10) : 0;
+            uint32_t length = lengthArg != NULL ? strtoul(lengthArg, NULL, 10) : 0;
+            logDownloadSend(argument, offset, length);
+        } else {
+            Serial.println("Missing file name for get. Use 'get <file> [offset] [length]'.");
+        }
+    } else if (strcmp(command, "trace") == 0) {
+#ifdef ENABLE_TRACE
+        if (argument != NULL && strcmp(argument, "on") == 0) {
+            traceSetEnabled(true);
+            Serial.println(traceEnabled() ? "Tracing enabled." : "Trace rings not allocated.");
+        } else if (argument != NULL && strcmp(argument, "off") == 0) {
+            traceSetEnabled(false);
+            Serial.println("Tracing disabled.");
+        } else if (argument != NULL && strcmp(argument, "dump") == 0) {
+            traceDump(Serial);
+        } else if (argument != NULL && strcmp(argument, "clear") == 0) {
+            traceClear();
+            Serial.println("Trace rings cleared.");
+        } else {
+            Serial.println("Invalid or missing argument for trace. Use 'on', 'off', 'dump' or 'clear'.");
+        }
+#else
+        Serial.println("Tracing is not compiled in. Define ENABLE_TRACE in config.h.");
+#endif
+    } else if (strcmp(command, "capture") == 0) {
+        if (argument != NULL && strcmp(argument, "on") == 0) {
+            rawCaptureSetMode(RAW_CAPTURE_ON);
+            Serial.println("Starting raw capture...");
+        } else if (argument != NULL && strcmp(argument, "only") == 0) {
+            rawCaptureSetMode(RAW_CAPTURE_ONLY);
+            Serial.println("Starting raw capture; GPS and power are not decoded until 'capture on' or 'capture off'.");
+        } else if (argument != NULL && strcmp(argument, "off") == 0) {
+            rawCaptureSetMode(RAW_CAPTURE_OFF);
+            Serial.println("Stopping raw capture...");
+        } else if (argument == NULL) {
+            rawCapturePrint(Serial);
+        } else {
+            Serial.println("Invalid argument for capture. Use 'on', 'only' or 'off'.");
+        }
+    } else if (strcmp(command, "stream") == 0) {
+        if (argument != NULL && strcmp(argument, "on") == 0) {
+            Serial.println("Binary telemetry stream enabled; text output from now on is interleaved with frames.");
+            Serial.flush();
+            telemetrySetEnabled(true);
+        } else if (argument != NULL && strcmp(argument, "off") == 0) {
+            telemetrySetEnabled(false);
+            Serial.println("Binary telemetry stream disabled.");
+        } else {
+            TelemetryStats stats;
+            telemetryGetStats(&stats);
+            Serial.printf("Stream %s: %lu frames queued, %lu dropped, %lu bytes sent, ring high-water %lu/%u bytes\n",
+                          telemetryEnabled() ? "on" : "off", (unsigned long)stats.frames_queued,
+                          (unsigned long)stats.frames_dropped, (unsigned long)stats.bytes_sent,
+                          (unsigned long)stats.ring_high_water, TELEMETRY_TX_RING_BYTES);
+        }
     } else {
         Serial.print("Unknown command: ");
         Serial.println(command); // This should now only be reached if none of the above matched
@@ -115,15 +614,50 @@ void process_command(char *command_line) {
     }
 }
 
+static TaskHandle_t s_terminalTaskHandle = NULL;
+
+static void wakeTerminalTask() {
+    if (s_terminalTaskHandle != NULL) {
+        xTaskNotifyGive(s_terminalTaskHandle);
+    }
+}
+
+#if ARDUINO_USB_CDC_ON_BOOT
+static void serialRxEvent(void* arg, esp_event_base_t base, int32_t id, void* data) {
+    wakeTerminalTask();
+}
+#endif
+
 void terminal_task(void *pvParameters) {
     (void)pvParameters; // Unused parameter
+    s_terminalTaskHandle = xTaskGetCurrentTaskHandle();
+#if ARDUINO_USB_MODE && ARDUINO_USB_CDC_ON_BOOT
+    Serial.onEvent(ARDUINO_HW_CDC_RX_EVENT, serialRxEvent); // USB Serial/JTAG controller
+#elif ARDUINO_USB_CDC_ON_BOOT
+    Serial.onEvent(ARDUINO_USB_CDC_RX_EVENT, serialRxEvent); // TinyUSB CDC
+#else
+    Serial.onReceive(wakeTerminalTask); // UART0
+#endif
+    bool usbLockHeld = false;
 
     // Initialize buffer
     memset(command_buffer, 0, sizeof(command_buffer));
     buffer_pos = 0;
 
+    taskMonitorCapture(&s_logBaseline); // First periodic task record covers the interval from here
+    unsigned long lastTaskStatsMs = millis();
+
     while (1) {
-        if (Serial.available() > 0) {
+        // An attached host needs the USB PHY clocked; light sleep would drop the connection
+        bool hostAttached = (bool)Serial;
+        if (hostAttached && !usbLockHeld) {
+            powerLockAcquire(POWER_LOCK_USB);
+        } else if (!hostAttached && usbLockHeld) {
+            powerLockRelease(POWER_LOCK_USB);
+        }
+        usbLockHeld = hostAttached;
+
+        while (Serial.available() > 0) {
             char incoming_char = Serial.read();
 
             if (incoming_char == '\n' || incoming_char == '\r') {
@@ -133,7 +667,9 @@ void terminal_task(void *pvParameters) {
                     Serial.println(); // Add this line for a clean break
                     Serial.print("Received command: "); // Echo command
                     Serial.println(command_buffer);
+                    TRACE_BEGIN(TRACE_TERMINAL_COMMAND);
                     process_command(command_buffer);
+                    TRACE_END(TRACE_TERMINAL_COMMAND);
                     buffer_pos = 0; // Reset buffer position for next command
                     memset(command_buffer, 0, sizeof(command_buffer)); // Clear buffer
                 }
@@ -147,6 +683,16 @@ void terminal_task(void *pvParameters) {
                 memset(command_buffer, 0, sizeof(command_buffer)); // Clear buffer
             }
         }
-        vTaskDelay(10 / portTICK_PERIOD_MS); // Yield for other tasks
+        TRACE_BEGIN(TRACE_TELEMETRY_DRAIN);
+        telemetryDrain(); // Binary stream shares the port; never blocks
+        TRACE_END(TRACE_TELEMETRY_DRAIN);
+        if (millis() - lastTaskStatsMs >= TASK_MONITOR_LOG_INTERVAL_S * 1000UL) {
+            lastTaskStatsMs = millis();
+            logTaskStats();
+        }
+        heapAuditService(Serial);
+        // Sleep until input arrives. The CDC TX buffer is small, so poll every tick while streaming
+        // to keep the ring from filling.
+        ulTaskNotifyTake(pdTRUE, telemetryEnabled() ? 1 : pdMS_TO_TICKS(TERMINAL_WAIT_MS));
     }
 }
@@ -0,0 +1,135 @@
+#include "trace.h"
+
+#ifdef ENABLE_TRACE
+
+#include "gps_data.h"  // For g_gpsDataMutex
+#include "mem_placement.h" // Rings come from the PSRAM arena
+#include <esp_cpu.h>   // For esp_cpu_get_ccount
+#include <esp_timer.h>
+
+#define TRACE_CORES 2
+#define TRACE_SYNC_CYCLES (1UL << 28)  // ~1 s at 240 MHz, well inside the 32-bit cycle counter wrap
+
+#define TRACE_NAME_ENTRY(id, name) name,
+static const char* const s_eventNames[TRACE_EVENT_COUNT] = { TRACE_EVENT_LIST(TRACE_NAME_ENTRY) };
+#undef TRACE_NAME_ENTRY
+
+// Ring storage lives in PSRAM; indices stay in internal RAM
+static TraceRecord* s_rings[TRACE_CORES] = { nullptr, nullptr };
+static uint32_t s_heads[TRACE_CORES] = { 0, 0 };       // Total records written (free-running)
+static uint32_t s_lastSync[TRACE_CORES] = { 0, 0 };
+static bool s_synced[TRACE_CORES] = { false, false };
+static volatile bool s_enabled = false;
+
+bool traceInit() {
+    for (int core = 0; core < TRACE_CORES; core++) {
+        if (s_rings[core] == nullptr) {
+            s_rings[core] = (TraceRecord*)memArenaAlloc(MEM_REGION_PSRAM, TRACE_RING_RECORDS * sizeof(TraceRecord),
+                                                        core == 0 ? "trace ring core 0" : "trace ring core 1");
+        }
+        if (s_rings[core] == nullptr) {
+            return false;
+        }
+    }
+    s_enabled = true;
+    return true;
+}
+
+void traceSetEnabled(bool enabled) {
+    s_enabled = enabled && s_rings[0] != nullptr;
+}
+
+bool traceEnabled() {
+    return s_enabled;
+}
+
+static inline void writeRecord(int core, uint32_t cycles, uint32_t task, uint32_t arg, uint16_t id, uint8_t phase) {
+    TraceRecord& r = s_rings[core][s_heads[core] % TRACE_RING_RECORDS];
+    r.cycles = cycles;
+    r.task = task;
+    r.arg = arg;
+    r.id = id;
+    r.phase = phase;
+    r.reserved = 0;
+    s_heads[core]++;
+}
+
+void traceRecord(TraceEventId id, TracePhase phase, uint32_t arg) {
+    if (!s_enabled) {
+        return;
+    }
+    // Masking interrupts pins us to this core and keeps other writers of this ring out
+    uint32_t irqState = portSET_INTERRUPT_MASK_FROM_ISR();
+    int core = xPortGetCoreID();
+    uint32_t cycles = esp_cpu_get_ccount();
+    if (!s_synced[core] || cycles - s_lastSync[core] >= TRACE_SYNC_CYCLES) {
+        uint64_t us = esp_timer_get_time();
+        writeRecord(core, cycles, (uint32_t)(us >> 32), (uint32_t)us, TRACE_SYNC, TRACE_PHASE_SYNC);
+        s_lastSync[core] = cycles;
+        s_synced[core] = true;
+    }
+    writeRecord(core, cycles, (uint32_t)xTaskGetCurrentTaskHandle(), arg, id, phase);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(irqState);
+}
+
+void traceClear() {
+    bool wasEnabled = s_enabled;
+    s_enabled = false;
+    vTaskDelay(1); // Let any record in progress on the other core finish
+    for (int core = 0; core < TRACE_CORES; core++) {
+        s_heads[core] = 0;
+        s_synced[core] = false;
+    }
+    s_enabled = wasEnabled;
+}
+
+static TraceEventId mutexWaitId(SemaphoreHandle_t mutex) {
+    if (mutex == g_dataMutex) return TRACE_DATA_MUTEX_WAIT;
+    if (mutex == g_gpsDataMutex) return TRACE_GPS_MUTEX_WAIT;
+    return TRACE_OTHER_MUTEX_WAIT;
+}
+
+BaseType_t traceMutexTake(SemaphoreHandle_t mutex, TickType_t timeout) {
+    TraceEventId waitId = mutexWaitId(mutex);
+    traceRecord(waitId, TRACE_PHASE_BEGIN, 0);
+    BaseType_t taken = xSemaphoreTake(mutex, timeout);
+    traceRecord(waitId, TRACE_PHASE_END, taken == pdTRUE ? 0 : 1); // arg 1: timed out
+    if (taken == pdTRUE) {
+        traceRecord((TraceEventId)(waitId + 1), TRACE_PHASE_BEGIN, 0); // *_HOLD follows *_WAIT
+    }
+    return taken;
+}
+
+void traceMutexGive(SemaphoreHandle_t mutex) {
+    traceRecord((TraceEventId)(mutexWaitId(mutex) + 1), TRACE_PHASE_END, 0);
+    xSemaphoreGive(mutex);
+}
+
+void traceDump(Print& out) {
+    bool wasEnabled = s_enabled;
+    s_enabled = false;
+    vTaskDelay(1); // Let any record in progress on the other core finish
+
+    out.printf("TRACE BEGIN cpu_mhz=%lu cores=%d\n", (unsigned long)getCpuFrequencyMhz(), TRACE_CORES);
+    for (int id = 0; id < TRACE_EVENT_COUNT; id++) {
+        out.printf("N %d %s\n", id, s_eventNames[id]);
+    }
+    // Task names for the handles in the records (tasks deleted since are left unnamed)
+    static TaskStatus_t tasks[24];
+    UBaseType_t taskCount = uxTaskGetSystemState(tasks, sizeof(tasks) / sizeof(tasks[0]), NULL);
+    for (UBaseType_t i = 0; i < taskCount; i++) {
+        out.printf("T %08lx %s\n", (unsigned long)(uint32_t)tasks[i].xHandle, tasks[i].pcTaskName);
+    }
+    for (int core = 0; core < TRACE_CORES && s_rings[core] != nullptr; core++) {
+        uint32_t count = s_heads[core] < TRACE_RING_RECORDS ? s_heads[core] : TRACE_RING_RECORDS;
+        for (uint32_t i = s_heads[core] - count; i != s_heads[core]; i++) {
+            const TraceRecord& r = s_rings[core][i % TRACE_RING_RECORDS];
+            out.printf("R %d %lu %c %u %08lx %lu\n", core, (unsigned long)r.cycles, (char)r.phase, r.id,
+                       (unsigned long)r.task, (unsigned long)r.arg);
+        }
+    }
+    out.println("TRACE END");
+    s_enabled = wasEnabled;
+}
+
+#endif // ENABLE_TRACE
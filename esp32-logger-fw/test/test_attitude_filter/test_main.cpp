@@ -0,0 +1,215 @@
+#include <unity.h>
+#include <math.h>
+#include <stdint.h>
+
+#include "attitude_filter.h"
+#include "config.h"
+
+// Synthetic motion at the IMU task's rate and gain. The true attitude is a ZYX Euler set
+// (yaw, pitch, roll) given as functions of time; gyro and accelerometer readings are derived
+// from it exactly, plus a small deterministic noise and gyro bias.
+
+static const float DT = 1.0f / IMU_ODR_HZ;
+static const float G = 9.80665f;
+static const float DEG = (float)M_PI / 180.0f;
+
+struct Truth {
+    float roll, pitch, yaw;          // rad
+    float rollRate, pitchRate, yawRate; // Euler angle rates, rad/s
+    float accelEarth[3];             // Kinematic acceleration, earth frame (X, Y horizontal, Z up)
+};
+
+static uint32_t s_seed;
+
+static float noise(float amplitude) {
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return amplitude * ((float)(s_seed >> 8) / (float)(1u << 24) * 2.0f - 1.0f);
+}
+
+static void sense(const Truth& t, float gyro[3], float accel[3]) {
+    float cr = cosf(t.roll), sr = sinf(t.roll);
+    float cp = cosf(t.pitch), sp = sinf(t.pitch);
+    float cy = cosf(t.yaw), sy = sinf(t.yaw);
+
+    // Body rates from Euler rates
+    gyro[0] = t.rollRate - t.yawRate * sp + 0.003f + noise(0.005f);
+    gyro[1] = t.pitchRate * cr + t.yawRate * cp * sr - 0.004f + noise(0.005f);
+    gyro[2] = -t.pitchRate * sr + t.yawRate * cp * cr + 0.002f + noise(0.005f);
+
+    // Specific force (kinematic acceleration minus gravity) rotated into the sensor frame: R^T f
+    float f[3] = { t.accelEarth[0], t.accelEarth[1], t.accelEarth[2] + G };
+    float r[3][3] = {
+        { cy * cp, cy * sp * sr - sy * cr, cy * sp * cr + sy * sr },
+        { sy * cp, sy * sp * sr + cy * cr, sy * sp * cr - cy * sr },
+        { -sp, cp * sr, cp * cr },
+    };
+    for (int i = 0; i < 3; i++) {
+        accel[i] = r[0][i] * f[0] + r[1][i] * f[1] + r[2][i] * f[2] + noise(0.05f);
+    }
+}
+
+static Truth still(float rollDeg, float pitchDeg) {
+    Truth t = {};
+    t.roll = rollDeg * DEG;
+    t.pitch = pitchDeg * DEG;
+    return t;
+}
+
+static void step(AttitudeFilter& filter, const Truth& t) {
+    float gyro[3], accel[3];
+    sense(t, gyro, accel);
+    filter.update(gyro, accel, DT);
+}
+
+static float rollError(const AttitudeFilter& filter, const Truth& t) {
+    return fabsf(filter.rollDeg() - t.roll / DEG);
+}
+
+static float pitchError(const AttitudeFilter& filter, const Truth& t) {
+    return fabsf(filter.pitchDeg() - t.pitch / DEG);
+}
+
+void setUp(void) {
+    s_seed = 12345;
+}
+
+void tearDown(void) {}
+
+void test_static_tilt(void) {
+    const float poses[][2] = { { 0, 0 }, { 20, -10 }, { -45, 15 }, { 10, 60 }, { -70, -5 } };
+    for (const auto& pose : poses) {
+        AttitudeFilter filter(AHRS_BETA);
+        Truth t = still(pose[0], pose[1]);
+        step(filter, t); // Seed
+        TEST_ASSERT_TRUE(filter.initialized());
+        TEST_ASSERT_FLOAT_WITHIN(1.0f, pose[0], filter.rollDeg());
+        TEST_ASSERT_FLOAT_WITHIN(1.0f, pose[1], filter.pitchDeg());
+
+        // A minute at rest with gyro bias: the accelerometer keeps it there
+        float worstRoll = 0.0f, worstPitch = 0.0f;
+        for (int i = 0; i < 60 * IMU_ODR_HZ; i++) {
+            step(filter, t);
+            worstRoll = fmaxf(worstRoll, rollError(filter, t));
+            worstPitch = fmaxf(worstPitch, pitchError(filter, t));
+        }
+        TEST_ASSERT_LESS_THAN_FLOAT(1.0f, worstRoll);
+        TEST_ASSERT_LESS_THAN_FLOAT(1.0f, worstPitch);
+    }
+}
+
+void test_roll_ramp(void) {
+    // Upright, lean to 40 degrees at 20 deg/s, hold, back through upright to -40 and up again
+    AttitudeFilter filter(AHRS_BETA);
+    Truth t = still(0, 2);
+    step(filter, t);
+    const float rate = 20.0f * DEG;
+    const float segments[][2] = { { 2.0f, rate }, { 3.0f, 0.0f }, { 4.0f, -rate }, { 3.0f, 0.0f }, { 2.0f, rate } };
+    float worstRoll = 0.0f, worstPitch = 0.0f;
+    for (const auto& seg : segments) {
+        t.rollRate = seg[1];
+        for (int i = 0; i < (int)(seg[0] * IMU_ODR_HZ); i++) {
+            t.roll += t.rollRate * DT;
+            step(filter, t);
+            worstRoll = fmaxf(worstRoll, rollError(filter, t));
+            worstPitch = fmaxf(worstPitch, pitchError(filter, t));
+        }
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 0.0f, t.roll / DEG);
+    TEST_ASSERT_LESS_THAN_FLOAT(1.5f, worstRoll);
+    TEST_ASSERT_LESS_THAN_FLOAT(1.0f, worstPitch);
+}
+
+// Lean in to 35 degrees over 2 s, hold a steady right-hand corner for 20 s at 10 m/s, lean out.
+// Coordinated: the specific force stays along the sensor's Z axis the whole time.
+// Returns the worst roll error over the corner and stores the worst pitch error.
+static float coordinatedTurn(AttitudeFilter& filter, float speedMps, float* worstPitch) {
+    const float speed = 10.0f;
+    Truth t = still(0, 0);
+    filter.setForwardSpeed(speedMps);
+    step(filter, t);
+    const float leanRate = 17.5f * DEG;
+    const float segments[][2] = { { 2.0f, leanRate }, { 20.0f, 0.0f }, { 2.0f, -leanRate }, { 2.0f, 0.0f } };
+    float worstRoll = 0.0f;
+    *worstPitch = 0.0f;
+    for (const auto& seg : segments) {
+        t.rollRate = seg[1];
+        for (int i = 0; i < (int)(seg[0] * IMU_ODR_HZ); i++) {
+            t.roll += t.rollRate * DT;
+            t.yawRate = -G * tanf(t.roll) / speed; // Leaning right turns right (negative yaw)
+            t.yaw += t.yawRate * DT;
+            float centripetal = speed * t.yawRate; // Along (z x heading), i.e. the left of the heading
+            t.accelEarth[0] = -sinf(t.yaw) * centripetal;
+            t.accelEarth[1] = cosf(t.yaw) * centripetal;
+            step(filter, t);
+            worstRoll = fmaxf(worstRoll, rollError(filter, t));
+            *worstPitch = fmaxf(*worstPitch, pitchError(filter, t));
+        }
+    }
+    return worstRoll;
+}
+
+void test_coordinated_35_degree_turn(void) {
+    AttitudeFilter filter(AHRS_BETA);
+    float worstPitch;
+    float worstRoll = coordinatedTurn(filter, 10.0f, &worstPitch);
+    TEST_ASSERT_LESS_THAN_FLOAT(1.0f, worstRoll);
+    TEST_ASSERT_LESS_THAN_FLOAT(1.0f, worstPitch);
+
+    // Without the speed the accelerometer reads "upright" all through the corner and pulls it back
+    AttitudeFilter uncompensated(AHRS_BETA);
+    s_seed = 12345;
+    TEST_ASSERT_GREATER_THAN_FLOAT(5.0f, coordinatedTurn(uncompensated, 0.0f, &worstPitch));
+}
+
+void test_seed_recovery(void) {
+    // Seeded from a jolt (4 m/s^2 sideways, 3 m/s^2 forward), then still at the true attitude
+    AttitudeFilter filter(AHRS_BETA);
+    Truth t = still(5, -3);
+    Truth jolt = t;
+    jolt.accelEarth[0] = 3.0f;
+    jolt.accelEarth[1] = 4.0f;
+    step(filter, jolt);
+    TEST_ASSERT_GREATER_THAN_FLOAT(15.0f, rollError(filter, t));
+    TEST_ASSERT_GREATER_THAN_FLOAT(10.0f, pitchError(filter, t));
+
+    // Converges at the gain's slew rate (about 2 * beta rad/s) and then stays
+    float previous = rollError(filter, t) + pitchError(filter, t);
+    for (int second = 1; second <= 20; second++) {
+        for (int i = 0; i < IMU_ODR_HZ; i++) {
+            step(filter, t);
+        }
+        float error = rollError(filter, t) + pitchError(filter, t);
+        if (second <= 5) {
+            TEST_ASSERT_LESS_THAN_FLOAT(previous, error);
+        }
+        if (second >= 10) {
+            TEST_ASSERT_LESS_THAN_FLOAT(1.0f, rollError(filter, t));
+            TEST_ASSERT_LESS_THAN_FLOAT(1.0f, pitchError(filter, t));
+        }
+        previous = error;
+    }
+
+    // reset() seeds again from the next sample
+    filter.reset();
+    TEST_ASSERT_FALSE(filter.initialized());
+    step(filter, still(-30, 10));
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, -30.0f, filter.rollDeg());
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 10.0f, filter.pitchDeg());
+}
+
+void test_zero_accel_does_not_seed(void) {
+    AttitudeFilter filter(AHRS_BETA);
+    const float gyro[3] = { 0.0f, 0.0f, 0.0f }, accel[3] = { 0.0f, 0.0f, 0.0f };
+    filter.update(gyro, accel, DT);
+    TEST_ASSERT_FALSE(filter.initialized());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_static_tilt);
+    RUN_TEST(test_roll_ramp);
+    RUN_TEST(test_coordinated_35_degree_turn);
+    RUN_TEST(test_seed_recovery);
+    RUN_TEST(test_zero_accel_does_not_seed);
+    return UNITY_END();
+}
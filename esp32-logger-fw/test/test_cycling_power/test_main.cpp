@@ -0,0 +1,186 @@
+#include <unity.h>
+#include <string.h>
+
+#include "cycling_power.h"
+
+// Notifications are built field by field in spec order, so each test states only the flags and
+// values it is about and the layout comes out as a meter would send it.
+
+struct Notification {
+    uint8_t bytes[40];
+    size_t length;
+};
+
+static void put16(Notification* n, uint16_t value) {
+    n->bytes[n->length++] = (uint8_t)value;
+    n->bytes[n->length++] = (uint8_t)(value >> 8);
+}
+
+static void pad(Notification* n, size_t count, uint8_t fill) {
+    memset(n->bytes + n->length, fill, count);
+    n->length += count;
+}
+
+// Every optional field the flags announce, with 0xA5 filler for the ones the decoder skips
+static Notification build(uint16_t flags, int16_t watts, uint8_t balance, uint16_t revolutions, uint16_t eventTime,
+                          uint16_t topDeg, uint16_t bottomDeg) {
+    Notification n = {};
+    put16(&n, flags);
+    put16(&n, (uint16_t)watts);
+    if (flags & CP_FLAG_BALANCE) n.bytes[n.length++] = balance;
+    if (flags & CP_FLAG_ACCUMULATED_TORQUE) pad(&n, 2, 0xA5);
+    if (flags & CP_FLAG_WHEEL_REVOLUTIONS) pad(&n, 6, 0xA5);
+    if (flags & CP_FLAG_CRANK_REVOLUTIONS) {
+        put16(&n, revolutions);
+        put16(&n, eventTime);
+    }
+    if (flags & CP_FLAG_EXTREME_FORCES) pad(&n, 4, 0xA5);
+    if (flags & CP_FLAG_EXTREME_TORQUES) pad(&n, 4, 0xA5);
+    if (flags & CP_FLAG_EXTREME_ANGLES) pad(&n, 3, 0xA5);
+    if (flags & CP_FLAG_TOP_DEAD_SPOT) put16(&n, topDeg);
+    if (flags & CP_FLAG_BOTTOM_DEAD_SPOT) put16(&n, bottomDeg);
+    if (flags & CP_FLAG_ACCUMULATED_ENERGY) pad(&n, 2, 0xA5);
+    return n;
+}
+
+static CyclingPowerMeasurement s_m;
+
+static uint8_t decode(CyclingPowerDecoder& decoder, const Notification& n) {
+    return decoder.decode(n.bytes, n.length, &s_m);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_power_only(void) {
+    CyclingPowerDecoder decoder;
+    TEST_ASSERT_EQUAL_UINT8(0, decode(decoder, build(0, 287, 0, 0, 0, 0, 0)));
+    TEST_ASSERT_EQUAL_UINT16(287, s_m.power_watts);
+    TEST_ASSERT_EQUAL_UINT8(0, s_m.cadence_rpm);
+    TEST_ASSERT_FALSE(s_m.balance_available);
+    TEST_ASSERT_EQUAL_FLOAT(50.0f, s_m.left_balance_percent);
+
+    TEST_ASSERT_EQUAL_UINT8(0, decode(decoder, build(0, -12, 0, 0, 0, 0, 0)));
+    TEST_ASSERT_EQUAL_UINT16(0, s_m.power_watts);
+}
+
+void test_crank_data_gives_cadence(void) {
+    // The layout the synthetic ride in tools/sensor_capture.py sends: flags 0x0020, power, crank data
+    CyclingPowerDecoder decoder;
+    TEST_ASSERT_EQUAL_UINT8(0, decode(decoder, build(CP_FLAG_CRANK_REVOLUTIONS, 250, 0, 100, 10000, 0, 0)));
+    TEST_ASSERT_EQUAL_UINT8(0, s_m.cadence_rpm); // One crank event is not a rate yet
+    // Two revolutions in 1.25 s: 96 rpm
+    TEST_ASSERT_EQUAL_UINT8(0, decode(decoder, build(CP_FLAG_CRANK_REVOLUTIONS, 250, 0, 102, 11280, 0, 0)));
+    TEST_ASSERT_EQUAL_UINT16(250, s_m.power_watts);
+    TEST_ASSERT_EQUAL_UINT8(96, s_m.cadence_rpm);
+    // Both counters wrap: 65535 -> 1 revolutions, 65000 -> 104 ticks (640 ticks, 0.625 s) is 192 rpm
+    decoder.reset();
+    decode(decoder, build(CP_FLAG_CRANK_REVOLUTIONS, 250, 0, 65535, 65000, 0, 0));
+    decode(decoder, build(CP_FLAG_CRANK_REVOLUTIONS, 250, 0, 1, 104, 0, 0));
+    TEST_ASSERT_EQUAL_UINT8(192, s_m.cadence_rpm);
+    // No new revolution (coasting): no rate
+    decode(decoder, build(CP_FLAG_CRANK_REVOLUTIONS, 0, 0, 1, 1124, 0, 0));
+    TEST_ASSERT_EQUAL_UINT8(0, s_m.cadence_rpm);
+}
+
+void test_balance_reference_is_not_crank_data(void) {
+    // 0x0002 only says which pedal the balance refers to; it has no field and no crank data
+    CyclingPowerDecoder decoder;
+    uint16_t flags = CP_FLAG_BALANCE | CP_FLAG_BALANCE_REFERENCE;
+    TEST_ASSERT_EQUAL_UINT8(0, decode(decoder, build(flags, 300, 96, 0, 0, 0, 0)));
+    TEST_ASSERT_TRUE(s_m.balance_available);
+    TEST_ASSERT_EQUAL_FLOAT(48.0f, s_m.left_balance_percent);
+    TEST_ASSERT_EQUAL_UINT8(0, decode(decoder, build(flags, 300, 96, 0, 0, 0, 0)));
+    TEST_ASSERT_EQUAL_UINT8(0, s_m.cadence_rpm);
+}
+
+void test_skipped_fields_keep_crank_and_dead_spots_aligned(void) {
+    CyclingPowerDecoder decoder;
+    decoder.setFeatures(CP_FEATURE_DEAD_SPOT_ANGLES);
+    const uint16_t all = CP_FLAG_BALANCE | CP_FLAG_ACCUMULATED_TORQUE | CP_FLAG_WHEEL_REVOLUTIONS |
+                         CP_FLAG_CRANK_REVOLUTIONS | CP_FLAG_EXTREME_FORCES | CP_FLAG_EXTREME_TORQUES |
+                         CP_FLAG_EXTREME_ANGLES | CP_FLAG_TOP_DEAD_SPOT | CP_FLAG_BOTTOM_DEAD_SPOT |
+                         CP_FLAG_ACCUMULATED_ENERGY;
+    decode(decoder, build(all, 410, 100, 500, 2048, 12, 190));
+    Notification n = build(all, 410, 100, 501, 2048 + 640, 15, 193);
+    TEST_ASSERT_EQUAL_UINT(2 + 2 + 1 + 2 + 6 + 4 + 4 + 4 + 3 + 2 + 2 + 2, n.length);
+    TEST_ASSERT_EQUAL_UINT8(0, decode(decoder, n));
+    TEST_ASSERT_EQUAL_UINT16(410, s_m.power_watts);
+    TEST_ASSERT_EQUAL_FLOAT(50.0f, s_m.left_balance_percent);
+    TEST_ASSERT_EQUAL_UINT8(96, s_m.cadence_rpm);
+    TEST_ASSERT_TRUE(s_m.top_dead_spot_available);
+    TEST_ASSERT_EQUAL_UINT16(15, s_m.top_dead_spot_deg);
+    TEST_ASSERT_TRUE(s_m.bottom_dead_spot_available);
+    TEST_ASSERT_EQUAL_UINT16(193, s_m.bottom_dead_spot_deg);
+
+    // Each skipped field on its own
+    const uint16_t skipped[] = { CP_FLAG_ACCUMULATED_TORQUE, CP_FLAG_WHEEL_REVOLUTIONS };
+    for (uint16_t flag : skipped) {
+        decoder.reset();
+        decode(decoder, build(flag | CP_FLAG_CRANK_REVOLUTIONS, 200, 0, 7, 1000, 0, 0));
+        TEST_ASSERT_EQUAL_UINT8(0, decode(decoder, build(flag | CP_FLAG_CRANK_REVOLUTIONS, 200, 0, 8, 1640, 0, 0)));
+        TEST_ASSERT_EQUAL_UINT8(96, s_m.cadence_rpm);
+    }
+}
+
+void test_dead_spots_need_their_flag_and_the_feature(void) {
+    const uint16_t flags = CP_FLAG_TOP_DEAD_SPOT | CP_FLAG_BOTTOM_DEAD_SPOT; // Without the extreme angles
+    CyclingPowerDecoder decoder;
+    TEST_ASSERT_EQUAL_UINT8(0, decode(decoder, build(flags, 200, 0, 0, 0, 20, 200)));
+    TEST_ASSERT_FALSE(s_m.top_dead_spot_available);
+    TEST_ASSERT_FALSE(s_m.bottom_dead_spot_available);
+
+    decoder.setFeatures(CP_FEATURE_DEAD_SPOT_ANGLES);
+    TEST_ASSERT_EQUAL_UINT8(0, decode(decoder, build(flags, 200, 0, 0, 0, 20, 200)));
+    TEST_ASSERT_TRUE(s_m.top_dead_spot_available);
+    TEST_ASSERT_EQUAL_UINT16(20, s_m.top_dead_spot_deg);
+    TEST_ASSERT_EQUAL_UINT16(200, s_m.bottom_dead_spot_deg);
+
+    // Bottom only
+    TEST_ASSERT_EQUAL_UINT8(0, decode(decoder, build(CP_FLAG_BOTTOM_DEAD_SPOT, 200, 0, 0, 0, 0, 185)));
+    TEST_ASSERT_FALSE(s_m.top_dead_spot_available);
+    TEST_ASSERT_TRUE(s_m.bottom_dead_spot_available);
+    TEST_ASSERT_EQUAL_UINT16(185, s_m.bottom_dead_spot_deg);
+
+    decoder.setFeatures(0);
+    TEST_ASSERT_EQUAL_UINT8(0, decode(decoder, build(flags, 200, 0, 0, 0, 20, 200)));
+    TEST_ASSERT_FALSE(s_m.top_dead_spot_available);
+}
+
+void test_truncated_notifications(void) {
+    CyclingPowerDecoder decoder;
+    const uint8_t one[] = { 0x20 };
+    TEST_ASSERT_EQUAL_UINT8(CP_SHORT_FLAGS, decoder.decode(one, sizeof(one), &s_m));
+
+    Notification n = build(0, 150, 0, 0, 0, 0, 0);
+    TEST_ASSERT_EQUAL_UINT8(CP_SHORT_POWER, decoder.decode(n.bytes, 3, &s_m));
+
+    // Crank data announced behind a wheel field, cut off inside the crank field
+    decode(decoder, build(CP_FLAG_CRANK_REVOLUTIONS, 150, 0, 10, 0, 0, 0));
+    n = build(CP_FLAG_WHEEL_REVOLUTIONS | CP_FLAG_CRANK_REVOLUTIONS, 150, 0, 11, 640, 0, 0);
+    TEST_ASSERT_EQUAL_UINT8(CP_SHORT_CRANK, decoder.decode(n.bytes, n.length - 1, &s_m));
+    TEST_ASSERT_EQUAL_UINT16(150, s_m.power_watts);
+    TEST_ASSERT_EQUAL_UINT8(0, s_m.cadence_rpm);
+    // The crank state was dropped, so the next complete notification starts a new rate
+    n = build(CP_FLAG_CRANK_REVOLUTIONS, 150, 0, 12, 1280, 0, 0);
+    TEST_ASSERT_EQUAL_UINT8(0, decode(decoder, n));
+    TEST_ASSERT_EQUAL_UINT8(0, s_m.cadence_rpm);
+
+    // Dead spots behind a truncated skipped field are short as well
+    decoder.setFeatures(CP_FEATURE_DEAD_SPOT_ANGLES);
+    n = build(CP_FLAG_EXTREME_ANGLES | CP_FLAG_TOP_DEAD_SPOT | CP_FLAG_BOTTOM_DEAD_SPOT, 150, 0, 0, 0, 10, 190);
+    TEST_ASSERT_EQUAL_UINT8(CP_SHORT_TOP_DEAD | CP_SHORT_BOTTOM_DEAD, decoder.decode(n.bytes, 6, &s_m));
+    TEST_ASSERT_EQUAL_UINT8(CP_SHORT_BOTTOM_DEAD, decoder.decode(n.bytes, n.length - 1, &s_m));
+    TEST_ASSERT_EQUAL_UINT16(10, s_m.top_dead_spot_deg);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_power_only);
+    RUN_TEST(test_crank_data_gives_cadence);
+    RUN_TEST(test_balance_reference_is_not_crank_data);
+    RUN_TEST(test_skipped_fields_keep_crank_and_dead_spots_aligned);
+    RUN_TEST(test_dead_spots_need_their_flag_and_the_feature);
+    RUN_TEST(test_truncated_notifications);
+    return UNITY_END();
+}
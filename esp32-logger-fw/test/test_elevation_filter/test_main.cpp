@@ -0,0 +1,218 @@
+#include <unity.h>
+#include <math.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "elevation_filter.h"
+
+// Synthetic ride generator: a route of legs (duration, speed, gradient) is integrated at the
+// BME280 poll rate into true elevation, then sensed as pressure (true elevation plus a
+// drifting baro offset and noise) and as 1 Hz GPS altitude (true elevation plus a slowly
+// wandering error, white noise and injected outliers).
+
+static const ElevationFilterConfig CONFIG = { ELEVATION_ACCEL_NOISE_MPS2, ELEVATION_BARO_NOISE_M,
+    ELEVATION_GPS_NOISE_M, ELEVATION_OFFSET_DRIFT_M, ELEVATION_GPS_GATE_SIGMA, ELEVATION_GRADIENT_TAU_S,
+    ELEVATION_GRADIENT_MIN_SPEED_MPS, ELEVATION_ASCENT_HYSTERESIS_M };
+
+static const uint32_t BARO_PERIOD_MS = 200;
+static const float TRANSITION_S = 20.0f; // Speed and gradient blend between legs over this long
+static const float SETTLE_S = 120.0f;    // Errors are scored after the filter has pinned the offset
+
+struct Leg {
+    float seconds;
+    float speed_mps;
+    float gradient_percent;
+};
+
+// One hour: rolling start, two long climbs and descents, a cafe stop and a sprint finish
+static const Leg ONE_HOUR_RIDE[] = {
+    { 300, 8.0f, 0.0f },    { 900, 4.5f, 6.0f },    { 420, 12.0f, -6.5f }, { 240, 9.0f, 1.0f },
+    { 180, 0.0f, 0.0f },    { 600, 5.0f, 5.0f },    { 120, 3.5f, 9.0f },   { 360, 13.0f, -7.0f },
+    { 300, 7.5f, 2.0f },    { 180, 11.0f, -2.0f },  { 0, 0.0f, 0.0f },
+};
+
+struct Scenario {
+    float baro_offset_m;           // Pressure altitude minus elevation at the start
+    float baro_drift_m_per_h;      // Weather: pressure falling reads as climbing
+    float gps_bias_sigma_m;        // Slowly wandering GPS altitude error
+    float gps_white_m;
+    bool outliers;                 // Multipath spikes and a short burst of bad fixes
+};
+
+struct Scores {
+    uint32_t samples;
+    double elevation_sq, vspeed_sq, gradient_sq;
+    uint32_t gradient_samples;
+    float elevation_max, vspeed_max, gradient_max;
+    float true_ascent;
+    ElevationEstimate last;
+};
+
+static uint32_t s_seed;
+
+static float uniform() {
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return ((s_seed >> 8) + 0.5f) / (float)(1u << 24);
+}
+
+static float gaussian() {
+    return sqrtf(-2.0f * logf(uniform())) * cosf(6.2831853f * uniform());
+}
+
+// Inverse of pressureAltitudeM()
+static float pressureAtAltitude(float altitudeM) {
+    return 101325.0f * powf(1.0f - altitudeM / 44330.0f, 1.0f / 0.190295f);
+}
+
+static bool isOutlierFix(uint32_t second, float* errorM) {
+    if (second == 700 || second == 1900 || second == 3000) {
+        *errorM = 80.0f;
+        return true;
+    }
+    if (second >= 2500 && second < 2505) {
+        *errorM = -60.0f;
+        return true;
+    }
+    return false;
+}
+
+static Scores runRide(const Leg* legs, const Scenario& scenario, ElevationFilter& filter) {
+    Scores scores = {};
+    s_seed = 2024;
+    const float dt = BARO_PERIOD_MS * 0.001f;
+    float elevation = 420.0f, previousAscentElevation = elevation, gpsBias = 0.0f;
+    float speed = legs[0].speed_mps, gradient = legs[0].gradient_percent;
+    uint32_t timeMs = 0;
+
+    for (const Leg* leg = legs; leg->seconds > 0.0f; leg++) {
+        const float fromSpeed = speed, fromGradient = gradient;
+        for (float t = dt; t <= leg->seconds; t += dt) {
+            float blend = fminf(t / TRANSITION_S, 1.0f);
+            speed = fromSpeed + (leg->speed_mps - fromSpeed) * blend;
+            gradient = fromGradient + (leg->gradient_percent - fromGradient) * blend;
+            float vspeed = speed * gradient / 100.0f;
+            elevation += vspeed * dt;
+            if (elevation > previousAscentElevation) {
+                scores.true_ascent += elevation - previousAscentElevation;
+            }
+            previousAscentElevation = elevation;
+            timeMs += BARO_PERIOD_MS;
+
+            float offset = scenario.baro_offset_m + scenario.baro_drift_m_per_h * timeMs / 3600000.0f;
+            float noisyAltitude = elevation + offset + ELEVATION_BARO_NOISE_M * gaussian();
+            filter.addPressure(timeMs, pressureAtAltitude(noisyAltitude));
+
+            if (timeMs % 1000 == 0) {
+                // First-order Gauss-Markov error with a 60 s correlation time
+                gpsBias += (-gpsBias / 60.0f) + scenario.gps_bias_sigma_m * sqrtf(2.0f / 60.0f) * gaussian();
+                float error = gpsBias + scenario.gps_white_m * gaussian();
+                float outlier;
+                if (scenario.outliers && isOutlierFix(timeMs / 1000, &outlier)) {
+                    error = outlier;
+                }
+                filter.addGps(timeMs + 37, elevation + error, speed);
+            }
+
+            if (timeMs < SETTLE_S * 1000.0f) {
+                continue;
+            }
+            ElevationEstimate e;
+            filter.getEstimate(&e);
+            float elevationError = fabsf(e.elevation_m - elevation);
+            float vspeedError = fabsf(e.vertical_speed_mps - vspeed);
+            scores.samples++;
+            scores.elevation_sq += elevationError * elevationError;
+            scores.vspeed_sq += vspeedError * vspeedError;
+            scores.elevation_max = fmaxf(scores.elevation_max, elevationError);
+            scores.vspeed_max = fmaxf(scores.vspeed_max, vspeedError);
+            if (speed >= ELEVATION_GRADIENT_MIN_SPEED_MPS) {
+                float gradientError = fabsf(e.gradient_percent - gradient);
+                scores.gradient_samples++;
+                scores.gradient_sq += gradientError * gradientError;
+                scores.gradient_max = fmaxf(scores.gradient_max, gradientError);
+            }
+        }
+    }
+    filter.getEstimate(&scores.last);
+    return scores;
+}
+
+static float rms(double sumSq, uint32_t count) {
+    return count ? (float)sqrt(sumSq / count) : 0.0f;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_pressure_altitude_inverse(void) {
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, pressureAltitudeM(101325.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 1000.0f, pressureAltitudeM(pressureAtAltitude(1000.0f)));
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 110.9f, pressureAltitudeM(100000.0f));
+}
+
+void test_one_hour_ride(void) {
+    ElevationFilter filter(CONFIG);
+    const Scenario scenario = { 35.0f, 0.0f, 3.0f, 1.5f, false };
+    Scores s = runRide(ONE_HOUR_RIDE, scenario, filter);
+
+    TEST_ASSERT_LESS_THAN_FLOAT(2.0f, rms(s.elevation_sq, s.samples));
+    TEST_ASSERT_LESS_THAN_FLOAT(6.0f, s.elevation_max);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.08f, rms(s.vspeed_sq, s.samples));
+    TEST_ASSERT_LESS_THAN_FLOAT(0.6f, s.vspeed_max);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.8f, rms(s.gradient_sq, s.gradient_samples));
+    TEST_ASSERT_LESS_THAN_FLOAT(6.0f, s.gradient_max); // Worst just above the minimum speed, slowing for the stop
+    TEST_ASSERT_FLOAT_WITHIN(0.03f * s.true_ascent, s.true_ascent, s.last.ascent_m);
+    TEST_ASSERT_FLOAT_WITHIN(3.0f, 35.0f, s.last.baro_offset_m);
+    TEST_ASSERT_EQUAL_UINT32(0, s.last.gps_rejected);
+}
+
+void test_gps_outliers_are_rejected(void) {
+    ElevationFilter filter(CONFIG);
+    const Scenario scenario = { 35.0f, 0.0f, 3.0f, 1.5f, true };
+    Scores s = runRide(ONE_HOUR_RIDE, scenario, filter);
+
+    // Three spikes and a five-fix burst, nothing else
+    TEST_ASSERT_EQUAL_UINT32(8, s.last.gps_rejected);
+    TEST_ASSERT_LESS_THAN_FLOAT(2.0f, rms(s.elevation_sq, s.samples));
+    TEST_ASSERT_LESS_THAN_FLOAT(6.0f, s.elevation_max);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.08f, rms(s.vspeed_sq, s.samples));
+    TEST_ASSERT_LESS_THAN_FLOAT(0.8f, rms(s.gradient_sq, s.gradient_samples));
+    TEST_ASSERT_FLOAT_WITHIN(0.03f * s.true_ascent, s.true_ascent, s.last.ascent_m);
+}
+
+void test_baro_drift_is_tracked_by_the_offset(void) {
+    // A weather front: pressure falls by about 3 hPa over the hour, which alone reads as 25 m of climb
+    ElevationFilter filter(CONFIG);
+    const Scenario scenario = { -60.0f, 25.0f, 3.0f, 1.5f, true };
+    Scores s = runRide(ONE_HOUR_RIDE, scenario, filter);
+
+    TEST_ASSERT_FLOAT_WITHIN(5.0f, -60.0f + 25.0f, s.last.baro_offset_m);
+    TEST_ASSERT_LESS_THAN_FLOAT(3.0f, rms(s.elevation_sq, s.samples));
+    TEST_ASSERT_LESS_THAN_FLOAT(7.0f, s.elevation_max);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.08f, rms(s.vspeed_sq, s.samples));
+    TEST_ASSERT_LESS_THAN_FLOAT(0.8f, rms(s.gradient_sq, s.gradient_samples));
+    TEST_ASSERT_FLOAT_WITHIN(0.03f * s.true_ascent, s.true_ascent, s.last.ascent_m);
+}
+
+void test_stopped_has_no_gradient(void) {
+    // Parked for ten minutes while the pressure drifts: the gradient is undefined and reads 0
+    static const Leg parked[] = { { 600, 0.0f, 0.0f }, { 0, 0.0f, 0.0f } };
+    ElevationFilter filter(CONFIG);
+    const Scenario scenario = { 10.0f, 10.0f, 3.0f, 1.5f, false };
+    Scores s = runRide(parked, scenario, filter);
+
+    TEST_ASSERT_EQUAL_UINT32(0, s.gradient_samples);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, s.last.gradient_percent);
+    TEST_ASSERT_LESS_THAN_FLOAT(5.0f, s.elevation_max);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.3f, s.vspeed_max);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_pressure_altitude_inverse);
+    RUN_TEST(test_one_hour_ride);
+    RUN_TEST(test_gps_outliers_are_rejected);
+    RUN_TEST(test_baro_drift_is_tracked_by_the_offset);
+    RUN_TEST(test_stopped_has_no_gradient);
+    return UNITY_END();
+}
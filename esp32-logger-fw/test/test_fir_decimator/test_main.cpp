@@ -0,0 +1,193 @@
+#include <unity.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "config.h"
+#include "fir_decimator.h"
+
+// Stage parameters as AnalogCaptureTask uses them
+#define TAPS1 ANALOG_FIR_STAGE1_TAPS
+#define TAPS2 ANALOG_FIR_STAGE2_TAPS
+#define DECIM1 ANALOG_DECIM_STAGE1
+#define DECIM2 ANALOG_DECIM_STAGE2
+
+#define INPUT_LEN 4000 // One second at ANALOG_SAMPLE_RATE_HZ
+#define MAX_BLOCK 64
+
+static float s_input[INPUT_LEN];
+static float s_expected[INPUT_LEN];
+static float s_actual[INPUT_LEN];
+
+// Straightforward decimating FIR: y[i] = sum_k h[k] * x[(i + 1) * decim - 1 - k], x[n < 0] = 0
+static int scalarDecimate(const float* taps, int numTaps, int decim, const float* in, int inLen, float* out) {
+    int outLen = inLen / decim;
+    for (int i = 0; i < outLen; i++) {
+        double acc = 0.0;
+        int newest = (i + 1) * decim - 1;
+        for (int k = 0; k < numTaps && newest - k >= 0; k++) {
+            acc += (double)taps[k] * in[newest - k];
+        }
+        out[i] = (float)acc;
+    }
+    return outLen;
+}
+
+static void reverse(const float* taps, float* reversed, int numTaps) {
+    for (int i = 0; i < numTaps; i++) reversed[i] = taps[numTaps - 1 - i];
+}
+
+// Sensor-like signal: offset, in-band tone, out-of-band tone and deterministic noise
+static void makeInput(unsigned seed) {
+    srand(seed);
+    for (int n = 0; n < INPUT_LEN; n++) {
+        float t = (float)n / ANALOG_SAMPLE_RATE_HZ;
+        float noise = (float)rand() / RAND_MAX - 0.5f;
+        s_input[n] = 2048.0f + 300.0f * sinf(2.0f * (float)M_PI * 7.0f * t) + 150.0f * sinf(2.0f * (float)M_PI * 1300.0f * t) +
+                     40.0f * noise;
+    }
+}
+
+static void assertClose(const float* expected, const float* actual, int count) {
+    for (int i = 0; i < count; i++) {
+        TEST_ASSERT_FLOAT_WITHIN(1e-5f * fabsf(expected[i]) + 1e-3f, expected[i], actual[i]);
+    }
+}
+
+void setUp(void) {
+    makeInput(1);
+}
+
+void tearDown(void) {}
+
+void test_design_has_unity_dc_gain_and_symmetric_taps(void) {
+    float taps[TAPS2];
+    firDesignLowpass(taps, TAPS2, 0.4f / DECIM2);
+    double sum = 0.0;
+    for (int i = 0; i < TAPS2; i++) {
+        sum += taps[i];
+        TEST_ASSERT_FLOAT_WITHIN(1e-7f, taps[i], taps[TAPS2 - 1 - i]);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, (float)sum);
+}
+
+void test_design_attenuates_above_output_nyquist(void) {
+    float taps[TAPS1];
+    firDesignLowpass(taps, TAPS1, 0.4f / DECIM1);
+    // Magnitude response at a passband and a stopband frequency (fractions of the input rate)
+    const double freqs[2] = { 0.02, 0.75 / DECIM1 };
+    double gain[2];
+    for (int f = 0; f < 2; f++) {
+        double re = 0.0, im = 0.0;
+        for (int n = 0; n < TAPS1; n++) {
+            re += taps[n] * cos(2.0 * M_PI * freqs[f] * n);
+            im -= taps[n] * sin(2.0 * M_PI * freqs[f] * n);
+        }
+        gain[f] = sqrt(re * re + im * im);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.0f, (float)gain[0]);
+    TEST_ASSERT_LESS_THAN(0.01, gain[1]); // Better than -40 dB
+}
+
+void test_reference_matches_scalar(void) {
+    float taps[TAPS1], delay[TAPS1];
+    firDesignLowpass(taps, TAPS1, 0.4f / DECIM1);
+    int outLen = scalarDecimate(taps, TAPS1, DECIM1, s_input, INPUT_LEN, s_expected);
+
+    FirDecimatorRef ref;
+    firDecimatorRefInit(&ref, taps, delay, TAPS1, DECIM1);
+    // Two calls, so the circular delay line carries state between them
+    int half = outLen / 2 + 3;
+    firDecimatorRefProcess(&ref, s_input, s_actual, half);
+    firDecimatorRefProcess(&ref, s_input + half * DECIM1, s_actual + half, outLen - half);
+    assertClose(s_expected, s_actual, outLen);
+}
+
+// Feed the block decimator blocks of `blockSize` (last one shorter), as the capture task does per DMA frame
+static int runBlocks(FirDecimator* fir, const float* in, int inLen, int blockSize, float* out) {
+    int produced = 0;
+    for (int offset = 0; offset < inLen; offset += blockSize) {
+        int n = inLen - offset < blockSize ? inLen - offset : blockSize;
+        produced += firDecimatorProcess(fir, in + offset, n, out + produced);
+    }
+    return produced;
+}
+
+void test_block_decimator_matches_scalar_for_any_block_size(void) {
+    float taps[TAPS1], tapsReversed[TAPS1];
+    firDesignLowpass(taps, TAPS1, 0.4f / DECIM1);
+    reverse(taps, tapsReversed, TAPS1);
+    int outLen = scalarDecimate(taps, TAPS1, DECIM1, s_input, INPUT_LEN, s_expected);
+
+    // Block sizes that divide the decimation, leave a remainder, or are shorter than one period
+    const int blockSizes[] = { 1, 3, DECIM1, 7, 33, MAX_BLOCK };
+    for (size_t b = 0; b < sizeof(blockSizes) / sizeof(blockSizes[0]); b++) {
+        float history[FIR_DECIMATOR_HISTORY_LEN(TAPS1, DECIM1, MAX_BLOCK)];
+        FirDecimator fir;
+        firDecimatorInit(&fir, tapsReversed, history, sizeof(history) / sizeof(float), TAPS1, DECIM1);
+        int produced = runBlocks(&fir, s_input, INPUT_LEN, blockSizes[b], s_actual);
+        TEST_ASSERT_EQUAL_INT(outLen, produced);
+        assertClose(s_expected, s_actual, outLen);
+    }
+}
+
+void test_two_stage_chain_matches_cascaded_scalar(void) {
+    float taps1[TAPS1], taps2[TAPS2], rev1[TAPS1], rev2[TAPS2];
+    firDesignLowpass(taps1, TAPS1, 0.4f / DECIM1);
+    firDesignLowpass(taps2, TAPS2, 0.4f / DECIM2);
+    reverse(taps1, rev1, TAPS1);
+    reverse(taps2, rev2, TAPS2);
+
+    static float mid[INPUT_LEN];
+    int midLen = scalarDecimate(taps1, TAPS1, DECIM1, s_input, INPUT_LEN, mid);
+    int outLen = scalarDecimate(taps2, TAPS2, DECIM2, mid, midLen, s_expected);
+
+    float history1[FIR_DECIMATOR_HISTORY_LEN(TAPS1, DECIM1, MAX_BLOCK)];
+    float history2[FIR_DECIMATOR_HISTORY_LEN(TAPS2, DECIM2, MAX_BLOCK)];
+    FirDecimator stage1, stage2;
+    firDecimatorInit(&stage1, rev1, history1, sizeof(history1) / sizeof(float), TAPS1, DECIM1);
+    firDecimatorInit(&stage2, rev2, history2, sizeof(history2) / sizeof(float), TAPS2, DECIM2);
+    int produced = 0;
+    for (int offset = 0; offset < INPUT_LEN; offset += MAX_BLOCK) {
+        float midBlock[MAX_BLOCK];
+        int n = INPUT_LEN - offset < MAX_BLOCK ? INPUT_LEN - offset : MAX_BLOCK;
+        int n1 = firDecimatorProcess(&stage1, s_input + offset, n, midBlock);
+        produced += firDecimatorProcess(&stage2, midBlock, n1, s_actual + produced);
+    }
+    TEST_ASSERT_EQUAL_INT(outLen, produced);
+    assertClose(s_expected, s_actual, outLen);
+
+    // Settled output tracks the offset and in-band tone; the 1300 Hz tone is gone
+    for (int i = TAPS2; i < outLen; i++) {
+        TEST_ASSERT_FLOAT_WITHIN(320.0f, 2048.0f, s_actual[i]);
+    }
+}
+
+void test_impulse_response_is_decimated_taps(void) {
+    float taps[TAPS1], tapsReversed[TAPS1];
+    firDesignLowpass(taps, TAPS1, 0.4f / DECIM1);
+    reverse(taps, tapsReversed, TAPS1);
+    float impulse[TAPS1 + DECIM1] = { 0 };
+    impulse[0] = 1.0f;
+
+    float history[FIR_DECIMATOR_HISTORY_LEN(TAPS1, DECIM1, TAPS1 + DECIM1)];
+    FirDecimator fir;
+    firDecimatorInit(&fir, tapsReversed, history, sizeof(history) / sizeof(float), TAPS1, DECIM1);
+    float out[(TAPS1 + DECIM1) / DECIM1];
+    int produced = firDecimatorProcess(&fir, impulse, TAPS1 + DECIM1, out);
+    TEST_ASSERT_EQUAL_INT((TAPS1 + DECIM1) / DECIM1, produced);
+    for (int i = 0; i < produced; i++) {
+        int k = (i + 1) * DECIM1 - 1;
+        TEST_ASSERT_EQUAL_FLOAT(k < TAPS1 ? taps[k] : 0.0f, out[i]);
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_design_has_unity_dc_gain_and_symmetric_taps);
+    RUN_TEST(test_design_attenuates_above_output_nyquist);
+    RUN_TEST(test_reference_matches_scalar);
+    RUN_TEST(test_block_decimator_matches_scalar_for_any_block_size);
+    RUN_TEST(test_two_stage_chain_matches_cascaded_scalar);
+    RUN_TEST(test_impulse_response_is_decimated_taps);
+    return UNITY_END();
+}
@@ -0,0 +1,113 @@
+#include <unity.h>
+#include <string.h>
+
+#include "frame_codec.h"
+
+#define MAX_PAYLOAD 600
+
+static uint8_t s_in[MAX_PAYLOAD];
+static uint8_t s_encoded[FRAME_ENCODED_MAX(MAX_PAYLOAD)];
+static uint8_t s_decoded[MAX_PAYLOAD + FRAME_HEADER_SIZE + FRAME_CRC_SIZE];
+static uint8_t s_scratch[FRAME_HEADER_SIZE + MAX_PAYLOAD + FRAME_CRC_SIZE];
+
+// Same frames as tools/tests/test_telemetry_rx.py, so both ends agree on the wire format:
+// a power message (type 1, seq 0x1234) and a payload of zeros (type 3, seq 7)
+static const uint8_t GOLDEN_POWER_PAYLOAD[] = { 0xE8, 0x03, 0x00, 0x00, 0xFA, 0x00, 0x5A, 0xFF };
+static const uint8_t GOLDEN_POWER_FRAME[] = { 0x02, 0x01, 0x04, 0x34, 0x12, 0x08, 0x03, 0xE8, 0x03, 0x01,
+                                              0x02, 0xFA, 0x07, 0x5A, 0xFF, 0xED, 0x20, 0x86, 0x5B, 0x00 };
+static const uint8_t GOLDEN_ZEROS_PAYLOAD[] = { 0x00, 0x00, 0x01, 0x00 };
+static const uint8_t GOLDEN_ZEROS_FRAME[] = { 0x02, 0x03, 0x02, 0x07, 0x02, 0x04, 0x01, 0x01,
+                                              0x02, 0x01, 0x05, 0x3B, 0xA9, 0xF2, 0x80, 0x00 };
+
+static void fill(size_t len, int zeroEvery) {
+    for (size_t i = 0; i < len; i++) {
+        s_in[i] = (zeroEvery > 0 && i % zeroEvery == 0) ? 0 : (uint8_t)(1 + i % 251);
+    }
+}
+
+static void assertRoundTrip(size_t len) {
+    size_t encoded = cobsEncode(s_in, len, s_encoded);
+    TEST_ASSERT_LESS_OR_EQUAL(len + len / 254 + 1, encoded);
+    for (size_t i = 0; i < encoded; i++) {
+        TEST_ASSERT_TRUE(s_encoded[i] != 0); // The delimiter never appears inside a frame
+    }
+    TEST_ASSERT_EQUAL_UINT(len, cobsDecode(s_encoded, encoded, s_decoded));
+    TEST_ASSERT_EQUAL_MEMORY(s_in, s_decoded, len);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_crc32_check_value(void) {
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, crc32Update(0, "123456789", 9));
+    // Incremental updates give the same result
+    uint32_t crc = crc32Update(0, "1234", 4);
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, crc32Update(crc, "56789", 5));
+    TEST_ASSERT_EQUAL_HEX32(0, crc32Update(0, "", 0));
+}
+
+void test_cobs_round_trip_edge_lengths(void) {
+    // Around the 254-byte block limit, with and without zeros
+    const size_t lengths[] = { 1, 2, 253, 254, 255, 256, 508, 509, MAX_PAYLOAD };
+    const int zeroEvery[] = { 0, 1, 7, 254 };
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        for (size_t z = 0; z < sizeof(zeroEvery) / sizeof(zeroEvery[0]); z++) {
+            fill(lengths[l], zeroEvery[z]);
+            assertRoundTrip(lengths[l]);
+        }
+    }
+}
+
+void test_cobs_rejects_malformed_input(void) {
+    const uint8_t zeroCode[] = { 0x02, 0x11, 0x00, 0x22 };
+    const uint8_t overrun[] = { 0x05, 0x11, 0x22 };
+    TEST_ASSERT_EQUAL_UINT(0, cobsDecode(zeroCode, sizeof(zeroCode), s_decoded));
+    TEST_ASSERT_EQUAL_UINT(0, cobsDecode(overrun, sizeof(overrun), s_decoded));
+}
+
+void test_frame_matches_golden_bytes(void) {
+    size_t n = frameEncode(1, 0x1234, GOLDEN_POWER_PAYLOAD, sizeof(GOLDEN_POWER_PAYLOAD), s_scratch, s_encoded);
+    TEST_ASSERT_EQUAL_UINT(sizeof(GOLDEN_POWER_FRAME), n);
+    TEST_ASSERT_EQUAL_MEMORY(GOLDEN_POWER_FRAME, s_encoded, n);
+
+    n = frameEncode(3, 7, GOLDEN_ZEROS_PAYLOAD, sizeof(GOLDEN_ZEROS_PAYLOAD), s_scratch, s_encoded);
+    TEST_ASSERT_EQUAL_UINT(sizeof(GOLDEN_ZEROS_FRAME), n);
+    TEST_ASSERT_EQUAL_MEMORY(GOLDEN_ZEROS_FRAME, s_encoded, n);
+}
+
+void test_frame_decodes_to_header_payload_and_crc(void) {
+    fill(300, 5);
+    size_t n = frameEncode(5, 0xFFFF, s_in, 300, s_scratch, s_encoded);
+    TEST_ASSERT_LESS_OR_EQUAL(FRAME_ENCODED_MAX(300), n);
+    TEST_ASSERT_EQUAL_HEX8(0x00, s_encoded[n - 1]); // Single trailing delimiter
+
+    size_t decoded = cobsDecode(s_encoded, n - 1, s_decoded);
+    TEST_ASSERT_EQUAL_UINT(FRAME_HEADER_SIZE + 300 + FRAME_CRC_SIZE, decoded);
+    FrameHeader header;
+    memcpy(&header, s_decoded, sizeof(header));
+    TEST_ASSERT_EQUAL_UINT8(5, header.type);
+    TEST_ASSERT_EQUAL_UINT8(0, header.flags);
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, header.seq);
+    TEST_ASSERT_EQUAL_UINT16(300, header.length);
+    TEST_ASSERT_EQUAL_MEMORY(s_in, s_decoded + FRAME_HEADER_SIZE, 300);
+    uint32_t crc;
+    memcpy(&crc, s_decoded + FRAME_HEADER_SIZE + 300, sizeof(crc));
+    TEST_ASSERT_EQUAL_HEX32(crc32Update(0, s_decoded, FRAME_HEADER_SIZE + 300), crc);
+}
+
+void test_empty_payload_frame(void) {
+    size_t n = frameEncode(9, 1, NULL, 0, s_scratch, s_encoded);
+    TEST_ASSERT_LESS_OR_EQUAL(FRAME_ENCODED_MAX(0), n);
+    TEST_ASSERT_EQUAL_UINT(FRAME_HEADER_SIZE + FRAME_CRC_SIZE, cobsDecode(s_encoded, n - 1, s_decoded));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_crc32_check_value);
+    RUN_TEST(test_cobs_round_trip_edge_lengths);
+    RUN_TEST(test_cobs_rejects_malformed_input);
+    RUN_TEST(test_frame_matches_golden_bytes);
+    RUN_TEST(test_frame_decodes_to_header_payload_and_crc);
+    RUN_TEST(test_empty_payload_frame);
+    return UNITY_END();
+}
@@ -0,0 +1,287 @@
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+#include "attitude_filter.h"
+#include "config.h"
+#include "cycling_power.h"
+#include "elevation_filter.h"
+#include "fir_decimator.h"
+#include "frame_codec.h"
+#include "imu_fifo_parser.h"
+#include "mean_max_power.h"
+#include "nmea_parser.h"
+#include "power_analytics.h"
+#include "segment_gates.h"
+
+// Host counterpart of `heap_audit soak` (heap_audit.h) for the portable per-sample paths: the
+// same module instances and configuration the tasks use are set up (allocations allowed), then
+// driven at the device's rates for simulated minutes, each of which must allocate nothing.
+// The device soak still covers the platform code (NimBLE, SdFat, FreeRTOS, printing).
+
+static volatile uint32_t s_allocations = 0;
+
+// Count every allocation: at malloc on glibc (catches C code and operator new alike), otherwise
+// at operator new
+#if defined(__GLIBC__)
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+
+void* malloc(size_t size) {
+    s_allocations = s_allocations + 1;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+    s_allocations = s_allocations + 1;
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    s_allocations = s_allocations + 1;
+    return __libc_realloc(ptr, size);
+}
+}
+#else
+void* operator new(size_t size) {
+    s_allocations = s_allocations + 1;
+    void* p = malloc(size);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+#endif
+
+#define SOAK_MINUTES 10
+#define IMU_BATCH_SAMPLES (IMU_FIFO_WATERMARK_WORDS / 2)
+#define ANALOG_BLOCK 200  // Conversions per channel per ADC frame (50 ms)
+#define ROUTE_SECONDS 60
+
+// --- Per-sample paths, as wired in the tasks ---
+
+static ImuFifoParser s_imuParser({ ACCEL_MPS2_PER_LSB, GYRO_RADPS_PER_LSB, IMU_SAMPLE_PERIOD_US });
+static AttitudeFilter s_attitude(AHRS_BETA);
+static uint8_t s_fifo[IMU_FIFO_WATERMARK_WORDS * IMU_FIFO_WORD_SIZE];
+static ImuSample s_imuSamples[IMU_BATCH_SAMPLES];
+
+static float s_taps1[ANALOG_FIR_STAGE1_TAPS], s_taps2[ANALOG_FIR_STAGE2_TAPS];
+static float s_history1[FIR_DECIMATOR_HISTORY_LEN(ANALOG_FIR_STAGE1_TAPS, ANALOG_DECIM_STAGE1, ANALOG_BLOCK)];
+static float s_history2[FIR_DECIMATOR_HISTORY_LEN(ANALOG_FIR_STAGE2_TAPS, ANALOG_DECIM_STAGE2, ANALOG_BLOCK)];
+static FirDecimator s_stage1, s_stage2;
+
+static CyclingPowerDecoder s_cpDecoder;
+static PowerAnalytics s_power(POWER_FTP_WATTS, POWER_DROPOUT_MS);
+static MeanMaxPower s_meanMax;
+static uint16_t s_meanMaxRing[1200];
+
+static NmeaParser s_nmea;
+static ElevationFilter s_elevation({ ELEVATION_ACCEL_NOISE_MPS2, ELEVATION_BARO_NOISE_M, ELEVATION_GPS_NOISE_M,
+                                     ELEVATION_OFFSET_DRIFT_M, ELEVATION_GPS_GATE_SIGMA, ELEVATION_GRADIENT_TAU_S,
+                                     ELEVATION_GRADIENT_MIN_SPEED_MPS, ELEVATION_ASCENT_HYSTERESIS_M });
+static GateIndex s_gates(GATE_CELL_SIZE_M, GATE_HASH_BUCKETS, malloc, free);
+static SegmentTimer s_segmentTimer(GATE_MIN_LAP_MS);
+
+static uint8_t s_frameScratch[FRAME_HEADER_SIZE + 256 + FRAME_CRC_SIZE];
+static uint8_t s_frame[FRAME_ENCODED_MAX(256)];
+static uint16_t s_frameSeq;
+
+// One minute of GPS output (RMC + GGA per second) along a straight road through a lap gate,
+// formatted once up front
+static char s_route[ROUTE_SECONDS][2][NMEA_MAX_SENTENCE];
+
+static void withChecksum(char* out, const char* body) {
+    uint8_t sum = 0;
+    for (const char* p = body; *p; p++) sum ^= (uint8_t)*p;
+    snprintf(out, NMEA_MAX_SENTENCE, "$%s*%02X\r\n", body, sum);
+}
+
+static void nmeaCoordinate(char* out, size_t size, double deg, bool latitude) {
+    char hemisphere = latitude ? (deg >= 0 ? 'N' : 'S') : (deg >= 0 ? 'E' : 'W');
+    deg = fabs(deg);
+    int whole = (int)deg;
+    snprintf(out, size, latitude ? "%02d%07.4f,%c" : "%03d%07.4f,%c", whole, (deg - whole) * 60.0, hemisphere);
+}
+
+static void buildRoute() {
+    for (int s = 0; s < ROUTE_SECONDS; s++) {
+        double lat = 47.0 + s * 10.0 / 111195.0; // 10 m/s north
+        char latText[20], lonText[20], body[NMEA_MAX_SENTENCE];
+        nmeaCoordinate(latText, sizeof(latText), lat, true);
+        nmeaCoordinate(lonText, sizeof(lonText), 8.0, false);
+        int hh = 10, mm = s / 60, ss = s % 60;
+        snprintf(body, sizeof(body), "GPRMC,%02d%02d%02d.000,A,%s,%s,19.44,0.0,191026,,,A", hh, mm, ss, latText,
+                 lonText);
+        withChecksum(s_route[s][0], body);
+        snprintf(body, sizeof(body), "GPGGA,%02d%02d%02d.000,%s,%s,1,09,0.9,%.1f,M,47.0,M,,", hh, mm, ss, latText,
+                 lonText, 420.0 + s * 0.3);
+        withChecksum(s_route[s][1], body);
+    }
+}
+
+static void setUpPipelines() {
+    s_imuParser.reset();
+    s_attitude.reset();
+
+    firDesignLowpass(s_taps1, ANALOG_FIR_STAGE1_TAPS, 0.4f / ANALOG_DECIM_STAGE1);
+    firDesignLowpass(s_taps2, ANALOG_FIR_STAGE2_TAPS, 0.4f / ANALOG_DECIM_STAGE2); // Symmetric: already reversed
+    firDecimatorInit(&s_stage1, s_taps1, s_history1, sizeof(s_history1) / sizeof(float), ANALOG_FIR_STAGE1_TAPS,
+                     ANALOG_DECIM_STAGE1);
+    firDecimatorInit(&s_stage2, s_taps2, s_history2, sizeof(s_history2) / sizeof(float), ANALOG_FIR_STAGE2_TAPS,
+                     ANALOG_DECIM_STAGE2);
+
+    s_cpDecoder.reset();
+    s_power.reset();
+    static const uint16_t durations[] = MMP_DURATIONS_S;
+    TEST_ASSERT_TRUE(s_meanMax.begin(durations, sizeof(durations) / sizeof(durations[0]), s_meanMaxRing, 1200));
+    s_power.setSecondSink(meanMaxPowerSecondSink, &s_meanMax);
+
+    s_nmea.reset();
+    s_elevation.reset();
+    GateDef gate = { 1, GATE_LAP, 47.0 + 300.0 / 111195.0, 7.999, 47.0 + 300.0 / 111195.0, 8.001 };
+    TEST_ASSERT_TRUE(s_gates.build(&gate, 1));
+    s_segmentTimer.reset();
+    buildRoute();
+}
+
+// Simulated device clock and GPS track state
+static uint32_t s_nowMs;
+static float s_prevX, s_prevY;
+static bool s_havePrev;
+static uint32_t s_crossings;
+
+static void runImu(uint32_t second) {
+    for (int batch = 0; batch < IMU_ODR_HZ / IMU_BATCH_SAMPLES; batch++) {
+        for (int i = 0; i < IMU_BATCH_SAMPLES; i++) {
+            uint8_t counter = (uint8_t)(i & 3);
+            uint8_t* gyro = s_fifo + (2 * i) * IMU_FIFO_WORD_SIZE;
+            uint8_t* accel = gyro + IMU_FIFO_WORD_SIZE;
+            memset(gyro, 0, 2 * IMU_FIFO_WORD_SIZE);
+            gyro[0] = (uint8_t)((IMU_FIFO_TAG_GYRO << 3) | (counter << 1));
+            gyro[1] = (uint8_t)(second + i);
+            accel[0] = (uint8_t)((IMU_FIFO_TAG_ACCEL << 3) | (counter << 1));
+            accel[5] = 0x10; // ~1 g on Z
+            accel[6] = 0x10;
+        }
+        size_t count = s_imuParser.parse(s_fifo, IMU_FIFO_WATERMARK_WORDS, (int64_t)s_nowMs * 1000, 0, s_imuSamples,
+                                         IMU_BATCH_SAMPLES);
+        for (size_t i = 0; i < count; i++) {
+            s_attitude.update(s_imuSamples[i].gyro_radps, s_imuSamples[i].accel_mps2, IMU_SAMPLE_PERIOD_US * 1e-6f);
+        }
+    }
+}
+
+static void runAnalog() {
+    float in[ANALOG_BLOCK], mid[ANALOG_BLOCK], out[ANALOG_BLOCK];
+    for (int frame = 0; frame < ANALOG_SAMPLE_RATE_HZ / ANALOG_BLOCK; frame++) {
+        for (int i = 0; i < ANALOG_BLOCK; i++) in[i] = 1.65f + 0.1f * sinf(0.01f * (frame * ANALOG_BLOCK + i));
+        int n1 = firDecimatorProcess(&s_stage1, in, ANALOG_BLOCK, mid);
+        firDecimatorProcess(&s_stage2, mid, n1, out);
+    }
+}
+
+static void runPower(uint32_t second) {
+    for (int n = 0; n < 4; n++) {
+        uint16_t watts = (uint16_t)(200 + (second * 7 + n * 13) % 150);
+        const uint8_t notification[] = { 0x00, 0x00, (uint8_t)watts, (uint8_t)(watts >> 8) };
+        CyclingPowerMeasurement m;
+        s_cpDecoder.decode(notification, sizeof(notification), &m);
+        s_power.addSample(s_nowMs + n * 250, m.power_watts);
+        uint8_t payload[8];
+        memcpy(payload, &s_nowMs, 4);
+        memcpy(payload + 4, &m.power_watts, 2);
+        payload[6] = m.cadence_rpm;
+        payload[7] = 0xFF;
+        frameEncode(1, s_frameSeq++, payload, sizeof(payload), s_frameScratch, s_frame);
+    }
+}
+
+static void runGps(uint32_t second) {
+    for (int i = 0; i < 5; i++) {
+        s_elevation.addPressure(s_nowMs + i * 200, 95000.0f - (second % 60) * 0.04f);
+    }
+    for (int k = 0; k < 2; k++) {
+        for (const char* c = s_route[second % ROUTE_SECONDS][k]; *c; c++) {
+            if (s_nmea.feed(*c) != NMEA_GGA) continue;
+            const NmeaFix& fix = s_nmea.fix();
+            s_elevation.addGps(s_nowMs, fix.altitude_m, fix.speed_knots * NMEA_KNOTS_TO_MPS);
+            float x, y;
+            s_gates.project(fix.latitude_deg, fix.longitude_deg, &x, &y);
+            if (s_havePrev) {
+                GateCrossing crossings[4];
+                size_t found = s_gates.findCrossings(s_prevX, s_prevY, s_nowMs - 1000, x, y, s_nowMs, crossings, 4);
+                for (size_t j = 0; j < found; j++) {
+                    SegmentResult result;
+                    s_segmentTimer.onCrossing(crossings[j], &result);
+                    s_crossings++;
+                }
+            }
+            s_prevX = x;
+            s_prevY = y;
+            s_havePrev = true;
+        }
+    }
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_counter_sees_allocations(void) {
+    uint32_t before = s_allocations;
+    void* volatile p = malloc(16);
+    free(p);
+    int* volatile q = new int[4];
+    delete[] q;
+    TEST_ASSERT_GREATER_OR_EQUAL(before + 2, s_allocations);
+}
+
+void test_steady_state_allocates_nothing_per_minute(void) {
+    setUpPipelines(); // Set-up may allocate (the gate index does), like the tasks before the marker
+    s_nowMs = 1000;
+    uint32_t second = 0;
+    for (int minute = 1; minute <= SOAK_MINUTES; minute++) {
+        uint32_t start = s_allocations;
+        for (int s = 0; s < 60; s++, second++, s_nowMs += 1000) {
+            runImu(second);
+            runAnalog();
+            runPower(second);
+            runGps(second);
+        }
+        uint32_t count = s_allocations - start;
+        char message[40];
+        snprintf(message, sizeof(message), "minute %d: %lu allocs", minute, (unsigned long)count);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, count, message);
+    }
+
+    // The paths really ran
+    TEST_ASSERT_TRUE(s_attitude.initialized());
+    TEST_ASSERT_EQUAL_UINT32(0, s_imuParser.unpairedWords());
+    TEST_ASSERT_EQUAL_UINT32(SOAK_MINUTES * 60 - 1, s_meanMax.elapsedSeconds()); // The last second is still open
+    TEST_ASSERT_EQUAL_UINT32(SOAK_MINUTES * 60 * 2, s_nmea.sentences());
+    TEST_ASSERT_EQUAL_UINT32(SOAK_MINUTES * 2 - 1, s_crossings); // Through the gate, and back on each jump to the start
+    ElevationEstimate elevation;
+    s_elevation.getEstimate(&elevation);
+    TEST_ASSERT_EQUAL_UINT32(SOAK_MINUTES * 60, elevation.gps_updates);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_counter_sees_allocations);
+    RUN_TEST(test_steady_state_allocates_nothing_per_minute);
+    return UNITY_END();
+}
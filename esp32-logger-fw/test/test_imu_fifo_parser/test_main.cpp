@@ -0,0 +1,223 @@
+#include <unity.h>
+#include <string.h>
+
+#include "imu_fifo_parser.h"
+
+// 416 Hz ODR; unit scales keep the decoded values equal to the raw counts
+static const uint32_t PERIOD_US = 2403;
+static const ImuFifoParserConfig CONFIG = { 1.0f, 1.0f, PERIOD_US };
+
+#define MAX_WORDS 64
+
+static uint8_t s_words[MAX_WORDS * IMU_FIFO_WORD_SIZE];
+static size_t s_wordCount;
+static ImuSample s_out[MAX_WORDS];
+
+// Tag byte: sensor in [7:3], batch counter in [2:1] (parity bit left clear)
+static void pushWord(uint8_t tag, uint8_t counter, int16_t x, int16_t y, int16_t z) {
+    uint8_t* word = &s_words[s_wordCount * IMU_FIFO_WORD_SIZE];
+    word[0] = (uint8_t)((tag << 3) | ((counter & 0x03) << 1));
+    int16_t axes[3] = { x, y, z };
+    for (int i = 0; i < 3; i++) {
+        word[1 + 2 * i] = (uint8_t)(axes[i] & 0xFF);
+        word[2 + 2 * i] = (uint8_t)((uint16_t)axes[i] >> 8);
+    }
+    s_wordCount++;
+}
+
+// Sample n: accel (n, -n, 1000 + n), gyro (2n, -2n, 2000 + n), batch counter n mod 4
+static void pushSample(int n, bool gyroFirst = false) {
+    uint8_t counter = (uint8_t)(n & 0x03);
+    if (gyroFirst) {
+        pushWord(IMU_FIFO_TAG_GYRO, counter, (int16_t)(2 * n), (int16_t)(-2 * n), (int16_t)(2000 + n));
+    }
+    pushWord(IMU_FIFO_TAG_ACCEL, counter, (int16_t)n, (int16_t)-n, (int16_t)(1000 + n));
+    if (!gyroFirst) {
+        pushWord(IMU_FIFO_TAG_GYRO, counter, (int16_t)(2 * n), (int16_t)(-2 * n), (int16_t)(2000 + n));
+    }
+}
+
+static void assertSample(const ImuSample& s, int n) {
+    TEST_ASSERT_EQUAL_FLOAT((float)n, s.accel_mps2[0]);
+    TEST_ASSERT_EQUAL_FLOAT((float)-n, s.accel_mps2[1]);
+    TEST_ASSERT_EQUAL_FLOAT((float)(1000 + n), s.accel_mps2[2]);
+    TEST_ASSERT_EQUAL_FLOAT((float)(2 * n), s.gyro_radps[0]);
+    TEST_ASSERT_EQUAL_FLOAT((float)(-2 * n), s.gyro_radps[1]);
+    TEST_ASSERT_EQUAL_FLOAT((float)(2000 + n), s.gyro_radps[2]);
+}
+
+void setUp(void) {
+    s_wordCount = 0;
+    memset(s_out, 0, sizeof(s_out));
+}
+
+void tearDown(void) {}
+
+void test_pairs_accel_and_gyro_in_either_order(void) {
+    pushSample(0);
+    pushSample(1, true);
+    pushSample(2);
+    ImuFifoParser parser(CONFIG);
+    size_t produced = parser.parse(s_words, s_wordCount, 1000000, 0, s_out, MAX_WORDS);
+
+    TEST_ASSERT_EQUAL_UINT(3, produced);
+    for (int n = 0; n < 3; n++) {
+        assertSample(s_out[n], n);
+        TEST_ASSERT_EQUAL_INT64(1000000 + (int64_t)n * PERIOD_US, s_out[n].timestamp_us);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, parser.unpairedWords());
+    TEST_ASSERT_EQUAL_UINT32(0, parser.unknownWords());
+}
+
+void test_anchor_index_places_later_sample_at_anchor(void) {
+    for (int n = 0; n < 4; n++) pushSample(n);
+    ImuFifoParser parser(CONFIG);
+    size_t produced = parser.parse(s_words, s_wordCount, 5000000, 3, s_out, MAX_WORDS);
+
+    TEST_ASSERT_EQUAL_UINT(4, produced);
+    TEST_ASSERT_EQUAL_INT64(5000000 - 3 * (int64_t)PERIOD_US, s_out[0].timestamp_us);
+    TEST_ASSERT_EQUAL_INT64(5000000, s_out[3].timestamp_us);
+}
+
+void test_orphaned_first_word_is_dropped(void) {
+    // Gyro half of a sample whose accel word was lost (e.g. read before an overrun)
+    pushWord(IMU_FIFO_TAG_GYRO, 3, 111, 222, 333);
+    pushSample(0);
+    pushSample(1);
+    ImuFifoParser parser(CONFIG);
+    size_t produced = parser.parse(s_words, s_wordCount, 0, 0, s_out, MAX_WORDS);
+
+    TEST_ASSERT_EQUAL_UINT(2, produced);
+    assertSample(s_out[0], 0);
+    assertSample(s_out[1], 1);
+    TEST_ASSERT_EQUAL_UINT32(1, parser.unpairedWords());
+}
+
+void test_orphan_with_same_sensor_as_next_word_is_dropped(void) {
+    pushWord(IMU_FIFO_TAG_ACCEL, 2, 111, 222, 333);
+    pushSample(3);
+    ImuFifoParser parser(CONFIG);
+    size_t produced = parser.parse(s_words, s_wordCount, 0, 0, s_out, MAX_WORDS);
+
+    TEST_ASSERT_EQUAL_UINT(1, produced);
+    assertSample(s_out[0], 3);
+    TEST_ASSERT_EQUAL_UINT32(1, parser.unpairedWords());
+}
+
+void test_tag_counter_wrap_keeps_pairing(void) {
+    // Counter runs 0..3 and wraps to 0 three times
+    for (int n = 0; n < 14; n++) pushSample(n, n % 3 == 0);
+    ImuFifoParser parser(CONFIG);
+    size_t produced = parser.parse(s_words, s_wordCount, 0, 0, s_out, MAX_WORDS);
+
+    TEST_ASSERT_EQUAL_UINT(14, produced);
+    for (int n = 0; n < 14; n++) assertSample(s_out[n], n);
+    TEST_ASSERT_EQUAL_UINT32(0, parser.unpairedWords());
+}
+
+void test_lost_sample_across_counter_wrap(void) {
+    pushSample(2);
+    pushWord(IMU_FIFO_TAG_ACCEL, 3, 3, -3, 1003); // Gyro word of sample 3 lost
+    pushSample(4);                                 // Counter wrapped to 0
+    ImuFifoParser parser(CONFIG);
+    size_t produced = parser.parse(s_words, s_wordCount, 0, 0, s_out, MAX_WORDS);
+
+    TEST_ASSERT_EQUAL_UINT(2, produced);
+    assertSample(s_out[0], 2);
+    assertSample(s_out[1], 4);
+    TEST_ASSERT_EQUAL_UINT32(1, parser.unpairedWords());
+}
+
+void test_unknown_tags_are_skipped(void) {
+    pushWord(IMU_FIFO_TAG_ACCEL, 0, 0, 0, 1000);
+    pushWord(0x03, 0, 25, 0, 0); // Temperature between the halves
+    pushWord(IMU_FIFO_TAG_GYRO, 0, 0, 0, 2000);
+    ImuFifoParser parser(CONFIG);
+    size_t produced = parser.parse(s_words, s_wordCount, 0, 0, s_out, MAX_WORDS);
+
+    TEST_ASSERT_EQUAL_UINT(1, produced);
+    assertSample(s_out[0], 0);
+    TEST_ASSERT_EQUAL_UINT32(1, parser.unknownWords());
+    TEST_ASSERT_EQUAL_UINT32(0, parser.unpairedWords());
+}
+
+// ImuTask splits a drain into bursts of whole words; a burst can end between the two halves
+// of a sample, which then completes in the next call at the following chunk start time
+void test_burst_split_between_halves(void) {
+    for (int n = 0; n < 20; n++) pushSample(n);
+    const size_t firstBurstWords = 17; // Ends on the accel half of sample 8
+    const int64_t firstSampleUs = 10000000;
+    ImuFifoParser parser(CONFIG);
+
+    size_t first = parser.parse(s_words, firstBurstWords, firstSampleUs, 0, s_out, MAX_WORDS);
+    TEST_ASSERT_EQUAL_UINT(8, first);
+    int64_t chunkStartUs = firstSampleUs + (int64_t)first * PERIOD_US;
+    size_t second = parser.parse(s_words + firstBurstWords * IMU_FIFO_WORD_SIZE, s_wordCount - firstBurstWords,
+                                 chunkStartUs, 0, s_out + first, MAX_WORDS - first);
+    TEST_ASSERT_EQUAL_UINT(12, second);
+
+    for (int n = 0; n < 20; n++) {
+        assertSample(s_out[n], n);
+        TEST_ASSERT_EQUAL_INT64(firstSampleUs + (int64_t)n * PERIOD_US, s_out[n].timestamp_us);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, parser.unpairedWords());
+}
+
+void test_reset_forgets_half_pair(void) {
+    pushWord(IMU_FIFO_TAG_ACCEL, 1, 9, 9, 9);
+    ImuFifoParser parser(CONFIG);
+    TEST_ASSERT_EQUAL_UINT(0, parser.parse(s_words, s_wordCount, 0, 0, s_out, MAX_WORDS));
+    parser.reset();
+
+    s_wordCount = 0;
+    pushWord(IMU_FIFO_TAG_GYRO, 1, 2, -2, 2001); // Same counter, but after an overrun
+    pushSample(2);
+    size_t produced = parser.parse(s_words, s_wordCount, 0, 0, s_out, MAX_WORDS);
+    TEST_ASSERT_EQUAL_UINT(1, produced);
+    assertSample(s_out[0], 2);
+}
+
+void test_output_limit(void) {
+    for (int n = 0; n < 6; n++) pushSample(n);
+    ImuFifoParser parser(CONFIG);
+    TEST_ASSERT_EQUAL_UINT(4, parser.parse(s_words, s_wordCount, 0, 0, s_out, 4));
+}
+
+// The watermark interrupt fires when word WM arrives, completing sample WM/2 - 1
+void test_watermark_timestamp_back_computation(void) {
+    const uint16_t watermarkWords = 32;
+    const int64_t irqUs = 123456789;
+    int64_t firstUs = imuFifoWatermarkFirstSampleUs(irqUs, watermarkWords, PERIOD_US);
+    TEST_ASSERT_EQUAL_INT64(irqUs - 15 * (int64_t)PERIOD_US, firstUs);
+
+    // Parsing the watermark's worth of words from that start puts the last sample at the IRQ
+    for (int n = 0; n < watermarkWords / 2; n++) pushSample(n);
+    ImuFifoParser parser(CONFIG);
+    size_t produced = parser.parse(s_words, s_wordCount, firstUs, 0, s_out, MAX_WORDS);
+    TEST_ASSERT_EQUAL_UINT(watermarkWords / 2, produced);
+    TEST_ASSERT_EQUAL_INT64(irqUs, s_out[produced - 1].timestamp_us);
+
+    // Same as anchoring the watermark sample at the IRQ time
+    ImuSample anchored[MAX_WORDS];
+    ImuFifoParser anchoredParser(CONFIG);
+    anchoredParser.parse(s_words, s_wordCount, irqUs, watermarkWords / 2 - 1, anchored, MAX_WORDS);
+    TEST_ASSERT_EQUAL_INT64(firstUs, anchored[0].timestamp_us);
+
+    TEST_ASSERT_EQUAL_INT64(irqUs, imuFifoWatermarkFirstSampleUs(irqUs, 2, PERIOD_US));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_pairs_accel_and_gyro_in_either_order);
+    RUN_TEST(test_anchor_index_places_later_sample_at_anchor);
+    RUN_TEST(test_orphaned_first_word_is_dropped);
+    RUN_TEST(test_orphan_with_same_sensor_as_next_word_is_dropped);
+    RUN_TEST(test_tag_counter_wrap_keeps_pairing);
+    RUN_TEST(test_lost_sample_across_counter_wrap);
+    RUN_TEST(test_unknown_tags_are_skipped);
+    RUN_TEST(test_burst_split_between_halves);
+    RUN_TEST(test_reset_forgets_half_pair);
+    RUN_TEST(test_output_limit);
+    RUN_TEST(test_watermark_timestamp_back_computation);
+    return UNITY_END();
+}
@@ -0,0 +1,241 @@
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+
+#include "config.h"
+#include "record_assembler.h"
+
+// The record path against a simulated SD writer: 200 Hz records with power changing at 4 Hz and
+// GPS at 1 Hz, a PSRAM ring of PSRAM_BUFFER_SIZE_RECORDS drained in writer-sized batches, and
+// card stalls during which nothing is drained.
+
+static const LogBackpressureConfig CONFIG = { LOG_BP_DECIMATE_PERCENT, LOG_BP_MINIMAL_PERCENT, LOG_BP_RECOVER_PERCENT,
+                                              LOG_BP_DECIMATED_EVERY, LOG_BP_MINIMAL_EVERY };
+
+#define TICK_MS 5
+#define DRAIN_PER_TICK 2    // 400 records/s when the card is writing
+#define MAX_TRANSITIONS 32
+
+struct SimRing {
+    size_t count;
+    uint32_t written;      // Records that reached the ring
+    uint32_t lastTimestamp;
+    bool ordered;
+};
+
+struct TransitionLog {
+    LogRateLevel levels[MAX_TRANSITIONS];
+    LogBackpressureTransition last;
+    size_t count;
+};
+
+static SimRing s_ring;
+static TransitionLog s_transitions;
+static LogRecordV1 s_staging[LOG_STAGING_RECORDS];
+
+static size_t ringWrite(void* context, const LogRecordV1* records, size_t count) {
+    SimRing* ring = (SimRing*)context;
+    size_t room = PSRAM_BUFFER_SIZE_RECORDS - ring->count;
+    size_t moved = count < room ? count : room;
+    for (size_t i = 0; i < moved; i++) {
+        ring->ordered = ring->ordered && records[i].system_timestamp_ms > ring->lastTimestamp;
+        ring->lastTimestamp = records[i].system_timestamp_ms;
+    }
+    ring->count += moved;
+    ring->written += moved;
+    return moved;
+}
+
+static size_t ringCount(void* context) {
+    return ((SimRing*)context)->count;
+}
+
+static void onTransition(void* context, const LogBackpressureTransition& transition, size_t stagingCount) {
+    TransitionLog* log = (TransitionLog*)context;
+    if (log->count < MAX_TRANSITIONS) log->levels[log->count++] = transition.to;
+    log->last = transition;
+}
+
+static void begin(RecordAssembler& assembler) {
+    memset(&s_ring, 0, sizeof(s_ring));
+    s_ring.ordered = true;
+    memset(&s_transitions, 0, sizeof(s_transitions));
+    RecordRing ring = { ringWrite, ringCount, PSRAM_BUFFER_SIZE_RECORDS, &s_ring };
+    TEST_ASSERT_TRUE(assembler.begin(CONFIG, ring, onTransition, &s_transitions));
+}
+
+static RecordInputs inputsAt(uint32_t nowMs) {
+    RecordInputs in = {};
+    in.gps_fix = true;
+    in.latitude_deg = 47.0 + (nowMs / 1000) * 1e-5;
+    in.longitude_deg = 8.0;
+    in.speed_mps = 8.0f;
+    in.power_watts = (uint16_t)(200 + (nowMs / 250) % 50);
+    in.cadence_rpm = 90;
+    for (int i = 0; i < 8; i++) in.analog[i] = NAN;
+    return in;
+}
+
+// Runs `seconds` of 200 Hz records; the writer stalls in [stallFromS, stallToS). Returns records stored.
+static uint32_t run(RecordAssembler& assembler, uint32_t* nowMs, float seconds, float stallFromS, float stallToS,
+                    uint32_t* priorityMissed) {
+    uint32_t stored = 0;
+    uint32_t startMs = *nowMs;
+    uint16_t lastPower = 0;
+    for (uint32_t t = 0; t < seconds * 1000; t += TICK_MS) {
+        *nowMs += TICK_MS;
+        RecordInputs in = inputsAt(*nowMs);
+        bool newPower = in.power_watts != lastPower;
+        assembler.assemble(*nowMs, in);
+        bool kept = assembler.store(*nowMs);
+        stored += kept;
+        if (newPower && !kept && priorityMissed != nullptr) (*priorityMissed)++;
+        if (kept) lastPower = in.power_watts;
+
+        float s = (*nowMs - startMs) / 1000.0f;
+        if (!(s >= stallFromS && s < stallToS)) {
+            s_ring.count -= s_ring.count < DRAIN_PER_TICK ? s_ring.count : DRAIN_PER_TICK;
+        }
+    }
+    return stored;
+}
+
+static void assertAccounting(const RecordAssembler& assembler, uint32_t stored) {
+    const LogBackpressureStats& stats = assembler.backpressure().stats();
+    TEST_ASSERT_EQUAL_UINT32(stats.produced, stored + stats.skipped);
+    TEST_ASSERT_EQUAL_UINT32(stored - stats.dropped, s_ring.written + assembler.stagingCount());
+    TEST_ASSERT_TRUE(s_ring.ordered);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_rejects_inconsistent_marks(void) {
+    LogBackpressure bp;
+    TEST_ASSERT_TRUE(bp.begin(CONFIG));
+    LogBackpressureConfig bad = CONFIG;
+    bad.recover_percent = bad.decimate_percent;
+    TEST_ASSERT_FALSE(bp.begin(bad));
+    bad = CONFIG;
+    bad.minimal_percent = 101;
+    TEST_ASSERT_FALSE(bp.begin(bad));
+    bad = CONFIG;
+    bad.minimal_every = 0;
+    TEST_ASSERT_FALSE(bp.begin(bad));
+}
+
+void test_no_stall_stays_at_full_rate(void) {
+    RecordAssembler assembler(s_staging, LOG_STAGING_RECORDS, LOG_STAGING_SPILL_RECORDS);
+    begin(assembler);
+    uint32_t nowMs = 0;
+    uint32_t stored = run(assembler, &nowMs, 60.0f, -1.0f, -1.0f, nullptr);
+    TEST_ASSERT_EQUAL_UINT32(60 * 200, stored);
+    TEST_ASSERT_EQUAL_UINT(0, s_transitions.count);
+    TEST_ASSERT_EQUAL_UINT32(0, assembler.backpressure().stats().skipped);
+    assertAccounting(assembler, stored);
+}
+
+void test_ten_second_stall_decimates_without_loss(void) {
+    RecordAssembler assembler(s_staging, LOG_STAGING_RECORDS, LOG_STAGING_SPILL_RECORDS);
+    begin(assembler);
+    uint32_t nowMs = 0, priorityMissed = 0;
+    uint32_t stored = run(assembler, &nowMs, 60.0f, 5.0f, 15.0f, &priorityMissed);
+
+    TEST_ASSERT_EQUAL_UINT(2, s_transitions.count);
+    TEST_ASSERT_EQUAL_UINT8(LOG_RATE_DECIMATED, s_transitions.levels[0]);
+    TEST_ASSERT_EQUAL_UINT8(LOG_RATE_FULL, s_transitions.levels[1]);
+    const LogBackpressureStats& stats = assembler.backpressure().stats();
+    TEST_ASSERT_EQUAL_UINT32(0, stats.dropped);
+    TEST_ASSERT_GREATER_THAN(0, stats.skipped);
+    TEST_ASSERT_EQUAL_UINT32(0, priorityMissed); // Every power change was logged
+    TEST_ASSERT_EQUAL_UINT32(stats.skipped, s_transitions.last.skipped);
+    assertAccounting(assembler, stored);
+}
+
+void test_long_stall_steps_down_and_recovers(void) {
+    RecordAssembler assembler(s_staging, LOG_STAGING_RECORDS, LOG_STAGING_SPILL_RECORDS);
+    begin(assembler);
+    uint32_t nowMs = 0, priorityMissed = 0;
+    uint32_t stored = run(assembler, &nowMs, 120.0f, 5.0f, 44.0f, &priorityMissed);
+
+    const LogRateLevel expected[] = { LOG_RATE_DECIMATED, LOG_RATE_MINIMAL, LOG_RATE_DECIMATED, LOG_RATE_FULL };
+    TEST_ASSERT_EQUAL_UINT(4, s_transitions.count);
+    for (size_t i = 0; i < 4; i++) TEST_ASSERT_EQUAL_UINT8(expected[i], s_transitions.levels[i]);
+    const LogBackpressureStats& stats = assembler.backpressure().stats();
+    TEST_ASSERT_EQUAL_UINT32(0, stats.dropped);
+    TEST_ASSERT_EQUAL_UINT32(0, priorityMissed);
+    TEST_ASSERT_LESS_THAN(PSRAM_BUFFER_SIZE_RECORDS, stats.ring_peak);
+    assertAccounting(assembler, stored);
+}
+
+void test_dead_card_drops_and_counts(void) {
+    RecordAssembler assembler(s_staging, LOG_STAGING_RECORDS, LOG_STAGING_SPILL_RECORDS);
+    begin(assembler);
+    uint32_t nowMs = 0;
+    uint32_t stored = run(assembler, &nowMs, 300.0f, 1.0f, 1000.0f, nullptr);
+
+    const LogBackpressureStats& stats = assembler.backpressure().stats();
+    TEST_ASSERT_EQUAL_UINT8(LOG_RATE_DROPPING, stats.level);
+    TEST_ASSERT_GREATER_THAN(0, stats.dropped);
+    TEST_ASSERT_EQUAL_UINT32(PSRAM_BUFFER_SIZE_RECORDS, stats.ring_peak);
+    TEST_ASSERT_EQUAL_UINT(LOG_STAGING_RECORDS, assembler.stagingCount());
+    assertAccounting(assembler, stored);
+}
+
+void test_fill_hovering_at_a_mark_does_not_chatter(void) {
+    LogBackpressure bp;
+    TEST_ASSERT_TRUE(bp.begin(CONFIG));
+    LogBackpressureTransition t;
+    const size_t capacity = 1000;
+    TEST_ASSERT_TRUE(bp.update(capacity * LOG_BP_DECIMATE_PERCENT / 100, capacity, false, 100, &t));
+    TEST_ASSERT_EQUAL_UINT8(LOG_RATE_DECIMATED, t.to);
+    // Between the recovery and decimation marks: stays decimated
+    for (int i = 0; i < 50; i++) {
+        size_t fill = capacity * (LOG_BP_DECIMATE_PERCENT - 1 - i % 10) / 100;
+        TEST_ASSERT_FALSE(bp.update(fill, capacity, false, 200 + i, &t));
+    }
+    TEST_ASSERT_TRUE(bp.update(capacity * LOG_BP_RECOVER_PERCENT / 100, capacity, false, 300, &t));
+    TEST_ASSERT_EQUAL_UINT8(LOG_RATE_FULL, t.to);
+    TEST_ASSERT_EQUAL_UINT32(200, t.in_previous_ms);
+    TEST_ASSERT_EQUAL_UINT32(2, bp.stats().transitions);
+}
+
+void test_imu_average_spans_skipped_records(void) {
+    RecordAssembler assembler(s_staging, LOG_STAGING_RECORDS, LOG_STAGING_SPILL_RECORDS);
+    begin(assembler);
+    // Force the decimated level through the policy directly
+    s_ring.count = PSRAM_BUFFER_SIZE_RECORDS * LOG_BP_DECIMATE_PERCENT / 100;
+    RecordInputs in = inputsAt(0);
+    in.power_watts = 250;
+    ImuSample sample = {};
+    float sum = 0.0f;
+    uint32_t nowMs = 0;
+    bool stored = false;
+    int ticks = 0;
+    // The first store switches the level; afterwards records are kept 1 in LOG_BP_DECIMATED_EVERY
+    assembler.assemble(nowMs, in);
+    assembler.store(nowMs);
+    TEST_ASSERT_EQUAL_UINT8(LOG_RATE_DECIMATED, assembler.backpressure().level());
+    while (!stored) {
+        nowMs += TICK_MS;
+        sample.accel_mps2[0] = (float)++ticks;
+        sum += sample.accel_mps2[0];
+        assembler.addImuSamples(&sample, 1);
+        const LogRecordV1& record = assembler.assemble(nowMs, in);
+        stored = assembler.store(nowMs);
+        if (stored) TEST_ASSERT_FLOAT_WITHIN(1e-5f, sum / ticks, record.imu_accel_x_mps2);
+    }
+    TEST_ASSERT_EQUAL_INT(LOG_BP_DECIMATED_EVERY, ticks);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_rejects_inconsistent_marks);
+    RUN_TEST(test_no_stall_stays_at_full_rate);
+    RUN_TEST(test_ten_second_stall_decimates_without_loss);
+    RUN_TEST(test_long_stall_steps_down_and_recovers);
+    RUN_TEST(test_dead_card_drops_and_counts);
+    RUN_TEST(test_fill_hovering_at_a_mark_does_not_chatter);
+    RUN_TEST(test_imu_average_spans_skipped_records);
+    return UNITY_END();
+}
@@ -0,0 +1,142 @@
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "log_schema.h"
+
+static uint8_t s_blob[LOG_SCHEMA_BLOB_MAX];
+static char s_text[4096];
+
+// Reads one field entry of the blob (see tools/log_schema.py for the layout)
+struct BlobField {
+    uint8_t type, count;
+    uint16_t offset;
+    float scale;
+    char name[64], unit[16];
+};
+
+static size_t readBlobField(const uint8_t* p, BlobField* out) {
+    const uint8_t* start = p;
+    out->type = *p++;
+    out->count = *p++;
+    memcpy(&out->offset, p, 2);
+    p += 2;
+    memcpy(&out->scale, p, 4);
+    p += 4;
+    uint8_t length = *p++;
+    memcpy(out->name, p, length);
+    out->name[length] = '\0';
+    p += length;
+    length = *p++;
+    memcpy(out->unit, p, length);
+    out->unit[length] = '\0';
+    p += length;
+    return p - start;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_blob_describes_the_record(void) {
+    size_t length = logSchemaWriteBlob(s_blob, sizeof(s_blob));
+    TEST_ASSERT_GREATER_THAN(sizeof(LogSchemaBlobHeader), length);
+
+    LogSchemaBlobHeader header;
+    memcpy(&header, s_blob, sizeof(header));
+    TEST_ASSERT_EQUAL_MEMORY(LOG_SCHEMA_MAGIC, header.magic, 4);
+    TEST_ASSERT_EQUAL_UINT16(length, header.blob_length);
+    TEST_ASSERT_EQUAL_UINT16(LOG_SCHEMA_VERSION, header.schema_version);
+    TEST_ASSERT_EQUAL_UINT16(LOG_RECORD_V1_SIZE, header.record_size);
+    TEST_ASSERT_EQUAL_UINT8(LOG_RECORD_V1_FIELD_COUNT, header.field_count);
+
+    // Fields are contiguous, in table order, and end exactly at the record size
+    size_t pos = sizeof(header);
+    uint16_t expectedOffset = 0;
+    for (size_t i = 0; i < LOG_RECORD_V1_FIELD_COUNT; i++) {
+        BlobField field;
+        pos += readBlobField(s_blob + pos, &field);
+        const LogFieldInfo& info = LOG_RECORD_V1_SCHEMA[i];
+        TEST_ASSERT_EQUAL_STRING(info.name, field.name);
+        TEST_ASSERT_EQUAL_STRING(info.unit, field.unit);
+        TEST_ASSERT_EQUAL_UINT8(info.type, field.type);
+        TEST_ASSERT_EQUAL_UINT8(info.count, field.count);
+        TEST_ASSERT_EQUAL_UINT16(expectedOffset, field.offset);
+        TEST_ASSERT_EQUAL_FLOAT(info.scale, field.scale);
+        expectedOffset += info.count * info.element_size;
+    }
+    TEST_ASSERT_EQUAL_UINT(length, pos);
+    TEST_ASSERT_EQUAL_UINT16(LOG_RECORD_V1_SIZE, expectedOffset);
+}
+
+void test_blob_too_small_is_refused(void) {
+    size_t length = logSchemaWriteBlob(s_blob, sizeof(s_blob));
+    TEST_ASSERT_EQUAL_UINT(0, logSchemaWriteBlob(s_blob, length - 1));
+    TEST_ASSERT_EQUAL_UINT(0, logSchemaWriteBlob(s_blob, sizeof(LogSchemaBlobHeader) - 1));
+    TEST_ASSERT_EQUAL_UINT(length, logSchemaWriteBlob(s_blob, length));
+}
+
+void test_pack_unpack_round_trip(void) {
+    // Every byte distinct, so a field written to the wrong offset shows up
+    uint8_t wire[LOG_RECORD_V1_SIZE], again[LOG_RECORD_V1_SIZE];
+    for (size_t i = 0; i < sizeof(wire); i++) wire[i] = (uint8_t)(i * 7 + 3);
+    LogRecordV1 record;
+    logRecordV1Unpack(wire, &record);
+    logRecordV1Pack(record, again);
+    TEST_ASSERT_EQUAL_MEMORY(wire, again, sizeof(wire));
+
+    memset(&record, 0, sizeof(record));
+    record.system_timestamp_ms = 0x11223344;
+    record.power_watts = 321;
+    record.cadence_rpm = 92;
+    record.analog_ch[7] = NAN;
+    logRecordV1Pack(record, wire);
+    uint32_t timestamp;
+    uint16_t watts;
+    memcpy(&timestamp, wire + LOG_RECORD_V1_SCHEMA[LOG_FIELD_system_timestamp_ms].offset, 4);
+    memcpy(&watts, wire + LOG_RECORD_V1_SCHEMA[LOG_FIELD_power_watts].offset, 2);
+    TEST_ASSERT_EQUAL_HEX32(0x11223344, timestamp);
+    TEST_ASSERT_EQUAL_UINT16(321, watts);
+    TEST_ASSERT_EQUAL_UINT8(92, wire[LOG_RECORD_V1_SCHEMA[LOG_FIELD_cadence_rpm].offset]);
+    float last;
+    memcpy(&last, wire + LOG_RECORD_V1_SIZE - 4, 4);
+    TEST_ASSERT_TRUE(isnan(last));
+}
+
+void test_csv_header_has_one_column_per_element(void) {
+    size_t length = logSchemaCsvHeader(s_text, sizeof(s_text));
+    TEST_ASSERT_EQUAL_UINT(strlen(s_text), length);
+    size_t columns = 1;
+    for (size_t i = 0; i < length; i++) columns += s_text[i] == ',';
+    size_t elements = 0;
+    for (size_t i = 0; i < LOG_RECORD_V1_FIELD_COUNT; i++) elements += LOG_RECORD_V1_SCHEMA[i].count;
+    TEST_ASSERT_EQUAL_UINT(elements, columns);
+    TEST_ASSERT_EQUAL_INT(0, strncmp(s_text, "system_timestamp_ms[ms],", 24));
+    TEST_ASSERT_NOT_NULL(strstr(s_text, ",gps_sats,"));      // No unit, no brackets
+    TEST_ASSERT_NOT_NULL(strstr(s_text, ",analog_ch7[V]"));
+    TEST_ASSERT_EQUAL_UINT(0, logSchemaCsvHeader(s_text, 32));
+}
+
+void test_json_lists_every_field(void) {
+    size_t length = logSchemaJson(s_text, sizeof(s_text));
+    TEST_ASSERT_EQUAL_UINT(strlen(s_text), length);
+    TEST_ASSERT_EQUAL_INT(0, strncmp(s_text, "{\"version\":1,\"record_size\":101,\"fields\":[", 41));
+    TEST_ASSERT_EQUAL_INT(0, strcmp(s_text + length - 2, "]}"));
+    for (size_t i = 0; i < LOG_RECORD_V1_FIELD_COUNT; i++) {
+        char needle[80];
+        snprintf(needle, sizeof(needle), "{\"name\":\"%s\",\"type\":\"%s\"", LOG_RECORD_V1_SCHEMA[i].name,
+                 logFieldTypeName(LOG_RECORD_V1_SCHEMA[i].type));
+        TEST_ASSERT_NOT_NULL(strstr(s_text, needle));
+    }
+    TEST_ASSERT_EQUAL_UINT(0, logSchemaJson(s_text, 64));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_blob_describes_the_record);
+    RUN_TEST(test_blob_too_small_is_refused);
+    RUN_TEST(test_pack_unpack_round_trip);
+    RUN_TEST(test_csv_header_has_one_column_per_element);
+    RUN_TEST(test_json_lists_every_field);
+    return UNITY_END();
+}
@@ -0,0 +1,184 @@
+#include <unity.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "mean_max_power.h"
+
+static const uint16_t DURATIONS[] = { 5, 60, 300, 1200 };
+static const size_t DURATION_COUNT = sizeof(DURATIONS) / sizeof(DURATIONS[0]);
+static const uint32_t LONGEST = 1200;
+
+// --- Brute-force reference ---
+
+// Best window of `duration` seconds over the whole series, first one on ties; nothing until the
+// series is that long, and end 0 while no window beats zero
+static MeanMaxPoint referencePoint(const std::vector<uint16_t>& s, uint16_t duration) {
+    MeanMaxPoint point = { duration, 0.0f, 0 };
+    uint32_t best = 0;
+    for (size_t end = duration; end <= s.size(); end++) {
+        uint32_t sum = 0;
+        for (size_t k = end - duration; k < end; k++) sum += s[k];
+        if (sum > best) {
+            best = sum;
+            point.best_end_s = (uint32_t)end;
+        }
+    }
+    point.best_watts = (float)best / duration;
+    return point;
+}
+
+static void assertMatchesReference(const MeanMaxPower& mmp, const std::vector<uint16_t>& s) {
+    TEST_ASSERT_EQUAL_UINT32(s.size(), mmp.elapsedSeconds());
+    MeanMaxPoint curve[MMP_MAX_DURATIONS];
+    TEST_ASSERT_EQUAL(DURATION_COUNT, mmp.getCurve(curve, MMP_MAX_DURATIONS));
+    for (size_t i = 0; i < DURATION_COUNT; i++) {
+        MeanMaxPoint want = referencePoint(s, DURATIONS[i]);
+        TEST_ASSERT_EQUAL_UINT16(want.duration_s, curve[i].duration_s);
+        TEST_ASSERT_EQUAL_FLOAT(want.best_watts, curve[i].best_watts);
+        TEST_ASSERT_EQUAL_UINT32(want.best_end_s, curve[i].best_end_s);
+    }
+}
+
+// --- Synthetic ride ---
+
+// Endurance pace with noise, a few efforts of every length and the odd coasting second
+static void appendRide(std::vector<uint16_t>* s, uint32_t seconds, unsigned seed) {
+    srand(seed);
+    uint32_t effortLeft = 0;
+    uint16_t effortWatts = 0;
+    for (uint32_t t = 0; t < seconds; t++) {
+        if (effortLeft == 0 && rand() % 200 == 0) {
+            static const uint32_t lengths[] = { 8, 45, 240, 700 };
+            effortLeft = lengths[rand() % 4];
+            effortWatts = (uint16_t)(300 + rand() % 500);
+        }
+        uint16_t watts;
+        if (effortLeft > 0) {
+            effortLeft--;
+            watts = (uint16_t)(effortWatts + rand() % 40);
+        } else if (rand() % 25 == 0) {
+            watts = 0;
+        } else {
+            watts = (uint16_t)(170 + rand() % 90);
+        }
+        s->push_back(watts);
+    }
+}
+
+static std::vector<uint16_t> s_ring;
+
+static void beginWithRing(MeanMaxPower& mmp, uint32_t ringLength) {
+    s_ring.assign(ringLength, 0xFFFF); // begin() must clear it
+    TEST_ASSERT_TRUE(mmp.begin(DURATIONS, DURATION_COUNT, s_ring.data(), ringLength));
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_ride_matches_brute_force_throughout(void) {
+    std::vector<uint16_t> ride;
+    appendRide(&ride, 3000, 1);
+    MeanMaxPower mmp;
+    beginWithRing(mmp, LONGEST);
+    std::vector<uint16_t> fed;
+    for (uint16_t watts : ride) {
+        mmp.push(watts);
+        fed.push_back(watts);
+        // Checkpoints either side of every duration, where the window first counts
+        if (fed.size() % 250 == 0 || fed.size() == 4 || fed.size() == 5 || fed.size() == 1199 || fed.size() == 1200) {
+            assertMatchesReference(mmp, fed);
+        }
+    }
+    assertMatchesReference(mmp, fed);
+}
+
+void test_ride_shorter_than_durations_has_no_points(void) {
+    std::vector<uint16_t> ride;
+    appendRide(&ride, 250, 2);
+    MeanMaxPower mmp;
+    beginWithRing(mmp, LONGEST);
+    for (uint16_t watts : ride) mmp.push(watts);
+    assertMatchesReference(mmp, ride);
+    MeanMaxPoint curve[MMP_MAX_DURATIONS];
+    mmp.getCurve(curve, MMP_MAX_DURATIONS);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, curve[2].best_watts); // 300 s
+    TEST_ASSERT_EQUAL_UINT32(0, curve[2].best_end_s);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, curve[3].best_watts); // 1200 s
+}
+
+void test_short_dropout_pushes_zeros(void) {
+    std::vector<uint16_t> ride;
+    appendRide(&ride, 900, 3);
+    MeanMaxPower mmp;
+    beginWithRing(mmp, LONGEST);
+    for (uint16_t watts : ride) mmp.push(watts);
+    mmp.pushZeros(LONGEST - 1); // Second by second
+    ride.insert(ride.end(), LONGEST - 1, 0);
+    assertMatchesReference(mmp, ride);
+    size_t before = ride.size();
+    appendRide(&ride, 1500, 4);
+    for (size_t i = before; i < ride.size(); i++) mmp.push(ride[i]);
+    assertMatchesReference(mmp, ride);
+}
+
+void test_dropout_longer_than_longest_duration_takes_bulk_path(void) {
+    std::vector<uint16_t> ride;
+    appendRide(&ride, 700, 5);
+    MeanMaxPower mmp;
+    beginWithRing(mmp, LONGEST);
+    for (uint16_t watts : ride) mmp.push(watts);
+    mmp.pushZeros(LONGEST + 437); // Clears the windows and skips ahead
+    ride.insert(ride.end(), LONGEST + 437, 0);
+    assertMatchesReference(mmp, ride);
+
+    // Windows that straddle the dropout's end must only see zeros before the new samples
+    size_t before = ride.size();
+    appendRide(&ride, 1300, 6);
+    for (size_t i = before; i < ride.size(); i++) {
+        mmp.push(ride[i]);
+        if ((i - before) % 100 == 0) assertMatchesReference(mmp, std::vector<uint16_t>(ride.begin(), ride.begin() + i + 1));
+    }
+    assertMatchesReference(mmp, ride);
+}
+
+void test_second_sink_with_ring_longer_than_longest(void) {
+    // PowerAnalytics' sink: single seconds and repeated zeros; a larger ring moves the bulk path's
+    // position modulo a length other than the longest duration
+    std::vector<uint16_t> ride;
+    MeanMaxPower mmp;
+    beginWithRing(mmp, LONGEST + 77);
+    appendRide(&ride, 1400, 7);
+    for (uint16_t watts : ride) meanMaxPowerSecondSink(watts, 1, &mmp);
+    meanMaxPowerSecondSink(0, 3 * LONGEST, &mmp);
+    ride.insert(ride.end(), 3 * LONGEST, 0);
+    size_t before = ride.size();
+    appendRide(&ride, 1300, 8);
+    for (size_t i = before; i < ride.size(); i++) meanMaxPowerSecondSink(ride[i], 1, &mmp);
+    meanMaxPowerSecondSink(0, 30, &mmp);
+    ride.insert(ride.end(), 30, 0);
+    assertMatchesReference(mmp, ride);
+}
+
+void test_reset_starts_a_new_session(void) {
+    std::vector<uint16_t> ride;
+    appendRide(&ride, 1500, 9);
+    MeanMaxPower mmp;
+    beginWithRing(mmp, LONGEST);
+    for (uint16_t watts : ride) mmp.push(watts);
+    mmp.reset();
+    ride.clear();
+    appendRide(&ride, 400, 10);
+    for (uint16_t watts : ride) mmp.push(watts);
+    assertMatchesReference(mmp, ride);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_ride_matches_brute_force_throughout);
+    RUN_TEST(test_ride_shorter_than_durations_has_no_points);
+    RUN_TEST(test_short_dropout_pushes_zeros);
+    RUN_TEST(test_dropout_longer_than_longest_duration_takes_bulk_path);
+    RUN_TEST(test_second_sink_with_ring_longer_than_longest);
+    RUN_TEST(test_reset_starts_a_new_session);
+    return UNITY_END();
+}
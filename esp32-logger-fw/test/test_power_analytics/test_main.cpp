@@ -0,0 +1,246 @@
+#include <unity.h>
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "power_analytics.h"
+
+static const uint16_t FTP = 250;
+static const uint32_t DROPOUT_MS = 3000;
+
+struct Notification {
+    uint32_t t_ms;
+    uint16_t watts;
+};
+
+// --- Straightforward reference ---
+
+// 1 Hz grid from the first notification: slot mean, held until the dropout expires, then zero.
+// Only slots that end at or before the last notification are complete.
+static std::vector<uint16_t> referenceSeconds(const std::vector<Notification>& in) {
+    std::vector<uint16_t> out;
+    if (in.empty()) return out;
+    uint32_t start = in.front().t_ms;
+    uint32_t slots = (in.back().t_ms - start) / 1000;
+    uint16_t held = 0;
+    size_t next = 0;
+    uint32_t lastMs = start;
+    for (uint32_t k = 0; k < slots; k++) {
+        uint32_t slotStart = start + k * 1000;
+        uint32_t sum = 0, count = 0;
+        while (next < in.size() && in[next].t_ms < slotStart + 1000) {
+            sum += in[next].watts;
+            count++;
+            lastMs = in[next].t_ms;
+            next++;
+        }
+        uint16_t value;
+        if (count > 0) {
+            value = (uint16_t)((sum + count / 2) / count);
+            held = value;
+        } else if (slotStart - lastMs < DROPOUT_MS) {
+            value = held;
+        } else {
+            value = 0;
+        }
+        out.push_back(value);
+    }
+    return out;
+}
+
+struct ReferenceMetrics {
+    double avg3, avg10, avg30, avg, np, intensity, tss, kj;
+};
+
+static double trailingMean(const std::vector<uint16_t>& s, size_t window) {
+    size_t n = s.size() < window ? s.size() : window;
+    if (n == 0) return 0.0;
+    double sum = 0.0;
+    for (size_t i = s.size() - n; i < s.size(); i++) sum += s[i];
+    return sum / n;
+}
+
+// NP: fourth root of the mean of (30 s rolling average)^4, taken from the 30th second on
+static ReferenceMetrics referenceMetrics(const std::vector<uint16_t>& s) {
+    ReferenceMetrics m = {};
+    m.avg3 = trailingMean(s, 3);
+    m.avg10 = trailingMean(s, 10);
+    m.avg30 = trailingMean(s, 30);
+    double total = 0.0;
+    for (uint16_t w : s) total += w;
+    m.avg = s.empty() ? 0.0 : total / s.size();
+    double fourth = 0.0;
+    size_t terms = 0;
+    for (size_t t = 29; t < s.size(); t++) {
+        double sum = 0.0;
+        for (size_t i = t - 29; i <= t; i++) sum += s[i];
+        double avg = sum / 30.0;
+        fourth += avg * avg * avg * avg;
+        terms++;
+    }
+    m.np = terms > 0 ? pow(fourth / terms, 0.25) : 0.0;
+    m.intensity = m.np / FTP;
+    m.tss = s.size() * m.np * m.intensity / (FTP * 3600.0) * 100.0;
+    m.kj = total / 1000.0;
+    return m;
+}
+
+// --- Fixture ---
+
+struct SinkLog {
+    std::vector<uint16_t> seconds;
+    uint32_t bulkCalls;
+};
+
+static void recordSecond(uint16_t watts, uint32_t repeat, void* context) {
+    SinkLog* log = (SinkLog*)context;
+    if (repeat > 1) log->bulkCalls++;
+    log->seconds.insert(log->seconds.end(), repeat, watts);
+}
+
+static std::vector<Notification> s_ride;
+
+// Irregular 1-4 Hz notifications with intervals and efforts; gaps are [from, to) in seconds
+static void makeRide(uint32_t durationS, const std::vector<std::pair<uint32_t, uint32_t> >& gaps, unsigned seed) {
+    s_ride.clear();
+    srand(seed);
+    uint32_t t = 5000;
+    while (t < 5000 + durationS * 1000) {
+        uint32_t s = (t - 5000) / 1000;
+        bool inGap = false;
+        for (const auto& g : gaps) inGap = inGap || (s >= g.first && s < g.second);
+        if (!inGap) {
+            double base = (s / 120) % 2 == 0 ? 180.0 : 320.0; // 2 min blocks
+            double w = base + 60.0 * sin(s / 7.0) + (rand() % 41) - 20;
+            s_ride.push_back({ t, (uint16_t)(w < 0 ? 0 : w) });
+        }
+        t += 250 + (uint32_t)(rand() % 751); // 1-4 Hz
+    }
+}
+
+static void feed(PowerAnalytics& pa, uint32_t* completed) {
+    *completed = 0;
+    for (const Notification& n : s_ride) *completed += pa.addSample(n.t_ms, n.watts);
+}
+
+static void assertMatchesReference(const PowerAnalytics& pa, const std::vector<uint16_t>& ref) {
+    ReferenceMetrics m = referenceMetrics(ref);
+    PowerMetrics out;
+    pa.getMetrics(&out);
+    TEST_ASSERT_EQUAL_UINT32(ref.size(), out.elapsed_s);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, (float)m.avg3, out.avg3s_watts);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, (float)m.avg10, out.avg10s_watts);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, (float)m.avg30, out.avg30s_watts);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, (float)m.avg, out.avg_watts);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, (float)m.np, out.normalized_power);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, (float)m.intensity, out.intensity_factor);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, (float)m.tss, out.tss);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, (float)m.kj, out.work_kj);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_steady_ride_matches_reference(void) {
+    makeRide(3600, {}, 1);
+    PowerAnalytics pa(FTP, DROPOUT_MS);
+    SinkLog log = {};
+    pa.setSecondSink(recordSecond, &log);
+    uint32_t completed;
+    feed(pa, &completed);
+
+    std::vector<uint16_t> ref = referenceSeconds(s_ride);
+    TEST_ASSERT_EQUAL_UINT32(ref.size(), completed);
+    TEST_ASSERT_TRUE(log.seconds == ref);
+    assertMatchesReference(pa, ref);
+}
+
+void test_short_gaps_hold_and_dropouts_count_as_zero(void) {
+    // 2 s gap (held), 10 s gap (dropout, window not drained) and a gap at the very start of the window
+    makeRide(900, { { 100, 102 }, { 300, 310 }, { 31, 35 } }, 2);
+    PowerAnalytics pa(FTP, DROPOUT_MS);
+    SinkLog log = {};
+    pa.setSecondSink(recordSecond, &log);
+    uint32_t completed;
+    feed(pa, &completed);
+
+    std::vector<uint16_t> ref = referenceSeconds(s_ride);
+    TEST_ASSERT_TRUE(log.seconds == ref);
+    TEST_ASSERT_EQUAL_UINT32(0, log.bulkCalls);
+    assertMatchesReference(pa, ref);
+
+    // The dropout reaches zero and the hold does not
+    size_t zeros = 0;
+    for (uint16_t w : ref) zeros += w == 0;
+    TEST_ASSERT_GREATER_THAN(0, zeros);
+}
+
+void test_long_dropout_takes_bulk_path(void) {
+    // Stops for 20 min, then a second stop of 45 s: both drain the 30 s window
+    makeRide(3600, { { 1200, 2400 }, { 3000, 3045 } }, 3);
+    PowerAnalytics pa(FTP, DROPOUT_MS);
+    SinkLog log = {};
+    pa.setSecondSink(recordSecond, &log);
+    uint32_t completed;
+    feed(pa, &completed);
+
+    std::vector<uint16_t> ref = referenceSeconds(s_ride);
+    TEST_ASSERT_EQUAL_UINT32(ref.size(), completed);
+    TEST_ASSERT_EQUAL_UINT32(2, log.bulkCalls);
+    TEST_ASSERT_TRUE(log.seconds == ref);
+    assertMatchesReference(pa, ref);
+}
+
+void test_single_late_notification_after_dropout(void) {
+    // One notification an hour after the last one: the whole gap in one call
+    s_ride.clear();
+    for (uint32_t t = 0; t < 60000; t += 500) s_ride.push_back({ t, 200 });
+    s_ride.push_back({ 60000 + 3600000, 150 });
+    PowerAnalytics pa(FTP, DROPOUT_MS);
+    SinkLog log = {};
+    pa.setSecondSink(recordSecond, &log);
+    uint32_t completed;
+    feed(pa, &completed);
+
+    std::vector<uint16_t> ref = referenceSeconds(s_ride);
+    TEST_ASSERT_EQUAL_UINT32(ref.size(), completed);
+    TEST_ASSERT_EQUAL_UINT32(1, log.bulkCalls);
+    TEST_ASSERT_TRUE(log.seconds == ref);
+    assertMatchesReference(pa, ref);
+}
+
+void test_shorter_than_window_has_no_np(void) {
+    makeRide(20, {}, 4);
+    PowerAnalytics pa(FTP, DROPOUT_MS);
+    uint32_t completed;
+    feed(pa, &completed);
+
+    std::vector<uint16_t> ref = referenceSeconds(s_ride);
+    assertMatchesReference(pa, ref);
+    PowerMetrics out;
+    pa.getMetrics(&out);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, out.normalized_power);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, out.tss);
+}
+
+void test_reset_starts_a_new_session(void) {
+    makeRide(600, {}, 5);
+    PowerAnalytics pa(FTP, DROPOUT_MS);
+    uint32_t completed;
+    feed(pa, &completed);
+    pa.reset();
+    makeRide(400, { { 100, 200 } }, 6);
+    feed(pa, &completed);
+    assertMatchesReference(pa, referenceSeconds(s_ride));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_steady_ride_matches_reference);
+    RUN_TEST(test_short_gaps_hold_and_dropouts_count_as_zero);
+    RUN_TEST(test_long_dropout_takes_bulk_path);
+    RUN_TEST(test_single_late_notification_after_dropout);
+    RUN_TEST(test_shorter_than_window_has_no_np);
+    RUN_TEST(test_reset_starts_a_new_session);
+    return UNITY_END();
+}
@@ -0,0 +1,182 @@
+#include <unity.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "segment_gates.h"
+
+#define CELL_M 50.0f
+#define BUCKETS 1024
+#define MAX_OUT 16
+
+static GateCrossing s_out[MAX_OUT];
+
+static void* testAlloc(size_t bytes) {
+    return malloc(bytes);
+}
+
+// Gates are given in metres around (lat0, lon0) so the tests read in the index's own frame
+static const double LAT0 = 47.0, LON0 = 8.0;
+
+static double metersToLat(float y) {
+    return LAT0 + y / 6371000.0 * 180.0 / M_PI;
+}
+
+static double metersToLon(float x) {
+    return LON0 + x / (6371000.0 * cos(LAT0 * M_PI / 180.0)) * 180.0 / M_PI;
+}
+
+// First gate is a tiny anchor at the origin so the projection origin is (LAT0, LON0)
+static GateDef s_defs[64];
+static uint32_t s_defCount;
+
+static void addGate(int32_t id, GateKind kind, float x1, float y1, float x2, float y2) {
+    GateDef& d = s_defs[s_defCount++];
+    d.segment_id = id;
+    d.kind = kind;
+    d.lat1 = metersToLat(y1);
+    d.lon1 = metersToLon(x1);
+    d.lat2 = metersToLat(y2);
+    d.lon2 = metersToLon(x2);
+}
+
+void setUp(void) {
+    s_defCount = 0;
+    addGate(0, GATE_START, 0.0f, 0.0f, 0.0f, 0.5f);
+}
+
+void tearDown(void) {}
+
+void test_short_movement_crosses_gate(void) {
+    addGate(1, GATE_LAP, 20.0f, -10.0f, 20.0f, 10.0f);
+    GateIndex index(CELL_M, BUCKETS, testAlloc, free);
+    TEST_ASSERT_TRUE(index.build(s_defs, s_defCount));
+
+    size_t found = index.findCrossings(10.0f, 1.0f, 1000, 30.0f, 1.0f, 2000, s_out, MAX_OUT);
+    TEST_ASSERT_EQUAL_UINT(1, found);
+    TEST_ASSERT_EQUAL_INT32(1, s_out[0].segment_id);
+    TEST_ASSERT_EQUAL_UINT32(1500, s_out[0].time_ms);
+}
+
+// A movement far longer than a cell (e.g. a fix after a tunnel) still finds every gate on its line
+void test_long_movement_walks_every_cell(void) {
+    addGate(1, GATE_START, 120.0f, -20.0f, 120.0f, 20.0f);
+    addGate(2, GATE_FINISH, 730.0f, -20.0f, 730.0f, 20.0f);
+    addGate(3, GATE_LAP, 400.0f, 100.0f, 400.0f, 140.0f); // Off the line: must not be reported
+    GateIndex index(CELL_M, BUCKETS, testAlloc, free);
+    TEST_ASSERT_TRUE(index.build(s_defs, s_defCount));
+
+    size_t found = index.findCrossings(-5.0f, 3.0f, 0, 995.0f, 3.0f, 10000, s_out, MAX_OUT);
+    TEST_ASSERT_EQUAL_UINT(2, found);
+    TEST_ASSERT_EQUAL_INT32(1, s_out[0].segment_id);
+    TEST_ASSERT_EQUAL_INT32(2, s_out[1].segment_id);
+    TEST_ASSERT_FLOAT_WITHIN(2.0f, 1250.0f, (float)s_out[0].time_ms);
+    TEST_ASSERT_FLOAT_WITHIN(2.0f, 7350.0f, (float)s_out[1].time_ms);
+    // 21 cells along x; nothing outside the line's row is visited
+    TEST_ASSERT_EQUAL_UINT32(21, index.lastCells());
+}
+
+void test_diagonal_movement_in_each_direction(void) {
+    addGate(1, GATE_LAP, 260.0f, 140.0f, 140.0f, 260.0f); // Perpendicular to the x = y diagonal at 200 m
+    addGate(2, GATE_LAP, 230.0f, 230.0f, 270.0f, 270.0f); // On the diagonal, across x + y = 500
+    GateIndex index(CELL_M, BUCKETS, testAlloc, free);
+    TEST_ASSERT_TRUE(index.build(s_defs, s_defCount));
+
+    // Forward, backward and through the exact cell corners (multiples of the cell size)
+    TEST_ASSERT_EQUAL_UINT(1, index.findCrossings(10.0f, 13.0f, 0, 390.0f, 387.0f, 1000, s_out, MAX_OUT));
+    TEST_ASSERT_EQUAL_UINT(1, index.findCrossings(390.0f, 387.0f, 0, 10.0f, 13.0f, 1000, s_out, MAX_OUT));
+    TEST_ASSERT_EQUAL_UINT(1, index.findCrossings(50.0f, 50.0f, 0, 450.0f, 450.0f, 1000, s_out, MAX_OUT));
+    TEST_ASSERT_FLOAT_WITHIN(2.0f, 375.0f, (float)s_out[0].time_ms);
+    TEST_ASSERT_EQUAL_UINT(1, index.findCrossings(450.0f, 450.0f, 0, 50.0f, 50.0f, 1000, s_out, MAX_OUT));
+    // Anti-diagonal through corners, across a gate on the diagonal (collinear with the runs above)
+    TEST_ASSERT_EQUAL_UINT(1, index.findCrossings(450.0f, 50.0f, 0, 50.0f, 450.0f, 1000, s_out, MAX_OUT));
+    TEST_ASSERT_EQUAL_INT32(2, s_out[0].segment_id);
+    TEST_ASSERT_EQUAL_UINT(1, index.findCrossings(50.0f, 450.0f, 0, 450.0f, 50.0f, 1000, s_out, MAX_OUT));
+}
+
+void test_steep_movement_and_negative_cells(void) {
+    addGate(1, GATE_LAP, -300.0f, -610.0f, -260.0f, -610.0f);
+    GateIndex index(CELL_M, BUCKETS, testAlloc, free);
+    TEST_ASSERT_TRUE(index.build(s_defs, s_defCount));
+
+    size_t found = index.findCrossings(-270.0f, 20.0f, 0, -290.0f, -980.0f, 1000, s_out, MAX_OUT);
+    TEST_ASSERT_EQUAL_UINT(1, found);
+    TEST_ASSERT_FLOAT_WITHIN(2.0f, 630.0f, (float)s_out[0].time_ms);
+}
+
+// A gate listed under several cells on the path is tested and reported once
+void test_gate_along_path_reported_once(void) {
+    addGate(1, GATE_LAP, 0.0f, -300.0f, 400.0f, 300.0f); // Long, shallow gate spanning many cells
+    GateIndex index(CELL_M, BUCKETS, testAlloc, free);
+    TEST_ASSERT_TRUE(index.build(s_defs, s_defCount));
+
+    size_t found = index.findCrossings(0.0f, 20.0f, 0, 500.0f, 40.0f, 1000, s_out, MAX_OUT);
+    TEST_ASSERT_EQUAL_UINT(1, found);
+    TEST_ASSERT_EQUAL_UINT32(2, index.lastCandidates()); // The anchor gate and this one
+}
+
+// Brute force over all gates agrees with the grid walk on random movements of any length
+void test_matches_brute_force(void) {
+    srand(7);
+    for (int i = 1; i < 60; i++) {
+        float x = (float)(rand() % 2000) - 1000.0f, y = (float)(rand() % 2000) - 1000.0f;
+        float a = (float)(rand() % 628) / 100.0f, len = 5.0f + (float)(rand() % 80);
+        addGate(i, GATE_LAP, x, y, x + len * cosf(a), y + len * sinf(a));
+    }
+    GateIndex index(CELL_M, BUCKETS, testAlloc, free);
+    TEST_ASSERT_TRUE(index.build(s_defs, s_defCount));
+
+    float gx[64][4];
+    for (uint32_t g = 0; g < s_defCount; g++) {
+        index.project(s_defs[g].lat1, s_defs[g].lon1, &gx[g][0], &gx[g][1]);
+        index.project(s_defs[g].lat2, s_defs[g].lon2, &gx[g][2], &gx[g][3]);
+    }
+    size_t total = 0;
+    for (int m = 0; m < 500; m++) {
+        float x0 = (float)(rand() % 2400) - 1200.0f, y0 = (float)(rand() % 2400) - 1200.0f;
+        float x1 = x0 + (float)(rand() % 1200) - 600.0f, y1 = y0 + (float)(rand() % 1200) - 600.0f;
+        size_t expected = 0;
+        for (uint32_t g = 0; g < s_defCount; g++) {
+            float dx = x1 - x0, dy = y1 - y0, ex = gx[g][2] - gx[g][0], ey = gx[g][3] - gx[g][1];
+            float denom = dx * ey - dy * ex;
+            if (denom == 0.0f) continue;
+            float qx = gx[g][0] - x0, qy = gx[g][1] - y0;
+            float t = (qx * ey - qy * ex) / denom, u = (qx * dy - qy * dx) / denom;
+            if (t > 0.0f && t <= 1.0f && u >= 0.0f && u <= 1.0f) expected++;
+        }
+        TEST_ASSERT_EQUAL_UINT(expected, index.findCrossings(x0, y0, 0, x1, y1, 1000, s_out, MAX_OUT));
+        total += expected;
+    }
+    TEST_ASSERT_GREATER_THAN(20, total);
+}
+
+void test_continuous_gps_time_across_midnight(void) {
+    const uint32_t day = 86400000UL;
+    TEST_ASSERT_EQUAL_UINT32(1000, gateContinuousTimeMs(0, 1000));
+    uint32_t t = gateContinuousTimeMs(0, day - 500);        // 23:59:59.5
+    TEST_ASSERT_EQUAL_UINT32(day - 500, t);
+    t = gateContinuousTimeMs(t, 500);                       // 00:00:00.5 the next day
+    TEST_ASSERT_EQUAL_UINT32(day + 500, t);
+    TEST_ASSERT_EQUAL_UINT32(day + 1500, gateContinuousTimeMs(t, 1500));
+    TEST_ASSERT_EQUAL_UINT32(day + 400, gateContinuousTimeMs(t, 400)); // Slightly older fix stays on the same day
+
+    // A lap across midnight keeps its real length
+    SegmentTimer timer(10000);
+    SegmentResult result;
+    GateCrossing crossing = { 0, -1, GATE_LAP, day - 30000 };
+    TEST_ASSERT_FALSE(timer.onCrossing(crossing, &result));
+    crossing.time_ms = gateContinuousTimeMs(day - 30000, 60000);
+    TEST_ASSERT_TRUE(timer.onCrossing(crossing, &result));
+    TEST_ASSERT_EQUAL_UINT32(90000, result.elapsed_ms);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_short_movement_crosses_gate);
+    RUN_TEST(test_long_movement_walks_every_cell);
+    RUN_TEST(test_diagonal_movement_in_each_direction);
+    RUN_TEST(test_steep_movement_and_negative_cells);
+    RUN_TEST(test_gate_along_path_reported_once);
+    RUN_TEST(test_matches_brute_force);
+    RUN_TEST(test_continuous_gps_time_across_midnight);
+    return UNITY_END();
+}
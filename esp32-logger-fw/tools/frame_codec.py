@@ -0,0 +1,86 @@
+"""Host side of the firmware's binary framing (include/frame_codec.h).
+
+A frame on the wire is COBS(header | payload | crc32) followed by 0x00, where the header is
+uint8 type, uint8 flags, uint16 seq, uint16 length (little endian) and the CRC-32 (zlib/IEEE)
+covers header and payload.
+"""
+import struct
+import zlib
+
+HEADER = struct.Struct("<BBHH")
+CRC = struct.Struct("<I")
+
+
+class FrameError(ValueError):
+    pass
+
+
+def cobs_encode(data):
+    out = bytearray()
+    block = bytearray()
+    for byte in data:
+        if byte == 0:
+            out.append(len(block) + 1)
+            out += block
+            block = bytearray()
+        else:
+            block.append(byte)
+            if len(block) == 254:
+                out.append(255)
+                out += block
+                block = bytearray()
+    out.append(len(block) + 1)
+    out += block
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            raise FrameError("bad COBS block")
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def encode_frame(ftype, seq, payload):
+    body = HEADER.pack(ftype, 0, seq & 0xFFFF, len(payload)) + payload
+    return cobs_encode(body + CRC.pack(zlib.crc32(body) & 0xFFFFFFFF)) + b"\x00"
+
+
+def decode_frame(block):
+    """Decodes one delimiter-free block into (type, seq, payload); raises FrameError."""
+    frame = cobs_decode(block)
+    if len(frame) < HEADER.size + CRC.size:
+        raise FrameError("short frame")
+    ftype, _flags, seq, length = HEADER.unpack_from(frame)
+    if HEADER.size + length + CRC.size != len(frame):
+        raise FrameError("length mismatch")
+    (crc,) = CRC.unpack_from(frame, HEADER.size + length)
+    if zlib.crc32(frame[:HEADER.size + length]) & 0xFFFFFFFF != crc:
+        raise FrameError("CRC mismatch")
+    return ftype, seq, frame[HEADER.size:HEADER.size + length]
+
+
+class FrameSplitter:
+    """Accumulates bytes and returns the complete 0x00-delimited blocks."""
+
+    def __init__(self):
+        self.buffer = bytearray()
+
+    def feed(self, data):
+        self.buffer += data
+        blocks = []
+        while True:
+            end = self.buffer.find(b"\x00")
+            if end < 0:
+                return blocks
+            block = bytes(self.buffer[:end])
+            del self.buffer[:end + 1]
+            if block:
+                blocks.append(block)
@@ -0,0 +1,57 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Host stand-in for the slice of the Arduino core and FreeRTOS that the log writer path uses
+// (log_writer.cpp, DataBuffer.cpp, log_rotation.cpp, event_log.cpp), so
+// tools/sensor_replay_host.cpp runs those files unchanged.
+// Time is the replay's virtual clock (host_platform.h). The replay is single-threaded and drives
+// the tasks' work itself: critical sections are empty, and notifications and delays do nothing.
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef void* TaskHandle_t;
+typedef struct HostQueue* QueueHandle_t;
+typedef int portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+#define portMAX_DELAY 0xFFFFFFFFu
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+uint32_t millis();
+
+inline void vTaskDelay(TickType_t) {}
+inline void xTaskNotifyGive(TaskHandle_t) {}
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return nullptr; }
+
+// Fixed-depth FIFO of fixed-size items, never blocking
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t timeout);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t timeout);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+class Print {
+public:
+    explicit Print(FILE* out) : _out(out) {}
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    size_t print(const char* text) { return (size_t)fprintf(_out, "%s", text); }
+    size_t println(const char* text = "") { return (size_t)fprintf(_out, "%s\n", text); }
+
+private:
+    FILE* _out;
+};
+
+extern Print Serial; // stdout
+
+#endif // HOST_ARDUINO_H
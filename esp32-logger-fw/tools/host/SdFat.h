@@ -0,0 +1,53 @@
+#ifndef HOST_SDFAT_H
+#define HOST_SDFAT_H
+
+// Host stand-in for the SdFat calls the log writer path makes, on a local directory that plays the
+// card (host_platform.h). Open flags are the POSIX ones SdFat mirrors. preAllocate() only checks
+// that the file is empty: there is no extent to reserve, and writes past the end fill the gap with
+// zeros as they do inside a preallocated extent.
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+
+class SdFs;
+
+class FsFile {
+public:
+    FsFile() : _fd(-1), _dir(nullptr) { _name[0] = '\0'; _path[0] = '\0'; }
+
+    bool open(SdFs* fs, const char* path, int oflag);
+    bool openNext(FsFile* dir, int oflag);
+    bool close();
+    bool isOpen() const { return _fd >= 0 || _dir != nullptr; }
+    explicit operator bool() const { return isOpen(); }
+
+    int read(void* buffer, size_t count);
+    size_t write(const void* buffer, size_t count);
+    bool seekSet(uint64_t position);
+    uint64_t curPosition() const;
+    bool truncate(uint64_t length);
+    bool preAllocate(uint64_t length);
+    bool sync() { return _fd >= 0; }
+    size_t getName(char* name, size_t size) const;
+
+private:
+    friend class SdFs;
+    int _fd;
+    void* _dir;       // DIR* while open as a directory
+    char _name[64];
+    char _path[512];  // Host path
+};
+
+class SdFs {
+public:
+    void setRoot(const char* root);
+    FsFile open(const char* path, int oflag = O_RDONLY);
+    bool remove(const char* path);
+    void hostPath(const char* path, char* out, size_t size) const;
+
+private:
+    char _root[448];
+};
+
+#endif // HOST_SDFAT_H
@@ -0,0 +1,8 @@
+#ifndef HOST_ESP_ATTR_H
+#define HOST_ESP_ATTR_H
+
+// Placement attributes (mem_placement.h) mean nothing on the host
+#define WORD_ALIGNED_ATTR
+#define EXT_RAM_ATTR
+
+#endif // HOST_ESP_ATTR_H
@@ -0,0 +1,208 @@
+#include "host_platform.h"
+#include "Arduino.h"
+#include "SdFat.h"
+#include "esp_timer.h"
+#include "sd_card.h"
+#include "mem_placement.h"
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static uint64_t s_clockUs = 0;
+static bool s_mounted = false;
+static SdFs s_fs;
+
+Print Serial(stdout);
+
+void hostClockSetUs(uint64_t us) {
+    s_clockUs = us;
+}
+
+void hostSdCardMount(const char* root) {
+    s_fs.setRoot(root);
+    s_mounted = true;
+}
+
+uint32_t millis() {
+    return (uint32_t)(s_clockUs / 1000);
+}
+
+int64_t esp_timer_get_time() {
+    return (int64_t)s_clockUs;
+}
+
+size_t Print::printf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int n = vfprintf(_out, format, args);
+    va_end(args);
+    return n > 0 ? (size_t)n : 0;
+}
+
+// --- Memory placement: every region is the heap ---
+
+void* memArenaAlloc(MemRegion region, size_t bytes, const char* owner, size_t align) {
+    (void)region;
+    (void)owner;
+    (void)align; // calloc's alignment covers every caller
+    return calloc(1, bytes);
+}
+
+// --- Queues ---
+
+struct HostQueue {
+    uint8_t* items;
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    HostQueue* queue = (HostQueue*)calloc(1, sizeof(HostQueue));
+    queue->items = (uint8_t*)calloc(length, itemSize);
+    queue->length = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t) {
+    if (queue->count == queue->length) {
+        return pdFALSE;
+    }
+    memcpy(queue->items + ((queue->head + queue->count) % queue->length) * queue->itemSize, item, queue->itemSize);
+    queue->count++;
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t) {
+    if (queue->count == 0) {
+        return pdFALSE;
+    }
+    memcpy(item, queue->items + queue->head * queue->itemSize, queue->itemSize);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    return queue->count;
+}
+
+// --- Card (sd_card.h) ---
+
+bool sdCardBegin() {
+    return s_mounted;
+}
+
+bool sdCardMounted() {
+    return s_mounted;
+}
+
+SdFs& sdCardFs() {
+    return s_fs;
+}
+
+bool sdCardLock(TickType_t) {
+    return true;
+}
+
+void sdCardUnlock() {}
+
+// --- Files ---
+
+void SdFs::setRoot(const char* root) {
+    snprintf(_root, sizeof(_root), "%s", root);
+}
+
+void SdFs::hostPath(const char* path, char* out, size_t size) const {
+    snprintf(out, size, "%s/%s", _root, path[0] == '/' ? path + 1 : path);
+}
+
+FsFile SdFs::open(const char* path, int oflag) {
+    FsFile file;
+    file.open(this, path, oflag);
+    return file;
+}
+
+bool SdFs::remove(const char* path) {
+    char host[512];
+    hostPath(path, host, sizeof(host));
+    return unlink(host) == 0;
+}
+
+bool FsFile::open(SdFs* fs, const char* path, int oflag) {
+    close();
+    fs->hostPath(path, _path, sizeof(_path));
+    const char* slash = strrchr(path, '/');
+    snprintf(_name, sizeof(_name), "%s", slash != nullptr ? slash + 1 : path);
+    struct stat st;
+    if (stat(_path, &st) == 0 && S_ISDIR(st.st_mode)) {
+        _dir = opendir(_path);
+        return _dir != nullptr;
+    }
+    _fd = ::open(_path, oflag, 0644);
+    return _fd >= 0;
+}
+
+bool FsFile::openNext(FsFile* dir, int oflag) {
+    close();
+    if (dir->_dir == nullptr) {
+        return false;
+    }
+    while (struct dirent* entry = readdir((DIR*)dir->_dir)) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        snprintf(_name, sizeof(_name), "%.*s", (int)sizeof(_name) - 1, entry->d_name);
+        snprintf(_path, sizeof(_path), "%.*s/%.*s", 255, dir->_path, (int)sizeof(_name) - 1, entry->d_name);
+        _fd = ::open(_path, oflag);
+        return _fd >= 0;
+    }
+    return false;
+}
+
+bool FsFile::close() {
+    if (_dir != nullptr) {
+        closedir((DIR*)_dir);
+        _dir = nullptr;
+    }
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+    return true;
+}
+
+int FsFile::read(void* buffer, size_t count) {
+    return _fd >= 0 ? (int)::read(_fd, buffer, count) : -1;
+}
+
+size_t FsFile::write(const void* buffer, size_t count) {
+    ssize_t n = _fd >= 0 ? ::write(_fd, buffer, count) : -1;
+    return n > 0 ? (size_t)n : 0;
+}
+
+bool FsFile::seekSet(uint64_t position) {
+    return _fd >= 0 && lseek(_fd, (off_t)position, SEEK_SET) == (off_t)position;
+}
+
+uint64_t FsFile::curPosition() const {
+    return _fd >= 0 ? (uint64_t)lseek(_fd, 0, SEEK_CUR) : 0;
+}
+
+bool FsFile::truncate(uint64_t length) {
+    return _fd >= 0 && ftruncate(_fd, (off_t)length) == 0;
+}
+
+bool FsFile::preAllocate(uint64_t length) {
+    struct stat st;
+    return _fd >= 0 && length > 0 && fstat(_fd, &st) == 0 && st.st_size == 0;
+}
+
+size_t FsFile::getName(char* name, size_t size) const {
+    snprintf(name, size, "%s", _name);
+    return strlen(name);
+}
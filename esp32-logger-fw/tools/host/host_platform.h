@@ -0,0 +1,12 @@
+#ifndef HOST_PLATFORM_H
+#define HOST_PLATFORM_H
+
+#include <stdint.h>
+
+// Controls for the host stand-ins in this directory (Arduino.h, esp_attr.h, esp_timer.h, SdFat.h,
+// and sd_card.h's functions and memArenaAlloc(), implemented in host_platform.cpp)
+
+void hostClockSetUs(uint64_t us);        // millis() and esp_timer_get_time() read this
+void hostSdCardMount(const char* root);  // sdCardBegin() succeeds and "/" is `root` from now on
+
+#endif // HOST_PLATFORM_H
@@ -0,0 +1,139 @@
+// Serves a local directory with the firmware's HTTP file server core (src/http_file_server.cpp),
+// for trying the Wi-Fi offload protocol against ordinary HTTP clients without the device.
+//
+//   g++ -std=c++17 -O2 -Iinclude tools/http_serve_host.cpp src/http_file_server.cpp -o http_serve_host
+//   ./http_serve_host ./logs 8080
+//   curl -O -C - http://127.0.0.1:8080/log_000.bin
+#include "http_file_server.h"
+
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+class DirectorySource : public HttpFileSource {
+public:
+    explicit DirectorySource(const char* root) : _root(root), _file(nullptr), _dir(nullptr) {}
+
+    bool open(const char* name, uint64_t* size) override {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s", _root, name);
+        struct stat st;
+        if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) return false;
+        _file = fopen(path, "rb");
+        *size = (uint64_t)st.st_size;
+        return _file != nullptr;
+    }
+    bool seek(uint64_t offset) override { return fseeko(_file, (off_t)offset, SEEK_SET) == 0; }
+    int32_t read(uint8_t* buffer, uint32_t length) override {
+        size_t n = fread(buffer, 1, length, _file);
+        return n > 0 ? (int32_t)n : -1;
+    }
+    void close() override {
+        if (_file) fclose(_file);
+        _file = nullptr;
+    }
+
+    bool listBegin() override { return (_dir = opendir(_root)) != nullptr; }
+    bool listNext(char* name, size_t nameSize, uint64_t* size) override {
+        while (struct dirent* entry = readdir(_dir)) {
+            char path[512];
+            snprintf(path, sizeof(path), "%s/%s", _root, entry->d_name);
+            struct stat st;
+            if (entry->d_name[0] == '.' || stat(path, &st) != 0 || !S_ISREG(st.st_mode)) continue;
+            snprintf(name, nameSize, "%s", entry->d_name);
+            *size = (uint64_t)st.st_size;
+            return true;
+        }
+        return false;
+    }
+    void listEnd() override {
+        if (_dir) closedir(_dir);
+        _dir = nullptr;
+    }
+
+private:
+    const char* _root;
+    FILE* _file;
+    DIR* _dir;
+};
+
+class SocketSink : public HttpByteSink {
+public:
+    explicit SocketSink(int fd) : _fd(fd) {}
+    bool write(const uint8_t* data, size_t length) override {
+        while (length > 0) {
+            ssize_t n = send(_fd, data, length, MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            data += n;
+            length -= (size_t)n;
+        }
+        return true;
+    }
+
+private:
+    int _fd;
+};
+
+static double nowSeconds() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <directory> [port]\n", argv[0]);
+        return 1;
+    }
+    int port = argc > 2 ? atoi(argv[2]) : 8080;
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (bind(server, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(server, 4) != 0) {
+        perror("bind/listen");
+        return 1;
+    }
+    fprintf(stderr, "Serving %s on http://127.0.0.1:%d/\n", argv[1], port);
+
+    DirectorySource source(argv[1]);
+    static uint8_t buffer[16384];
+    HttpFileServer http(source, buffer, sizeof(buffer));
+
+    for (;;) {
+        int client = accept(server, nullptr, nullptr);
+        if (client < 0) continue;
+        char head[HTTP_MAX_HEAD];
+        size_t used = 0;
+        size_t headEnd = 0;
+        while (used < sizeof(head) && (headEnd = httpFindHeadEnd(head, used)) == 0) {
+            ssize_t n = recv(client, head + used, sizeof(head) - used, 0);
+            if (n <= 0) break;
+            used += (size_t)n;
+        }
+        SocketSink sink(client);
+        HttpRequest request;
+        if (headEnd == 0 || !httpParseRequest(head, headEnd, &request)) {
+            http.sendError(sink, 400);
+        } else {
+            double start = nowSeconds();
+            HttpTransferResult result = http.handle(request, sink);
+            double elapsed = nowSeconds() - start;
+            fprintf(stderr, "%s %s -> %d, %llu bytes in %.3f s (%.2f MB/s)\n", request.method, request.path,
+                    result.status, (unsigned long long)result.body_bytes, elapsed,
+                    elapsed > 0 ? result.body_bytes / elapsed / 1e6 : 0.0);
+        }
+        shutdown(client, SHUT_WR);
+        close(client);
+    }
+}
@@ -0,0 +1,92 @@
+// Decodes a log file to CSV or JSON lines with the record layout compiled from
+// include/log_schema.h, refusing files whose embedded schema blob differs from it
+// (tools/log_schema.py decodes any schema version from the blob instead).
+//
+//   g++ -std=c++17 -O2 -Iinclude tools/log_decode_host.cpp src/log_schema.cpp -o log_decode_host
+//   ./log_decode_host log_000.bin > ride.csv
+//   ./log_decode_host log_000.bin --json
+#include "log_schema.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool s_json = false;
+
+static void printFloat(double v, const char* format) {
+    if (s_json && !isfinite(v)) {
+        fputs("null", stdout); // Unused analog channels are NAN
+    } else {
+        printf(format, v);
+    }
+}
+
+static void printElement(const LogFieldInfo& field, const uint8_t* p) {
+    switch (field.type) {
+        case LOG_TYPE_U8: printf("%u", *p); break;
+        case LOG_TYPE_I8: printf("%d", (int8_t)*p); break;
+        case LOG_TYPE_U16: { uint16_t v; memcpy(&v, p, 2); printf("%u", v); break; }
+        case LOG_TYPE_I16: { int16_t v; memcpy(&v, p, 2); printf("%d", v); break; }
+        case LOG_TYPE_U32: { uint32_t v; memcpy(&v, p, 4); printf("%u", v); break; }
+        case LOG_TYPE_I32: { int32_t v; memcpy(&v, p, 4); printf("%d", v); break; }
+        case LOG_TYPE_F32: { float v; memcpy(&v, p, 4); printFloat(v * field.scale, "%.7g"); break; }
+        case LOG_TYPE_F64: { double v; memcpy(&v, p, 8); printFloat(v * field.scale, "%.15g"); break; }
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <log.bin> [--json]\n", argv[0]);
+        return 2;
+    }
+    bool json = s_json = argc > 2 && strcmp(argv[2], "--json") == 0;
+    FILE* file = fopen(argv[1], "rb");
+    if (file == nullptr) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    static uint8_t expected[LOG_SCHEMA_BLOB_MAX];
+    size_t blobLength = logSchemaWriteBlob(expected, sizeof(expected));
+    static uint8_t blob[LOG_SCHEMA_BLOB_MAX];
+    if (blobLength == 0 || fread(blob, 1, blobLength, file) != blobLength || memcmp(blob, expected, blobLength) != 0) {
+        fprintf(stderr, "%s: schema blob does not match schema version %d; use tools/log_schema.py\n", argv[1],
+                LOG_SCHEMA_VERSION);
+        fclose(file);
+        return 1;
+    }
+
+    if (!json) {
+        static char header[2048];
+        if (logSchemaCsvHeader(header, sizeof(header)) == 0) {
+            fprintf(stderr, "CSV header does not fit\n");
+            return 1;
+        }
+        puts(header);
+    }
+
+    uint8_t record[sizeof(LogRecordV1)];
+    unsigned long records = 0;
+    while (fread(record, 1, sizeof(record), file) == sizeof(record)) {
+        if (json) putchar('{');
+        bool first = true;
+        for (size_t i = 0; i < LOG_RECORD_V1_FIELD_COUNT; i++) {
+            const LogFieldInfo& field = LOG_RECORD_V1_SCHEMA[i];
+            if (json) {
+                printf("%s\"%s\":%s", i > 0 ? "," : "", field.name, field.count > 1 ? "[" : "");
+            }
+            for (uint8_t element = 0; element < field.count; element++) {
+                if (json ? element > 0 : !first) putchar(',');
+                first = false;
+                printElement(field, record + field.offset + element * field.element_size);
+            }
+            if (json && field.count > 1) putchar(']');
+        }
+        puts(json ? "}" : "");
+        records++;
+    }
+    fclose(file);
+    fprintf(stderr, "%lu records\n", records);
+    return 0;
+}
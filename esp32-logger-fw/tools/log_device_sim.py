@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+"""Pseudo-terminal stand-in for the logger's `ls`/`get` protocol, for exercising log_download.py
+without hardware.
+
+    log_device_sim.py ./some_logs --corrupt-every 50 &
+    log_download.py --port /dev/pts/N get log_000.bin
+
+Prints the pty path, then answers commands like the firmware's terminal (include/log_download.h),
+including the "Received command" echo before each answer. --corrupt-every flips one bit in every
+Nth data frame and --drop-every drops every Nth data frame, to exercise the client's recovery.
+"""
+import argparse
+import os
+import struct
+import sys
+import tty
+import zlib
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from frame_codec import encode_frame  # noqa: E402
+
+CHUNK = 4096   # LOG_DOWNLOAD_CHUNK_BYTES
+
+
+class Device:
+    def __init__(self, fd, directory, corrupt_every, drop_every):
+        self.fd = fd
+        self.directory = directory
+        self.corrupt_every = corrupt_every
+        self.drop_every = drop_every
+        self.seq = 0
+        self.data_frames = 0
+
+    def write(self, data):
+        view = memoryview(data)
+        while view:
+            written = os.write(self.fd, view)
+            view = view[written:]
+
+    def frame(self, ftype, payload):
+        self.write(encode_frame(ftype, self.seq, payload))
+        self.seq += 1
+
+    def data_frame(self, payload):
+        self.data_frames += 1
+        encoded = bytearray(encode_frame(0x42, self.seq, payload))
+        self.seq += 1
+        if self.drop_every and self.data_frames % self.drop_every == 0:
+            return
+        if self.corrupt_every and self.data_frames % self.corrupt_every == 0:
+            index = len(encoded) // 2
+            encoded[index] ^= 0x01 if encoded[index] != 0x01 else 0x02
+        self.write(bytes(encoded))
+
+    def command(self, line):
+        self.write(b"\r\nReceived command: " + line.encode() + b"\r\n")
+        parts = line.split()
+        if not parts:
+            return
+        if parts[0] == "ls":
+            names = sorted(n for n in os.listdir(self.directory) if os.path.isfile(os.path.join(self.directory, n)))
+            total = 0
+            text = "Files in /:\r\n"
+            for name in names:
+                size = os.path.getsize(os.path.join(self.directory, name))
+                total += size
+                text += "  %-32s %10d\r\n" % (name, size)
+            text += "%d files, %d bytes\r\n" % (len(names), total)
+            self.write(text.encode())
+        elif parts[0] == "get" and len(parts) >= 2:
+            self.get(parts[1], int(parts[2]) if len(parts) > 2 else 0, int(parts[3]) if len(parts) > 3 else 0)
+        else:
+            self.write(b"Unknown command: " + parts[0].encode() + b"\r\n")
+
+    def get(self, name, offset, length):
+        self.write(b"\x00")
+        path = os.path.join(self.directory, name)
+        if "/" in name or not os.path.isfile(path):
+            self.frame(0x44, b"file not found")
+            return
+        size = os.path.getsize(path)
+        if offset > size:
+            self.frame(0x44, b"offset beyond end of file")
+            return
+        remaining = size - offset if length == 0 else min(length, size - offset)
+        self.frame(0x41, struct.pack("<III", offset, remaining, size))
+        crc = 0
+        with open(path, "rb") as f:
+            f.seek(offset)
+            while remaining > 0:
+                chunk = f.read(min(CHUNK, remaining))
+                crc = zlib.crc32(chunk, crc)
+                self.data_frame(struct.pack("<I", offset) + chunk)
+                offset += len(chunk)
+                remaining -= len(chunk)
+        self.frame(0x43, struct.pack("<II", offset, crc & 0xFFFFFFFF))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("directory", help="Directory served as the SD card's log directory")
+    parser.add_argument("--corrupt-every", type=int, default=0)
+    parser.add_argument("--drop-every", type=int, default=0)
+    args = parser.parse_args()
+
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    print(os.ttyname(slave), flush=True)
+    device = Device(master, args.directory, args.corrupt_every, args.drop_every)
+    line = b""
+    try:
+        while True:
+            data = os.read(master, 4096)
+            for byte in data:
+                if byte in (0x0A, 0x0D):
+                    if line:
+                        device.command(line.decode(errors="replace"))
+                    line = b""
+                else:
+                    line += bytes([byte])
+    except (KeyboardInterrupt, OSError):
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,245 @@
+#!/usr/bin/env python3
+"""Downloads log files from the logger over the USB CDC serial link.
+
+    log_download.py --port /dev/ttyACM0 list
+    log_download.py --port /dev/ttyACM0 get log_003.bin [-o log_003.bin]
+
+`get` resumes a partial local file from its current size (use --restart to start over). Requests
+cover --window bytes each and --depth of them are kept queued on the device, so the link never
+waits for a round trip. Every chunk is CRC-checked and carries its file offset, so chunks after a
+lost or corrupted one are still kept and only the missing ranges are requested again. See include/log_download.h for the protocol; log_device_sim.py serves
+a local directory over a pseudo-terminal with the same protocol for testing this client.
+"""
+import argparse
+import collections
+import os
+import re
+import struct
+import sys
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from frame_codec import FrameError, FrameSplitter, decode_frame  # noqa: E402
+
+DL_FRAME_INFO = 0x41
+DL_FRAME_DATA = 0x42
+DL_FRAME_END = 0x43
+DL_FRAME_ERROR = 0x44
+
+INFO = struct.Struct("<III")
+END = struct.Struct("<II")
+OFFSET = struct.Struct("<I")
+
+QUIET_S = 0.5       # Line silent this long with requests outstanding: their answers were lost
+STALL_S = 10.0      # No new data at all for this long: give up
+
+
+class DownloadError(Exception):
+    pass
+
+
+class Link:
+    def __init__(self, port, baud):
+        import serial
+        self.serial = serial.Serial(port, baud, timeout=0.05)
+        self.splitter = FrameSplitter()
+
+    def send(self, line):
+        self.serial.write(line.encode() + b"\n")
+
+    def read(self):
+        return self.serial.read(65536)
+
+    def drain_input(self):
+        self.serial.reset_input_buffer()
+        self.splitter = FrameSplitter()
+
+
+class Ranges:
+    """Sorted, merged [start, end) byte ranges already written to the local file."""
+
+    def __init__(self):
+        self.ranges = []
+
+    def add(self, start, end):
+        merged = []
+        for s, e in self.ranges:
+            if e < start or s > end:
+                merged.append((s, e))
+            else:
+                start, end = min(s, start), max(e, end)
+        merged.append((start, end))
+        self.ranges = sorted(merged)
+
+    def missing(self, start, end):
+        holes = []
+        for s, e in self.ranges:
+            if e <= start or s >= end:
+                continue
+            if s > start:
+                holes.append((start, s))
+            start = max(start, e)
+        if start < end:
+            holes.append((start, end))
+        return holes
+
+    def prefix_end(self, start):
+        for s, e in self.ranges:
+            if s <= start < e:
+                return e
+        return start
+
+
+def list_files(link, timeout=5.0):
+    link.drain_input()
+    link.send("ls")
+    text = b""
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        text += link.read()
+        if re.search(rb"^\d+ files, \d+ bytes", text, re.M) or b"not available" in text or b"not found" in text:
+            break
+    files = []
+    for match in re.finditer(rb"^  (\S+)\s+(\d+)\r?$", text, re.M):
+        files.append((match.group(1).decode(), int(match.group(2))))
+    if not files and b"files," not in text:
+        raise DownloadError(text.decode(errors="replace").strip() or "no answer to ls")
+    return files
+
+
+def download(link, name, path, window, depth, restart, progress=True):
+    """Fetches `name` into `path`, resuming from the local file's size. Returns (bytes, re-requests)."""
+    mode = "wb" if restart or not os.path.exists(path) else "r+b"
+    out = open(path, mode)
+    out.seek(0, os.SEEK_END)
+    resume_from = out.tell()
+    have = Ranges()
+    if resume_from:
+        have.add(0, resume_from)
+
+    file_size = None
+    todo = collections.deque([(resume_from, None)])  # (offset, length); None = one window
+    pending = collections.deque()                     # Requests queued on the device, in order
+    rerequests = 0
+    last_byte_time = last_data_time = started = time.monotonic()
+
+    link.drain_input()
+
+    def finish_requests(upto):
+        """Requests before index `upto` are fully answered: re-request whatever they lost."""
+        nonlocal rerequests
+        for _ in range(upto):
+            offset, length = pending.popleft()
+            holes = have.missing(offset, offset + length)
+            rerequests += len(holes)
+            for hole in reversed(holes):
+                todo.appendleft((hole[0], hole[1] - hole[0]))
+
+    def request_index(offset):
+        for i, (start, length) in enumerate(pending):
+            if start <= offset < start + length:
+                return i
+        return None
+
+    try:
+        while True:
+            done = file_size is not None and not have.missing(0, file_size)
+            if done:
+                break
+            # Keep `depth` requests queued; plain windows only once the size is known
+            while todo and len(pending) < depth:
+                offset, length = todo[0]
+                if length is None:
+                    if file_size is not None and offset >= file_size:
+                        todo.popleft()
+                        continue
+                    if file_size is None and pending:
+                        break
+                    length = window if file_size is None else min(window, file_size - offset)
+                    todo[0] = (offset + length, None)
+                else:
+                    todo.popleft()
+                link.send("get %s %d %d" % (name, offset, length))
+                pending.append((offset, length))
+
+            data = link.read()
+            now = time.monotonic()
+            if data:
+                last_byte_time = now
+            elif pending and now - last_byte_time > QUIET_S:
+                finish_requests(len(pending))  # Answers (or their END frames) were lost
+                last_byte_time = now
+            if now - last_data_time > STALL_S:
+                raise DownloadError("transfer stalled")
+
+            for block in link.splitter.feed(data):
+                try:
+                    ftype, _seq, payload = decode_frame(block)
+                except FrameError:
+                    continue  # Terminal echo text or a damaged frame; lost bytes are re-requested
+                if ftype == DL_FRAME_ERROR:
+                    raise DownloadError(payload.decode(errors="replace"))
+                if ftype == DL_FRAME_INFO:
+                    offset, length, file_size = INFO.unpack(payload)
+                    index = request_index(offset) if length else None
+                    if index:
+                        finish_requests(index)
+                    elif length == 0 and pending and pending[0][0] == offset:
+                        pending.popleft()  # Nothing left to send at this offset
+                elif ftype == DL_FRAME_DATA:
+                    (offset,) = OFFSET.unpack_from(payload)
+                    chunk = payload[OFFSET.size:]
+                    index = request_index(offset)
+                    if index:
+                        finish_requests(index)
+                    out.seek(offset)
+                    out.write(chunk)
+                    have.add(offset, offset + len(chunk))
+                    last_data_time = now
+                elif ftype == DL_FRAME_END:
+                    end_offset, _crc = END.unpack(payload)
+                    index = request_index(end_offset - 1)
+                    if index is not None:
+                        finish_requests(index + 1)
+
+            if progress and file_size:
+                received = have.prefix_end(0)
+                rate = (received - resume_from) / max(time.monotonic() - started, 1e-6) / 1e6
+                sys.stderr.write("\r%s: %d/%d bytes (%.0f%%), %.2f MB/s, %d re-requests " %
+                                 (name, received, file_size, 100.0 * received / max(file_size, 1), rate, rerequests))
+    finally:
+        # Keep only the verified prefix so a later run resumes from a clean point
+        out.truncate(have.prefix_end(0))
+        out.close()
+        if progress:
+            sys.stderr.write("\n")
+    return have.prefix_end(0), rerequests
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", required=True, help="Serial port of the logger (or log_device_sim.py's pty)")
+    parser.add_argument("--baud", type=int, default=115200)
+    sub = parser.add_subparsers(dest="command", required=True)
+    sub.add_parser("list", help="List the log files")
+    get = sub.add_parser("get", help="Download (or resume) a file")
+    get.add_argument("name")
+    get.add_argument("-o", "--output", help="Local file (default: same name)")
+    get.add_argument("--window", type=int, default=256 * 1024, help="Bytes per request")
+    get.add_argument("--depth", type=int, default=3, help="Requests kept queued on the device")
+    get.add_argument("--restart", action="store_true", help="Ignore an existing partial file")
+    args = parser.parse_args()
+
+    link = Link(args.port, args.baud)
+    try:
+        if args.command == "list":
+            for name, size in list_files(link):
+                print("%-32s %12d" % (name, size))
+        else:
+            download(link, args.name, args.output or args.name, args.window, args.depth, args.restart)
+    except DownloadError as error:
+        sys.exit("error: %s" % error)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""Log record schema for host tools (include/log_schema.h is the single source).
+
+Every log file starts with the schema blob the firmware wrote for it, so files are decoded from
+their own description rather than from a layout copied into this script:
+    magic "LGS1", uint16 blob_length, uint16 schema_version, uint16 record_size,
+    uint8 field_count, uint8 reserved, then per field
+    uint8 type, uint8 count, uint16 offset, float scale, uint8 name_len, name, uint8 unit_len, unit
+followed directly by the records. For data without a blob (the live telemetry stream) the
+schema is read from the LOG_RECORD_V1_FIELDS table in include/log_schema.h.
+
+Examples:
+    log_schema.py log_000.bin --format csv > ride.csv
+    log_schema.py log_000.bin --format json
+    log_schema.py --header          # the schema compiled into the current source tree
+"""
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+
+MAGIC = b"LGS1"
+BLOB_HEADER = struct.Struct("<4sHHHBB")
+FIELD_HEADER = struct.Struct("<BBHf")
+
+# Type code -> (name, struct character); must match LogFieldType in log_schema.h
+TYPES = {1: ("u8", "B"), 2: ("i8", "b"), 3: ("u16", "H"), 4: ("i16", "h"),
+         5: ("u32", "I"), 6: ("i32", "i"), 7: ("f32", "f"), 8: ("f64", "d")}
+C_TYPES = {"uint8_t": 1, "int8_t": 2, "uint16_t": 3, "int16_t": 4,
+           "uint32_t": 5, "int32_t": 6, "float": 7, "double": 8}
+
+DEFAULT_HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "include", "log_schema.h")
+
+
+class SchemaError(ValueError):
+    pass
+
+
+class Field:
+    def __init__(self, name, type_code, count, offset, scale, unit):
+        if type_code not in TYPES:
+            raise SchemaError("unknown type code %d for %s" % (type_code, name))
+        self.name = name
+        self.type_code = type_code
+        self.count = count
+        self.offset = offset
+        self.scale = scale
+        self.unit = unit
+
+    @property
+    def size(self):
+        return struct.calcsize("<" + TYPES[self.type_code][1]) * self.count
+
+
+class Schema:
+    def __init__(self, version, record_size, fields):
+        self.version = version
+        self.record_size = record_size
+        self.fields = fields
+        fmt = "<"
+        position = 0
+        for field in fields:
+            if field.offset < position:
+                raise SchemaError("field %s overlaps the previous one" % field.name)
+            fmt += "%dx" % (field.offset - position) if field.offset > position else ""
+            fmt += "%d%s" % (field.count, TYPES[field.type_code][1])
+            position = field.offset + field.size
+        fmt += "%dx" % (record_size - position) if record_size > position else ""
+        self.struct = struct.Struct(fmt)
+        if self.struct.size != record_size:
+            raise SchemaError("fields cover %d bytes, record is %d" % (self.struct.size, record_size))
+
+    def columns(self):
+        names = []
+        for field in self.fields:
+            unit = "[%s]" % field.unit if field.unit else ""
+            if field.count == 1:
+                names.append(field.name + unit)
+            else:
+                names.extend("%s%d%s" % (field.name, i, unit) for i in range(field.count))
+        return names
+
+    def decode(self, record):
+        """One record as a dict; arrays become lists, scaled values are applied."""
+        values = self.struct.unpack(record[:self.record_size])
+        row = {}
+        i = 0
+        for field in self.fields:
+            chunk = values[i:i + field.count]
+            i += field.count
+            if field.scale != 1.0:
+                chunk = tuple(v * field.scale for v in chunk)
+            row[field.name] = chunk[0] if field.count == 1 else list(chunk)
+        return row
+
+    def to_json(self):
+        return {"version": self.version, "record_size": self.record_size,
+                "fields": [{"name": f.name, "type": TYPES[f.type_code][0], "count": f.count,
+                            "offset": f.offset, "scale": f.scale, "unit": f.unit} for f in self.fields]}
+
+
+def parse_blob(data):
+    """Returns (schema, blob_length) for the blob at the start of `data`."""
+    if len(data) < BLOB_HEADER.size:
+        raise SchemaError("file too short for a schema blob")
+    magic, blob_length, version, record_size, count, _ = BLOB_HEADER.unpack_from(data)
+    if magic != MAGIC:
+        raise SchemaError("no schema blob (magic %r)" % magic)
+    pos = BLOB_HEADER.size
+    fields = []
+    for _ in range(count):
+        type_code, elements, offset, scale = FIELD_HEADER.unpack_from(data, pos)
+        pos += FIELD_HEADER.size
+        strings = []
+        for _ in range(2):
+            length = data[pos]
+            strings.append(data[pos + 1:pos + 1 + length].decode("ascii"))
+            pos += 1 + length
+        fields.append(Field(strings[0], type_code, elements, offset, scale, strings[1]))
+    if pos != blob_length:
+        raise SchemaError("blob length %d, fields end at %d" % (blob_length, pos))
+    return Schema(version, record_size, fields), blob_length
+
+
+def from_header(path=DEFAULT_HEADER):
+    """Schema from the LOG_RECORD_V1_FIELDS table in the firmware header."""
+    with open(path) as f:
+        text = f.read()
+    version = int(re.search(r"#define LOG_SCHEMA_VERSION (\d+)", text).group(1))
+    table = text[text.index("#define LOG_RECORD_V1_FIELDS"):]
+    table = table[:table.index("\n\n")]
+    fields = []
+    offset = 0
+    for m in re.finditer(r"\b([FA])\((\w+), (\w+), (?:(\d+), )?([\d.]+)f?, \"([^\"]*)\"\)", table):
+        kind, name, ctype, count, scale, unit = m.groups()
+        if ctype not in C_TYPES:
+            raise SchemaError("unsupported C type %s for %s" % (ctype, name))
+        field = Field(name, C_TYPES[ctype], int(count) if kind == "A" else 1, offset, float(scale), unit)
+        fields.append(field)
+        offset += field.size
+    return Schema(version, offset, fields)
+
+
+def decode_file(path):
+    """Yields (schema, row) for every complete record in a log file."""
+    with open(path, "rb") as f:
+        data = f.read()
+    schema, pos = parse_blob(data)
+    while pos + schema.record_size <= len(data):
+        yield schema, schema.decode(data[pos:pos + schema.record_size])
+        pos += schema.record_size
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("file", nargs="?", help="Log file (.bin) starting with a schema blob")
+    parser.add_argument("--format", choices=("csv", "json"), default="csv")
+    parser.add_argument("--header", action="store_true", help="Print the schema from include/log_schema.h")
+    args = parser.parse_args()
+
+    if args.header or not args.file:
+        print(json.dumps(from_header().to_json(), indent=2))
+        return
+    header_done = False
+    for schema, row in decode_file(args.file):
+        if args.format == "json":
+            print(json.dumps(row))
+            continue
+        if not header_done:
+            print(",".join(schema.columns()))
+            header_done = True
+        flat = []
+        for value in row.values():
+            flat.extend(value if isinstance(value, list) else [value])
+        print(",".join(str(v) for v in flat))
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+"""Reads the level-of-detail sidecar (log_NNN.lod) written next to each log (include/log_summary.h).
+
+Layout: header, then the log's schema blob (channel names come from it), then one region per
+level, coarsest first:
+    magic "LOD1", uint16 header_length, uint16 bucket_size, uint16 channel_count,
+    uint8 level_count, uint8 flags, uint32 t0_ms, per level
+    uint32 period_ms, uint32 offset, uint32 capacity, uint32 count
+Each bucket is uint32 start_ms, uint32 records, then per channel float min, max, mean. Channels
+are the schema elements in record order without system_timestamp_ms. Reading a level only reads
+the header and that region.
+
+--verify aggregates the records of the .bin by brute force and compares every bucket of every
+level with the sidecar: record counts and min/max exactly, means to float precision.
+
+Examples:
+    log_summary.py log_000.lod                      # levels and channels
+    log_summary.py log_000.lod --level 60 > overview.csv
+    log_summary.py log_000.lod --level 1 --format json
+    log_summary.py log_000.lod --verify log_000.bin
+"""
+import argparse
+import json
+import math
+import struct
+import sys
+
+import log_schema
+
+MAGIC = b"LOD1"
+HEADER = struct.Struct("<4sHHHBBI")
+LEVEL = struct.Struct("<IIII")
+BUCKET_HEAD = struct.Struct("<II")
+FLAG_COMPLETE = 0x01
+FLAG_OVERFLOW = 0x02
+
+
+class Level:
+    def __init__(self, period_ms, offset, capacity, count):
+        self.period_ms = period_ms
+        self.offset = offset
+        self.capacity = capacity
+        self.count = count
+
+
+class Summary:
+    """Header of a sidecar; levels are read on demand with read_level()."""
+
+    def __init__(self, path):
+        self.path = path
+        with open(path, "rb") as f:
+            head = f.read(HEADER.size)
+            if len(head) < HEADER.size:
+                raise log_schema.SchemaError("file too short for a summary header")
+            (magic, self.header_length, self.bucket_size, self.channel_count, level_count,
+             self.flags, self.t0_ms) = HEADER.unpack(head)
+            if magic != MAGIC:
+                raise log_schema.SchemaError("not a summary sidecar (magic %r)" % magic)
+            rest = f.read(self.header_length - HEADER.size)
+        self.levels = [Level(*LEVEL.unpack_from(rest, i * LEVEL.size)) for i in range(level_count)]
+        self.schema, _ = log_schema.parse_blob(rest[level_count * LEVEL.size:])
+        self.channels = channel_names(self.schema)
+        if len(self.channels) != self.channel_count:
+            raise log_schema.SchemaError("%d channels in the header, %d in the schema"
+                                         % (self.channel_count, len(self.channels)))
+        if self.bucket_size != BUCKET_HEAD.size + 12 * self.channel_count:
+            raise log_schema.SchemaError("bucket size %d does not fit %d channels"
+                                         % (self.bucket_size, self.channel_count))
+        self.body = struct.Struct("<%df" % (3 * self.channel_count))
+
+    def level(self, period_s):
+        for level in self.levels:
+            if level.period_ms == int(period_s * 1000):
+                return level
+        raise KeyError("no %g s level (have %s)" % (period_s, ", ".join("%g" % (l.period_ms / 1000) for l in self.levels)))
+
+    def read_level(self, level):
+        """List of (start_ms, records, [(min, max, mean) per channel]) for one level."""
+        with open(self.path, "rb") as f:
+            f.seek(level.offset)
+            data = f.read(level.count * self.bucket_size)
+        buckets = []
+        for pos in range(0, len(data) - self.bucket_size + 1, self.bucket_size):
+            start_ms, records = BUCKET_HEAD.unpack_from(data, pos)
+            values = self.body.unpack_from(data, pos + BUCKET_HEAD.size)
+            buckets.append((start_ms, records, [values[i:i + 3] for i in range(0, len(values), 3)]))
+        return buckets
+
+
+def channel_names(schema):
+    names = []
+    for field in schema.fields[1:]:
+        if field.count == 1:
+            names.append(field.name)
+        else:
+            names.extend("%s%d" % (field.name, i) for i in range(field.count))
+    return names
+
+
+def channel_values(schema, row):
+    values = []
+    for field in schema.fields[1:]:
+        value = row[field.name]
+        values.extend(value if isinstance(value, list) else [value])
+    return values
+
+
+def brute_force(log_path, period_ms):
+    """Aggregates one level straight from the records: {start_ms: (records, [values per channel])}."""
+    buckets = {}
+    t0 = None
+    last_start = None
+    for schema, row in log_schema.decode_file(log_path):
+        t = row[schema.fields[0].name]
+        if t0 is None:
+            t0 = t
+        start = (t0 + ((t - t0) & 0xFFFFFFFF) // period_ms * period_ms) & 0xFFFFFFFF  # uint32 like the clock
+        if last_start is not None and ((start - last_start) & 0x80000000):
+            start = last_start  # Clock stepped back: the firmware folds it into the open bucket
+        last_start = start
+        records, channels = buckets.setdefault(start, [0, None])
+        values = channel_values(schema, row)
+        if channels is None:
+            channels = [[] for _ in values]
+            buckets[start][1] = channels
+        buckets[start][0] += 1
+        for i, value in enumerate(values):
+            value = struct.unpack("<f", struct.pack("<f", value))[0]  # As the firmware sees it
+            if not math.isnan(value):
+                channels[i].append(value)
+    return buckets
+
+
+def verify(summary, log_path):
+    """Returns a list of mismatch descriptions (empty when the sidecar matches the log)."""
+    problems = []
+    for level in summary.levels:
+        expected = brute_force(log_path, level.period_ms)
+        got = summary.read_level(level)
+        label = "%g s" % (level.period_ms / 1000)
+        if len(got) != len(expected):
+            problems.append("%s: %d buckets, expected %d" % (label, len(got), len(expected)))
+        for start_ms, records, channels in got:
+            if start_ms not in expected:
+                problems.append("%s: unexpected bucket at %d ms" % (label, start_ms))
+                continue
+            want_records, want_channels = expected[start_ms]
+            if records != want_records:
+                problems.append("%s @%d: %d records, expected %d" % (label, start_ms, records, want_records))
+            for name, (lo, hi, mean), values in zip(summary.channels, channels, want_channels):
+                if not values:
+                    if not (math.isnan(lo) and math.isnan(hi) and math.isnan(mean)):
+                        problems.append("%s @%d %s: expected NAN" % (label, start_ms, name))
+                    continue
+                want_mean = sum(values) / len(values)
+                tolerance = 1e-5 * max(abs(min(values)), abs(max(values)), 1.0)
+                if lo != min(values) or hi != max(values) or abs(mean - want_mean) > tolerance:
+                    problems.append("%s @%d %s: %g/%g/%g, expected %g/%g/%g"
+                                    % (label, start_ms, name, lo, hi, mean, min(values), max(values), want_mean))
+    return problems
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("file", help="Summary sidecar (.lod)")
+    parser.add_argument("--level", type=float, help="Print the buckets of this level (seconds)")
+    parser.add_argument("--format", choices=("csv", "json"), default="csv")
+    parser.add_argument("--verify", metavar="LOG", help="Compare against a brute-force aggregation of this .bin")
+    args = parser.parse_args()
+
+    summary = Summary(args.file)
+    if args.verify:
+        problems = verify(summary, args.verify)
+        for problem in problems[:50]:
+            print(problem)
+        print("%s: %s" % (args.file, "%d mismatches" % len(problems) if problems else "matches the log"))
+        return 1 if problems else 0
+
+    if args.level is None:
+        state = "complete" if summary.flags & FLAG_COMPLETE else "not closed (counts may be short)"
+        print("%s: %s, t0 %d ms, %d channels%s" % (args.file, state, summary.t0_ms, summary.channel_count,
+                                                   ", a level overflowed" if summary.flags & FLAG_OVERFLOW else ""))
+        for level in summary.levels:
+            print("  %6g s: %d buckets (room for %d)" % (level.period_ms / 1000, level.count, level.capacity))
+        print("Channels: " + ", ".join(summary.channels))
+        return 0
+
+    buckets = summary.read_level(summary.level(args.level))
+    if args.format == "csv":
+        columns = ["start_ms", "records"]
+        for name in summary.channels:
+            columns += [name + "_min", name + "_max", name + "_mean"]
+        print(",".join(columns))
+    for start_ms, records, channels in buckets:
+        if args.format == "json":
+            print(json.dumps({"start_ms": start_ms, "records": records,
+                              "channels": {name: [None if math.isnan(v) else v for v in values]
+                                           for name, values in zip(summary.channels, channels)}}))
+        else:
+            print(",".join([str(start_ms), str(records)] + ["%.7g" % v for values in channels for v in values]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,96 @@
+// Builds the .lod summary sidecar (include/log_summary.h) for an existing log file with the same
+// aggregation code the firmware runs, e.g. for logs recorded before the sidecar existed or to
+// check a card's .lod against its .bin (tools/log_summary.py --verify compares either against a
+// brute-force aggregation of the records).
+//
+//   g++ -std=c++17 -O2 -Iinclude tools/log_summary_host.cpp src/log_summary.cpp src/log_schema.cpp -o log_summary_host
+//   ./log_summary_host log_000.bin log_000.lod
+#include "log_summary.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct Output {
+    FILE* file;
+    LogSummaryFileHeader header;
+};
+
+static void writeBucket(void* context, uint8_t level, const LogSummaryBucket& bucket) {
+    Output* output = (Output*)context;
+    LogSummaryLevelInfo& info = output->header.levels[level];
+    if (info.count >= info.capacity) {
+        output->header.flags |= LOG_SUMMARY_FLAG_OVERFLOW;
+        return;
+    }
+    uint8_t encoded[LOG_SUMMARY_BUCKET_SIZE];
+    logSummaryEncodeBucket(bucket, encoded);
+    fseek(output->file, info.offset + info.count * LOG_SUMMARY_BUCKET_SIZE, SEEK_SET);
+    fwrite(encoded, 1, sizeof(encoded), output->file);
+    info.count++;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <log.bin> <out.lod>\n", argv[0]);
+        return 2;
+    }
+    FILE* in = fopen(argv[1], "rb");
+    if (in == nullptr) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    static uint8_t expected[LOG_SCHEMA_BLOB_MAX];
+    size_t blobLength = logSchemaWriteBlob(expected, sizeof(expected));
+    static uint8_t blob[LOG_SCHEMA_BLOB_MAX];
+    if (blobLength == 0 || fread(blob, 1, blobLength, in) != blobLength || memcmp(blob, expected, blobLength) != 0) {
+        fprintf(stderr, "%s: schema blob does not match schema version %d\n", argv[1], LOG_SCHEMA_VERSION);
+        fclose(in);
+        return 1;
+    }
+
+    // First pass for the time span, so the regions are sized to this log
+    uint8_t record[LOG_RECORD_V1_SIZE];
+    uint32_t first = 0, last = 0;
+    unsigned long records = 0;
+    while (fread(record, 1, sizeof(record), in) == sizeof(record)) {
+        memcpy(&last, record, sizeof(last));
+        if (records++ == 0) {
+            first = last;
+        }
+    }
+
+    Output output;
+    output.file = fopen(argv[2], "wb");
+    if (output.file == nullptr) {
+        perror(argv[2]);
+        fclose(in);
+        return 1;
+    }
+    uint32_t size = logSummaryLayout(last - first, blobLength, &output.header);
+
+    LogSummary summary;
+    summary.begin(writeBucket, &output);
+    fseek(in, blobLength, SEEK_SET);
+    while (fread(record, 1, sizeof(record), in) == sizeof(record)) {
+        summary.add(record);
+    }
+    summary.finish();
+    fclose(in);
+
+    output.header.t0_ms = summary.origin();
+    output.header.flags |= LOG_SUMMARY_FLAG_COMPLETE;
+    fseek(output.file, 0, SEEK_SET);
+    fwrite(&output.header, 1, sizeof(output.header), output.file);
+    fwrite(blob, 1, blobLength, output.file);
+    fclose(output.file);
+
+    printf("%lu records, %u bytes of regions", records, (unsigned)(size - output.header.header_length));
+    for (int level = 0; level < LOG_SUMMARY_LEVELS; level++) {
+        printf(", %lu s: %u", (unsigned long)(output.header.levels[level].period_ms / 1000),
+               (unsigned)output.header.levels[level].count);
+    }
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,499 @@
+#!/usr/bin/env python3
+"""Decodes, lists and synthesizes sensor capture sessions (include/sensor_capture.h): the
+cap_NNN.cap files of the logger's raw-capture mode (`capture on|only`, include/raw_capture.h) and
+the input of the host replay (tools/sensor_replay_host.cpp).
+
+Layout: header magic "SNS1", uint16 version, uint16 header_length, uint32 start_ms, then chunks of
+    uint32 t_ms, uint8 type, uint16 length, payload
+in non-decreasing t_ms order per type.
+
+`decode` writes one JSON object per line with everything the inputs carry. Where the firmware
+decodes an input, the values here are the ones it gets (tools/tests/test_sensor_capture.py checks
+that against the device decoders):
+  nmea            every sentence with its checksum verdict and all fields; RMC, GGA, GSA, GSV,
+                  VTG, GLL and ZDA fields are named (GSV with per-satellite elevation, azimuth, SNR)
+  cp_measurement  every field of the Cycling Power Measurement the flags announce (balance,
+                  accumulated torque, wheel and crank revolutions, extreme forces, torques and
+                  angles, dead spot angles when the features support them, accumulated energy),
+                  plus cadence and wheel rpm from consecutive revolution data
+  cp_feature      the Feature bitmask with the supported features named
+  imu_fifo        accel (m/s^2) / gyro (rad/s) pairs with per-sample times, paired by batch counter
+                  as the firmware pairs them
+  pressure, analog  the values as captured
+
+`synth` writes a deterministic ride: 10 Hz RMC+GGA over a slow climb, Cycling Power notifications
+at 4 Hz with crank data, 416 Hz IMU bursts of IMU_FIFO_WATERMARK_WORDS words, 1 Hz pressure
+following the climb and 50 Hz analog. The same seed and duration give the same bytes.
+
+Examples:
+    sensor_capture.py decode cap_000.cap > ride.jsonl
+    sensor_capture.py decode cap_000.cap --type cp_measurement --type cp_feature
+    sensor_capture.py synth session.cap --minutes 10
+    sensor_capture.py list session.cap              # chunk summary
+    sensor_capture.py list session.cap --chunks     # one line per chunk
+"""
+import argparse
+import json
+import math
+import random
+import struct
+import sys
+
+MAGIC = b"SNS1"
+VERSION = 1
+HEADER = struct.Struct("<4sHHI")
+CHUNK_HEAD = struct.Struct("<IBH")
+
+TYPES = {1: "nmea", 2: "cp_measurement", 3: "cp_feature", 4: "imu_fifo", 5: "pressure", 6: "analog"}
+NMEA, CP_MEASUREMENT, CP_FEATURE, IMU_FIFO, PRESSURE, ANALOG = 1, 2, 3, 4, 5, 6
+
+IMU_ODR_HZ = 416                       # config.h
+IMU_WORDS_PER_BURST = 32               # IMU_FIFO_WATERMARK_WORDS
+ACCEL_MPS2_PER_LSB = 0.244e-3 * 9.80665
+GYRO_RADPS_PER_LSB = 70.0e-3 * 0.01745329252
+TAG_GYRO, TAG_ACCEL = 0x01, 0x02
+
+
+def read_chunks(data):
+    """Yields (t_ms, type, payload); stops at a truncated chunk."""
+    magic, version, header_length, start_ms = HEADER.unpack_from(data, 0)
+    if magic != MAGIC:
+        raise ValueError("not a sensor capture")
+    pos = header_length
+    while pos + CHUNK_HEAD.size <= len(data):
+        t_ms, kind, length = CHUNK_HEAD.unpack_from(data, pos)
+        pos += CHUNK_HEAD.size
+        if pos + length > len(data):
+            break
+        yield t_ms, kind, data[pos:pos + length]
+        pos += length
+
+
+# --- Decoding ---
+
+NMEA_FIELDS = {
+    "RMC": ["time", "status", "lat", "ns", "lon", "ew", "speed_knots", "course_deg", "date",
+            "magnetic_variation", "variation_ew", "mode", "nav_status"],
+    "GGA": ["time", "lat", "ns", "lon", "ew", "quality", "satellites", "hdop", "altitude_m", "altitude_unit",
+            "geoid_separation_m", "separation_unit", "dgps_age_s", "dgps_station"],
+    "GSA": ["mode", "fix_type"] + ["prn%d" % i for i in range(1, 13)] + ["pdop", "hdop", "vdop", "system_id"],
+    "VTG": ["course_true_deg", "t", "course_magnetic_deg", "m", "speed_knots", "n", "speed_kmh", "k", "mode"],
+    "GLL": ["lat", "ns", "lon", "ew", "time", "status", "mode"],
+    "ZDA": ["time", "day", "month", "year", "zone_hours", "zone_minutes"],
+}
+
+
+def nmea_degrees(value, hemisphere):
+    if not value:
+        return None
+    dot = value.index(".") if "." in value else len(value)
+    degrees = float(value[:dot - 2]) + float(value[dot - 2:]) / 60.0
+    return -degrees if hemisphere in ("S", "W") else degrees
+
+
+def decode_nmea_sentence(line):
+    """One sentence without CR/LF -> dict"""
+    out = {"sentence": line}
+    body, star, checksum = line[1:].partition("*")
+    computed = 0
+    for c in body.encode("latin-1"):
+        computed ^= c
+    try:
+        out["checksum_ok"] = bool(star) and int(checksum[:2], 16) == computed
+    except ValueError:
+        out["checksum_ok"] = False
+    fields = body.split(",")
+    address = fields[0]
+    out["talker"], out["kind"] = (address[:2], address[2:]) if not address.startswith("P") else ("P", address[1:])
+    names = NMEA_FIELDS.get(out["kind"]) if out["talker"] != "P" else None
+    values = fields[1:]
+    if out["kind"] == "GSV" and out["talker"] != "P":
+        head = dict(zip(["messages", "message", "in_view"], values[:3]))
+        satellites = []
+        for i in range(3, len(values) - 3, 4):
+            prn, elevation, azimuth, snr = values[i:i + 4]
+            satellites.append({"prn": prn, "elevation_deg": elevation, "azimuth_deg": azimuth, "snr_db": snr})
+        head["satellites"] = satellites
+        if (len(values) - 3) % 4 == 1:
+            head["signal_id"] = values[-1]
+        out["fields"] = head
+    elif names is not None:
+        named = dict(zip(names, values))
+        if len(values) > len(names):
+            named["extra"] = values[len(names):]
+        if "lat" in named:
+            named["lat_deg"] = nmea_degrees(named["lat"], named.get("ns"))
+            named["lon_deg"] = nmea_degrees(named.get("lon"), named.get("ew"))
+        out["fields"] = named
+    else:
+        out["fields"] = values
+    return out
+
+
+class NmeaStream:
+    """Reassembles sentences across chunk boundaries; each is stamped with the chunk holding its '$'"""
+    def __init__(self):
+        self.line = bytearray()
+        self.t_ms = None
+
+    def feed(self, t_ms, data):
+        for b in data:
+            if b == 0x24:  # '$'
+                if self.line:
+                    yield self.t_ms, bytes(self.line), False  # Cut short by the next sentence
+                self.line = bytearray(b"$")
+                self.t_ms = t_ms
+            elif b in (0x0D, 0x0A):
+                if self.line:
+                    yield self.t_ms, bytes(self.line), True
+                self.line = bytearray()
+            elif self.line:
+                self.line.append(b)
+
+
+CP_FEATURES = [
+    "pedal_power_balance", "accumulated_torque", "wheel_revolution_data", "crank_revolution_data",
+    "extreme_magnitudes", "extreme_angles", "dead_spot_angles", "accumulated_energy",
+    "offset_compensation_indicator", "offset_compensation", "measurement_content_masking",
+    "multiple_sensor_locations", "crank_length_adjustment", "chain_length_adjustment",
+    "chain_weight_adjustment", "span_length_adjustment", "sensor_measurement_context_torque",
+    "instantaneous_measurement_direction", "factory_calibration_date", "enhanced_offset_compensation",
+]
+
+
+def decode_cp_feature(payload):
+    bits = struct.unpack_from("<I", payload)[0] if len(payload) >= 4 else 0
+    return {"bits": "0x%08X" % bits,
+            "supported": [name for i, name in enumerate(CP_FEATURES) if bits & (1 << i)],
+            "distributed_system": (bits >> 20) & 0x3}
+
+
+CP_FEATURE_DEAD_SPOT_ANGLES = 1 << 6
+
+# The CP_SHORT_* bits of include/cycling_power.h, by name
+CP_SHORT = ["flags", "power", "balance", "crank", "top_dead_spot", "bottom_dead_spot"]
+
+
+class CyclingPowerMeasurement:
+    """Cycling Power Measurement (0x2A63) by the Cycling Power Service spec, walked field by field
+    as src/cycling_power.cpp does: every field the flags announce moves the offset whether or not
+    it fits, a field that does not fit is listed under "short", and the values the device decodes
+    come out as it computes them (negative power as 0, whole-rpm cadence from consecutive crank
+    data, dead spot angles only when the Feature bitmask supports them). The fields the device
+    steps over are decoded as well, and wheel rpm from consecutive wheel data."""
+    def __init__(self):
+        self.features = 0
+        self.crank = None
+        self.wheel = None
+
+    def set_features(self, bits):
+        self.features = bits
+
+    def decode(self, payload):
+        if len(payload) < 2:
+            return {"short": ["flags"], "raw": payload.hex()}
+        flags = struct.unpack_from("<H", payload)[0]
+        out = {"flags": "0x%04X" % flags}
+        short = []
+        pos = 2
+
+        def take(fmt, name=None):
+            nonlocal pos
+            size = struct.calcsize(fmt)
+            start, pos = pos, pos + size
+            if pos > len(payload):
+                if name:
+                    short.append(name)
+                return None
+            return struct.unpack_from(fmt, payload, start)
+
+        power = take("<h", "power")
+        if power is not None:
+            out["power_watts"] = max(power[0], 0)
+        if flags & 0x0001:
+            balance = take("<B", "balance")
+            if balance is not None:
+                out["pedal_balance_percent"] = balance[0] / 2.0
+                out["pedal_balance_reference"] = "left" if flags & 0x0002 else "unknown"
+        if flags & 0x0004:
+            torque = take("<H")
+            if torque is not None:
+                out["accumulated_torque_nm"] = torque[0] / 32.0
+                out["accumulated_torque_source"] = "crank" if flags & 0x0008 else "wheel"
+        wheel = take("<IH") if flags & 0x0010 else None
+        if wheel is not None:
+            revolutions, event = wheel
+            out["wheel_revolutions"], out["wheel_event_time_s"] = revolutions, event / 2048.0
+            if self.wheel is not None:
+                dr = (revolutions - self.wheel[0]) & 0xFFFFFFFF
+                dt = ((event - self.wheel[1]) & 0xFFFF) / 2048.0
+                if dt > 0:
+                    out["wheel_rpm"] = dr / dt * 60.0
+        self.wheel = wheel
+        crank = take("<HH", "crank") if flags & 0x0020 else None
+        if crank is not None:
+            revolutions, event = crank
+            out["crank_revolutions"], out["crank_event_time_s"] = revolutions, event / 1024.0
+            out["cadence_rpm"] = 0  # One crank event is not a rate yet
+            if self.crank is not None:
+                dr = (revolutions - self.crank[0]) & 0xFFFF
+                dt = ((event - self.crank[1]) & 0xFFFF) / 1024.0
+                if dr > 0 and dt > 0:
+                    out["cadence_rpm"] = int(dr / dt * 60.0) & 0xFF  # uint8, as on the device
+        self.crank = crank
+        if flags & 0x0040:
+            forces = take("<hh")
+            if forces is not None:
+                out["max_force_n"], out["min_force_n"] = forces
+        if flags & 0x0080:
+            torques = take("<hh")
+            if torques is not None:
+                out["max_torque_nm"], out["min_torque_nm"] = torques[0] / 32.0, torques[1] / 32.0
+        if flags & 0x0100:
+            angles = take("<BBB")
+            if angles is not None:
+                a, b, c = angles
+                out["max_angle_deg"] = a | ((b & 0x0F) << 8)
+                out["min_angle_deg"] = (b >> 4) | (c << 4)
+        supported = bool(self.features & CP_FEATURE_DEAD_SPOT_ANGLES)
+        for flag, key in ((0x0200, "top_dead_spot"), (0x0400, "bottom_dead_spot")):
+            if flags & flag:
+                angle = take("<H", key if supported else None)
+                if angle is not None and supported:
+                    out[key + "_deg"] = angle[0]
+        if flags & 0x0800:
+            energy = take("<H")
+            if energy is not None:
+                out["accumulated_energy_kj"] = energy[0]
+        if flags & 0x1000:
+            out["offset_compensation_indicator"] = True
+        if short:
+            out["short"] = short
+        elif pos < len(payload):
+            out["trailing"] = payload[pos:].hex()
+        return out
+
+
+class ImuFifo:
+    """LSM6DSO tagged FIFO words, paired into samples as src/imu_fifo_parser.cpp does: an accel
+    and a gyro word with the same batch counter (tag bits [2:1]) make a sample, and a half whose
+    partner does not arrive before the counter moves on or the same sensor repeats is dropped and
+    counted. The pairing state carries over between bursts."""
+    def __init__(self):
+        self.accel = None
+        self.gyro = None
+        self.counter = 0
+
+    def decode(self, t_ms, payload):
+        samples, unknown, unpaired = [], 0, 0
+        for i in range(0, len(payload) - 6, 7):
+            tag, counter = payload[i] >> 3, (payload[i] >> 1) & 0x03
+            if tag not in (TAG_ACCEL, TAG_GYRO):
+                unknown += 1
+                continue
+            x, y, z = struct.unpack_from("<hhh", payload, i + 1)
+            if (self.accel is not None or self.gyro is not None) and counter != self.counter:
+                unpaired += 1  # The pending half belongs to an earlier batch period
+                self.accel = self.gyro = None
+            self.counter = counter
+            if tag == TAG_ACCEL:
+                unpaired += self.accel is not None
+                self.accel = [v * ACCEL_MPS2_PER_LSB for v in (x, y, z)]
+            else:
+                unpaired += self.gyro is not None
+                self.gyro = [v * GYRO_RADPS_PER_LSB for v in (x, y, z)]
+            if self.accel is not None and self.gyro is not None:
+                samples.append({"t_ms": round(t_ms + len(samples) * 1000.0 / IMU_ODR_HZ, 3),
+                                "accel_mps2": self.accel, "gyro_radps": self.gyro})
+                self.accel = self.gyro = None
+        out = {"samples": samples}
+        if unknown:
+            out["unknown_words"] = unknown
+        if unpaired:
+            out["unpaired_words"] = unpaired
+        return out
+
+
+def decode_session(path, types, out):
+    with open(path, "rb") as f:
+        data = f.read()
+    nmea, cp, imu = NmeaStream(), CyclingPowerMeasurement(), ImuFifo()
+
+    def emit(t_ms, kind, record):
+        record = dict(record)
+        record["t_ms"], record["type"] = t_ms, kind
+        out.write(json.dumps(record, sort_keys=True) + "\n")
+
+    for t_ms, kind, payload in read_chunks(data):
+        name = TYPES.get(kind, "type%d" % kind)
+        if kind == CP_FEATURE and len(payload) >= 4:
+            cp.set_features(struct.unpack_from("<I", payload)[0])  # Also when only measurements are shown
+        if types and name not in types:
+            continue
+        if kind == NMEA:
+            for start_ms, line, complete in nmea.feed(t_ms, payload):
+                record = decode_nmea_sentence(line.decode("latin-1"))
+                if not complete:
+                    record["truncated"] = True
+                emit(start_ms, name, record)
+        elif kind == CP_MEASUREMENT:
+            emit(t_ms, name, cp.decode(payload))
+        elif kind == CP_FEATURE:
+            emit(t_ms, name, decode_cp_feature(payload))
+        elif kind == IMU_FIFO:
+            emit(t_ms, name, imu.decode(t_ms, payload))
+        elif kind == PRESSURE and len(payload) >= 4:
+            emit(t_ms, name, {"pressure_pa": struct.unpack_from("<f", payload)[0]})
+        elif kind == ANALOG:
+            values = struct.unpack_from("<%df" % (len(payload) // 4), payload)
+            emit(t_ms, name, {"volts": [None if math.isnan(v) else v for v in values]})
+        else:
+            emit(t_ms, name, {"raw": payload.hex()})
+
+
+# --- Synthesis ---
+
+def nmea_sentence(body):
+    checksum = 0
+    for c in body.encode():
+        checksum ^= c
+    return "$%s*%02X\r\n" % (body, checksum)
+
+
+def nmea_coordinate(value, degree_digits, hemispheres):
+    hemisphere = hemispheres[0] if value >= 0 else hemispheres[1]
+    value = abs(value)
+    degrees = int(value)
+    return "%0*d%07.4f,%s" % (degree_digits, degrees, (value - degrees) * 60.0, hemisphere)
+
+
+def synth(path, minutes, seed):
+    rng = random.Random(seed)
+    duration_ms = int(minutes * 60000)
+    chunks = []  # (t_ms, order, type, payload); order keeps same-time chunks stable
+
+    def add(t_ms, kind, payload):
+        chunks.append((t_ms, len(chunks), kind, payload))
+
+    add(0, CP_FEATURE, struct.pack("<I", 0x0000000C))  # crank + wheel data supported
+
+    # Route: 0.5 % climb at ~8 m/s heading north-east
+    lat, lon, alt = 47.3769, 8.5417, 410.0
+    for t in range(0, duration_ms, 100):
+        s = t / 1000.0
+        speed = 8.0 + 1.5 * math.sin(s / 40.0)
+        lat += speed * 0.1 * 0.7071 / 111320.0
+        lon += speed * 0.1 * 0.7071 / (111320.0 * math.cos(math.radians(lat)))
+        alt += speed * 0.1 * 0.005
+        hhmmss = "%02d%02d%06.3f" % (10 + int(s // 3600), int(s // 60) % 60, s % 60)
+        rmc = nmea_sentence("GPRMC,%s,A,%s,%s,%.2f,45.0,191026,,,A" % (
+            hhmmss, nmea_coordinate(lat, 2, "NS"), nmea_coordinate(lon, 3, "EW"), speed / 0.514444))
+        gga = nmea_sentence("GPGGA,%s,%s,%s,1,09,0.9,%.1f,M,47.0,M,," % (
+            hhmmss, nmea_coordinate(lat, 2, "NS"), nmea_coordinate(lon, 3, "EW"),
+            alt + rng.gauss(0.0, 2.0)))
+        text = (rmc + gga).encode()
+        split = rng.randrange(1, len(text))  # UART reads split sentences anywhere
+        add(t, NMEA, text[:split])
+        add(t + 2, NMEA, text[split:])
+
+    # Power at 4 Hz: intervals around 220 W, cadence ~90 rpm from cumulative crank revolutions
+    revolutions, event_time = 0, 0.0
+    for t in range(125, duration_ms, 250):
+        s = t / 1000.0
+        watts = 220 + (130 if int(s) % 300 < 60 else 0) + int(rng.gauss(0.0, 12.0))
+        cadence = 90.0 + 5.0 * math.sin(s / 25.0)
+        event_time += 0.25
+        revolutions_due = int(event_time * cadence / 60.0)
+        revolutions = max(revolutions, revolutions_due)
+        crank_time = int(revolutions * 60.0 / cadence * 1024.0) & 0xFFFF
+        add(t, CP_MEASUREMENT, struct.pack("<HhHH", 0x0020, max(watts, 0), revolutions & 0xFFFF, crank_time))
+
+    # IMU: gravity on Z with road vibration, small roll oscillation
+    period_s = 1.0 / IMU_ODR_HZ
+    samples_per_burst = IMU_WORDS_PER_BURST // 2
+    sample = 0
+    while sample * period_s * 1000.0 < duration_ms:
+        t_ms = int(sample * period_s * 1000.0)
+        words = bytearray()
+        for i in range(samples_per_burst):
+            s = (sample + i) * period_s
+            accel = (0.3 * math.sin(s), 9.80665 * math.sin(0.05 * math.sin(s / 3.0)) + rng.gauss(0.0, 0.2),
+                     9.80665 + rng.gauss(0.0, 0.4))
+            gyro = (0.05 / 3.0 * math.cos(s / 3.0) + rng.gauss(0.0, 0.01), rng.gauss(0.0, 0.01),
+                    rng.gauss(0.0, 0.01))
+            counter = ((sample + i) & 0x03) << 1  # Batch counter, as the sensor tags each ODR period
+            words += struct.pack("<Bhhh", TAG_ACCEL << 3 | counter, *(int(round(a / ACCEL_MPS2_PER_LSB)) for a in accel))
+            words += struct.pack("<Bhhh", TAG_GYRO << 3 | counter, *(int(round(g / GYRO_RADPS_PER_LSB)) for g in gyro))
+        add(t_ms, IMU_FIFO, bytes(words))
+        sample += samples_per_burst
+
+    # Pressure at 1 Hz following the GPS climb (~12 Pa per metre)
+    for t in range(500, duration_ms, 1000):
+        s = t / 1000.0
+        climbed = 8.0 * s * 0.005
+        add(t, PRESSURE, struct.pack("<f", 96500.0 - climbed * 12.0 + rng.gauss(0.0, 3.0)))
+
+    # Analog at 50 Hz: two channels in use
+    for t in range(10, duration_ms, 20):
+        values = [1.65 + 0.1 * math.sin(t / 700.0), 3.3 * ((t // 5000) % 2)] + [float("nan")] * 6
+        add(t, ANALOG, struct.pack("<8f", *values))
+
+    chunks.sort(key=lambda c: (c[0], c[1]))
+    with open(path, "wb") as out:
+        out.write(HEADER.pack(MAGIC, VERSION, HEADER.size, 0))
+        for t_ms, _, kind, payload in chunks:
+            out.write(CHUNK_HEAD.pack(t_ms, kind, len(payload)))
+            out.write(payload)
+    print("%s: %d chunks over %.1f min" % (path, len(chunks), minutes))
+
+
+def list_session(path, per_chunk):
+    with open(path, "rb") as f:
+        data = f.read()
+    counts, sizes = {}, {}
+    first = last = None
+    for t_ms, kind, payload in read_chunks(data):
+        name = TYPES.get(kind, "type%d" % kind)
+        if per_chunk:
+            print("%10d %-15s %4d %s" % (t_ms, name, len(payload), payload[:24].hex()))
+        counts[name] = counts.get(name, 0) + 1
+        sizes[name] = sizes.get(name, 0) + len(payload)
+        first = t_ms if first is None else first
+        last = t_ms
+    if not per_chunk:
+        span = (last - first) / 1000.0 if first is not None else 0.0
+        print("%s: %.1f s" % (path, span))
+        for name in sorted(counts):
+            print("  %-15s %8d chunks %10d bytes" % (name, counts[name], sizes[name]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command", required=True)
+    p = sub.add_parser("decode", help="decode every chunk to JSON lines")
+    p.add_argument("session")
+    p.add_argument("--type", action="append", choices=sorted(TYPES.values()), help="only these chunk types")
+    p = sub.add_parser("synth", help="write a deterministic synthetic session")
+    p.add_argument("output")
+    p.add_argument("--minutes", type=float, default=5.0)
+    p.add_argument("--seed", type=int, default=1)
+    p = sub.add_parser("list", help="summarize a session")
+    p.add_argument("session")
+    p.add_argument("--chunks", action="store_true", help="one line per chunk")
+    args = parser.parse_args()
+    if args.command == "synth":
+        synth(args.output, args.minutes, args.seed)
+        return
+    try:
+        if args.command == "decode":
+            decode_session(args.session, args.type, sys.stdout)
+        else:
+            list_session(args.session, args.chunks)
+    except ValueError as e:
+        sys.exit("%s: %s" % (args.session, e))
+    except BrokenPipeError:
+        pass
+
+
+if __name__ == "__main__":
+    main()
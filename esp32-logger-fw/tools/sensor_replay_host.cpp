@@ -0,0 +1,428 @@
+// Deterministic replay of a captured sensor session (sensor_capture.h) through the firmware's
+// parsing, analytics and logging code on the host, driven by a virtual clock:
+//   - NMEA bytes through NmeaParser into the GPS state and the elevation filter
+//   - Cycling Power notifications through CyclingPowerDecoder, PowerAnalytics and MeanMaxPower
+//   - IMU FIFO bursts through ImuFifoParser and the attitude filter; pressure into the elevation filter
+//   - every acquisition tick through RecordAssembler into the record ring (DataBuffer), which the
+//     SD logging task's passes (log_writer.h) drain through log_rotation and event_log into
+//     log_NNN.bin/.evt/.lod in DIR
+// The card is a local directory and the platform calls those files make are served by the
+// stand-ins in tools/host/. Nothing depends on the wall clock, so the output files are
+// byte-identical across runs; their CRCs are printed for regression checks
+// (tools/tests/test_sensor_replay.py). The wall time goes to stderr as the pipeline's throughput
+// (virtual seconds per real second).
+//
+//   g++ -std=c++17 -O2 -Iinclude -Itools/host tools/sensor_replay_host.cpp tools/host/host_platform.cpp
+//       src/nmea_parser.cpp src/cycling_power.cpp src/record_assembler.cpp src/sensor_capture.cpp
+//       src/imu_fifo_parser.cpp src/attitude_filter.cpp src/elevation_filter.cpp src/power_analytics.cpp
+//       src/mean_max_power.cpp src/log_backpressure.cpp src/log_schema.cpp src/log_summary.cpp
+//       src/log_rotation.cpp src/event_log.cpp src/frame_codec.cpp src/DataBuffer.cpp src/log_writer.cpp
+//       -o sensor_replay_host
+//   ./sensor_replay_host session.cap -o ride      (ride/log_000.bin, .evt, .lod)
+//
+//   options: [-o DIR] [--rate N] [--stall-every MS --stall-ms MS] [--trace]
+//     -o DIR          the card: a new or empty directory (default: replay)
+//     --trace         also print what the Cycling Power decoder and the IMU FIFO parser made of each
+//                     chunk, one JSON object per line (compared with tools/sensor_capture.py decode
+//                     by tools/tests/test_sensor_capture.py)
+//     --rate N        pace the virtual clock to N x real time (default: as fast as possible)
+//     --stall-every / --stall-ms  the SD writer stops draining for MS every MS of session time,
+//                     to exercise the overflow policy
+#include "config.h"
+#include "sensor_capture.h"
+#include "nmea_parser.h"
+#include "cycling_power.h"
+#include "record_assembler.h"
+#include "attitude_filter.h"
+#include "elevation_filter.h"
+#include "power_analytics.h"
+#include "mean_max_power.h"
+#include "log_rotation.h"
+#include "log_writer.h"
+#include "DataBuffer.h"
+#include "event_log.h"
+#include "frame_codec.h" // crc32Update
+#include "host_platform.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+PowerCadenceData g_powerCadenceData; // config.h declares it for the firmware
+
+// The acquisition task's record ring, sized and allocated as in main.cpp
+static DataBuffer<LogRecordV1> s_recordRing(PSRAM_BUFFER_SIZE_RECORDS);
+
+static size_t ringWrite(void* context, const LogRecordV1* records, size_t count) {
+    return ((DataBuffer<LogRecordV1>*)context)->writeBatch(records, count);
+}
+
+static size_t ringCount(void* context) {
+    return ((DataBuffer<LogRecordV1>*)context)->getCount();
+}
+
+struct Transitions {
+    const uint32_t* nowMs;
+    const RecordAssembler* assembler;
+};
+
+// As the acquisition task's sink: an EVENT_BACKPRESSURE record, plus a line on stdout
+static void postTransition(void* context, const LogBackpressureTransition& transition, size_t stagingCount) {
+    const Transitions* t = (const Transitions*)context;
+    BackpressureEvent event;
+    event.from_level = transition.from;
+    event.to_level = transition.to;
+    event.ring_fill_percent = transition.ring_fill_percent;
+    event.staging_count = (uint8_t)stagingCount;
+    event.in_previous_ms = transition.in_previous_ms;
+    event.produced = t->assembler->backpressure().stats().produced;
+    event.skipped = transition.skipped;
+    event.dropped = transition.dropped;
+    event.ring_peak = transition.ring_peak;
+    eventLogPost(EVENT_BACKPRESSURE, &event, sizeof(event));
+    printf("t=%lu ms: log rate %s -> %s (ring %u%%, staging %u, %lu dropped)\n", (unsigned long)*t->nowMs,
+           logRateLevelName(transition.from), logRateLevelName(transition.to), transition.ring_fill_percent,
+           (unsigned)stagingCount, (unsigned long)transition.dropped);
+}
+
+// One pass of the SD logging task (log_writer.h); returns the records written
+static size_t writerPass(uint32_t nowMs) {
+    bool ok;
+    size_t written = logWriterService(s_recordRing, nowMs, &ok);
+    if (!ok) {
+        printf("t=%lu ms: log write failed\n", (unsigned long)nowMs);
+    }
+    return written;
+}
+
+static void traceCyclingPower(uint32_t tMs, const CyclingPowerMeasurement& m, uint8_t issues) {
+    static const char* const shortNames[] = { "flags", "power", "balance", "crank", "top_dead_spot", "bottom_dead_spot" };
+    printf("{\"t_ms\": %lu, \"type\": \"cp_measurement\", \"power_watts\": %u, \"cadence_rpm\": %u",
+           (unsigned long)tMs, m.power_watts, m.cadence_rpm);
+    if (m.balance_available) printf(", \"pedal_balance_percent\": %.9g", m.left_balance_percent);
+    if (m.top_dead_spot_available) printf(", \"top_dead_spot_deg\": %u", m.top_dead_spot_deg);
+    if (m.bottom_dead_spot_available) printf(", \"bottom_dead_spot_deg\": %u", m.bottom_dead_spot_deg);
+    printf(", \"short\": [");
+    const char* separator = "";
+    for (size_t i = 0; i < sizeof(shortNames) / sizeof(shortNames[0]); i++) {
+        if (issues & (1 << i)) {
+            printf("%s\"%s\"", separator, shortNames[i]);
+            separator = ", ";
+        }
+    }
+    printf("]}\n");
+}
+
+static void traceImu(uint32_t tMs, const ImuSample* samples, size_t count, uint32_t unpaired) {
+    printf("{\"t_ms\": %lu, \"type\": \"imu_fifo\", \"unpaired_words\": %lu, \"samples\": [", (unsigned long)tMs,
+           (unsigned long)unpaired);
+    for (size_t i = 0; i < count; i++) {
+        const ImuSample& s = samples[i];
+        printf("%s[%.9g, %.9g, %.9g, %.9g, %.9g, %.9g]", i ? ", " : "", s.accel_mps2[0], s.accel_mps2[1],
+               s.accel_mps2[2], s.gyro_radps[0], s.gyro_radps[1], s.gyro_radps[2]);
+    }
+    printf("]}\n");
+}
+
+static bool readFile(const char* path, std::vector<uint8_t>* out) {
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    uint8_t buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        out->insert(out->end(), buffer, buffer + n);
+    }
+    fclose(file);
+    return true;
+}
+
+// The replay numbers files from 0 like a fresh card, so it only writes into a new or empty directory
+static bool prepareCard(const char* dir) {
+    if (mkdir(dir, 0755) == 0) {
+        return true;
+    }
+    DIR* d = errno == EEXIST ? opendir(dir) : nullptr;
+    if (d == nullptr) {
+        return false;
+    }
+    bool empty = true;
+    while (struct dirent* entry = readdir(d)) {
+        empty = empty && entry->d_name[0] == '.';
+    }
+    closedir(d);
+    return empty;
+}
+
+int main(int argc, char** argv) {
+    const char* sessionPath = nullptr;
+    const char* cardDir = "replay";
+    double rate = 0.0;
+    uint32_t stallEveryMs = 0, stallMs = 0;
+    bool trace = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            cardDir = argv[++i];
+        } else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            rate = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--stall-every") == 0 && i + 1 < argc) {
+            stallEveryMs = (uint32_t)atol(argv[++i]);
+        } else if (strcmp(argv[i], "--stall-ms") == 0 && i + 1 < argc) {
+            stallMs = (uint32_t)atol(argv[++i]);
+        } else if (strcmp(argv[i], "--trace") == 0) {
+            trace = true;
+        } else if (sessionPath == nullptr && argv[i][0] != '-') {
+            sessionPath = argv[i];
+        } else {
+            sessionPath = nullptr;
+            break;
+        }
+    }
+    if (sessionPath == nullptr) {
+        fprintf(stderr, "usage: %s <session> [-o DIR] [--rate N] [--stall-every MS --stall-ms MS] [--trace]\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<uint8_t> session;
+    CaptureReader reader;
+    if (!readFile(sessionPath, &session) || !reader.begin(session.data(), session.size())) {
+        fprintf(stderr, "%s: not a sensor capture\n", sessionPath);
+        return 1;
+    }
+
+    // First pass: time span and chunk counts
+    CaptureChunk chunk;
+    uint32_t chunkCounts[CAPTURE_TYPE_COUNT] = {};
+    uint32_t firstMs = 0, lastMs = 0;
+    bool any = false;
+    while (reader.next(&chunk)) {
+        if (!any) firstMs = chunk.t_ms;
+        lastMs = chunk.t_ms;
+        any = true;
+        chunkCounts[chunk.type < CAPTURE_TYPE_COUNT ? chunk.type : 0]++;
+    }
+    if (!any) {
+        fprintf(stderr, "%s: no chunks\n", sessionPath);
+        return 1;
+    }
+    if (reader.truncated()) {
+        printf("session ends in a truncated chunk; replaying what is complete\n");
+    }
+
+    // The card and the logging path, started as the SD logging task does
+    if (!prepareCard(cardDir)) {
+        fprintf(stderr, "%s: not a new or empty directory\n", cardDir);
+        return 1;
+    }
+    uint32_t nowMs = firstMs; // The virtual clock
+    hostClockSetUs((uint64_t)nowMs * 1000);
+    hostSdCardMount(cardDir);
+    initializeEventLog();
+    if (!s_recordRing.initialize()) {
+        fprintf(stderr, "could not allocate the record ring\n");
+        return 1;
+    }
+    if (!logRotationBegin()) {
+        fprintf(stderr, "%s: could not open a log file\n", cardDir);
+        return 1;
+    }
+    logWriterBegin(nowMs);
+    logRotationService(); // The rotation task prepares the next pair
+
+    // The firmware pipeline, configured as on the device
+    NmeaParser nmea;
+    CyclingPowerDecoder cpDecoder;
+    ImuFifoParser imuParser({ ACCEL_MPS2_PER_LSB, GYRO_RADPS_PER_LSB, IMU_SAMPLE_PERIOD_US });
+    AttitudeFilter ahrs(AHRS_BETA);
+    ElevationFilter elevation({ ELEVATION_ACCEL_NOISE_MPS2, ELEVATION_BARO_NOISE_M, ELEVATION_GPS_NOISE_M,
+                                ELEVATION_OFFSET_DRIFT_M, ELEVATION_GPS_GATE_SIGMA, ELEVATION_GRADIENT_TAU_S,
+                                ELEVATION_GRADIENT_MIN_SPEED_MPS, ELEVATION_ASCENT_HYSTERESIS_M });
+    PowerAnalytics powerAnalytics(POWER_FTP_WATTS, POWER_DROPOUT_MS);
+    MeanMaxPower meanMax;
+    static const uint16_t durations[] = MMP_DURATIONS_S;
+    const size_t durationCount = sizeof(durations) / sizeof(durations[0]);
+    uint32_t longest = meanMaxLongestDuration(durations, durationCount);
+    std::vector<uint16_t> meanMaxRing(longest);
+    if (meanMax.begin(durations, durationCount, meanMaxRing.data(), longest)) {
+        powerAnalytics.setSecondSink(meanMaxPowerSecondSink, &meanMax);
+    }
+
+    static LogRecordV1 staging[LOG_STAGING_RECORDS];
+    RecordAssembler assembler(staging, LOG_STAGING_RECORDS, LOG_STAGING_SPILL_RECORDS);
+    const LogBackpressureConfig backpressureConfig = {
+        LOG_BP_DECIMATE_PERCENT, LOG_BP_MINIMAL_PERCENT, LOG_BP_RECOVER_PERCENT,
+        LOG_BP_DECIMATED_EVERY, LOG_BP_MINIMAL_EVERY,
+    };
+    const RecordRing recordRing = { ringWrite, ringCount, s_recordRing.getCapacity(), &s_recordRing };
+    Transitions transitions = { &nowMs, &assembler };
+    assembler.begin(backpressureConfig, recordRing, postTransition, &transitions);
+
+    RecordInputs inputs = {};
+    for (size_t i = 0; i < sizeof(inputs.analog) / sizeof(inputs.analog[0]); i++) {
+        inputs.analog[i] = NAN;
+    }
+    ImuSample imuSamples[CAPTURE_MAX_PAYLOAD / IMU_FIFO_WORD_SIZE / 2 + 1];
+    uint32_t cpShort = 0;
+
+    auto wallStart = std::chrono::steady_clock::now();
+    reader.begin(session.data(), session.size());
+    bool pending = reader.next(&chunk);
+    for (; (int32_t)(nowMs - lastMs) <= 0 || pending; nowMs += DATA_ACQUISITION_INTERVAL_MS) {
+        hostClockSetUs((uint64_t)nowMs * 1000);
+
+        // Inputs that arrived up to this tick, in capture order
+        for (; pending && (int32_t)(chunk.t_ms - nowMs) <= 0; pending = reader.next(&chunk)) {
+            switch (chunk.type) {
+                case CAPTURE_NMEA:
+                    for (uint16_t i = 0; i < chunk.length; i++) {
+                        NmeaSentenceType type = nmea.feed((char)chunk.payload[i]);
+                        if (type != NMEA_RMC && type != NMEA_GGA) {
+                            continue;
+                        }
+                        GpsReading gps = nmeaGpsReading(nmea.fix()); // As the GPS task fills g_gpsData
+                        inputs.gps_fix = gps.valid;
+                        inputs.latitude_deg = gps.latitude_deg;
+                        inputs.longitude_deg = gps.longitude_deg;
+                        inputs.altitude_m = gps.altitude_m;
+                        inputs.speed_mps = gps.speed_mps;
+                        inputs.satellites = gps.satellites;
+                        if (gps.valid && type == NMEA_GGA) { // Altitude only comes with GGA
+                            elevation.addGps(chunk.t_ms, gps.altitude_m, gps.speed_mps);
+                        }
+                    }
+                    break;
+                case CAPTURE_CP_FEATURE:
+                    if (chunk.length >= 4) {
+                        uint32_t features;
+                        memcpy(&features, chunk.payload, 4);
+                        cpDecoder.setFeatures(features);
+                    }
+                    break;
+                case CAPTURE_CP_MEASUREMENT: {
+                    CyclingPowerMeasurement measurement;
+                    uint8_t issues = cpDecoder.decode(chunk.payload, chunk.length, &measurement);
+                    cpShort += issues != 0;
+                    if (trace) {
+                        traceCyclingPower(chunk.t_ms, measurement, issues);
+                    }
+                    if (issues & CP_SHORT_FLAGS) {
+                        break;
+                    }
+                    powerAnalytics.addSample(chunk.t_ms, measurement.power_watts);
+                    inputs.power_watts = measurement.power_watts;
+                    inputs.cadence_rpm = measurement.cadence_rpm;
+                    break;
+                }
+                case CAPTURE_IMU_FIFO: {
+                    uint32_t unpaired = imuParser.unpairedWords();
+                    size_t produced = imuParser.parse(chunk.payload, chunk.length / IMU_FIFO_WORD_SIZE,
+                                                      (int64_t)chunk.t_ms * 1000, 0, imuSamples,
+                                                      sizeof(imuSamples) / sizeof(imuSamples[0]));
+                    if (trace) {
+                        traceImu(chunk.t_ms, imuSamples, produced, imuParser.unpairedWords() - unpaired);
+                    }
+                    float speed = inputs.gps_fix ? inputs.speed_mps : 0.0f;
+                    ahrs.setForwardSpeed(speed >= AHRS_COMPENSATION_MIN_SPEED_MPS ? speed : 0.0f);
+                    for (size_t i = 0; i < produced; i++) {
+                        ahrs.update(imuSamples[i].gyro_radps, imuSamples[i].accel_mps2, IMU_SAMPLE_PERIOD_US * 1e-6f);
+                    }
+                    inputs.attitude_valid = ahrs.initialized();
+                    inputs.roll_deg = ahrs.rollDeg();
+                    inputs.pitch_deg = ahrs.pitchDeg();
+                    assembler.addImuSamples(imuSamples, produced);
+                    break;
+                }
+                case CAPTURE_PRESSURE:
+                    if (chunk.length >= 4) {
+                        float pressurePa;
+                        memcpy(&pressurePa, chunk.payload, 4);
+                        elevation.addPressure(chunk.t_ms, pressurePa);
+                    }
+                    break;
+                case CAPTURE_ANALOG:
+                    memcpy(inputs.analog, chunk.payload,
+                           chunk.length < sizeof(inputs.analog) ? chunk.length : sizeof(inputs.analog));
+                    break;
+                default:
+                    break; // Newer chunk types are skipped
+            }
+        }
+        elevation.getEstimate(&inputs.elevation);
+
+        // Acquisition tick
+        assembler.assemble(nowMs, inputs);
+        assembler.store(nowMs);
+
+        // SD logging task: wakes every SD_LOG_IDLE_POLL_MS and loops at once while it gets full
+        // batches; the rotation task's work follows, unless a card stall is being simulated
+        uint32_t sessionMs = nowMs - firstMs;
+        bool stalled = stallEveryMs > 0 && sessionMs % stallEveryMs < stallMs;
+        if (sessionMs % SD_LOG_IDLE_POLL_MS == 0 && !stalled) {
+            while (writerPass(nowMs) == LOG_STAGING_SPILL_RECORDS) {
+            }
+            logRotationService();
+        }
+
+        if (rate > 0.0 && sessionMs % 1000 == 0) {
+            std::this_thread::sleep_until(wallStart + std::chrono::microseconds((int64_t)(sessionMs * 1000.0 / rate)));
+        }
+    }
+
+    // End of session, as closeLogFile() does: everything staged, queued and posted reaches the card
+    assembler.flush();
+    if (!logWriterFlush(s_recordRing, nowMs)) {
+        printf("t=%lu ms: log write failed\n", (unsigned long)nowMs);
+    }
+    LogRotationStats rotation;
+    logRotationGetStats(&rotation);
+    logRotationEnd();
+    double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    // Report: deterministic on stdout, timing on stderr
+    double sessionS = (lastMs - firstMs) / 1000.0;
+    printf("session: %.1f s;", sessionS);
+    for (int type = 1; type < CAPTURE_TYPE_COUNT; type++) {
+        printf(" %s %lu", captureTypeName((CaptureType)type), (unsigned long)chunkCounts[type]);
+    }
+    printf("\n");
+    printf("gps: %lu sentences, %lu rejected; power: %lu notifications short\n", (unsigned long)nmea.sentences(),
+           (unsigned long)nmea.rejected(), (unsigned long)cpShort);
+    const LogBackpressureStats& bp = assembler.backpressure().stats();
+    printf("records: %lu produced, %lu skipped, %lu dropped; ring peak %lu; %lu rotations, %lu write failures\n",
+           (unsigned long)bp.produced, (unsigned long)bp.skipped, (unsigned long)bp.dropped,
+           (unsigned long)bp.ring_peak, (unsigned long)rotation.rotations, (unsigned long)rotation.failures);
+    PowerMetrics metrics;
+    powerAnalytics.getMetrics(&metrics);
+    printf("power: avg %.1f W, NP %.1f W, IF %.3f, TSS %.1f, %.1f kJ over %lu s\n", metrics.avg_watts,
+           metrics.normalized_power, metrics.intensity_factor, metrics.tss, metrics.work_kj,
+           (unsigned long)metrics.elapsed_s);
+    MeanMaxPoint curve[MMP_MAX_DURATIONS];
+    size_t points = meanMax.getCurve(curve, MMP_MAX_DURATIONS);
+    printf("mean-max:");
+    for (size_t i = 0; i < points; i++) {
+        printf(" %us %.1f W", curve[i].duration_s, curve[i].best_watts);
+    }
+    printf("\n");
+    static const char* const extensions[] = { "bin", "evt", "lod" };
+    for (uint32_t index = 0; index <= rotation.active_index; index++) {
+        for (const char* extension : extensions) {
+            char path[512];
+            std::vector<uint8_t> data;
+            snprintf(path, sizeof(path), "%s/log_%03lu.%s", cardDir, (unsigned long)index, extension);
+            if (readFile(path, &data)) {
+                printf("log_%03lu.%s: %lu bytes, crc32 %08lx\n", (unsigned long)index, extension,
+                       (unsigned long)data.size(), (unsigned long)crc32Update(0, data.data(), data.size()));
+            }
+        }
+    }
+    fprintf(stderr, "replayed %.1f s in %.3f s (%.0fx real time)\n", sessionS, wallS,
+            wallS > 0.0 ? sessionS / wallS : 0.0);
+    return 0;
+}
@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+"""Receiver for the logger's binary telemetry stream (`stream on` in the terminal).
+
+Frames are COBS-encoded and separated by 0x00. Decoded frame layout (little endian):
+    uint8 type, uint8 flags, uint16 seq, uint16 length, payload[length], uint32 crc32
+The CRC (zlib/IEEE) covers header and payload. Anything that is not a valid frame (e.g. text
+printed by other tasks) is counted as a bad frame and skipped; the next delimiter resyncs.
+
+Examples:
+    telemetry_rx.py --port /dev/ttyACM0 --format csv
+    telemetry_rx.py --file capture.bin --format json
+    telemetry_rx.py --port /dev/ttyACM0 --raw capture.bin
+"""
+import argparse
+import json
+import os
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from frame_codec import FrameError, FrameSplitter, decode_frame  # noqa: E402
+from log_schema import from_header  # noqa: E402
+
+LOG_SCHEMA = from_header()  # Record layout straight from include/log_schema.h
+
+TYPE_NAMES = {1: "power", 2: "gps", 3: "imu", 4: "analog", 5: "log_record"}
+
+
+def decode_payload(ftype, payload):
+    """Returns a list of dicts (IMU and analog frames can carry several rows)."""
+    if ftype == 1:
+        t, watts, cadence, balance = struct.unpack("<IHBB", payload)
+        return [{"t_ms": t, "power_w": watts, "cadence_rpm": cadence,
+                 "left_balance_pct": None if balance == 0xFF else balance / 2.0}]
+    if ftype == 2:
+        t, lat, lon, alt, speed, sats, fix = struct.unpack("<IddffBB", payload)
+        return [{"t_ms": t, "lat": lat, "lon": lon, "alt_m": alt, "speed_mps": speed,
+                 "sats": sats, "fix": fix}]
+    if ftype == 3:
+        count = payload[0]
+        rows = []
+        for i in range(count):
+            v = struct.unpack_from("<q6f", payload, 1 + i * 32)
+            rows.append({"t_us": v[0], "ax": v[1], "ay": v[2], "az": v[3],
+                         "gx": v[4], "gy": v[5], "gz": v[6]})
+        return rows
+    if ftype == 4:
+        t, count = struct.unpack_from("<IB", payload)
+        volts = struct.unpack_from("<%df" % count, payload, 5)
+        return [{"t_ms": t, "volts": list(volts)}]
+    if ftype == 5:
+        return [LOG_SCHEMA.decode(payload)]
+    return [{"bytes": payload.hex()}]
+
+
+class Receiver:
+    def __init__(self, fmt, raw_out):
+        self.fmt = fmt
+        self.raw_out = raw_out
+        self.splitter = FrameSplitter()
+        self.last_seq = None
+        self.frames = 0
+        self.bad = 0
+        self.lost = 0
+        self.csv_headers = set()
+
+    def feed(self, data):
+        for block in self.splitter.feed(data):
+            self.handle(block)
+
+    def handle(self, block):
+        try:
+            ftype, seq, payload = decode_frame(block)
+        except FrameError:
+            self.bad += 1
+            return
+
+        if self.last_seq is not None:
+            gap = (seq - self.last_seq - 1) & 0xFFFF
+            if gap:
+                self.lost += gap
+                print("# gap: %d frame(s) lost before seq %d" % (gap, seq), file=sys.stderr)
+        self.last_seq = seq
+        self.frames += 1
+
+        if self.raw_out:
+            self.raw_out.write(block + b"\x00")
+            return
+        name = TYPE_NAMES.get(ftype, "type%d" % ftype)
+        try:
+            rows = decode_payload(ftype, payload)
+        except struct.error:
+            self.bad += 1
+            return
+        for row in rows:
+            self.emit(name, seq, row)
+
+    def emit(self, name, seq, row):
+        if self.fmt == "json":
+            print(json.dumps(dict(type=name, seq=seq, **row)))
+            return
+        flat = {}
+        for key, value in row.items():
+            if isinstance(value, list):
+                for i, v in enumerate(value):
+                    flat["%s%d" % (key, i)] = v
+            else:
+                flat[key] = value
+        if name not in self.csv_headers:
+            self.csv_headers.add(name)
+            print("#%s,seq,%s" % (name, ",".join(flat.keys())))
+        print("%s,%d,%s" % (name, seq, ",".join("" if v is None else str(v) for v in flat.values())))
+
+    def summary(self):
+        print("# %d frames, %d lost (seq gaps), %d bad (CRC/format)" % (self.frames, self.lost, self.bad),
+              file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    source = parser.add_mutually_exclusive_group()
+    source.add_argument("--port", help="Serial port (requires pyserial)")
+    source.add_argument("--file", help="Read a previously captured byte stream")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--format", choices=("csv", "json"), default="csv")
+    parser.add_argument("--raw", help="Write valid frames (still COBS-encoded) to this file instead of decoding")
+    parser.add_argument("--no-start", action="store_true", help="Do not send 'stream on' when opening a port")
+    args = parser.parse_args()
+
+    raw_out = open(args.raw, "wb") if args.raw else None
+    rx = Receiver(args.format, raw_out)
+    port = None
+    try:
+        if args.port:
+            import serial
+            port = serial.Serial(args.port, args.baud, timeout=0.1)
+            if not args.no_start:
+                port.write(b"stream on\n")
+            while True:
+                rx.feed(port.read(4096))
+        else:
+            stream = open(args.file, "rb") if args.file else sys.stdin.buffer
+            while True:
+                chunk = stream.read(4096)
+                if not chunk:
+                    break
+                rx.feed(chunk)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if port is not None and not args.no_start:
+            port.write(b"stream off\n")
+        if raw_out:
+            raw_out.close()
+        rx.summary()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+"""Writes tools/tests/fixtures/log_fixture.bin, the log test_log_summary.py checks the summary against.
+
+The schema blob is encoded here from include/log_schema.h; log_summary_host refuses the file
+unless it is byte for byte the blob the firmware writes, so rebuilding the sidecar also checks
+this encoder. About 200 s of records at 5 Hz, with the clock starting just short of the uint32
+wrap, a 25 s gap, a 300 ms clock step back, unused (NAN) analog channels and IMU dropouts.
+
+Regenerate both files after a schema change:
+    tools/tests/make_log_fixture.py
+    g++ -std=c++17 -O2 -Iinclude tools/log_summary_host.cpp src/log_summary.cpp src/log_schema.cpp -o /tmp/log_summary_host
+    /tmp/log_summary_host tools/tests/fixtures/log_fixture.bin tools/tests/fixtures/log_fixture.lod
+"""
+import math
+import os
+import struct
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+
+import log_schema
+
+FIXTURES = os.path.join(os.path.dirname(os.path.abspath(__file__)), "fixtures")
+T0_MS = 0xFFFFFFFF - 45000          # Wraps 45 s in
+PERIOD_MS = 200
+GAP = (70000, 95000)                # No records in [start, end) ms after T0
+CLOCK_STEP_AT_MS = 150000           # The clock steps back 300 ms here
+NAN = float("nan")
+
+
+def encode_blob(schema):
+    """The blob logSchemaWriteBlob() writes for `schema`."""
+    body = b""
+    for field in schema.fields:
+        body += log_schema.FIELD_HEADER.pack(field.type_code, field.count, field.offset, field.scale)
+        for text in (field.name, field.unit):
+            body += bytes([len(text)]) + text.encode("ascii")
+    length = log_schema.BLOB_HEADER.size + len(body)
+    return log_schema.BLOB_HEADER.pack(log_schema.MAGIC, length, schema.version, schema.record_size,
+                                       len(schema.fields), 0) + body
+
+
+def rows():
+    """(elapsed_ms, values in field order) for every record."""
+    elapsed = 0
+    while elapsed < 200000:
+        t = elapsed / 1000.0
+        if not GAP[0] <= elapsed < GAP[1]:
+            imu_valid = not 120000 <= elapsed < 124000
+            accel = [0.3 * math.sin(t), 0.2 * math.cos(1.3 * t), 9.81 + 0.1 * math.sin(7 * t)]
+            gyro = [0.01 * math.sin(2 * t), 0.02 * math.cos(t), 0.05 * math.sin(0.2 * t)]
+            yield elapsed, [
+                47.3769 + t * 1e-5, 8.5417 + t * 2e-5, 410.0 + 5 * math.sin(t / 30), 8.0 + math.sin(t / 10),
+                9 + int(t) % 3, 3 if t > 5 else 0,
+                412.5 + 5 * math.sin(t / 30), math.cos(t / 30) / 6, 2.0 * math.cos(t / 30),
+                int(220 + 60 * math.sin(t / 4)), int(88 + 6 * math.sin(t / 9)),
+            ] + (accel + gyro if imu_valid else [NAN] * 6) + [
+                4.0 * math.sin(t / 6), -2.0 * math.cos(t / 30),
+                3.0 * math.sin(t / 5), 1.5 * math.cos(t / 7),
+                0.8 + 0.01 * (int(t * 5) % 7), NAN if int(t) % 10 == 3 else 3.3 - 0.001 * t,
+                NAN, NAN, NAN, NAN,
+            ]
+        elapsed += PERIOD_MS
+        if elapsed == CLOCK_STEP_AT_MS + PERIOD_MS:
+            elapsed -= 300 + PERIOD_MS  # One record 300 ms behind the previous, then carry on from there
+
+
+def write(path):
+    schema = log_schema.from_header()
+    with open(path, "wb") as f:
+        f.write(encode_blob(schema))
+        for elapsed, values in rows():
+            f.write(schema.struct.pack((T0_MS + elapsed) & 0xFFFFFFFF, *values))
+
+
+if __name__ == "__main__":
+    write(os.path.join(FIXTURES, "log_fixture.bin"))
@@ -0,0 +1,103 @@
+"""Runs log_download.py's client against log_device_sim.py over a pseudo-terminal.
+
+Run from the project root (needs pyserial, like the client itself):
+    python3 -m unittest discover tools/tests
+"""
+import os
+import random
+import subprocess
+import sys
+import tempfile
+import unittest
+
+TOOLS = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+sys.path.insert(0, TOOLS)
+from log_download import DownloadError, Link, download, list_files  # noqa: E402
+
+try:
+    import serial  # noqa: F401
+    HAVE_SERIAL = True
+except ImportError:
+    HAVE_SERIAL = False
+
+FILE_SIZE = 300 * 1024 + 123   # Not a multiple of the 4 KiB chunk or the request window
+WINDOW = 32 * 1024
+
+
+@unittest.skipUnless(HAVE_SERIAL, "pyserial not installed")
+class DownloadTest(unittest.TestCase):
+    def setUp(self):
+        self.served = tempfile.TemporaryDirectory()
+        self.local = tempfile.TemporaryDirectory()
+        self.content = random.Random(37).randbytes(FILE_SIZE)
+        with open(os.path.join(self.served.name, "log_000.bin"), "wb") as f:
+            f.write(self.content)
+        with open(os.path.join(self.served.name, "log_001.bin"), "wb") as f:
+            f.write(b"short")
+        self.sim = None
+        self.link = None
+
+    def tearDown(self):
+        if self.link:
+            self.link.serial.close()
+        if self.sim:
+            self.sim.terminate()
+            self.sim.wait()
+            self.sim.stdout.close()
+        self.served.cleanup()
+        self.local.cleanup()
+
+    def start(self, *options):
+        self.sim = subprocess.Popen([sys.executable, os.path.join(TOOLS, "log_device_sim.py"),
+                                     self.served.name] + list(options), stdout=subprocess.PIPE)
+        self.link = Link(self.sim.stdout.readline().decode().strip(), 115200)
+
+    def fetch(self, name="log_000.bin", restart=False):
+        path = os.path.join(self.local.name, name)
+        received, rerequests = download(self.link, name, path, WINDOW, 3, restart, progress=False)
+        with open(path, "rb") as f:
+            return received, rerequests, f.read()
+
+    def test_list(self):
+        self.start()
+        self.assertEqual(list_files(self.link), [("log_000.bin", FILE_SIZE), ("log_001.bin", 5)])
+
+    def test_clean_link(self):
+        self.start()
+        received, rerequests, data = self.fetch()
+        self.assertEqual(received, FILE_SIZE)
+        self.assertEqual(rerequests, 0)
+        self.assertEqual(data, self.content)
+
+    def test_recovers_corrupted_and_dropped_chunks(self):
+        self.start("--corrupt-every", "7", "--drop-every", "11")
+        received, rerequests, data = self.fetch()
+        self.assertEqual(received, FILE_SIZE)
+        self.assertGreater(rerequests, 0)
+        self.assertEqual(data, self.content)
+
+    def test_resumes_partial_file(self):
+        path = os.path.join(self.local.name, "log_000.bin")
+        with open(path, "wb") as f:
+            f.write(self.content[:100000])
+        self.start()
+        received, _, data = self.fetch()
+        self.assertEqual(received, FILE_SIZE)
+        self.assertEqual(data, self.content)
+
+        # A wrong partial file is only replaced with --restart
+        with open(path, "wb") as f:
+            f.write(b"x" * 1000)
+        _, _, data = self.fetch(restart=True)
+        self.assertEqual(data, self.content)
+
+    def test_small_file_and_missing_file(self):
+        self.start()
+        self.assertEqual(self.fetch("log_001.bin")[2], b"short")
+        with self.assertRaises(DownloadError) as raised:
+            self.fetch("log_999.bin")
+        self.assertIn("file not found", str(raised.exception))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,87 @@
+"""Checks the .lod summary of a fixture log against a brute-force aggregation of its records.
+
+tools/tests/fixtures/log_fixture.bin comes from make_log_fixture.py (clock wrap, gap, clock step,
+NAN channels); log_fixture.lod was built from it by tools/log_summary_host.cpp, the aggregation
+the firmware runs. When g++ is available the sidecar is also rebuilt and compared byte for byte.
+
+Run from the project root:
+    python3 -m unittest discover tools/tests
+"""
+import os
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import unittest
+
+TOOLS = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+ROOT = os.path.join(TOOLS, "..")
+sys.path.insert(0, TOOLS)
+import log_schema  # noqa: E402
+import log_summary  # noqa: E402
+
+FIXTURES = os.path.join(os.path.dirname(os.path.abspath(__file__)), "fixtures")
+LOG = os.path.join(FIXTURES, "log_fixture.bin")
+LOD = os.path.join(FIXTURES, "log_fixture.lod")
+
+
+def field_summary(schema):
+    return [(f.name, f.type_code, f.count, f.offset, f.scale, f.unit) for f in schema.fields]
+
+
+class LogSummaryTest(unittest.TestCase):
+    def test_fixture_schema_is_the_header_schema(self):
+        with open(LOG, "rb") as f:
+            schema, _ = log_schema.parse_blob(f.read())
+        header = log_schema.from_header()
+        self.assertEqual(header.version, schema.version)
+        self.assertEqual(header.record_size, schema.record_size)
+        self.assertEqual(field_summary(header), field_summary(schema))
+
+    def test_sidecar_matches_brute_force(self):
+        summary = log_summary.Summary(LOD)
+        self.assertTrue(summary.flags & log_summary.FLAG_COMPLETE)
+        self.assertFalse(summary.flags & log_summary.FLAG_OVERFLOW)
+        self.assertEqual([1000, 10000, 60000], [level.period_ms for level in summary.levels])
+        self.assertEqual([], log_summary.verify(summary, LOG))
+
+    def test_verify_command(self):
+        result = subprocess.run([sys.executable, os.path.join(TOOLS, "log_summary.py"), LOD, "--verify", LOG],
+                                capture_output=True, text=True)
+        self.assertEqual(0, result.returncode, result.stdout)
+        self.assertIn("matches the log", result.stdout)
+
+    def test_corrupted_bucket_is_reported(self):
+        summary = log_summary.Summary(LOD)
+        level = summary.level(10)
+        channel = summary.channels.index("power_watts")
+        bucket = 3
+        position = level.offset + bucket * summary.bucket_size + log_summary.BUCKET_HEAD.size + channel * 12 + 4
+        with open(LOD, "rb") as f:
+            data = bytearray(f.read())
+        struct.pack_into("<f", data, position, struct.unpack_from("<f", data, position)[0] + 1.0)
+        with tempfile.TemporaryDirectory() as tmp:
+            corrupted = os.path.join(tmp, "log_fixture.lod")
+            with open(corrupted, "wb") as f:
+                f.write(data)
+            problems = log_summary.verify(log_summary.Summary(corrupted), LOG)
+        self.assertEqual(1, len(problems), problems)
+        self.assertTrue(problems[0].startswith("10 s @"), problems[0])
+        self.assertIn("power_watts", problems[0])
+
+    @unittest.skipUnless(shutil.which("g++"), "g++ not installed")
+    def test_rebuilt_sidecar_is_identical(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            tool = os.path.join(tmp, "log_summary_host")
+            subprocess.run(["g++", "-std=c++17", "-O2", "-I" + os.path.join(ROOT, "include"),
+                            os.path.join(TOOLS, "log_summary_host.cpp"), os.path.join(ROOT, "src", "log_summary.cpp"),
+                            os.path.join(ROOT, "src", "log_schema.cpp"), "-o", tool], check=True)
+            rebuilt = os.path.join(tmp, "log_fixture.lod")
+            subprocess.run([tool, LOG, rebuilt], check=True, capture_output=True)
+            with open(rebuilt, "rb") as a, open(LOD, "rb") as b:
+                self.assertEqual(b.read(), a.read(), "log_summary changed: regenerate the fixture (make_log_fixture.py)")
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,205 @@
+"""Checks that tools/sensor_capture.py decodes Cycling Power notifications and IMU FIFO bursts as
+the firmware does.
+
+The vectors are the cases of test/test_cycling_power and test/test_imu_fifo_parser, written into a
+capture. Their expected values are asserted here as they are there, and when g++ is available the
+capture (and the golden replay capture) also goes through the device decoders in the host replay
+(`sensor_replay_host --trace`), whose output must match the Python decoder record for record.
+
+Run from the project root:
+    python3 -m unittest discover tools/tests
+"""
+import io
+import json
+import os
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import unittest
+
+TOOLS = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+sys.path.insert(0, TOOLS)
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import sensor_capture as sc  # noqa: E402
+import test_sensor_replay  # noqa: E402
+
+BALANCE, BALANCE_REFERENCE, TORQUE, WHEEL, CRANK = 0x0001, 0x0002, 0x0004, 0x0010, 0x0020
+FORCES, TORQUES, ANGLES, TOP_DEAD, BOTTOM_DEAD, ENERGY = 0x0040, 0x0080, 0x0100, 0x0200, 0x0400, 0x0800
+ALL = BALANCE | TORQUE | WHEEL | CRANK | FORCES | TORQUES | ANGLES | TOP_DEAD | BOTTOM_DEAD | ENERGY
+
+
+def build(flags, watts, balance=0, revolutions=0, event_time=0, top_deg=0, bottom_deg=0):
+    """Every optional field the flags announce, in spec order, with 0xA5 filler for the ones the
+    device skips (the build() of test/test_cycling_power)"""
+    out = struct.pack("<Hh", flags, watts)
+    if flags & BALANCE:
+        out += bytes([balance])
+    if flags & TORQUE:
+        out += b"\xa5" * 2
+    if flags & WHEEL:
+        out += b"\xa5" * 6
+    if flags & CRANK:
+        out += struct.pack("<HH", revolutions, event_time)
+    if flags & FORCES:
+        out += b"\xa5" * 4
+    if flags & TORQUES:
+        out += b"\xa5" * 4
+    if flags & ANGLES:
+        out += b"\xa5" * 3
+    if flags & TOP_DEAD:
+        out += struct.pack("<H", top_deg)
+    if flags & BOTTOM_DEAD:
+        out += struct.pack("<H", bottom_deg)
+    if flags & ENERGY:
+        out += b"\xa5" * 2
+    return out
+
+
+def word(tag, counter, x, y, z):
+    return struct.pack("<Bhhh", tag << 3 | (counter & 0x03) << 1, x, y, z)
+
+
+def sample(n, gyro_first=False):
+    """Sample n of test/test_imu_fifo_parser: accel (n, -n, 1000 + n), gyro (2n, -2n, 2000 + n)"""
+    accel = word(sc.TAG_ACCEL, n, n, -n, 1000 + n)
+    gyro = word(sc.TAG_GYRO, n, 2 * n, -2 * n, 2000 + n)
+    return gyro + accel if gyro_first else accel + gyro
+
+
+# (t_ms, type, payload, expected Python record fields) in capture order
+VECTORS = [
+    (0, sc.CP_MEASUREMENT, build(0, 287), {"power_watts": 287}),
+    (1, sc.CP_MEASUREMENT, build(0, -12), {"power_watts": 0}),
+    # Crank data; wrapping counters; coasting
+    (10, sc.CP_MEASUREMENT, build(CRANK, 250, revolutions=100, event_time=10000), {"cadence_rpm": 0}),
+    (11, sc.CP_MEASUREMENT, build(CRANK, 250, revolutions=102, event_time=11280), {"cadence_rpm": 96}),
+    (12, sc.CP_MEASUREMENT, build(CRANK, 250, revolutions=65535, event_time=65000), {}),
+    (13, sc.CP_MEASUREMENT, build(CRANK, 250, revolutions=1, event_time=104), {"cadence_rpm": 192}),
+    (14, sc.CP_MEASUREMENT, build(CRANK, 0, revolutions=1, event_time=1124), {"cadence_rpm": 0}),
+    # 0x0002 has no field and is not crank data
+    (20, sc.CP_MEASUREMENT, build(BALANCE | BALANCE_REFERENCE, 300, balance=96),
+     {"pedal_balance_percent": 48.0, "pedal_balance_reference": "left"}),
+    # Dead spots without the feature
+    (30, sc.CP_MEASUREMENT, build(TOP_DEAD | BOTTOM_DEAD, 200, top_deg=20, bottom_deg=200), {"power_watts": 200}),
+    (31, sc.CP_FEATURE, struct.pack("<I", sc.CP_FEATURE_DEAD_SPOT_ANGLES), None),
+    (32, sc.CP_MEASUREMENT, build(TOP_DEAD | BOTTOM_DEAD, 200, top_deg=20, bottom_deg=200),
+     {"top_dead_spot_deg": 20, "bottom_dead_spot_deg": 200}),
+    (33, sc.CP_MEASUREMENT, build(BOTTOM_DEAD, 200, bottom_deg=185), {"bottom_dead_spot_deg": 185}),
+    # Every field: the skipped ones keep crank data and dead spots aligned
+    (40, sc.CP_MEASUREMENT, build(ALL, 410, balance=100, revolutions=500, event_time=2048, top_deg=12,
+                                  bottom_deg=190), {}),
+    (41, sc.CP_MEASUREMENT, build(ALL, 410, balance=100, revolutions=501, event_time=2048 + 640, top_deg=15,
+                                  bottom_deg=193),
+     {"power_watts": 410, "pedal_balance_percent": 50.0, "cadence_rpm": 96, "top_dead_spot_deg": 15,
+      "bottom_dead_spot_deg": 193}),
+    (42, sc.CP_MEASUREMENT, build(TORQUE | CRANK, 200, revolutions=7, event_time=1000), {}),
+    (43, sc.CP_MEASUREMENT, build(TORQUE | CRANK, 200, revolutions=8, event_time=1640), {"cadence_rpm": 96}),
+    (44, sc.CP_MEASUREMENT, build(WHEEL | CRANK, 200, revolutions=9, event_time=2280), {"cadence_rpm": 96}),
+    (45, sc.CP_MEASUREMENT, build(WHEEL | CRANK, 200, revolutions=10, event_time=2920), {"cadence_rpm": 96}),
+    # Truncated notifications
+    (50, sc.CP_MEASUREMENT, b"\x20", {"short": ["flags"]}),
+    (51, sc.CP_MEASUREMENT, build(0, 150)[:3], {"short": ["power"]}),
+    (52, sc.CP_MEASUREMENT, build(CRANK, 150, revolutions=10), {}),
+    (53, sc.CP_MEASUREMENT, build(WHEEL | CRANK, 150, revolutions=11, event_time=640)[:-1],
+     {"power_watts": 150, "short": ["crank"]}),
+    (54, sc.CP_MEASUREMENT, build(CRANK, 150, revolutions=12, event_time=1280), {"cadence_rpm": 0}),
+    (55, sc.CP_MEASUREMENT, build(ANGLES | TOP_DEAD | BOTTOM_DEAD, 150, top_deg=10, bottom_deg=190)[:6],
+     {"short": ["top_dead_spot", "bottom_dead_spot"]}),
+    (56, sc.CP_MEASUREMENT, build(ANGLES | TOP_DEAD | BOTTOM_DEAD, 150, top_deg=10, bottom_deg=190)[:-1],
+     {"top_dead_spot_deg": 10, "short": ["bottom_dead_spot"]}),
+    # IMU: either order; orphans; counter wrap; a lost word across the wrap; unknown tags; a burst
+    # ending between the halves of a sample
+    (100, sc.IMU_FIFO, sample(0) + sample(1, True) + sample(2), {"samples": 3}),
+    (101, sc.IMU_FIFO, word(sc.TAG_GYRO, 3, 111, 222, 333) + sample(0) + sample(1),
+     {"samples": 2, "unpaired_words": 1}),
+    (102, sc.IMU_FIFO, word(sc.TAG_ACCEL, 2, 111, 222, 333) + sample(3), {"samples": 1, "unpaired_words": 1}),
+    (103, sc.IMU_FIFO, b"".join(sample(n, n % 3 == 0) for n in range(14)), {"samples": 14}),
+    (104, sc.IMU_FIFO, sample(2) + word(sc.TAG_ACCEL, 3, 3, -3, 1003) + sample(4),
+     {"samples": 2, "unpaired_words": 1}),
+    (105, sc.IMU_FIFO, word(sc.TAG_ACCEL, 0, 0, 0, 1000) + word(0x03, 0, 25, 0, 0) + word(sc.TAG_GYRO, 0, 0, 0, 2000),
+     {"samples": 1, "unknown_words": 1}),
+    (106, sc.IMU_FIFO, b"".join(sample(n) for n in range(20))[:17 * 7], {"samples": 8}),
+    (107, sc.IMU_FIFO, b"".join(sample(n) for n in range(20))[17 * 7:], {"samples": 12}),
+]
+
+
+def write_capture(path, chunks):
+    with open(path, "wb") as f:
+        f.write(sc.HEADER.pack(sc.MAGIC, sc.VERSION, sc.HEADER.size, 0))
+        for t_ms, kind, payload in chunks:
+            f.write(sc.CHUNK_HEAD.pack(t_ms, kind, len(payload)))
+            f.write(payload)
+
+
+def python_records(path):
+    out = io.StringIO()
+    sc.decode_session(path, ["cp_measurement", "imu_fifo"], out)
+    return [json.loads(line) for line in out.getvalue().splitlines()]
+
+
+def device_records(tool, path, card):
+    result = subprocess.run([tool, path, "-o", card, "--trace"], capture_output=True, text=True, check=True)
+    return [json.loads(line) for line in result.stdout.splitlines() if line.startswith("{")]
+
+
+class SensorCaptureTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        cls.tmp = tempfile.mkdtemp()
+        cls.capture = os.path.join(cls.tmp, "vectors.cap")
+        write_capture(cls.capture, [(t_ms, kind, payload) for t_ms, kind, payload, _ in VECTORS])
+
+    @classmethod
+    def tearDownClass(cls):
+        shutil.rmtree(cls.tmp)
+
+    def test_vectors(self):
+        records = python_records(self.capture)
+        expected = [(t_ms, fields) for t_ms, kind, _, fields in VECTORS if kind != sc.CP_FEATURE]
+        self.assertEqual(len(expected), len(records))
+        for (t_ms, fields), record in zip(expected, records):
+            self.assertEqual(t_ms, record["t_ms"])
+            if record["type"] == "imu_fifo":
+                self.assertEqual(fields.pop("samples"), len(record["samples"]), record)
+            for key, value in fields.items():
+                self.assertEqual(value, record.get(key), "t_ms %d: %r" % (t_ms, record))
+            if record["type"] == "cp_measurement" and "short" not in fields:
+                self.assertNotIn("short", record, record)
+            if t_ms == 30:
+                self.assertNotIn("top_dead_spot_deg", record)  # Not without the feature
+
+    def test_imu_samples_scale_and_time(self):
+        record = python_records(self.capture)[-2]  # Eight samples of the split burst
+        self.assertEqual(106, record["t_ms"])
+        first = record["samples"][0]
+        self.assertEqual([0.0, 0.0, 1000 * sc.ACCEL_MPS2_PER_LSB], first["accel_mps2"])
+        self.assertEqual([0.0, 0.0, 2000 * sc.GYRO_RADPS_PER_LSB], first["gyro_radps"])
+        self.assertAlmostEqual(106 + 7000.0 / sc.IMU_ODR_HZ, record["samples"][7]["t_ms"], places=3)
+
+    @unittest.skipUnless(shutil.which("g++"), "g++ not installed")
+    def test_device_decoders_agree(self):
+        tool = test_sensor_replay.build_replay(self.tmp)
+        for name, path in (("vectors", self.capture), ("golden", test_sensor_replay.CAPTURE)):
+            python = python_records(path)
+            device = device_records(tool, path, os.path.join(self.tmp, "card_" + name))
+            self.assertEqual(len(python), len(device), name)
+            for p, d in zip(python, device):
+                self.assertEqual((p["t_ms"], p["type"]), (d["t_ms"], d["type"]))
+                if d["type"] == "cp_measurement":
+                    self.assertEqual(d["short"], p.get("short", []), p)
+                    for key in ("power_watts", "cadence_rpm", "pedal_balance_percent", "top_dead_spot_deg",
+                                "bottom_dead_spot_deg"):
+                        default = 0 if key in ("power_watts", "cadence_rpm") else None
+                        self.assertEqual(d.get(key, default), p.get(key, default), "%s: %r vs %r" % (key, p, d))
+                else:
+                    self.assertEqual(d["unpaired_words"], p.get("unpaired_words", 0), p["t_ms"])
+                    self.assertEqual(len(d["samples"]), len(p["samples"]), p["t_ms"])
+                    for values, s in zip(d["samples"], p["samples"]):
+                        for a, b in zip(values, s["accel_mps2"] + s["gyro_radps"]):
+                            self.assertAlmostEqual(a, b, delta=1e-6 * max(1.0, abs(b)))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,136 @@
+"""Replays tools/tests/fixtures/replay_golden.cap through the host build of the firmware pipeline
+(tools/sensor_replay_host.cpp) and checks the files it writes against known CRCs.
+
+The capture is `sensor_capture.py synth replay_golden.cap --minutes 0.5 --seed 1`. The replay
+logs through log_rotation and event_log on a virtual clock, so the same capture gives the same
+bytes; a CRC that moves means the decoders, the record layout, the summary or the logging path
+changed what reaches the card. When that is intended, update GOLDEN from the replay's output.
+
+Run from the project root:
+    python3 -m unittest discover tools/tests
+"""
+import bisect
+import math
+import os
+import re
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import unittest
+
+TOOLS = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+ROOT = os.path.join(TOOLS, "..")
+sys.path.insert(0, TOOLS)
+import log_schema  # noqa: E402
+import log_summary  # noqa: E402
+import sensor_capture  # noqa: E402
+
+CAPTURE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "fixtures", "replay_golden.cap")
+SOURCES = ["nmea_parser", "cycling_power", "record_assembler", "sensor_capture", "imu_fifo_parser",
+           "attitude_filter", "elevation_filter", "power_analytics", "mean_max_power", "log_backpressure",
+           "log_schema", "log_summary", "log_rotation", "event_log", "frame_codec", "DataBuffer", "log_writer"]
+
+# (bytes, crc32) per file
+GOLDEN = {
+    "log_000.bin": (606457, 0xec6423fb),
+    "log_000.evt": (0, 0x00000000),
+    "log_000.lod": (186210, 0xe28b6f5a),
+}
+GOLDEN_STALLED = {
+    "log_000.bin": (548079, 0x7fdc7b5c),
+    "log_000.evt": (112, 0x6daabe43),
+    "log_000.lod": (186210, 0xaa81b3c8),
+}
+
+
+def build_replay(directory):
+    """Compiles tools/sensor_replay_host.cpp into `directory`; returns the executable"""
+    tool = os.path.join(directory, "sensor_replay_host")
+    subprocess.run(["g++", "-std=c++17", "-O2", "-I" + os.path.join(ROOT, "include"),
+                    "-I" + os.path.join(TOOLS, "host"), os.path.join(TOOLS, "sensor_replay_host.cpp"),
+                    os.path.join(TOOLS, "host", "host_platform.cpp")]
+                   + [os.path.join(ROOT, "src", name + ".cpp") for name in SOURCES] + ["-o", tool], check=True)
+    return tool
+
+
+def crc_lines(stdout):
+    return {m.group(1): (int(m.group(2)), int(m.group(3), 16))
+            for m in re.finditer(r"^(log_\d+\.\w+): (\d+) bytes, crc32 ([0-9a-f]{8})$", stdout, re.M)}
+
+
+@unittest.skipUnless(shutil.which("g++"), "g++ not installed")
+class SensorReplayTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        cls.tmp = tempfile.mkdtemp()
+        cls.tool = build_replay(cls.tmp)
+
+    @classmethod
+    def tearDownClass(cls):
+        shutil.rmtree(cls.tmp)
+
+    def replay(self, card, *options):
+        result = subprocess.run([self.tool, CAPTURE, "-o", card] + list(options), capture_output=True, text=True)
+        self.assertEqual(0, result.returncode, result.stderr)
+        return result.stdout
+
+    def test_golden_crcs(self):
+        card = os.path.join(self.tmp, "golden")
+        stdout = self.replay(card)
+        self.assertIn("0 skipped, 0 dropped", stdout)
+        self.assertEqual(GOLDEN, crc_lines(stdout), stdout)
+        summary = log_summary.Summary(os.path.join(card, "log_000.lod"))
+        self.assertEqual([], log_summary.verify(summary, os.path.join(card, "log_000.bin")))
+
+    def test_records_carry_analog_channels(self):
+        # The acquisition path copies the latest decimated analog values (analogGetLatest() on the
+        # device, CAPTURE_ANALOG chunks here) into analog_ch of every record
+        card = os.path.join(self.tmp, "analog")
+        self.replay(card)
+        with open(CAPTURE, "rb") as f:
+            analog = [(t, struct.unpack("<8f", payload)) for t, kind, payload in sensor_capture.read_chunks(f.read())
+                      if kind == sensor_capture.ANALOG]
+        times = [t for t, _ in analog]
+        checked = 0
+        for _, row in log_schema.decode_file(os.path.join(card, "log_000.bin")):
+            i = bisect.bisect_right(times, row["system_timestamp_ms"]) - 1
+            if i < 0:
+                self.assertTrue(all(math.isnan(v) for v in row["analog_ch"]), row)
+                continue
+            for got, want in zip(row["analog_ch"], analog[i][1]):
+                if math.isnan(want):
+                    self.assertTrue(math.isnan(got), row)
+                else:
+                    self.assertEqual(want, got, row)
+            checked += 1
+        self.assertGreater(checked, 5000)
+
+    def test_replay_is_deterministic(self):
+        first = os.path.join(self.tmp, "first")
+        second = os.path.join(self.tmp, "second")
+        self.assertEqual(self.replay(first), self.replay(second))
+        for name in sorted(os.listdir(first)):
+            with open(os.path.join(first, name), "rb") as a, open(os.path.join(second, name), "rb") as b:
+                self.assertEqual(a.read(), b.read(), name)
+
+    def test_stalled_card_decimates(self):
+        card = os.path.join(self.tmp, "stalled")
+        stdout = self.replay(card, "--stall-every", "30000", "--stall-ms", "9000")
+        self.assertIn("log rate full -> decimated", stdout)
+        self.assertIn("log rate decimated -> full", stdout)
+        self.assertEqual(GOLDEN_STALLED, crc_lines(stdout), stdout)
+        summary = log_summary.Summary(os.path.join(card, "log_000.lod"))
+        self.assertEqual([], log_summary.verify(summary, os.path.join(card, "log_000.bin")))
+
+    def test_refuses_a_used_card(self):
+        card = os.path.join(self.tmp, "used")
+        os.mkdir(card)
+        open(os.path.join(card, "log_000.bin"), "wb").close()
+        result = subprocess.run([self.tool, CAPTURE, "-o", card], capture_output=True, text=True)
+        self.assertNotEqual(0, result.returncode)
+
+
+if __name__ == "__main__":
+    unittest.main()
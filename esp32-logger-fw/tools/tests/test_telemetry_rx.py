@@ -0,0 +1,81 @@
+"""Tests for the telemetry receiver: frame decoding and sequence gap reporting.
+
+Run from the project root:
+    python3 -m unittest discover tools/tests
+"""
+import io
+import os
+import struct
+import sys
+import unittest
+from contextlib import redirect_stderr, redirect_stdout
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+from frame_codec import encode_frame  # noqa: E402
+from telemetry_rx import Receiver  # noqa: E402
+
+# Same frames as test/test_frame_codec, produced there by the device's frameEncode()
+GOLDEN_POWER_FRAME = bytes.fromhex("02010434120803e8030102fa075affed20865b00")
+GOLDEN_ZEROS_FRAME = bytes.fromhex("02030207020401010201053ba9f28000")
+
+
+def power_frame(seq, t_ms=1000, watts=250, cadence=90, balance=0xFF):
+    return encode_frame(1, seq, struct.pack("<IHBB", t_ms, watts, cadence, balance))
+
+
+class ReceiverTest(unittest.TestCase):
+    def run_rx(self, data, chunk=None):
+        """Feeds `data` (optionally in `chunk`-byte pieces) and returns (receiver, stdout, stderr)."""
+        rx = Receiver("json", None)
+        out, err = io.StringIO(), io.StringIO()
+        with redirect_stdout(out), redirect_stderr(err):
+            step = chunk or len(data) or 1
+            for i in range(0, len(data), step):
+                rx.feed(data[i:i + step])
+        return rx, out.getvalue(), err.getvalue()
+
+    def test_encoder_matches_device_bytes(self):
+        self.assertEqual(power_frame(0x1234), GOLDEN_POWER_FRAME)
+        self.assertEqual(encode_frame(3, 7, bytes([0, 0, 1, 0])), GOLDEN_ZEROS_FRAME)
+
+    def test_decodes_golden_power_frame(self):
+        rx, out, err = self.run_rx(GOLDEN_POWER_FRAME)
+        self.assertEqual((rx.frames, rx.lost, rx.bad), (1, 0, 0))
+        self.assertIn('"type": "power", "seq": 4660, "t_ms": 1000, "power_w": 250, "cadence_rpm": 90', out)
+        self.assertIn('"left_balance_pct": null', out)
+        self.assertEqual(err, "")
+
+    def test_frames_split_across_reads(self):
+        data = b"".join(power_frame(s, t_ms=s * 250) for s in range(50))
+        rx, out, err = self.run_rx(data, chunk=7)
+        self.assertEqual((rx.frames, rx.lost, rx.bad), (50, 0, 0))
+        self.assertEqual(len(out.splitlines()), 50)
+
+    def test_reports_sequence_gaps(self):
+        seqs = [10, 11, 12, 15, 16, 20]
+        rx, _, err = self.run_rx(b"".join(power_frame(s) for s in seqs))
+        self.assertEqual((rx.frames, rx.lost), (6, 5))
+        self.assertIn("2 frame(s) lost before seq 15", err)
+        self.assertIn("3 frame(s) lost before seq 20", err)
+        self.assertEqual(len(err.splitlines()), 2)
+
+    def test_sequence_wrap_is_not_a_gap(self):
+        rx, _, err = self.run_rx(b"".join(power_frame(s) for s in (0xFFFE, 0xFFFF, 0, 1)))
+        self.assertEqual((rx.frames, rx.lost), (4, 0))
+        self.assertEqual(err, "")
+        rx, _, err = self.run_rx(b"".join(power_frame(s) for s in (0xFFFE, 1)))
+        self.assertEqual(rx.lost, 2)
+
+    def test_text_and_corruption_count_as_bad(self):
+        corrupt = bytearray(power_frame(2))
+        corrupt[8] ^= 0x40
+        data = (power_frame(1) + b"[GPS] fix acquired\r\n\x00" + bytes(corrupt) + power_frame(3))
+        rx, out, err = self.run_rx(data)
+        self.assertEqual((rx.frames, rx.bad), (2, 2))
+        # The corrupted frame is missing from the sequence, so it also shows up as a gap
+        self.assertEqual(rx.lost, 1)
+        self.assertEqual(len(out.splitlines()), 2)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""Converts a `trace dump` capture into Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+
+Capture the terminal output of `trace dump` to a file (anything outside the
+TRACE BEGIN/TRACE END block is ignored), then:
+    trace2chrome.py capture.txt -o trace.json
+
+Each core's records carry that core's 32-bit cycle counter. Sync records pair it with the shared
+esp_timer clock about once a second, so both cores land on one timeline in microseconds.
+Begin/end pairs become complete ("X") events on the core where they began; a task that migrated
+in between is still matched by its task handle.
+"""
+import argparse
+import json
+import sys
+
+
+def parse(lines):
+    header = {}
+    names = {}
+    tasks = {}
+    records = {}
+    inside = False
+    for line in lines:
+        line = line.strip()
+        if line.startswith("TRACE BEGIN"):
+            inside = True
+            for field in line.split()[2:]:
+                key, _, value = field.partition("=")
+                header[key] = int(value)
+            continue
+        if not inside:
+            continue
+        if line == "TRACE END":
+            break
+        kind, _, rest = line.partition(" ")
+        if kind == "N":
+            ident, _, name = rest.partition(" ")
+            names[int(ident)] = name
+        elif kind == "T":
+            handle, _, name = rest.partition(" ")
+            tasks[int(handle, 16)] = name
+        elif kind == "R":
+            core, cycles, phase, ident, task, arg = rest.split()
+            records.setdefault(int(core), []).append(
+                (int(cycles), phase, int(ident), int(task, 16), int(arg)))
+    if not inside:
+        sys.exit("No TRACE BEGIN block found")
+    return header, names, tasks, records
+
+
+def to_microseconds(core_records, mhz):
+    """Yields (us, phase, id, task, arg) for every non-sync record that has a sync to anchor to."""
+    syncs = [(i, r[0], (r[3] << 32) | r[4]) for i, r in enumerate(core_records) if r[1] == "S"]
+    if not syncs:
+        return
+    next_sync = 0
+    for i, (cycles, phase, ident, task, arg) in enumerate(core_records):
+        if phase == "S":
+            continue
+        while next_sync + 1 < len(syncs) and syncs[next_sync + 1][0] <= i:
+            next_sync += 1
+        index, sync_cycles, sync_us = syncs[next_sync]
+        if index <= i:
+            delta = (cycles - sync_cycles) & 0xFFFFFFFF
+            us = sync_us + delta / mhz
+        else:
+            # Records older than the first surviving sync (the ring wrapped): count backwards
+            delta = (sync_cycles - cycles) & 0xFFFFFFFF
+            us = sync_us - delta / mhz
+        yield us, phase, ident, task, arg
+
+
+def convert(header, names, tasks, records):
+    mhz = float(header.get("cpu_mhz", 240))
+    events = []
+    for core in sorted(records):
+        events.append({"name": "process_name", "ph": "M", "pid": core, "args": {"name": "Core %d" % core}})
+    stamped = []
+    for core, core_records in records.items():
+        for us, phase, ident, task, arg in to_microseconds(core_records, mhz):
+            stamped.append((us, core, phase, ident, task, arg))
+    stamped.sort(key=lambda e: e[0])
+
+    seen_threads = set()
+    open_spans = {}   # (task, id) -> stack of (us, core)
+    for us, core, phase, ident, task, arg in stamped:
+        name = names.get(ident, "event %d" % ident)
+        if (core, task) not in seen_threads:
+            seen_threads.add((core, task))
+            events.append({"name": "thread_name", "ph": "M", "pid": core, "tid": task,
+                           "args": {"name": tasks.get(task, "task %08x" % task)}})
+        if phase == "B":
+            open_spans.setdefault((task, ident), []).append((us, core))
+        elif phase == "E":
+            stack = open_spans.get((task, ident))
+            if not stack:
+                continue  # Begin was overwritten in the ring
+            start, start_core = stack.pop()
+            event = {"name": name, "ph": "X", "ts": start, "dur": max(us - start, 0.0),
+                     "pid": start_core, "tid": task}
+            if arg:
+                event["args"] = {"arg": arg}
+            events.append(event)
+        elif phase == "I":
+            events.append({"name": name, "ph": "i", "s": "t", "ts": us, "pid": core, "tid": task,
+                           "args": {"arg": arg}})
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", nargs="?", help="Text captured from `trace dump` (default: stdin)")
+    parser.add_argument("-o", "--output", help="JSON output file (default: stdout)")
+    args = parser.parse_args()
+
+    source = open(args.capture, errors="replace") if args.capture else sys.stdin
+    trace = convert(*parse(source))
+    out = open(args.output, "w") if args.output else sys.stdout
+    json.dump(trace, out)
+    if args.output:
+        out.close()
+        print("%d events written to %s" % (len(trace["traceEvents"]), args.output), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()